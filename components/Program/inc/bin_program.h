@@ -7,6 +7,7 @@
  * Date           Author       Notes
  * 2023-9-8      lihongquan   Initial version
  * 2026-3-16     Refactor     Improved interface documentation
+ * 2026-10-19    hongquan.li   report the final flush from clean()
  */
 #pragma once
 
@@ -62,7 +63,8 @@ public:
     virtual size_t get_program_address(void) override;
     
     /**
-     * @brief Clean up and reset programmer state
+     * @brief Flush the last page, then clean up and reset programmer state
+     * @return true if the final flush and the algorithm uninit succeeded
      */
-    virtual void clean(void) override;
+    virtual bool clean(void) override;
 };
\ No newline at end of file
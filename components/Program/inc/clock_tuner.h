@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add SWJ clock auto-tuning
+ * 2026-10-19    hongquan.li   drop the boot-time restore, clocks are per target only
+ */
+#pragma once
+
+#include <cstdint>
+#include "swd_iface.h"
+
+/**
+ * @brief SWJ clock auto-tuner
+ *
+ * Steps the SWJ clock up from a safe rate while checking DP IDCODE reads
+ * and MEM-AP TAR write/read patterns, and backs off at the first parity
+ * error, WAIT storm or mismatch. The fastest reliable clock is cached in
+ * NVS per target IDCODE and re-checked on every attach before it is used.
+ * It becomes the default SWJ clock, explicit host DAP_SWJ_Clock requests
+ * still apply as requested.
+ */
+class ClockTuner
+{
+private:
+    static constexpr uint32_t _safe_clock = 1000000;    ///< Clock used to identify the target
+    static constexpr uint32_t _test_rounds = 16;        ///< Test iterations per clock step
+    static constexpr uint32_t _wait_limit = 8;          ///< WAIT acks tolerated per transfer
+
+    uint32_t _tar_ref[4];                               ///< TAR readback at the safe clock
+
+    /**
+     * @brief Private constructor (Singleton pattern)
+     */
+    ClockTuner() = default;
+
+    /**
+     * @brief Perform a raw transfer and classify the result
+     * @param swd SWD interface
+     * @param req Transfer request
+     * @param data Data buffer, may be nullptr for reads
+     * @return true if the transfer completed with an OK acknowledge
+     */
+    bool transfer(SWDIface &swd, uint32_t req, uint32_t *data);
+
+    /**
+     * @brief Run the link test at the current clock
+     * @param swd SWD interface, debug port already powered up
+     * @param idcode Expected DP IDCODE
+     * @param learn true to record the TAR readback as reference
+     * @return true if all test rounds passed
+     */
+    bool check_link(SWDIface &swd, uint32_t idcode, bool learn);
+
+    /**
+     * @brief Connect at a clock and run the link test
+     * @param swd SWD interface
+     * @param clock SWJ clock in Hz
+     * @param idcode Expected DP IDCODE
+     * @return true if the target is reliable at this clock
+     */
+    bool try_clock(SWDIface &swd, uint32_t clock, uint32_t idcode);
+
+    /**
+     * @brief Load the cached clock for a target from NVS
+     * @param key NVS key
+     * @param clock Pointer to store the clock
+     * @return true if a cached value exists
+     */
+    bool load(const char *key, uint32_t *clock);
+
+    /**
+     * @brief Store the clock for a target in NVS
+     * @param key NVS key
+     * @param clock Clock in Hz
+     */
+    void store(const char *key, uint32_t clock);
+
+public:
+    /**
+     * @brief Get singleton instance
+     * @return Reference to ClockTuner instance
+     */
+    static ClockTuner &get_instance();
+
+    /**
+     * @brief Find the fastest reliable clock for the connected target
+     *
+     * Uses the cached clock when it still passes the link test, otherwise
+     * sweeps the clock range. The result is installed as default SWJ clock.
+     *
+     * @param swd SWD interface
+     * @param clock Pointer to store the selected clock, may be nullptr
+     * @return true on success, false if the target could not be reached
+     */
+    bool tune(SWDIface &swd, uint32_t *clock);
+};
@@ -7,6 +7,7 @@
  * Date           Author       Notes
  * 2023-9-8      lihongquan   Initial version
  * 2026-3-16     Refactor     Improved interface documentation
+ * 2026-10-19    hongquan.li   program whole pages straight from the caller buffer
  */
 #pragma once
 
@@ -75,6 +76,10 @@ public:
     
     /**
      * @brief Write data to flash with buffering
+     *
+     * Whole aligned pages are programmed straight from data, only partial
+     * pages go through the page buffer.
+     *
      * @param addr Target address
      * @param data Data buffer
      * @param size Data size
@@ -7,6 +7,7 @@
  * Date           Author       Notes
  * 2023-9-8      lihongquan   Initial version
  * 2026-3-16     Refactor     Improved interface structure and documentation
+ * 2026-10-19    hongquan.li   add programming phase timing
  */
 #pragma once
 
@@ -73,6 +74,30 @@ public:
         FLASH_STATE_ERROR
     } state_t;
 
+    /**
+     * @brief Programming phases timed by the flash driver
+     */
+    typedef enum
+    {
+        PHASE_CONNECT,          ///< Reset and attach, including SWJ clock tuning
+        PHASE_ALGO_DOWNLOAD,    ///< Flash algorithm written to target RAM
+        PHASE_ERASE,            ///< Sector or chip erase
+        PHASE_PROGRAM,          ///< Page data transfer and program_page calls
+        PHASE_VERIFY,           ///< Verify calls or readback compare
+        PHASE_RESET,            ///< Algorithm uninit and target restart
+        PHASE_COUNT
+    } phase_t;
+
+    /**
+     * @brief Time spent in one programming phase
+     */
+    typedef struct
+    {
+        int64_t start_us;   ///< esp_timer time the phase was first entered, 0 if never
+        int64_t total_us;   ///< Time accumulated over all entries
+        uint32_t count;     ///< Number of entries
+    } phase_time_t;
+
     /**
      * @brief Information about a flash sector
      */
@@ -7,6 +7,7 @@
  * Date           Author       Notes
  * 2023-9-8      lihongquan   Initial version
  * 2026-3-16     Refactor     Improved interface documentation
+ * 2026-10-19    hongquan.li   report the final flush from clean()
  */
 #pragma once
 
@@ -67,7 +68,8 @@ public:
     bool write(uint8_t *data, size_t len);
     
     /**
-     * @brief Clean up and reset programmer state
+     * @brief Flush the last page, then clean up and reset programmer state
+     * @return true if the final flush and the algorithm uninit succeeded
      */
-    void clean(void);
+    bool clean(void);
 };
@@ -7,6 +7,8 @@
  * Date           Author       Notes
  * 2023-9-8      lihongquan   Initial version
  * 2026-3-16     Refactor     Improved interface structure and documentation
+ * 2026-10-19    hongquan.li   add target presence detection
+ * 2026-10-19    hongquan.li   expose core register access
  */
 #pragma once
 
@@ -113,6 +115,39 @@ public:
     bool write_memory(uint32_t address, uint8_t *data, uint32_t size);
     bool flash_syscall_exec(const syscall_t *sysCallParam, uint32_t entry, uint32_t arg1, uint32_t arg2, uint32_t arg3, uint32_t arg4);
 
+    /**
+     * @brief Check for a target on the wire
+     *
+     * Only switches the line to SWD and reads DP IDCODE, the target is not
+     * powered up or halted. The caller calls init() before and off() after.
+     *
+     * @param id Output: DP IDCODE
+     * @return true if a target answered
+     */
+    bool detect_target(uint32_t *id);
+
+    /**
+     * @brief Read a core register through DCRSR/DCRDR
+     *
+     * The core must be halted.
+     *
+     * @param n Register selector, 0-15 for R0-R15, 16 for xPSR, 17 MSP, 18 PSP
+     * @param val Output: register value
+     * @return true on success
+     */
+    bool read_core_register(uint32_t n, uint32_t *val);
+
+    /**
+     * @brief Write a core register through DCRSR/DCRDR
+     *
+     * The core must be halted.
+     *
+     * @param n Register selector, see read_core_register()
+     * @param val Register value
+     * @return true on success
+     */
+    bool write_core_register(uint32_t n, uint32_t val);
+
 protected:
     typedef struct
     {
@@ -136,8 +171,6 @@ protected:
     bool write_word(uint32_t addr, uint32_t val);
     bool read_byte(uint32_t addr, uint8_t *val);
     bool write_byte(uint32_t addr, uint8_t val);
-    bool read_core_register(uint32_t n, uint32_t *val);
-    bool write_core_register(uint32_t n, uint32_t val);
     bool write_debug_state(debug_state_t *state);
     bool wait_until_halted(void);
     bool swd_reset(void);
@@ -7,6 +7,7 @@
  * Date           Author       Notes
  * 2023-9-8      lihongquan   Initial version
  * 2026-3-16     Refactor     Improved interface documentation
+ * 2026-10-19    hongquan.li   add programming phase timing
  */
 #pragma once
 
@@ -30,6 +31,20 @@ private:
     uint32_t _flash_start_addr;            ///< Flash start address
     const region_info_t *_default_flash_region;  ///< Default flash region
     uint8_t _verify_buf[256];              ///< Buffer for verify operations
+    phase_time_t _phase_time[PHASE_COUNT]; ///< Time spent per programming phase
+    int64_t _phase_start;                  ///< Entry time of the running phase
+
+    /**
+     * @brief Enter a programming phase
+     * @param phase Phase
+     */
+    void phase_begin(phase_t phase);
+
+    /**
+     * @brief Leave a programming phase and account its duration
+     * @param phase Phase
+     */
+    void phase_end(phase_t phase);
 
     /**
      * @brief Start flash function execution
@@ -118,4 +133,15 @@ public:
      * @return ERR_NONE on success
      */
     virtual err_t flash_algo_set(uint32_t addr) override;
+
+    /**
+     * @brief Clear the phase timing, call before a job starts
+     */
+    void clear_phase_times(void);
+
+    /**
+     * @brief Get the phase timing accumulated since clear_phase_times()
+     * @return PHASE_COUNT entries indexed by phase_t
+     */
+    const phase_time_t *get_phase_times(void);
 };
\ No newline at end of file
@@ -6,6 +6,7 @@
  * Change Logs:
  * Date           Author       Notes
  * 2023-9-8      lihongquan   add license declaration
+ * 2026-10-19    hongquan.li   report the final flush from clean()
  */
 #include "log.h"
 #include "bin_program.h"
@@ -57,8 +58,9 @@ size_t BinaryProgram::get_program_address(void)
     return _program_addr;
 }
 
-void BinaryProgram::clean()
+bool BinaryProgram::clean()
 {
     _program_addr = 0;
-    _flash_accessor.uninit();
+
+    return (_flash_accessor.uninit() == FlashIface::ERR_NONE);
 }
\ No newline at end of file
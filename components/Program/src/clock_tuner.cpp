@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add SWJ clock auto-tuning
+ * 2026-10-19    hongquan.li   drop the boot-time restore, clocks are per target only
+ */
+#include "clock_tuner.h"
+#include "debug_cm.h"
+#include "swj_clock.h"
+#include "log.h"
+#include "nvs.h"
+#include "sdkconfig.h"
+#include <cstdio>
+
+#define TAG "clock_tuner"
+
+#define NVS_NAMESPACE "swj_clock"
+
+// SWD register access
+#define SWD_REG_AP (1)
+#define SWD_REG_DP (0)
+#define SWD_REG_R (1 << 1)
+#define SWD_REG_W (0 << 1)
+#define SWD_REG_ADR(a) (a & 0x0c)
+
+#define DP_IDCODE 0x00U
+#define DP_RDBUFF 0x0CU
+
+#ifndef CONFIG_DEBUG_PROBE_SWJ_AUTO_TUNE_MAX
+#define CONFIG_DEBUG_PROBE_SWJ_AUTO_TUNE_MAX 10000000
+#endif
+
+static const uint32_t s_clock_steps[] = {
+    1000000, 2000000, 4000000, 6000000, 8000000, 10000000, 12000000, 16000000, 20000000,
+};
+
+static const uint32_t s_tar_patterns[4] = {
+    0xAAAAAAA8, 0x55555554, 0xFFFFFFFC, 0x00000000,
+};
+
+ClockTuner &ClockTuner::get_instance()
+{
+    static ClockTuner instance;
+    return instance;
+}
+
+bool ClockTuner::transfer(SWDIface &swd, uint32_t req, uint32_t *data)
+{
+    SWDIface::transfer_err_def ack = SWDIface::TRANSFER_OK;
+
+    for (uint32_t i = 0; i <= _wait_limit; i++)
+    {
+        ack = swd.transer(req, data);
+
+        if (ack != SWDIface::TRANSFER_WAIT)
+        {
+            break;
+        }
+    }
+
+    // WAIT storm, parity error (TRANSFER_ERROR), FAULT or no response
+    return (ack == SWDIface::TRANSFER_OK);
+}
+
+bool ClockTuner::check_link(SWDIface &swd, uint32_t idcode, bool learn)
+{
+    uint32_t val = 0;
+    uint32_t data = 0;
+
+    for (uint32_t round = 0; round < _test_rounds; round++)
+    {
+        if (!transfer(swd, SWD_REG_DP | SWD_REG_R | SWD_REG_ADR(DP_IDCODE), &val) || (val != idcode))
+        {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < sizeof(s_tar_patterns) / sizeof(s_tar_patterns[0]); i++)
+        {
+            data = s_tar_patterns[i];
+
+            if (!transfer(swd, SWD_REG_AP | SWD_REG_W | SWD_REG_ADR(AP_TAR), &data))
+            {
+                return false;
+            }
+
+            // AP reads are posted, the value comes back through RDBUFF
+            if (!transfer(swd, SWD_REG_AP | SWD_REG_R | SWD_REG_ADR(AP_TAR), nullptr) ||
+                !transfer(swd, SWD_REG_DP | SWD_REG_R | SWD_REG_ADR(DP_RDBUFF), &val))
+            {
+                return false;
+            }
+
+            // Some MEM-APs do not implement every TAR bit, compare against the safe clock result
+            if (learn && (round == 0))
+            {
+                _tar_ref[i] = val;
+            }
+            else if (val != _tar_ref[i])
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool ClockTuner::try_clock(SWDIface &swd, uint32_t clock, uint32_t idcode)
+{
+    swj_clock_set_tuned(clock);
+
+    if (!swd.init_debug())
+    {
+        return false;
+    }
+
+    return check_link(swd, idcode, false);
+}
+
+bool ClockTuner::load(const char *key, uint32_t *clock)
+{
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
+
+    if (err != ESP_OK)
+    {
+        return false;
+    }
+
+    err = nvs_get_u32(handle, key, clock);
+    nvs_close(handle);
+
+    return (err == ESP_OK);
+}
+
+void ClockTuner::store(const char *key, uint32_t clock)
+{
+    nvs_handle_t handle;
+
+    if (nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK)
+    {
+        LOG_WARN("nvs open failed, tuned clock not cached");
+        return;
+    }
+
+    if ((nvs_set_u32(handle, key, clock) != ESP_OK) || (nvs_commit(handle) != ESP_OK))
+    {
+        LOG_WARN("nvs write failed, tuned clock not cached");
+    }
+
+    nvs_close(handle);
+}
+
+bool ClockTuner::tune(SWDIface &swd, uint32_t *clock)
+{
+    char key[16];
+    uint32_t idcode = 0;
+    uint32_t cached = 0;
+    uint32_t best = 0;
+
+    // Identify the target at a clock every wiring can handle
+    swj_clock_set_tuned(_safe_clock);
+
+    if (!swd.init_debug() || !swd.read_dp(DP_IDCODE, &idcode) || !check_link(swd, idcode, true))
+    {
+        LOG_ERROR("target not reachable at %lu Hz", _safe_clock);
+        swj_clock_set_tuned(0);
+        return false;
+    }
+
+    snprintf(key, sizeof(key), "%08lx", idcode);
+
+    if (load(key, &cached) && try_clock(swd, cached, idcode))
+    {
+        best = cached;
+    }
+    else
+    {
+        best = _safe_clock;
+
+        for (auto step : s_clock_steps)
+        {
+            if ((step <= _safe_clock) || (step > CONFIG_DEBUG_PROBE_SWJ_AUTO_TUNE_MAX))
+            {
+                continue;
+            }
+
+            if (!try_clock(swd, step, idcode))
+            {
+                break;
+            }
+
+            best = step;
+        }
+
+        store(key, best);
+    }
+
+    // Leave the debug port connected at the selected clock
+    swj_clock_set_tuned(best);
+    swd.init_debug();
+
+    LOG_INFO("target %08lx SWJ clock %lu Hz%s", idcode, best, (best == cached) ? " (cached)" : "");
+
+    if (clock)
+    {
+        *clock = best;
+    }
+
+    return true;
+}
@@ -7,6 +7,7 @@
  * Date           Author       Notes
  * 2023-9-8      lihongquan   Initial version
  * 2026-3-16     Refactor     Fixed typos and improved code style
+ * 2026-10-19    hongquan.li   report the final flush from clean()
  */
 #include "file_programmer.h"
 #include "log.h"
@@ -102,9 +103,16 @@ bool FileProgrammer::program(const std::string &path, FlashIface::target_cfg_t &
         }
     }
 
-    set_program_progress(100);
     fclose(fp);
-    iface->clean();
+
+    /* The last page is only written by the flush in clean() */
+    if (iface->clean() != true)
+    {
+        LOG_ERROR("Failed to flush at address: 0x%lx", (unsigned long)iface->get_program_address());
+        return false;
+    }
+
+    set_program_progress(100);
 
     return true;
 }
@@ -6,6 +6,7 @@
  * Change Logs:
  * Date           Author       Notes
  * 2023-9-8      lihongquan   add license declaration
+ * 2026-10-19    hongquan.li   program whole pages straight from the caller buffer
  */
 #include "log.h"
 #include "flash_accessor.h"
@@ -39,16 +40,14 @@ FlashIface::err_t FlashAccessor::flush_current_block(uint32_t addr)
 {
     FlashIface::err_t status = ERR_NONE;
 
-    // Write out current buffer if there is data in it
+    // Write out current buffer if there is data in it, an empty buffer is still all 0xFF
     if (!_page_buf_empty)
     {
         status = flash_program_page(_current_write_block_addr, _page_buffer, _current_write_block_size);
+        memset(_page_buffer, 0xFF, _current_write_block_size);
         _page_buf_empty = true;
     }
 
-    // Setup for next block
-    memset(_page_buffer, 0xFF, _current_write_block_size);
-
     if (!_current_write_block_size)
     {
         
@@ -215,8 +214,25 @@ FlashIface::err_t FlashAccessor::write(uint32_t packet_addr, const uint8_t *data
             }
         }
 
-        // write buffer
         copy_start_pos = packet_addr - _current_write_block_addr;
+
+        // A whole block is available in the caller buffer, program it without staging
+        if (_page_buf_empty && (copy_start_pos == 0) && (size >= _current_write_block_size))
+        {
+            status = flash_program_page(_current_write_block_addr, data, _current_write_block_size);
+            if (ERR_NONE != status)
+            {
+                _flash_state = FLASH_STATE_ERROR;
+                return status;
+            }
+
+            packet_addr += _current_write_block_size;
+            data += _current_write_block_size;
+            size -= _current_write_block_size;
+            continue;
+        }
+
+        // write buffer
         page_buf_left = _current_write_block_size - copy_start_pos;
         copy_size = ((size) < (page_buf_left) ? (size) : (page_buf_left));
         memcpy(_page_buffer + copy_start_pos, data, copy_size);
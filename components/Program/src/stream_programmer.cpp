@@ -52,8 +52,10 @@ bool StreamProgrammer::write(uint8_t *data, size_t len)
     return false;
 }
 
-void StreamProgrammer::clean(void)
+bool StreamProgrammer::clean(void)
 {
     if (_iface)
-        _iface->clean();
+        return _iface->clean();
+
+    return false;
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
  * Change Logs:
  * Date           Author       Notes
  * 2023-9-8      lihongquan   add license declaration
+ * 2026-10-19    hongquan.li   add target presence detection
  */
 #include "swd_iface.h"
 #include "debug_cm.h"
@@ -729,6 +730,16 @@ bool SWDIface::jtag_to_swd()
     return true;
 }
 
+bool SWDIface::detect_target(uint32_t *id)
+{
+    if (!swd_reset() || !swd_switch(0xE79E) || !swd_reset())
+    {
+        return false;
+    }
+
+    return read_idcode(id);
+}
+
 bool SWDIface::init_debug(void)
 {
     int i = 0;
@@ -6,9 +6,14 @@
  * Change Logs:
  * Date           Author       Notes
  * 2023-9-8      lihongquan   add license declaration
+ * 2026-10-19    hongquan.li   tune SWJ clock before programming
+ * 2026-10-19    hongquan.li   add programming phase timing
  */
 #include "target_flash.h"
+#include "clock_tuner.h"
 #include "log.h"
+#include "sdkconfig.h"
+#include "esp_timer.h"
 #include <cstring>
 
 #define TAG "target_flash"
@@ -21,8 +26,36 @@ TargetFlash::TargetFlash()
       _current_flash_algo(nullptr),
       _flash_state(FLASH_STATE_CLOSED),
       _flash_start_addr(0),
-      _default_flash_region(nullptr)
+      _default_flash_region(nullptr),
+      _phase_start(0)
 {
+    clear_phase_times();
+}
+
+void TargetFlash::phase_begin(phase_t phase)
+{
+    _phase_start = esp_timer_get_time();
+
+    if (!_phase_time[phase].count)
+    {
+        _phase_time[phase].start_us = _phase_start;
+    }
+}
+
+void TargetFlash::phase_end(phase_t phase)
+{
+    _phase_time[phase].total_us += esp_timer_get_time() - _phase_start;
+    _phase_time[phase].count++;
+}
+
+void TargetFlash::clear_phase_times(void)
+{
+    memset(_phase_time, 0, sizeof(_phase_time));
+}
+
+const FlashIface::phase_time_t *TargetFlash::get_phase_times(void)
+{
+    return _phase_time;
 }
 
 const FlashIface::program_target_t *TargetFlash::get_flash_algo(uint32_t addr)
@@ -89,11 +122,24 @@ FlashIface::err_t TargetFlash::flash_init(const target_cfg_t &cfg)
     _last_func_type = FLASH_FUNC_NOP;
     _current_flash_algo = nullptr;
 
+    phase_begin(PHASE_CONNECT);
+
+#ifdef CONFIG_DEBUG_PROBE_SWJ_AUTO_TUNE
+    if (!ClockTuner::get_instance().tune(*_swd, nullptr))
+    {
+        phase_end(PHASE_CONNECT);
+        return ERR_RESET;
+    }
+#endif
+
     if (!_swd->set_target_state(SWDIface::TARGET_RESET_PROGRAM))
     {
+        phase_end(PHASE_CONNECT);
         return ERR_RESET;
     }
 
+    phase_end(PHASE_CONNECT);
+
     // get default region
     for (auto &flash_region : _flash_cfg->flash_regions)
     {
@@ -112,9 +158,12 @@ FlashIface::err_t TargetFlash::flash_uninit(void)
 {
     if (_flash_cfg)
     {
+        phase_begin(PHASE_RESET);
+
         err_t status = flash_func_start(FLASH_FUNC_NOP);
         if (status != ERR_NONE)
         {
+            phase_end(PHASE_RESET);
             return status;
         }
 
@@ -125,6 +174,8 @@ FlashIface::err_t TargetFlash::flash_uninit(void)
         // This is usually a no-op for most targets.
         _swd->set_target_state(SWDIface::TARGET_POST_FLASH_RESET);
 
+        phase_end(PHASE_RESET);
+
         _flash_state = FLASH_STATE_CLOSED;
         _swd->off();
         return ERR_NONE;
@@ -160,11 +211,13 @@ FlashIface::err_t TargetFlash::flash_program_page(uint32_t addr, const uint8_t *
         while (size > 0)
         {
             write_size = (size <= flash_algo->program_buffer_size) ? (size) : (flash_algo->program_buffer_size);
+            phase_begin(PHASE_PROGRAM);
 
             // Write page to buffer
             if (!_swd->write_memory(flash_algo->program_buffer, (uint8_t *)buf, write_size))
             {
                 LOG_ERROR("Error writing flash buffer");
+                phase_end(PHASE_PROGRAM);
                 return ERR_ALGO_DATA_SEQ;
             }
 
@@ -172,20 +225,26 @@ FlashIface::err_t TargetFlash::flash_program_page(uint32_t addr, const uint8_t *
             if (!_swd->flash_syscall_exec(&flash_algo->sys_call_s, flash_algo->program_page, addr, write_size, flash_algo->program_buffer, 0))
             {
                 LOG_ERROR("flash_syscall_exec program page error");
+                phase_end(PHASE_PROGRAM);
                 return ERR_WRITE;
             }
 
+            phase_end(PHASE_PROGRAM);
+            phase_begin(PHASE_VERIFY);
+
             // Verify data flashed if in automation mode
             if (flash_algo->verify != 0)
             {
                 status = flash_func_start(FLASH_FUNC_VERIFY);
                 if (status != ERR_NONE)
                 {
+                    phase_end(PHASE_VERIFY);
                     return status;
                 }
 
                 if (!_swd->flash_syscall_exec(&flash_algo->sys_call_s, flash_algo->verify, addr, write_size, flash_algo->program_buffer, 0))
                 {
+                    phase_end(PHASE_VERIFY);
                     return ERR_WRITE_VERIFY;
                 }
 
@@ -205,12 +264,14 @@ FlashIface::err_t TargetFlash::flash_program_page(uint32_t addr, const uint8_t *
                     if (!_swd->read_memory(addr, _verify_buf, verify_size))
                     {
                         LOG_ERROR("Error reading flash buffer");
+                        phase_end(PHASE_VERIFY);
                         return ERR_ALGO_DATA_SEQ;
                     }
 
                     if (memcmp(buf, _verify_buf, verify_size) != 0)
                     {
                         LOG_ERROR("Verify error at addr 0x%08lx", addr);
+                        phase_end(PHASE_VERIFY);
                         return ERR_WRITE_VERIFY;
                     }
 
@@ -221,6 +282,7 @@ FlashIface::err_t TargetFlash::flash_program_page(uint32_t addr, const uint8_t *
                 }
             }
 
+            phase_end(PHASE_VERIFY);
             // LOG_INFO("Write %ld bytes to 0x%08lx", write_size, addr - write_size);
         }
 
@@ -250,18 +312,23 @@ FlashIface::err_t TargetFlash::flash_erase_sector(uint32_t addr)
             return ERR_ERASE_SECTOR;
         }
 
+        phase_begin(PHASE_ERASE);
         status = flash_func_start(FLASH_FUNC_ERASE);
 
         if (status != ERR_NONE)
         {
+            phase_end(PHASE_ERASE);
             return status;
         }
 
         if (!_swd->flash_syscall_exec(&flash->sys_call_s, flash->erase_sector, addr, 0, 0, 0))
         {
+            phase_end(PHASE_ERASE);
             return ERR_ERASE_SECTOR;
         }
 
+        phase_end(PHASE_ERASE);
+
         return ERR_NONE;
     }
     else
@@ -292,16 +359,21 @@ FlashIface::err_t TargetFlash::flash_erase_chip(void)
                 return status;
             }
 
+            phase_begin(PHASE_ERASE);
             status = flash_func_start(FLASH_FUNC_ERASE);
             if (status != ERR_NONE)
             {
+                phase_end(PHASE_ERASE);
                 return status;
             }
 
             if (!_swd->flash_syscall_exec(&_current_flash_algo->sys_call_s, _current_flash_algo->erase_chip, 0, 0, 0, 0))
             {
+                phase_end(PHASE_ERASE);
                 return ERR_ERASE_ALL;
             }
+
+            phase_end(PHASE_ERASE);
         }
 
         // Reset and re-initialize the target after the erase if required
@@ -380,12 +452,16 @@ FlashIface::err_t TargetFlash::flash_algo_set(uint32_t addr)
             return status;
         }
         // Download flash programming algorithm to target
+        phase_begin(PHASE_ALGO_DOWNLOAD);
         if (!_swd->write_memory(new_flash_algo->algo_start, (uint8_t *)new_flash_algo->algo_blob, new_flash_algo->algo_size))
         {
             LOG_ERROR("Error writing flash algo");
+            phase_end(PHASE_ALGO_DOWNLOAD);
             return ERR_ALGO_DL;
         }
 
+        phase_end(PHASE_ALGO_DOWNLOAD);
+
         LOG_INFO("Flash algo write success");
         _current_flash_algo = new_flash_algo;
     }
@@ -47,6 +47,9 @@ This information includes:
 #include "sdkconfig.h"
 #include "compiler.h"
 #include "debug_gpio.h"
+#ifdef CONFIG_DEBUG_PROBE_SWD_SPI_SHIFT
+#include "debug_spi_shift.h"
+#endif
 #include "esp_timer.h"
 
 /// Processor Clock of the Cortex-M MCU used in the Debug Unit.
@@ -104,13 +107,17 @@ This information includes:
 
 /// Indicate that UART Serial Wire Output (SWO) trace is available.
 /// This information is returned by the command \ref DAP_Info as part of <b>Capabilities</b>.
+#ifdef CONFIG_DEBUG_PROBE_SWO
+#define SWO_UART                1               ///< SWO UART:  1 = available, 0 = not available.
+#else
 #define SWO_UART                0               ///< SWO UART:  1 = available, 0 = not available.
+#endif
 
 /// USART Driver instance number for the UART SWO.
 #define SWO_UART_DRIVER         0               ///< USART Driver instance number (Driver_USART#).
 
 /// Maximum SWO UART Baudrate.
-#define SWO_UART_MAX_BAUDRATE   10000000U       ///< SWO UART Maximum Baudrate in Hz.
+#define SWO_UART_MAX_BAUDRATE   5000000U        ///< SWO UART Maximum Baudrate in Hz (APB clock / 16).
 
 /// Indicate that Manchester Serial Wire Output (SWO) trace is available.
 /// This information is returned by the command \ref DAP_Info as part of <b>Capabilities</b>.
@@ -120,6 +127,7 @@ This information includes:
 #define SWO_BUFFER_SIZE         4096U           ///< SWO Trace Buffer Size in bytes (must be 2^n).
 
 /// SWO Streaming Trace.
+/// Needs a third bulk endpoint on the DAP interface, which the vendor class does not provide.
 #define SWO_STREAM              0               ///< SWO Streaming Trace: 1 = available, 0 = not available.
 
 /// Clock frequency of the Test Domain Timer. Timer value is returned with \ref TIMESTAMP_GET.
@@ -328,6 +336,9 @@ Configures the DAP Hardware I/O pins for Serial Wire Debug (SWD) mode:
 */
 __STATIC_INLINE void PORT_SWD_SETUP (void) {
     debug_probe_init_swd_pins();
+#ifdef CONFIG_DEBUG_PROBE_SWD_SPI_SHIFT
+    debug_probe_spi_shift_init();
+#endif
 }
 
 /** Disable JTAG/SWD I/O Pins.
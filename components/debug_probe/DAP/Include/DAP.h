@@ -281,6 +281,7 @@
  extern void     JTAG_WriteAbort (uint32_t data);
  extern uint8_t  JTAG_Transfer   (uint32_t request, uint32_t *data);
  extern uint8_t  SWD_Transfer    (uint32_t request, uint32_t *data);
+ extern void     SWD_TransferSelect (void);
  
  extern void     Delayms         (uint32_t delay);
  
@@ -28,6 +28,7 @@
  #include <string.h>
  #include "DAP_config.h"
  #include "DAP.h"
+ #include "swj_clock.h"
  
  
  #if (DAP_PACKET_SIZE < 64U)
@@ -91,6 +92,10 @@
  
      DAP_Data.clock_delay = delay;
    }
+ 
+ #if (DAP_SWD != 0)
+   SWD_TransferSelect();
+ #endif
  }
  
  
@@ -479,6 +484,7 @@
    value = *request;
    DAP_Data.swd_conf.turnaround = (value & 0x03U) + 1U;
    DAP_Data.swd_conf.data_phase = (value & 0x04U) ? 1U : 0U;
+   SWD_TransferSelect();
  
    *response = DAP_OK;
  #else
@@ -489,6 +495,53 @@
  }
  
  
+ #if (DAP_SWD != 0) && defined(CONFIG_DEBUG_PROBE_SWD_SPI_SHIFT)
+ // Gather consecutive output sequences and clock them out in one SPI transaction
+ //   request:        pointer to the next sequence info byte
+ //   sequence_count: number of sequences left, reduced by the ones sent
+ //   return:         number of request bytes consumed (0 to bit-bang the next sequence)
+ static uint32_t DAP_SWD_SequenceShift(const uint8_t *request, uint32_t *sequence_count) {
+   uint32_t sequence_info;
+   uint32_t sequences = 0U;
+   uint32_t size = 0U;
+   uint32_t count;
+ 
+   if ((DAP_Data.fast_clock == 0U) || !debug_probe_spi_shift_ready()) {
+     return 0U;
+   }
+ 
+   debug_probe_spi_shift_begin();
+   while (sequences < *sequence_count) {
+     sequence_info = request[size];
+     if ((sequence_info & SWD_SEQUENCE_DIN) != 0U) {
+       break;
+     }
+     count = sequence_info & SWD_SEQUENCE_CLK;
+     if (count == 0U) {
+       count = 64U;
+     }
+     if (!debug_probe_spi_shift_append(&request[size + 1U], count)) {
+       break;
+     }
+     size += 1U + ((count + 7U) / 8U);
+     sequences++;
+   }
+ 
+   if (debug_probe_spi_shift_pending() < CONFIG_DEBUG_PROBE_SPI_SHIFT_MIN_BITS) {
+     return 0U;
+   }
+ 
+   PIN_SWDIO_OUT_ENABLE();
+   if (!debug_probe_spi_shift_flush()) {
+     return 0U;
+   }
+ 
+   *sequence_count -= sequences;
+   return size;
+ }
+ #endif
+ 
+ 
  // Process SWD Sequence command and prepare response
  //   request:  pointer to request data
  //   response: pointer to response data
@@ -510,7 +563,16 @@
    response_count = 1U;
  
    sequence_count = *request++;
-   while (sequence_count--) {
+   while (sequence_count) {
+ #if (DAP_SWD != 0) && defined(CONFIG_DEBUG_PROBE_SWD_SPI_SHIFT)
+     count = DAP_SWD_SequenceShift(request, &sequence_count);
+     if (count != 0U) {
+       request += count;
+       request_count += count;
+       continue;
+     }
+ #endif
+     sequence_count--;
      sequence_info = *request++;
      count = sequence_info & SWD_SEQUENCE_CLK;
      if (count == 0U) {
@@ -679,6 +741,9 @@
                                    (uint16_t)(*(request+2) << 8);
    DAP_Data.transfer.match_retry = (uint16_t) *(request+3) |
                                    (uint16_t)(*(request+4) << 8);
+ #if (DAP_SWD != 0)
+   SWD_TransferSelect();
+ #endif
  
    *response = DAP_OK;
    return ((5U << 16) | 1U);
@@ -1823,7 +1888,7 @@
  #endif
  
    // Sets DAP_Data.fast_clock and DAP_Data.clock_delay.
-   Set_Clock_Delay(DAP_DEFAULT_SWJ_CLOCK);
+   Set_Clock_Delay(swj_clock_default(DAP_DEFAULT_SWJ_CLOCK));
  
    DAP_SETUP();  // Device specific setup
  }
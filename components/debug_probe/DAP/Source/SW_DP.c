@@ -27,6 +27,9 @@
 
  #include "DAP_config.h"
  #include "DAP.h"
+ #ifdef CONFIG_DEBUG_PROBE_SWD_SPI_SHIFT
+ #include "debug_spi_shift.h"
+ #endif
  
  
  // SW Macros
@@ -57,6 +60,25 @@
  #define PIN_DELAY() PIN_DELAY_SLOW(DAP_Data.clock_delay)
  
  
+ // Shift an output bit stream with the SPI peripheral (fast clock, SWD mode only)
+ //   data:   pointer to bit data, LSB first
+ //   count:  number of bits
+ //   return: 1 when the bits were sent, 0 to fall back to bit-bang
+ __STATIC_FORCEINLINE uint32_t SW_ShiftOut (const uint8_t *data, uint32_t count) {
+ #ifdef CONFIG_DEBUG_PROBE_SWD_SPI_SHIFT
+   if (DAP_Data.fast_clock && (DAP_Data.debug_port == DAP_PORT_SWD) &&
+       (count >= CONFIG_DEBUG_PROBE_SPI_SHIFT_MIN_BITS) &&
+       (count <= DEBUG_SPI_SHIFT_MAX_BITS) && debug_probe_spi_shift_ready()) {
+     return debug_probe_spi_shift_out(data, count) ? 1U : 0U;
+   }
+ #else
+   (void)data;
+   (void)count;
+ #endif
+   return 0U;
+ }
+ 
+ 
  // Generate SWJ Sequence
  //   count:  sequence bit count
  //   data:   pointer to sequence bit data
@@ -66,6 +88,10 @@
    uint32_t val;
    uint32_t n;
  
+   if (SW_ShiftOut(data, count)) {
+     return;
+   }
+ 
    val = 0U;
    n = 0U;
    while (count--) {
@@ -270,6 +296,211 @@
  SWD_TransferFunction(Slow)
  
  
+ #ifdef CONFIG_DEBUG_PROBE_SWD_FAST_PATH
+
+
+ // Request header byte sent LSB first: Start, APnDP, RnW, A2, A3, Parity, Stop, Park
+ #define SWD_REQUEST_PARITY(r)  ((((r) >> 0) ^ ((r) >> 1) ^ ((r) >> 2) ^ ((r) >> 3)) & 1U)
+ #define SWD_REQUEST_HEADER(r)  (0x81U | ((r) << 1) | (SWD_REQUEST_PARITY(r) << 5))
+
+ static const uint8_t SWD_RequestHeader[16] = {
+   SWD_REQUEST_HEADER( 0U), SWD_REQUEST_HEADER( 1U), SWD_REQUEST_HEADER( 2U), SWD_REQUEST_HEADER( 3U),
+   SWD_REQUEST_HEADER( 4U), SWD_REQUEST_HEADER( 5U), SWD_REQUEST_HEADER( 6U), SWD_REQUEST_HEADER( 7U),
+   SWD_REQUEST_HEADER( 8U), SWD_REQUEST_HEADER( 9U), SWD_REQUEST_HEADER(10U), SWD_REQUEST_HEADER(11U),
+   SWD_REQUEST_HEADER(12U), SWD_REQUEST_HEADER(13U), SWD_REQUEST_HEADER(14U), SWD_REQUEST_HEADER(15U),
+ };
+
+
+ // Parity of a 32-bit word (0x6996 is the parity table of a nibble)
+ __STATIC_FORCEINLINE uint32_t SWD_Parity32 (uint32_t val) {
+   val ^= val >> 16;
+   val ^= val >>  8;
+   val ^= val >>  4;
+   return ((0x6996U >> (val & 0x0FU)) & 1U);
+ }
+
+
+ #define SW_WRITE_BYTE(val, shift)       \
+   SW_WRITE_BIT((val) >> ((shift) + 0)); \
+   SW_WRITE_BIT((val) >> ((shift) + 1)); \
+   SW_WRITE_BIT((val) >> ((shift) + 2)); \
+   SW_WRITE_BIT((val) >> ((shift) + 3)); \
+   SW_WRITE_BIT((val) >> ((shift) + 4)); \
+   SW_WRITE_BIT((val) >> ((shift) + 5)); \
+   SW_WRITE_BIT((val) >> ((shift) + 6)); \
+   SW_WRITE_BIT((val) >> ((shift) + 7))
+
+ #define SW_READ_BIT_AT(val, pos)        \
+   SW_READ_BIT(bit);                     \
+   val |= (bit & 1U) << (pos)
+
+ #define SW_READ_BYTE(val, shift)        \
+   SW_READ_BIT_AT(val, (shift) + 0);     \
+   SW_READ_BIT_AT(val, (shift) + 1);     \
+   SW_READ_BIT_AT(val, (shift) + 2);     \
+   SW_READ_BIT_AT(val, (shift) + 3);     \
+   SW_READ_BIT_AT(val, (shift) + 4);     \
+   SW_READ_BIT_AT(val, (shift) + 5);     \
+   SW_READ_BIT_AT(val, (shift) + 6);     \
+   SW_READ_BIT_AT(val, (shift) + 7)
+
+
+ // SWD Transfer I/O specialised for fast clock, turnaround and data phase
+ //   request: A[3:2] RnW APnDP
+ //   data:    DATA[31:0]
+ //   return:  ACK[2:0]
+ #define SWD_TransferFastFunction(turnaround, data_phase)  /**/                 \
+ static uint8_t SWD_TransferFast_T##turnaround##_D##data_phase (uint32_t request, uint32_t *data) { \
+   uint32_t ack;                                                                 \
+   uint32_t bit;                                                                 \
+   uint32_t val;                                                                 \
+   uint32_t hdr;                                                                 \
+   uint32_t n;                                                                   \
+                                                                                 \
+   /* Packet Request */                                                          \
+   hdr = SWD_RequestHeader[request & 0x0FU];                                     \
+   SW_WRITE_BYTE(hdr, 0);                                                        \
+                                                                                 \
+   /* Turnaround */                                                              \
+   PIN_SWDIO_OUT_DISABLE();                                                      \
+   for (n = turnaround; n; n--) {                                                \
+     SW_CLOCK_CYCLE();                                                           \
+   }                                                                             \
+                                                                                 \
+   /* Acknowledge response */                                                    \
+   ack = 0U;                                                                     \
+   SW_READ_BIT_AT(ack, 0);                                                       \
+   SW_READ_BIT_AT(ack, 1);                                                       \
+   SW_READ_BIT_AT(ack, 2);                                                       \
+                                                                                 \
+   if (ack == DAP_TRANSFER_OK) {         /* OK response */                       \
+     /* Data transfer */                                                         \
+     if (request & DAP_TRANSFER_RnW) {                                           \
+       /* Read data */                                                           \
+       val = 0U;                                                                 \
+       SW_READ_BYTE(val,  0);            /* Read RDATA[0:31] */                  \
+       SW_READ_BYTE(val,  8);                                                    \
+       SW_READ_BYTE(val, 16);                                                    \
+       SW_READ_BYTE(val, 24);                                                    \
+       SW_READ_BIT(bit);                 /* Read Parity */                       \
+       if ((SWD_Parity32(val) ^ bit) & 1U) {                                     \
+         ack = DAP_TRANSFER_ERROR;                                               \
+       }                                                                         \
+       if (data) { *data = val; }                                                \
+       /* Turnaround */                                                          \
+       for (n = turnaround; n; n--) {                                            \
+         SW_CLOCK_CYCLE();                                                       \
+       }                                                                         \
+       PIN_SWDIO_OUT_ENABLE();                                                   \
+     } else {                                                                    \
+       /* Turnaround */                                                          \
+       for (n = turnaround; n; n--) {                                            \
+         SW_CLOCK_CYCLE();                                                       \
+       }                                                                         \
+       PIN_SWDIO_OUT_ENABLE();                                                   \
+       /* Write data */                                                          \
+       val = *data;                                                              \
+       SW_WRITE_BYTE(val,  0);           /* Write WDATA[0:31] */                 \
+       SW_WRITE_BYTE(val,  8);                                                   \
+       SW_WRITE_BYTE(val, 16);                                                   \
+       SW_WRITE_BYTE(val, 24);                                                   \
+       SW_WRITE_BIT(SWD_Parity32(val));  /* Write Parity Bit */                  \
+     }                                                                           \
+     /* Capture Timestamp */                                                     \
+     if (request & DAP_TRANSFER_TIMESTAMP) {                                     \
+       DAP_Data.timestamp = TIMESTAMP_GET();                                     \
+     }                                                                           \
+     /* Idle cycles */                                                           \
+     n = DAP_Data.transfer.idle_cycles;                                          \
+     if (n) {                                                                    \
+       PIN_SWDIO_OUT(0U);                                                        \
+       for (; n; n--) {                                                          \
+         SW_CLOCK_CYCLE();                                                       \
+       }                                                                         \
+     }                                                                           \
+     PIN_SWDIO_OUT(1U);                                                          \
+     return ((uint8_t)ack);                                                      \
+   }                                                                             \
+                                                                                 \
+   if ((ack == DAP_TRANSFER_WAIT) || (ack == DAP_TRANSFER_FAULT)) {              \
+     /* WAIT or FAULT response */                                                \
+     if (data_phase && ((request & DAP_TRANSFER_RnW) != 0U)) {                   \
+       for (n = 32U+1U; n; n--) {                                                \
+         SW_CLOCK_CYCLE();               /* Dummy Read RDATA[0:31] + Parity */   \
+       }                                                                         \
+     }                                                                           \
+     /* Turnaround */                                                            \
+     for (n = turnaround; n; n--) {                                              \
+       SW_CLOCK_CYCLE();                                                         \
+     }                                                                           \
+     PIN_SWDIO_OUT_ENABLE();                                                     \
+     if (data_phase && ((request & DAP_TRANSFER_RnW) == 0U)) {                   \
+       PIN_SWDIO_OUT(0U);                                                        \
+       for (n = 32U+1U; n; n--) {                                                \
+         SW_CLOCK_CYCLE();               /* Dummy Write WDATA[0:31] + Parity */  \
+       }                                                                         \
+     }                                                                           \
+     PIN_SWDIO_OUT(1U);                                                          \
+     return ((uint8_t)ack);                                                      \
+   }                                                                             \
+                                                                                 \
+   /* Protocol error */                                                          \
+   for (n = turnaround + 32U + 1U; n; n--) {                                     \
+     SW_CLOCK_CYCLE();                   /* Back off data phase */               \
+   }                                                                             \
+   PIN_SWDIO_OUT_ENABLE();                                                       \
+   PIN_SWDIO_OUT(1U);                                                            \
+   return ((uint8_t)ack);                                                        \
+ }
+
+
+ // Only the default turnaround of one cycle is specialised, other settings
+ // are rare and use the generic fast variant to keep the IRAM footprint small.
+ #undef  PIN_DELAY
+ #define PIN_DELAY() PIN_DELAY_FAST()
+ SWD_TransferFastFunction(1, 0)
+ SWD_TransferFastFunction(1, 1)
+
+ #undef  PIN_DELAY
+ #define PIN_DELAY() PIN_DELAY_SLOW(DAP_Data.clock_delay)
+
+
+ static uint8_t (*SWD_TransferSelected)(uint32_t request, uint32_t *data) = SWD_TransferSlow;
+
+
+ // Select the SWD transfer variant for the current clock and SWD configuration
+ //   return: none
+ void SWD_TransferSelect (void) {
+   if (DAP_Data.fast_clock == 0U) {
+     SWD_TransferSelected = SWD_TransferSlow;
+   } else if (DAP_Data.swd_conf.turnaround != 1U) {
+     SWD_TransferSelected = SWD_TransferFast;
+   } else if (DAP_Data.swd_conf.data_phase) {
+     SWD_TransferSelected = SWD_TransferFast_T1_D1;
+   } else {
+     SWD_TransferSelected = SWD_TransferFast_T1_D0;
+   }
+ }
+
+
+ // SWD Transfer I/O
+ //   request: A[3:2] RnW APnDP
+ //   data:    DATA[31:0]
+ //   return:  ACK[2:0]
+ uint8_t  SWD_Transfer(uint32_t request, uint32_t *data) {
+   return SWD_TransferSelected(request, data);
+ }
+
+
+ #else  /* CONFIG_DEBUG_PROBE_SWD_FAST_PATH */
+
+
+ // Select the SWD transfer variant for the current clock and SWD configuration
+ //   return: none
+ void SWD_TransferSelect (void) {
+ }
+
+
  // SWD Transfer I/O
  //   request: A[3:2] RnW APnDP
  //   data:    DATA[31:0]
@@ -281,6 +512,9 @@
      return SWD_TransferSlow(request, data);
    }
  }
+
+
+ #endif /* CONFIG_DEBUG_PROBE_SWD_FAST_PATH */
  
  
  #endif  /* (DAP_SWD != 0) */
@@ -0,0 +1,294 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add DAP port arbitration and lock metrics
+ * 2026-10-19    hongquan.li   add strict claim and try-lock
+ * 2026-10-19    hongquan.li   serve DAP_SWO_Data to the owner only
+ * 2026-10-19    hongquan.li   add batched execution under one lock hold
+ */
+
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "dap_arbiter.h"
+#include "DAP_config.h"
+#include "DAP.h"
+
+#ifndef CONFIG_DEBUG_PROBE_DAP_ARBITER_IDLE_MS
+#define CONFIG_DEBUG_PROBE_DAP_ARBITER_IDLE_MS 5000
+#endif
+
+#ifndef CONFIG_DEBUG_PROBE_DAP_ARBITER_BATCH_MAX
+#define CONFIG_DEBUG_PROBE_DAP_ARBITER_BATCH_MAX 16
+#endif
+
+static portMUX_TYPE s_state_lock = portMUX_INITIALIZER_UNLOCKED;
+static StaticSemaphore_t s_dap_mutex_buf;
+static SemaphoreHandle_t s_dap_mutex = NULL;
+static volatile uint32_t s_owner = DAP_SESSION_NONE;
+static volatile int64_t s_owner_active_us = 0;
+static volatile int s_locked = 0;
+static dap_arbiter_stats_t s_stats;
+static int64_t s_lock_start_us = 0;
+static TaskHandle_t s_batch_task = NULL; /* Task holding the DAP lock for a batch, only it writes itself here */
+static uint32_t s_batch_count = 0;
+
+static SemaphoreHandle_t dap_arbiter_mutex(void)
+{
+    if (s_dap_mutex == NULL)
+    {
+        taskENTER_CRITICAL(&s_state_lock);
+
+        if (s_dap_mutex == NULL)
+        {
+            s_dap_mutex = xSemaphoreCreateMutexStatic(&s_dap_mutex_buf);
+        }
+
+        taskEXIT_CRITICAL(&s_state_lock);
+    }
+
+    return s_dap_mutex;
+}
+
+/* Commands that only read probe state, SWO_Data consumes the owner's trace and goes through the lock */
+static int dap_arbiter_is_monitor(uint8_t command)
+{
+    switch (command)
+    {
+    case ID_DAP_Info:
+    case ID_DAP_SWO_Status:
+    case ID_DAP_SWO_ExtendedStatus:
+    case ID_DAP_UART_Status:
+        return 1;
+
+    default:
+        return 0;
+    }
+}
+
+int dap_arbiter_claim(uint32_t session)
+{
+    int64_t now = esp_timer_get_time();
+    int owned = 0;
+
+    taskENTER_CRITICAL(&s_state_lock);
+
+    if ((s_owner == DAP_SESSION_NONE) || (s_owner == session))
+    {
+        owned = 1;
+    }
+    else if (!s_locked && (s_owner != DAP_SESSION_PROGRAMMER) &&
+             ((now - s_owner_active_us) > (int64_t)CONFIG_DEBUG_PROBE_DAP_ARBITER_IDLE_MS * 1000))
+    {
+        /* The owner went quiet (host crashed or link dropped), hand the port over.
+         * A programming job releases the port itself when it ends or times out. */
+        s_stats.handovers++;
+        owned = 1;
+    }
+
+    if (owned)
+    {
+        s_owner = session;
+        s_owner_active_us = now;
+    }
+
+    taskEXIT_CRITICAL(&s_state_lock);
+
+    return owned;
+}
+
+int dap_arbiter_try_claim(uint32_t session)
+{
+    int owned = 0;
+
+    taskENTER_CRITICAL(&s_state_lock);
+
+    if ((s_owner == DAP_SESSION_NONE) || (s_owner == session))
+    {
+        s_owner = session;
+        s_owner_active_us = esp_timer_get_time();
+        owned = 1;
+    }
+
+    taskEXIT_CRITICAL(&s_state_lock);
+
+    return owned;
+}
+
+void dap_arbiter_release(uint32_t session)
+{
+    taskENTER_CRITICAL(&s_state_lock);
+
+    if (s_owner == session)
+    {
+        s_owner = DAP_SESSION_NONE;
+    }
+
+    taskEXIT_CRITICAL(&s_state_lock);
+}
+
+void dap_arbiter_lock(void)
+{
+    SemaphoreHandle_t mutex = dap_arbiter_mutex();
+    int64_t start = esp_timer_get_time();
+    uint32_t wait;
+
+    if (xSemaphoreTake(mutex, 0) != pdTRUE)
+    {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        s_lock_start_us = esp_timer_get_time();
+        wait = (uint32_t)(s_lock_start_us - start);
+
+        s_stats.contended++;
+        if (wait > s_stats.wait_max_us)
+        {
+            s_stats.wait_max_us = wait;
+        }
+    }
+    else
+    {
+        s_lock_start_us = start;
+    }
+
+    s_locked = 1;
+}
+
+int dap_arbiter_try_lock(void)
+{
+    dap_arbiter_lock();
+
+    if (s_owner != DAP_SESSION_NONE)
+    {
+        /* Not a command, keep it out of the hold time statistics */
+        s_locked = 0;
+        xSemaphoreGive(dap_arbiter_mutex());
+        return 0;
+    }
+
+    return 1;
+}
+
+void dap_arbiter_unlock(void)
+{
+    uint32_t hold = (uint32_t)(esp_timer_get_time() - s_lock_start_us);
+
+    s_stats.commands++;
+    s_stats.hold_total_us += hold;
+    if (hold > s_stats.hold_max_us)
+    {
+        s_stats.hold_max_us = hold;
+    }
+
+    s_owner_active_us = esp_timer_get_time();
+    s_locked = 0;
+    xSemaphoreGive(dap_arbiter_mutex());
+}
+
+uint32_t dap_arbiter_execute(uint32_t session, const uint8_t *request, uint8_t *response)
+{
+    uint32_t ret;
+
+    if (dap_arbiter_is_monitor(request[0]))
+    {
+        s_stats.monitor++;
+        return DAP_ProcessCommand(request, response);
+    }
+
+    if (!dap_arbiter_claim(session))
+    {
+        /* Same reply as a failed command, the host sees a busy probe */
+        s_stats.rejected++;
+        response[0] = request[0];
+        response[1] = DAP_ERROR;
+        return (1U << 16) | 2U;
+    }
+
+    dap_arbiter_lock();
+    ret = DAP_ExecuteCommand(request, response);
+    dap_arbiter_unlock();
+
+    if (request[0] == ID_DAP_Disconnect)
+    {
+        dap_arbiter_release(session);
+    }
+
+    return ret;
+}
+
+uint32_t dap_arbiter_execute_batch(uint32_t session, const uint8_t *request, uint8_t *response)
+{
+    uint32_t ret;
+
+    if (dap_arbiter_is_monitor(request[0]))
+    {
+        s_stats.monitor++;
+        return DAP_ProcessCommand(request, response);
+    }
+
+    if (!dap_arbiter_claim(session))
+    {
+        /* Nobody can take the port over while the batch holds the lock, end it anyway */
+        dap_arbiter_batch_end();
+        s_stats.rejected++;
+        response[0] = request[0];
+        response[1] = DAP_ERROR;
+        return (1U << 16) | 2U;
+    }
+
+    if (s_batch_task != xTaskGetCurrentTaskHandle())
+    {
+        dap_arbiter_lock();
+        s_batch_task = xTaskGetCurrentTaskHandle();
+        s_batch_count = 0;
+    }
+
+    ret = DAP_ExecuteCommand(request, response);
+    s_batch_count++;
+
+    if ((request[0] == ID_DAP_Disconnect) || (s_batch_count >= CONFIG_DEBUG_PROBE_DAP_ARBITER_BATCH_MAX))
+    {
+        dap_arbiter_batch_end();
+    }
+
+    if (request[0] == ID_DAP_Disconnect)
+    {
+        dap_arbiter_release(session);
+    }
+
+    return ret;
+}
+
+void dap_arbiter_batch_end(void)
+{
+    if (s_batch_task != xTaskGetCurrentTaskHandle())
+    {
+        return;
+    }
+
+    /* unlock() counts the batch once, count the rest of its commands here */
+    s_batch_task = NULL;
+    s_stats.commands += s_batch_count - 1;
+    dap_arbiter_unlock();
+}
+
+void dap_arbiter_get_stats(dap_arbiter_stats_t *stats)
+{
+    taskENTER_CRITICAL(&s_state_lock);
+    *stats = s_stats;
+    stats->owner = s_owner;
+    taskEXIT_CRITICAL(&s_state_lock);
+}
+
+void dap_arbiter_reset_stats(void)
+{
+    taskENTER_CRITICAL(&s_state_lock);
+    memset(&s_stats, 0, sizeof(s_stats));
+    taskEXIT_CRITICAL(&s_state_lock);
+}
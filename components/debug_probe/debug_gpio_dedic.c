@@ -38,6 +38,11 @@ void debug_probe_notify_activity(bool active)
     }
 }
 
+bool debug_probe_pins_active(void)
+{
+    return s_debug_gpio_init != 0;
+}
+
 #if CONFIG_DEBUG_PROBE_IFACE_JTAG
 
 void debug_probe_init_jtag_pins(void)
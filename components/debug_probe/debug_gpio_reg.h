@@ -35,6 +35,12 @@ void debug_probe_init_swd_pins(void);
  */
 void debug_probe_reset_pins(void);
 
+/**
+ * @brief Check if the debug pins are driven, set up and not reset since
+ * @return true between debug_probe_init_*_pins() and debug_probe_reset_pins()
+ */
+bool debug_probe_pins_active(void);
+
 /**
  * @brief Notify debug activity
  * @param active true when debug activity is happening, false when idle
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add SPI shifter for SWD output phases
+ * 2026-10-19    hongquan.li   gather several sequences into one transaction
+ */
+
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_rom_gpio.h"
+#include "driver/spi_master.h"
+#include "soc/spi_periph.h"
+#include "debug_gpio.h"
+#include "debug_spi_shift.h"
+
+#define SPI_SHIFT_HOST      SPI2_HOST
+#define SPI_SHIFT_OUT_SEL(gpio) (GPIO_FUNC0_OUT_SEL_CFG_REG + ((gpio) * 4))
+
+static const char *TAG = "debug_spi";
+
+static spi_device_handle_t s_spi_dev = NULL;
+/* GPIO matrix words for both routings, a shift only writes registers */
+static uint32_t s_swclk_conf;
+static uint32_t s_swclk_spi_conf;
+static uint32_t s_swdio_spi_conf;
+static uint32_t s_tx_bits = 0;
+static DMA_ATTR uint8_t s_tx_buf[CONFIG_DEBUG_PROBE_SPI_SHIFT_MAX_BYTES];
+
+bool debug_probe_spi_shift_init(void)
+{
+    if (s_spi_dev) {
+        return true;
+    }
+
+    /* Pins are routed by hand around each shift, the bus owns none of them */
+    spi_bus_config_t bus_cfg = {
+        .mosi_io_num = -1,
+        .miso_io_num = -1,
+        .sclk_io_num = -1,
+        .quadwp_io_num = -1,
+        .quadhd_io_num = -1,
+        .max_transfer_sz = CONFIG_DEBUG_PROBE_SPI_SHIFT_MAX_BYTES,
+        .flags = SPICOMMON_BUSFLAG_MASTER,
+    };
+
+    spi_device_interface_config_t dev_cfg = {
+        .mode = 3,
+        .clock_speed_hz = CONFIG_DEBUG_PROBE_SPI_SHIFT_CLOCK,
+        .spics_io_num = -1,
+        .queue_size = 1,
+        .flags = SPI_DEVICE_3WIRE | SPI_DEVICE_HALFDUPLEX | SPI_DEVICE_BIT_LSBFIRST,
+    };
+
+    if (spi_bus_initialize(SPI_SHIFT_HOST, &bus_cfg, SPI_DMA_CH_AUTO) != ESP_OK) {
+        ESP_LOGE(TAG, "SPI bus init failed, SWD stays bit-banged");
+        return false;
+    }
+
+    if (spi_bus_add_device(SPI_SHIFT_HOST, &dev_cfg, &s_spi_dev) != ESP_OK) {
+        ESP_LOGE(TAG, "SPI device add failed, SWD stays bit-banged");
+        spi_bus_free(SPI_SHIFT_HOST);
+        return false;
+    }
+
+    /* The debug probe is the only user, keep the bus to skip per-transfer locking */
+    spi_device_acquire_bus(s_spi_dev, portMAX_DELAY);
+
+    /* Let the ROM compute the SPI routing once, then put the dedicated GPIO routing back */
+    s_swclk_conf = REG_READ(SPI_SHIFT_OUT_SEL(GPIO_SWCLK));
+    esp_rom_gpio_connect_out_signal(GPIO_SWCLK, spi_periph_signal[SPI_SHIFT_HOST].spiclk_out, false, false);
+    esp_rom_gpio_connect_out_signal(GPIO_SWDIO, spi_periph_signal[SPI_SHIFT_HOST].spid_out, false, false);
+    s_swclk_spi_conf = REG_READ(SPI_SHIFT_OUT_SEL(GPIO_SWCLK));
+    s_swdio_spi_conf = REG_READ(SPI_SHIFT_OUT_SEL(GPIO_SWDIO));
+    REG_WRITE(SPI_SHIFT_OUT_SEL(GPIO_SWCLK), s_swclk_conf);
+    REG_WRITE(SPI_SHIFT_OUT_SEL(GPIO_SWDIO), dedic_gpio_conf);
+
+    ESP_LOGI(TAG, "SWD SPI shifter ready at %d Hz", CONFIG_DEBUG_PROBE_SPI_SHIFT_CLOCK);
+
+    return true;
+}
+
+bool debug_probe_spi_shift_ready(void)
+{
+    return s_spi_dev != NULL;
+}
+
+void debug_probe_spi_shift_begin(void)
+{
+    s_tx_bits = 0;
+}
+
+bool debug_probe_spi_shift_append(const uint8_t *data, uint32_t nbits)
+{
+    if (s_tx_bits + nbits > DEBUG_SPI_SHIFT_MAX_BITS) {
+        return false;
+    }
+
+    debug_spi_shift_pack(s_tx_buf, s_tx_bits, data, nbits);
+    s_tx_bits += nbits;
+
+    return true;
+}
+
+uint32_t debug_probe_spi_shift_pending(void)
+{
+    return s_tx_bits;
+}
+
+bool debug_probe_spi_shift_flush(void)
+{
+    spi_transaction_t trans = { 0 };
+    spi_transaction_t *done = NULL;
+    uint32_t last = s_tx_bits - 1;
+    esp_err_t ret;
+
+    if (!s_spi_dev || (s_tx_bits == 0)) {
+        return false;
+    }
+
+    trans.length = s_tx_bits;
+    trans.tx_buffer = s_tx_buf;
+
+    REG_WRITE(SPI_SHIFT_OUT_SEL(GPIO_SWCLK), s_swclk_spi_conf);
+    REG_WRITE(SPI_SHIFT_OUT_SEL(GPIO_SWDIO), s_swdio_spi_conf);
+
+    /* Interrupt driven, the DAP task sleeps while DMA clocks the stream out */
+    ret = spi_device_queue_trans(s_spi_dev, &trans, portMAX_DELAY);
+    if (ret == ESP_OK) {
+        ret = spi_device_get_trans_result(s_spi_dev, &done, portMAX_DELAY);
+    }
+
+    /* Hand the pins back to the dedicated GPIO bundle, SWCLK idles high and SWDIO keeps the last bit */
+    debug_probe_swclk_set();
+    REG_WRITE(SPI_SHIFT_OUT_SEL(GPIO_SWCLK), s_swclk_conf);
+    debug_probe_swdio_write(s_tx_buf[last / 8] >> (last % 8));
+    REG_WRITE(SPI_SHIFT_OUT_SEL(GPIO_SWDIO), dedic_gpio_conf);
+    s_tx_bits = 0;
+
+    return ret == ESP_OK;
+}
+
+bool debug_probe_spi_shift_out(const uint8_t *data, uint32_t nbits)
+{
+    debug_probe_spi_shift_begin();
+
+    return (nbits > 0) && debug_probe_spi_shift_append(data, nbits) && debug_probe_spi_shift_flush();
+}
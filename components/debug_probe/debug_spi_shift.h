@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add SPI shifter for SWD output phases
+ * 2026-10-19    hongquan.li   gather several sequences into one transaction
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Largest bit stream accepted by one transaction */
+#define DEBUG_SPI_SHIFT_MAX_BITS    (CONFIG_DEBUG_PROBE_SPI_SHIFT_MAX_BYTES * 8)
+
+/**
+ * @brief Append a bit stream to an LSB first bit buffer
+ *
+ * Bits from offset on are overwritten, bits past the end of the appended
+ * stream in its last byte are cleared so the next append can OR into it.
+ * The buffer must have room for (offset + nbits + 7) / 8 bytes.
+ *
+ * @param dst Bit buffer, LSB of dst[0] is sent first
+ * @param offset Number of bits already in dst
+ * @param src Bits to append, LSB of src[0] first
+ * @param nbits Number of bits to append
+ */
+static inline void debug_spi_shift_pack(uint8_t *dst, uint32_t offset, const uint8_t *src, uint32_t nbits)
+{
+    uint32_t shift = offset & 7U;
+    uint32_t full = nbits / 8U;
+    uint32_t rest = nbits & 7U;
+    uint8_t *out = dst + offset / 8U;
+    uint32_t val;
+
+    if (shift == 0U) {
+        memcpy(out, src, full);
+        if (rest) {
+            out[full] = src[full] & ((1U << rest) - 1U);
+        }
+        return;
+    }
+
+    out[0] &= (1U << shift) - 1U;
+
+    for (uint32_t i = 0; i < full; i++) {
+        out[i] |= (uint8_t)(src[i] << shift);
+        out[i + 1] = (uint8_t)(src[i] >> (8U - shift));
+    }
+
+    if (rest) {
+        val = src[full] & ((1U << rest) - 1U);
+        out[full] |= (uint8_t)(val << shift);
+        if (shift + rest > 8U) {
+            out[full + 1] = (uint8_t)(val >> (8U - shift));
+        }
+    }
+}
+
+/**
+ * @brief Initialize the SPI shifter on the SWCLK/SWDIO pins
+ *
+ * The SPI peripheral is set up in 3-wire half-duplex mode 3 (clock idles
+ * high, data changes on falling edge) which matches SWD timing. The pins
+ * stay routed to the dedicated GPIO bundle until a shift is started, the
+ * GPIO matrix words for both routings are computed here once.
+ *
+ * @return true on success, false on failure
+ */
+bool debug_probe_spi_shift_init(void);
+
+/**
+ * @brief Check if the SPI shifter is ready for use
+ * @return true if initialized successfully
+ */
+bool debug_probe_spi_shift_ready(void);
+
+/**
+ * @brief Start gathering a new output stream
+ */
+void debug_probe_spi_shift_begin(void);
+
+/**
+ * @brief Append bits to the gathered stream
+ * @param data Bits, LSB of data[0] first
+ * @param nbits Number of bits
+ * @return false if the stream would exceed DEBUG_SPI_SHIFT_MAX_BITS, nothing is appended then
+ */
+bool debug_probe_spi_shift_append(const uint8_t *data, uint32_t nbits);
+
+/**
+ * @brief Number of bits gathered since debug_probe_spi_shift_begin()
+ * @return Bit count
+ */
+uint32_t debug_probe_spi_shift_pending(void);
+
+/**
+ * @brief Clock out the gathered stream on SWDIO in one SPI transaction
+ *
+ * Routes SWCLK/SWDIO to the SPI peripheral, queues the DMA transaction and
+ * sleeps until it is done, then routes them back to the dedicated GPIO
+ * bundle. SWDIO must already be an output. Input phases (turnaround, ACK
+ * and read data) stay bit-banged.
+ *
+ * @return true on success, false if the shifter is unavailable or the stream is empty
+ */
+bool debug_probe_spi_shift_flush(void);
+
+/**
+ * @brief Clock out one bit stream, begin, append and flush in one call
+ * @param data Bit stream, LSB of data[0] is sent first
+ * @param nbits Number of bits to send, at most DEBUG_SPI_SHIFT_MAX_BITS
+ * @return true on success, false if the shifter is unavailable
+ */
+bool debug_probe_spi_shift_out(const uint8_t *data, uint32_t nbits);
+
+#ifdef __cplusplus
+}
+#endif
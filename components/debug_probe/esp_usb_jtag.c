@@ -222,6 +222,76 @@ inline static void do_jtag_one(const uint8_t tdo_req, const uint8_t tms_tdi_mask
     debug_probe_tck_clr();
 }
 
+/* As soon as either DEBUG_PROBE_PACKET_SIZE bytes have been collected or a CMD_FLUSH command is executed,
+    make the usb buffer available for the host to receive.
+*/
+static void esp_usb_jtag_send_full_packet(void)
+{
+    int waiting_to_send_bits = s_total_tdo_bits - s_usb_sent_bits;
+    if (waiting_to_send_bits >= JTAG_PROTO_MAX_BITS) {
+        int send_bits = ROUND_UP_BITS(waiting_to_send_bits > JTAG_PROTO_MAX_BITS ? JTAG_PROTO_MAX_BITS : waiting_to_send_bits);
+        int n_byte = send_bits / 8;
+        esp_err_t send_result = esp_usb_jtag_send_data(s_tdo_bytes + (s_usb_sent_bits / 8), n_byte);
+        if (send_result != ESP_OK) {
+            ESP_LOGE(TAG, "JTAG send buffer full, dropping data.");
+        }
+        memset(s_tdo_bytes + (s_usb_sent_bits / 8), 0x00, n_byte);
+        s_usb_sent_bits += send_bits;
+        waiting_to_send_bits -= send_bits;
+        if (waiting_to_send_bits <= 0) {
+            s_total_tdo_bits = s_usb_sent_bits = 0;
+        }
+    }
+}
+
+/* CMD_REPx run of a clock command without TDO capture: TMS/TDI are set once, then only TCK toggles */
+inline static void do_jtag_run(const uint8_t tms_tdi_mask, int count)
+{
+    debug_probe_write_tmstck(tms_tdi_mask);
+
+    while (count-- > 0) {
+        debug_probe_tck_set();
+        debug_probe_tck_clr();
+    }
+}
+
+/* CMD_REPx run of a clock command with TDO capture, bits are packed a byte at a time into s_tdo_bytes */
+static void do_jtag_run_tdo(const uint8_t tms_tdi_mask, int count)
+{
+    debug_probe_write_tmstck(tms_tdi_mask);
+
+    while (count > 0) {
+        /* Split the run so the pending bits never exceed one USB packet */
+        int room = JTAG_PROTO_MAX_BITS - (s_total_tdo_bits - s_usb_sent_bits);
+        if (room <= 0) {
+            esp_usb_jtag_send_full_packet();
+            continue;
+        }
+        int chunk = count < room ? count : room;
+        uint8_t *dst = &s_tdo_bytes[s_total_tdo_bits / 8];
+        uint32_t shift = s_total_tdo_bits % 8;
+        uint32_t acc = *dst;
+
+        for (int i = 0; i < chunk; i++) {
+            debug_probe_tck_set();
+            acc |= (debug_probe_tdo_read() & 1) << shift;
+            debug_probe_tck_clr();
+            if (++shift == 8) {
+                *dst++ = (uint8_t)acc;
+                acc = 0;
+                shift = 0;
+            }
+        }
+        if (shift) {
+            *dst = (uint8_t)acc;
+        }
+
+        s_total_tdo_bits += chunk;
+        count -= chunk;
+        esp_usb_jtag_send_full_packet();
+    }
+}
+
 static void esp_usb_jtag_task(void *pvParameters)
 {
     enum e_cmds {
@@ -287,8 +357,12 @@ static void esp_usb_jtag_task(void *pvParameters)
             }
 
             if (cmd_exec < CMD_FLUSH) {
-                for (int i = 0; i < cmd_rpt_cnt; i++) {
+                if (cmd_rpt_cnt == 1) {
                     do_jtag_one(pin_levels[cmd_exec].tdo_req, pin_levels[cmd_exec].tms_tdi_mask);
+                } else if (pin_levels[cmd_exec].tdo_req) {
+                    do_jtag_run_tdo(pin_levels[cmd_exec].tms_tdi_mask, cmd_rpt_cnt);
+                } else {
+                    do_jtag_run(pin_levels[cmd_exec].tms_tdi_mask, cmd_rpt_cnt);
                 }
             } else if (cmd_exec == CMD_FLUSH) {
                 s_total_tdo_bits = ROUND_UP_BITS(s_total_tdo_bits);
@@ -308,24 +382,7 @@ static void esp_usb_jtag_task(void *pvParameters)
                 }
             }
 
-            /* As soon as either DEBUG_PROBE_PACKET_SIZE bytes have been collected or a CMD_FLUSH command is executed,
-                make the usb buffer available for the host to receive.
-            */
-            int waiting_to_send_bits = s_total_tdo_bits - s_usb_sent_bits;
-            if (waiting_to_send_bits >= JTAG_PROTO_MAX_BITS) {
-                int send_bits = ROUND_UP_BITS(waiting_to_send_bits > JTAG_PROTO_MAX_BITS ? JTAG_PROTO_MAX_BITS : waiting_to_send_bits);
-                int n_byte = send_bits / 8;
-                esp_err_t send_result = esp_usb_jtag_send_data(s_tdo_bytes + (s_usb_sent_bits / 8), n_byte);
-                if (send_result != ESP_OK) {
-                    ESP_LOGE(TAG, "JTAG send buffer full, dropping data.");
-                }
-                memset(s_tdo_bytes + (s_usb_sent_bits / 8), 0x00, n_byte);
-                s_usb_sent_bits += send_bits;
-                waiting_to_send_bits -= send_bits;
-                if (waiting_to_send_bits <= 0) {
-                    s_total_tdo_bits = s_usb_sent_bits = 0;
-                }
-            }
+            esp_usb_jtag_send_full_packet();
 
             if (cmd < CMD_REP0 && cmd != CMD_FLUSH) {
                 prev_cmd = cmd;
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add host GPIO stub for the SWD bit engine
+ */
+
+/*****************************************************************************
+ * Host DAP Configuration
+ *
+ * Stands in for DAP/Config/DAP_config.h when SW_DP.c is built on the host.
+ * The pins drive a simulated wire instead of GPIO: every SWCLK rising edge
+ * is folded into a hash together with the SWDIO level the probe drives, and
+ * SWDIO reads return the bits queued in sim_wire.in. Two bit engines that
+ * produce the same hash for the same input clocked the same waveform.
+ *****************************************************************************/
+
+#ifndef __DAP_CONFIG_H__
+#define __DAP_CONFIG_H__
+
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "compiler.h"
+
+#define CPU_CLOCK               240000000U
+#define IO_PORT_WRITE_CYCLES    1U
+#define DAP_SWD                 1
+#define DAP_JTAG                0
+#define DAP_JTAG_DEV_CNT        1U
+#define DAP_DEFAULT_PORT        1U
+#define DAP_DEFAULT_SWJ_CLOCK   10000000U
+#define DAP_PACKET_SIZE         64U
+#define DAP_PACKET_COUNT        1U
+#define SWO_UART                0
+#define SWO_MANCHESTER          0
+#define SWO_STREAM              0
+#define TIMESTAMP_CLOCK         0U
+#define DAP_UART                0
+
+typedef struct
+{
+    uint32_t out_en;        /* The probe drives SWDIO */
+    uint32_t out;           /* Level the probe drives */
+    uint32_t hash;          /* FNV-1a of the waveform */
+    uint32_t cycles;        /* SWCLK rising edges */
+    const uint8_t *in;      /* Bits the target drives, one per byte */
+    uint32_t in_len;
+    uint32_t in_pos;
+} sim_wire_t;
+
+extern sim_wire_t sim_wire;
+
+__STATIC_FORCEINLINE void PIN_SWCLK_TCK_SET(void)
+{
+    sim_wire.cycles++;
+    sim_wire.hash = (sim_wire.hash ^ (sim_wire.out_en ? (sim_wire.out & 1U) : 2U)) * 16777619U;
+}
+
+__STATIC_FORCEINLINE void PIN_SWCLK_TCK_CLR(void)
+{
+}
+
+__STATIC_FORCEINLINE void PIN_SWDIO_TMS_SET(void)
+{
+    sim_wire.out = 1U;
+}
+
+__STATIC_FORCEINLINE void PIN_SWDIO_TMS_CLR(void)
+{
+    sim_wire.out = 0U;
+}
+
+__STATIC_FORCEINLINE uint32_t PIN_SWDIO_IN(void)
+{
+    return (sim_wire.in_pos < sim_wire.in_len) ? sim_wire.in[sim_wire.in_pos++] : 0U;
+}
+
+__STATIC_FORCEINLINE void PIN_SWDIO_OUT(uint32_t bit)
+{
+    sim_wire.out = bit & 1U;
+}
+
+__STATIC_FORCEINLINE void PIN_SWDIO_OUT_ENABLE(void)
+{
+    sim_wire.out_en = 1U;
+}
+
+__STATIC_FORCEINLINE void PIN_SWDIO_OUT_DISABLE(void)
+{
+    sim_wire.out_en = 0U;
+}
+
+__STATIC_INLINE uint32_t TIMESTAMP_GET(void)
+{
+    return 0U;
+}
+
+#endif /* __DAP_CONFIG_H__ */
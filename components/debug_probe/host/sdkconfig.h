@@ -0,0 +1,13 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add host build configuration
+ */
+
+#pragma once
+
+/* Host builds take their options from the compile definitions in CMakeLists.txt */
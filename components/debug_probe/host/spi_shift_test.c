@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add SPI shift encoder test
+ */
+
+/*****************************************************************************
+ * SPI Shift Encoder Test
+ *
+ * Packs random bit streams at running offsets into a buffer that starts out
+ * filled with garbage, the way DAP_SWD_Sequence gathers sequences, and
+ * compares every bit against a one bit at a time reference. Bits past the
+ * end of the stream in its last byte must read back as zero.
+ *
+ * Usage: spi_shift_test [iterations]
+ *****************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "debug_spi_shift.h"
+
+#define SPI_SHIFT_TEST_BYTES    CONFIG_DEBUG_PROBE_SPI_SHIFT_MAX_BYTES
+
+static uint32_t spi_shift_test_rand(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+
+    return *state;
+}
+
+static uint32_t spi_shift_test_bit(const uint8_t *buf, uint32_t n)
+{
+    return (buf[n / 8U] >> (n % 8U)) & 1U;
+}
+
+static int spi_shift_test_run(uint32_t iterations)
+{
+    uint32_t seed = 0x9E3779B9U;
+    uint32_t failures = 0;
+    uint8_t buf[SPI_SHIFT_TEST_BYTES + 1];
+    uint8_t ref[DEBUG_SPI_SHIFT_MAX_BITS];
+    uint8_t src[9];
+
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        uint32_t offset = 0;
+        uint32_t bad = 0;
+
+        for (uint32_t n = 0; n < sizeof(buf); n++)
+        {
+            buf[n] = (uint8_t)spi_shift_test_rand(&seed);
+        }
+
+        /* SWD sequences carry 1 to 64 bits each */
+        for (;;)
+        {
+            uint32_t nbits = 1U + (spi_shift_test_rand(&seed) & 63U);
+
+            if (offset + nbits > DEBUG_SPI_SHIFT_MAX_BITS)
+            {
+                break;
+            }
+
+            for (uint32_t n = 0; n < sizeof(src); n++)
+            {
+                src[n] = (uint8_t)spi_shift_test_rand(&seed);
+            }
+
+            debug_spi_shift_pack(buf, offset, src, nbits);
+
+            for (uint32_t n = 0; n < nbits; n++)
+            {
+                ref[offset + n] = (uint8_t)spi_shift_test_bit(src, n);
+            }
+            offset += nbits;
+
+            for (uint32_t n = 0; n < offset; n++)
+            {
+                bad |= spi_shift_test_bit(buf, n) != ref[n];
+            }
+            for (uint32_t n = offset; n < ((offset + 7U) & ~7U); n++)
+            {
+                bad |= spi_shift_test_bit(buf, n) != 0U;
+            }
+        }
+
+        if (bad && (failures++ < 10))
+        {
+            printf("mismatch: iteration %u, %u bits packed\n", i, offset);
+        }
+    }
+
+    printf("check: %u streams, %u mismatches\n", iterations, failures);
+
+    return failures ? -1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t iterations = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 10000;
+
+    return (spi_shift_test_run(iterations) < 0) ? 1 : 0;
+}
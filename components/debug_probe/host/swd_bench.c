@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add SWD bit engine microbenchmark
+ */
+
+/*****************************************************************************
+ * SWD Bit Engine Benchmark
+ *
+ * SW_DP.c is linked twice against the GPIO stub in DAP_config.h: once as
+ * shipped without CONFIG_DEBUG_PROBE_SWD_FAST_PATH (symbols prefixed with
+ * generic_) and once with the specialised fast path. The check feeds both
+ * the same random requests, data and target bits, covering OK, WAIT, FAULT
+ * and protocol errors, and compares the ACK, read data and waveform hash.
+ * The benchmark then times OK reads and writes through both engines.
+ *
+ * Usage: swd_bench [check iterations] [bench iterations]
+ *****************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "DAP_config.h"
+#include "DAP.h"
+
+#define SWD_BENCH_IN_BITS 64
+
+typedef uint8_t (*swd_transfer_t)(uint32_t request, uint32_t *data);
+
+extern uint8_t generic_SWD_Transfer(uint32_t request, uint32_t *data);
+extern void generic_SWD_TransferSelect(void);
+
+DAP_Data_t DAP_Data;
+volatile uint8_t DAP_TransferAbort;
+sim_wire_t sim_wire;
+
+typedef struct
+{
+    uint8_t ack;
+    uint32_t data;
+    uint32_t hash;
+    uint32_t cycles;
+} swd_bench_result_t;
+
+/*****************************************************************************
+ * Helpers
+ *****************************************************************************/
+
+static uint64_t swd_bench_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t swd_bench_rand(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+
+    return *state;
+}
+
+static void swd_bench_configure(uint32_t turnaround, uint32_t data_phase, uint32_t idle_cycles)
+{
+    DAP_Data.fast_clock = 1U;
+    DAP_Data.swd_conf.turnaround = (uint8_t)turnaround;
+    DAP_Data.swd_conf.data_phase = (uint8_t)data_phase;
+    DAP_Data.transfer.idle_cycles = (uint8_t)idle_cycles;
+    generic_SWD_TransferSelect();
+    SWD_TransferSelect();
+}
+
+static void swd_bench_run(swd_transfer_t fn, uint32_t request, uint32_t data, const uint8_t *in, swd_bench_result_t *result)
+{
+    memset(&sim_wire, 0, sizeof(sim_wire));
+    sim_wire.out_en = 1U;
+    sim_wire.hash = 2166136261U;
+    sim_wire.in = in;
+    sim_wire.in_len = SWD_BENCH_IN_BITS;
+
+    result->data = data;
+    result->ack = fn(request, &result->data);
+    result->hash = sim_wire.hash;
+    result->cycles = sim_wire.cycles;
+}
+
+/* Target bits for an OK response, followed by read data and parity */
+static void swd_bench_ok_response(uint8_t *in, uint32_t value)
+{
+    uint32_t parity = 0;
+
+    memset(in, 0, SWD_BENCH_IN_BITS);
+    in[0] = 1;
+
+    for (uint32_t i = 0; i < 32; i++)
+    {
+        in[3 + i] = (value >> i) & 1U;
+        parity ^= in[3 + i];
+    }
+
+    in[35] = (uint8_t)parity;
+}
+
+/*****************************************************************************
+ * Equivalence Check
+ *****************************************************************************/
+
+static int swd_bench_check(uint32_t iterations)
+{
+    uint32_t seed = 0x12345678U;
+    uint32_t failures = 0;
+    uint8_t in[SWD_BENCH_IN_BITS];
+    swd_bench_result_t generic;
+    swd_bench_result_t fast;
+
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        uint32_t request = swd_bench_rand(&seed) & 0x0FU;
+        uint32_t data = swd_bench_rand(&seed);
+
+        swd_bench_configure(1U + (swd_bench_rand(&seed) & 1U), swd_bench_rand(&seed) & 1U, swd_bench_rand(&seed) & 3U);
+
+        for (uint32_t n = 0; n < SWD_BENCH_IN_BITS; n++)
+        {
+            in[n] = swd_bench_rand(&seed) & 1U;
+        }
+
+        /* Mostly OK responses, the rest random to reach WAIT, FAULT and protocol errors */
+        if (swd_bench_rand(&seed) & 3U)
+        {
+            in[0] = 1;
+            in[1] = 0;
+            in[2] = 0;
+        }
+
+        swd_bench_run(generic_SWD_Transfer, request, data, in, &generic);
+        swd_bench_run(SWD_Transfer, request, data, in, &fast);
+
+        if (memcmp(&generic, &fast, sizeof(generic)) != 0)
+        {
+            if (failures++ < 10)
+            {
+                printf("mismatch: request 0x%x turnaround %u data_phase %u ack %u/%u data 0x%08x/0x%08x cycles %u/%u\n",
+                       request, DAP_Data.swd_conf.turnaround, DAP_Data.swd_conf.data_phase, generic.ack, fast.ack,
+                       generic.data, fast.data, generic.cycles, fast.cycles);
+            }
+        }
+    }
+
+    printf("check: %u transfers, %u mismatches\n", iterations, failures);
+
+    return failures ? -1 : 0;
+}
+
+/*****************************************************************************
+ * Benchmark
+ *****************************************************************************/
+
+static double swd_bench_time(swd_transfer_t fn, uint32_t request, const uint8_t *in, uint32_t iterations)
+{
+    swd_bench_result_t result;
+    uint64_t start = swd_bench_now_ns();
+
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        swd_bench_run(fn, request, i, in, &result);
+    }
+
+    return (double)(swd_bench_now_ns() - start) / iterations;
+}
+
+static void swd_bench_report(const char *name, uint32_t request, const uint8_t *in, uint32_t iterations)
+{
+    double generic = swd_bench_time(generic_SWD_Transfer, request, in, iterations);
+    double fast = swd_bench_time(SWD_Transfer, request, in, iterations);
+
+    printf("%-6s generic %7.1f ns  fast %7.1f ns  speedup %.2fx\n", name, generic, fast, generic / fast);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t check = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 100000;
+    uint32_t iterations = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 0) : 1000000;
+    uint8_t in[SWD_BENCH_IN_BITS];
+
+    if (swd_bench_check(check) < 0)
+    {
+        return 1;
+    }
+
+    if (iterations == 0)
+    {
+        return 0;
+    }
+
+    /* Default SWD configuration, the one the specialised variants cover */
+    swd_bench_configure(1, 0, 0);
+    swd_bench_ok_response(in, 0x2BA01477U);
+
+    swd_bench_report("read", DAP_TRANSFER_RnW | DAP_TRANSFER_APnDP, in, iterations);
+    swd_bench_report("write", DAP_TRANSFER_APnDP, in, iterations);
+
+    return 0;
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add DAP port arbitration and lock metrics
+ * 2026-10-19    hongquan.li   add GDB server session
+ * 2026-10-19    hongquan.li   add strict claim, try-lock and USB/IP session
+ * 2026-10-19    hongquan.li   add memory dump session
+ * 2026-10-19    hongquan.li   give every USB/IP connection a session id
+ * 2026-10-19    hongquan.li   add batched execution under one lock hold
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Fixed session ids for the local transports, network sessions use any other non-zero id */
+#define DAP_SESSION_NONE        0U
+#define DAP_SESSION_USB         1U
+#define DAP_SESSION_PROGRAMMER  2U
+#define DAP_SESSION_GDB         3U
+#define DAP_SESSION_DUMP        5U
+/* USB/IP connection n is DAP_SESSION_USBIP + n, every connection is a session of its own */
+#define DAP_SESSION_USBIP       0x100U
+
+/**
+ * @brief DAP lock statistics
+ */
+typedef struct
+{
+    uint32_t owner;         ///< Session owning the debug port, DAP_SESSION_NONE if free
+    uint32_t commands;      ///< Commands executed under the DAP lock
+    uint32_t monitor;       ///< Read-only commands served without the DAP lock
+    uint32_t rejected;      ///< Commands refused because another session owns the port
+    uint32_t contended;     ///< Lock acquisitions that had to wait
+    uint32_t handovers;     ///< Ownership taken over from an idle session
+    uint64_t hold_total_us; ///< Total time the DAP lock was held
+    uint32_t hold_max_us;   ///< Longest single lock hold
+    uint32_t wait_max_us;   ///< Longest wait for the lock
+} dap_arbiter_stats_t;
+
+/**
+ * @brief Execute a DAP packet on behalf of a session
+ *
+ * One session owns the SWD/JTAG port at a time. A session becomes the owner
+ * with its first command that touches the port and stays the owner until it
+ * sends DAP_Disconnect, calls dap_arbiter_release() or stays idle for longer
+ * than CONFIG_DEBUG_PROBE_DAP_ARBITER_IDLE_MS while another session is
+ * waiting. Port commands from other sessions are answered with DAP_ERROR
+ * instead of blocking or corrupting the owner's state.
+ *
+ * Commands that only read probe state (DAP_Info, SWO and UART status) are
+ * served to every session without taking the DAP lock, so monitoring
+ * clients never wait behind a long transfer. DAP_SWO_Data consumes the
+ * trace buffer and is a port command like the others.
+ *
+ * @param session Session id, not DAP_SESSION_NONE
+ * @param request DAP request packet
+ * @param response Response buffer, DAP_PACKET_SIZE bytes
+ * @return Request length in the upper 16 bits, response length in the lower 16 bits
+ */
+uint32_t dap_arbiter_execute(uint32_t session, const uint8_t *request, uint8_t *response);
+
+/**
+ * @brief Execute a DAP packet as part of a batch from the calling task
+ *
+ * Same as dap_arbiter_execute(), but the DAP lock taken by the first
+ * command stays held for the following ones, like DAP_ExecuteCommands does
+ * for the commands of one packet. A transport calls this while it has more
+ * commands queued and dap_arbiter_batch_end() before it waits for the next
+ * one. The batch also ends on DAP_Disconnect and after
+ * CONFIG_DEBUG_PROBE_DAP_ARBITER_BATCH_MAX commands.
+ *
+ * The calling task must not block on anything another DAP user may hold
+ * while the batch is open.
+ *
+ * @param session Session id, not DAP_SESSION_NONE
+ * @param request DAP request packet
+ * @param response Response buffer, DAP_PACKET_SIZE bytes
+ * @return Request length in the upper 16 bits, response length in the lower 16 bits
+ */
+uint32_t dap_arbiter_execute_batch(uint32_t session, const uint8_t *request, uint8_t *response);
+
+/**
+ * @brief Release the DAP lock held by the calling task's batch
+ *
+ * Does nothing if the calling task has no batch open.
+ */
+void dap_arbiter_batch_end(void);
+
+/**
+ * @brief Try to take ownership of the debug port
+ * @param session Session id
+ * @return 1 if the session owns the port, 0 if another session does
+ */
+int dap_arbiter_claim(uint32_t session);
+
+/**
+ * @brief Take ownership of the debug port only if nobody holds it
+ *
+ * Unlike dap_arbiter_claim() an idle owner is never handed over, so a host
+ * or GDB session that is merely quiet keeps the port. The programmer claims
+ * this way for every job, and while it owns the port no other session can
+ * take it over.
+ *
+ * @param session Session id
+ * @return 1 if the session owns the port, 0 if another session does
+ */
+int dap_arbiter_try_claim(uint32_t session);
+
+/**
+ * @brief Give up ownership of the debug port
+ *
+ * Does nothing if the session is not the owner. Transports call this when
+ * a client disconnects.
+ *
+ * @param session Session id
+ */
+void dap_arbiter_release(uint32_t session);
+
+/**
+ * @brief Take the DAP lock for direct SWD access outside of DAP commands
+ *
+ * Used by the programmer, which drives SWD_Transfer() itself. Blocks until
+ * the lock is free and counts towards the hold time statistics.
+ */
+void dap_arbiter_lock(void);
+
+/**
+ * @brief Take the DAP lock only while no session owns the debug port
+ *
+ * For background tasks (RTT, data watch, SWO, armed mode) that touch the
+ * target between sessions. The owner is checked with the lock held, so a
+ * session cannot start in between. Release with dap_arbiter_unlock().
+ *
+ * @return 1 with the lock taken, 0 if a session owns the port
+ */
+int dap_arbiter_try_lock(void);
+
+/**
+ * @brief Release the lock taken with dap_arbiter_lock() or dap_arbiter_try_lock()
+ */
+void dap_arbiter_unlock(void);
+
+/**
+ * @brief Get a snapshot of the lock statistics
+ * @param stats Output statistics
+ */
+void dap_arbiter_get_stats(dap_arbiter_stats_t *stats);
+
+/**
+ * @brief Clear the lock statistics, ownership is not affected
+ */
+void dap_arbiter_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add tuned SWJ clock override
+ * 2026-10-19    hongquan.li   use the tuned clock as default only
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Set the tuned SWJ clock used instead of the default clock
+ *
+ * Takes effect on the next DAP_Setup() call. Explicit DAP_SWJ_Clock
+ * requests from the host are always applied as requested.
+ *
+ * @param clock Clock in Hz, 0 to follow the requested clock again
+ */
+void swj_clock_set_tuned(uint32_t clock);
+
+/**
+ * @brief Get the tuned SWJ clock
+ * @return Clock in Hz, 0 if no tuned clock is set
+ */
+uint32_t swj_clock_get_tuned(void);
+
+/**
+ * @brief Get the SWJ clock applied by DAP_Setup()
+ * @param fallback Default clock in Hz
+ * @return Tuned clock when one is set, otherwise the fallback clock
+ */
+uint32_t swj_clock_default(uint32_t fallback);
+
+#ifdef __cplusplus
+}
+#endif
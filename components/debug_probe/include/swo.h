@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add SWO UART capture
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief SWO capture statistics
+ */
+typedef struct
+{
+    uint32_t baudrate;      ///< UART baudrate, 0 while the UART is off
+    uint32_t bytes;         ///< Bytes received since boot
+    uint32_t overruns;      ///< Times the DAP trace buffer ran full
+    uint8_t host_active;    ///< The host captures with DAP_SWO_Control
+} swo_stats_t;
+
+/**
+ * @brief Start capturing for probe side consumers
+ *
+ * SWO is received on CONFIG_DEBUG_PROBE_GPIO_SWO by a UART. The host
+ * configures the same UART with DAP_SWO_Mode and DAP_SWO_Baudrate, while
+ * it does so its baudrate wins over the one given here.
+ *
+ * @param baudrate SWO baudrate in Hz
+ * @return Baudrate in use, 0 if the UART could not be started
+ */
+uint32_t swo_start(uint32_t baudrate);
+
+/**
+ * @brief Stop capturing for probe side consumers, the host keeps its capture
+ */
+void swo_stop(void);
+
+/**
+ * @brief Register the probe side output
+ *
+ * The callback runs in the capture task with every block received while
+ * probe side capture is started, it must not block.
+ *
+ * @param cb Callback
+ */
+void swo_register_output(void (*cb)(const uint8_t *data, uint32_t size));
+
+/**
+ * @brief Get the capture statistics
+ * @param stats Output statistics
+ */
+void swo_get_stats(swo_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
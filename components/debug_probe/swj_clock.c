@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add tuned SWJ clock override
+ * 2026-10-19    hongquan.li   use the tuned clock as default only
+ */
+
+#include "swj_clock.h"
+#include "sdkconfig.h"
+
+static volatile uint32_t s_tuned_clock = 0;
+
+void swj_clock_set_tuned(uint32_t clock)
+{
+    s_tuned_clock = clock;
+}
+
+uint32_t swj_clock_get_tuned(void)
+{
+    return s_tuned_clock;
+}
+
+uint32_t swj_clock_default(uint32_t fallback)
+{
+#ifdef CONFIG_DEBUG_PROBE_SWJ_AUTO_TUNE
+    uint32_t tuned = s_tuned_clock;
+
+    if (tuned != 0)
+    {
+        return tuned;
+    }
+#endif
+
+    return fallback;
+}
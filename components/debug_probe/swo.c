@@ -0,0 +1,475 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add SWO UART capture
+ * 2026-10-19    hongquan.li   keep the overrun flag apart from the capture state
+ * 2026-10-19    hongquan.li   document which side owns the capture state
+ */
+
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "driver/uart.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "swo.h"
+#include "DAP_config.h"
+#include "DAP.h"
+
+#define SWO_UART_PORT ((uart_port_t)CONFIG_DEBUG_PROBE_SWO_UART_NUM)
+/* The driver's RX ring takes bursts while the capture task is busy with a consumer */
+#define SWO_UART_RX_BUF_SIZE (2 * SWO_BUFFER_SIZE)
+#define SWO_RX_FULL_THRESHOLD 64
+#define SWO_RX_TIMEOUT_SYMBOLS 4
+#define SWO_CHUNK_SIZE 256
+#define SWO_READ_TIMEOUT_MS 10
+
+#if ((SWO_BUFFER_SIZE & (SWO_BUFFER_SIZE - 1)) != 0)
+#error "SWO_BUFFER_SIZE must be a power of 2"
+#endif
+
+static const char *TAG = "swo";
+
+static portMUX_TYPE s_state_lock = portMUX_INITIALIZER_UNLOCKED;
+static StaticSemaphore_t s_config_mutex_buf;
+static SemaphoreHandle_t s_config_mutex = NULL;
+static SemaphoreHandle_t s_applied = NULL;
+static TaskHandle_t s_task = NULL;
+static void (*s_output_cb)(const uint8_t *data, uint32_t size) = NULL;
+
+/*
+ * Host capture, the trace buffer is filled by the capture task and drained by DAP_SWO_Data.
+ * Every SWO command that changes state, DAP_SWO_Data included, runs under the DAP lock
+ * (dap_arbiter.c), only the status queries are served without it and they only read.
+ * s_index_in belongs to the capture task, s_index_out and s_status to the DAP lock holder.
+ */
+static uint8_t s_trace_buf[SWO_BUFFER_SIZE];
+static volatile uint32_t s_index_in = 0;
+static volatile uint32_t s_index_out = 0;
+/* Capture active, never read-modify-written by the capture task */
+static volatile uint8_t s_status = 0;
+/* Set by the capture task, cleared under the DAP lock before a capture starts */
+static volatile bool s_overrun = false;
+static uint8_t s_transport = 0;
+static uint8_t s_mode = DAP_SWO_OFF;
+static uint32_t s_host_baud = 0;
+
+/* Probe side capture */
+static volatile bool s_probe_active = false;
+static uint32_t s_probe_baud = 0;
+
+/* Owned by the capture task, requested with swo_apply() */
+static volatile bool s_apply = false;
+static volatile uint32_t s_baud = 0;
+static volatile uint32_t s_bytes = 0;
+static volatile uint32_t s_overruns = 0;
+
+static SemaphoreHandle_t swo_config_mutex(void)
+{
+    if (s_config_mutex == NULL)
+    {
+        taskENTER_CRITICAL(&s_state_lock);
+
+        if (s_config_mutex == NULL)
+        {
+            s_config_mutex = xSemaphoreCreateMutexStatic(&s_config_mutex_buf);
+        }
+
+        taskEXIT_CRITICAL(&s_state_lock);
+    }
+
+    return s_config_mutex;
+}
+
+/* Runs on the capture task, nobody else touches the UART */
+static void swo_uart_update(void)
+{
+    uint32_t baud = (s_mode == DAP_SWO_UART) ? s_host_baud : s_probe_baud;
+    bool want = ((s_mode == DAP_SWO_UART) || s_probe_active) && (baud != 0);
+    uint32_t actual = 0;
+    uart_config_t config = {
+        .baud_rate = (int)baud,
+        .data_bits = UART_DATA_8_BITS,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .source_clk = UART_SCLK_DEFAULT,
+    };
+
+    if (!want)
+    {
+        if (uart_is_driver_installed(SWO_UART_PORT))
+        {
+            uart_driver_delete(SWO_UART_PORT);
+        }
+
+        s_baud = 0;
+        return;
+    }
+
+    if (!uart_is_driver_installed(SWO_UART_PORT))
+    {
+        if ((uart_driver_install(SWO_UART_PORT, SWO_UART_RX_BUF_SIZE, 0, 0, NULL, 0) != ESP_OK) ||
+            (uart_param_config(SWO_UART_PORT, &config) != ESP_OK) ||
+            (uart_set_pin(SWO_UART_PORT, UART_PIN_NO_CHANGE, CONFIG_DEBUG_PROBE_GPIO_SWO, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE) != ESP_OK))
+        {
+            ESP_LOGE(TAG, "Failed to start UART%d", SWO_UART_PORT);
+            uart_driver_delete(SWO_UART_PORT);
+            s_baud = 0;
+            return;
+        }
+
+        /* Fewer interrupts at high baudrates, the timeout flushes a quiet line */
+        uart_set_rx_full_threshold(SWO_UART_PORT, SWO_RX_FULL_THRESHOLD);
+        uart_set_rx_timeout(SWO_UART_PORT, SWO_RX_TIMEOUT_SYMBOLS);
+    }
+    else
+    {
+        uart_set_baudrate(SWO_UART_PORT, baud);
+    }
+
+    uart_get_baudrate(SWO_UART_PORT, &actual);
+    uart_flush_input(SWO_UART_PORT);
+    s_baud = actual;
+}
+
+/* Status byte of the SWO commands */
+static uint8_t swo_status(void)
+{
+    return s_status | (s_overrun ? DAP_SWO_BUFFER_OVERRUN : 0U);
+}
+
+static void swo_buffer_put(const uint8_t *data, uint32_t len)
+{
+    uint32_t index = s_index_in;
+    uint32_t space = SWO_BUFFER_SIZE - (index - s_index_out);
+    uint32_t offset = 0;
+    uint32_t n = 0;
+
+    if (len > space)
+    {
+        len = space;
+        s_overrun = true;
+        s_overruns++;
+    }
+
+    while (len > 0)
+    {
+        offset = index & (SWO_BUFFER_SIZE - 1);
+        n = ((SWO_BUFFER_SIZE - offset) < len) ? (SWO_BUFFER_SIZE - offset) : len;
+        memcpy(&s_trace_buf[offset], data, n);
+        data += n;
+        index += n;
+        len -= n;
+    }
+
+    s_index_in = index;
+}
+
+static void swo_task(void *param)
+{
+    static uint8_t chunk[SWO_CHUNK_SIZE];
+    int len = 0;
+
+    for (;;)
+    {
+        if (s_apply)
+        {
+            s_apply = false;
+            swo_uart_update();
+            xSemaphoreGive(s_applied);
+        }
+
+        if (s_baud == 0)
+        {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        len = uart_read_bytes(SWO_UART_PORT, chunk, sizeof(chunk), pdMS_TO_TICKS(SWO_READ_TIMEOUT_MS));
+        if (len <= 0)
+        {
+            continue;
+        }
+
+        s_bytes += len;
+
+        if (s_status & DAP_SWO_CAPTURE_ACTIVE)
+        {
+            swo_buffer_put(chunk, len);
+        }
+
+        if (s_probe_active && s_output_cb)
+        {
+            s_output_cb(chunk, len);
+        }
+    }
+}
+
+/* Called with the config mutex held, returns the baudrate in use */
+static uint32_t swo_apply(void)
+{
+    if (!s_task)
+    {
+        s_applied = xSemaphoreCreateBinary();
+
+        if (!s_applied || (xTaskCreate(swo_task, "swo", 3072, NULL, 5, &s_task) != pdPASS))
+        {
+            ESP_LOGE(TAG, "Failed to start the capture task");
+            return 0;
+        }
+    }
+
+    s_apply = true;
+    xTaskNotifyGive(s_task);
+    xSemaphoreTake(s_applied, portMAX_DELAY);
+
+    return s_baud;
+}
+
+uint32_t swo_start(uint32_t baudrate)
+{
+    uint32_t ret = 0;
+
+    xSemaphoreTake(swo_config_mutex(), portMAX_DELAY);
+    s_probe_baud = (baudrate > SWO_UART_MAX_BAUDRATE) ? SWO_UART_MAX_BAUDRATE : baudrate;
+    s_probe_active = true;
+    ret = swo_apply();
+    xSemaphoreGive(swo_config_mutex());
+
+    return ret;
+}
+
+void swo_stop(void)
+{
+    xSemaphoreTake(swo_config_mutex(), portMAX_DELAY);
+    s_probe_active = false;
+    swo_apply();
+    xSemaphoreGive(swo_config_mutex());
+}
+
+void swo_register_output(void (*cb)(const uint8_t *data, uint32_t size))
+{
+    s_output_cb = cb;
+}
+
+void swo_get_stats(swo_stats_t *stats)
+{
+    stats->baudrate = s_baud;
+    stats->bytes = s_bytes;
+    stats->overruns = s_overruns;
+    stats->host_active = (s_status & DAP_SWO_CAPTURE_ACTIVE) ? 1U : 0U;
+}
+
+// Process SWO Transport command and prepare response
+//   request:  pointer to request data
+//   response: pointer to response data
+//   return:   number of bytes in response (lower 16 bits)
+//             number of bytes in request (upper 16 bits)
+uint32_t SWO_Transport(const uint8_t *request, uint8_t *response)
+{
+    uint8_t transport = *request;
+    uint8_t result = DAP_ERROR;
+
+    /* 0: none, 1: DAP_SWO_Data, 2 (stream endpoint) is not available */
+    if (!(s_status & DAP_SWO_CAPTURE_ACTIVE) && (transport <= 1U))
+    {
+        s_transport = transport;
+        result = DAP_OK;
+    }
+
+    *response = result;
+
+    return ((1U << 16) | 1U);
+}
+
+// Process SWO Mode command and prepare response
+//   request:  pointer to request data
+//   response: pointer to response data
+//   return:   number of bytes in response (lower 16 bits)
+//             number of bytes in request (upper 16 bits)
+uint32_t SWO_Mode(const uint8_t *request, uint8_t *response)
+{
+    uint8_t mode = *request;
+    uint8_t result = DAP_ERROR;
+
+    s_status &= ~DAP_SWO_CAPTURE_ACTIVE;
+
+    if ((mode == DAP_SWO_OFF) || (mode == DAP_SWO_UART))
+    {
+        xSemaphoreTake(swo_config_mutex(), portMAX_DELAY);
+        s_mode = mode;
+        s_host_baud = s_host_baud ? s_host_baud : SWO_UART_MAX_BAUDRATE;
+
+        if ((swo_apply() != 0) || (mode == DAP_SWO_OFF))
+        {
+            result = DAP_OK;
+        }
+        else
+        {
+            s_mode = DAP_SWO_OFF;
+        }
+
+        xSemaphoreGive(swo_config_mutex());
+    }
+
+    *response = result;
+
+    return ((1U << 16) | 1U);
+}
+
+// Process SWO Baudrate command and prepare response
+//   request:  pointer to request data
+//   response: pointer to response data
+//   return:   number of bytes in response (lower 16 bits)
+//             number of bytes in request (upper 16 bits)
+uint32_t SWO_Baudrate(const uint8_t *request, uint8_t *response)
+{
+    uint32_t baudrate = (uint32_t)request[0] | ((uint32_t)request[1] << 8) | ((uint32_t)request[2] << 16) | ((uint32_t)request[3] << 24);
+
+    s_status &= ~DAP_SWO_CAPTURE_ACTIVE;
+
+    xSemaphoreTake(swo_config_mutex(), portMAX_DELAY);
+    s_host_baud = (baudrate > SWO_UART_MAX_BAUDRATE) ? SWO_UART_MAX_BAUDRATE : baudrate;
+
+    /* The UART divider decides the real rate, the host programs the target's prescaler from it */
+    if (s_mode == DAP_SWO_UART)
+    {
+        baudrate = swo_apply();
+    }
+    else
+    {
+        baudrate = s_host_baud;
+    }
+
+    xSemaphoreGive(swo_config_mutex());
+
+    response[0] = (uint8_t)(baudrate >> 0);
+    response[1] = (uint8_t)(baudrate >> 8);
+    response[2] = (uint8_t)(baudrate >> 16);
+    response[3] = (uint8_t)(baudrate >> 24);
+
+    return ((4U << 16) | 4U);
+}
+
+// Process SWO Control command and prepare response
+//   request:  pointer to request data
+//   response: pointer to response data
+//   return:   number of bytes in response (lower 16 bits)
+//             number of bytes in request (upper 16 bits)
+uint32_t SWO_Control(const uint8_t *request, uint8_t *response)
+{
+    uint8_t active = *request & DAP_SWO_CAPTURE_ACTIVE;
+    uint8_t result = DAP_OK;
+
+    if (active && !(s_status & DAP_SWO_CAPTURE_ACTIVE))
+    {
+        if ((s_mode == DAP_SWO_UART) && s_baud)
+        {
+            /* Only the consumer index moves here, the capture task owns the producer index */
+            s_index_out = s_index_in;
+            s_overrun = false;
+            s_status = DAP_SWO_CAPTURE_ACTIVE;
+        }
+        else
+        {
+            result = DAP_ERROR;
+        }
+    }
+    else if (!active)
+    {
+        s_status &= ~DAP_SWO_CAPTURE_ACTIVE;
+    }
+
+    *response = result;
+
+    return ((1U << 16) | 1U);
+}
+
+// Process SWO Status command and prepare response
+//   response: pointer to response data
+//   return:   number of bytes in response
+uint32_t SWO_Status(uint8_t *response)
+{
+    uint32_t count = s_index_in - s_index_out;
+
+    response[0] = swo_status();
+    response[1] = (uint8_t)(count >> 0);
+    response[2] = (uint8_t)(count >> 8);
+    response[3] = (uint8_t)(count >> 16);
+    response[4] = (uint8_t)(count >> 24);
+
+    return 5U;
+}
+
+// Process SWO Extended Status command and prepare response
+//   request:  pointer to request data
+//   response: pointer to response data
+//   return:   number of bytes in response (lower 16 bits)
+//             number of bytes in request (upper 16 bits)
+uint32_t SWO_ExtendedStatus(const uint8_t *request, uint8_t *response)
+{
+    uint8_t cmd = *request;
+    uint32_t count = s_index_in - s_index_out;
+    uint32_t num = 0;
+
+    if (cmd & 0x01U)
+    {
+        response[num++] = swo_status();
+    }
+
+    if (cmd & 0x02U)
+    {
+        response[num++] = (uint8_t)(count >> 0);
+        response[num++] = (uint8_t)(count >> 8);
+        response[num++] = (uint8_t)(count >> 16);
+        response[num++] = (uint8_t)(count >> 24);
+    }
+
+    /* Index and timestamp need TIMESTAMP_CLOCK, which this probe does not have */
+
+    return ((1U << 16) | num);
+}
+
+// Process SWO Data command and prepare response
+//   request:  pointer to request data
+//   response: pointer to response data
+//   return:   number of bytes in response (lower 16 bits)
+//             number of bytes in request (upper 16 bits)
+uint32_t SWO_Data(const uint8_t *request, uint8_t *response)
+{
+    uint32_t index = s_index_out;
+    uint32_t count = s_index_in - index;
+    uint32_t max = (uint32_t)request[0] | ((uint32_t)request[1] << 8);
+    uint32_t offset = 0;
+    uint32_t n = 0;
+    uint32_t i = 0;
+
+    if (s_transport != 1U)
+    {
+        count = 0;
+    }
+
+    count = (count > max) ? max : count;
+    count = (count > (DAP_PACKET_SIZE - 4U)) ? (DAP_PACKET_SIZE - 4U) : count;
+
+    response[0] = swo_status();
+    response[1] = (uint8_t)(count >> 0);
+    response[2] = (uint8_t)(count >> 8);
+
+    for (i = 0; i < count; i += n)
+    {
+        offset = (index + i) & (SWO_BUFFER_SIZE - 1);
+        n = ((SWO_BUFFER_SIZE - offset) < (count - i)) ? (SWO_BUFFER_SIZE - offset) : (count - i);
+        memcpy(&response[3 + i], &s_trace_buf[offset], n);
+    }
+
+    s_index_out = index + count;
+
+    return ((2U << 16) | (3U + count));
+}
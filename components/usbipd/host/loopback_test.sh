@@ -0,0 +1,20 @@
+#!/bin/sh
+# Start the simulated probe on a loopback port, run the benchmark against it
+# and fail if the import or any URB round trip fails.
+#   loopback_test.sh <usbipd_sim> <usbip_bench> [port]
+
+SIM=$1
+BENCH=$2
+PORT=${3:-13240}
+
+"$SIM" "$PORT" &
+SIM_PID=$!
+trap 'kill $SIM_PID 2>/dev/null' EXIT
+
+# Give the server thread time to bind
+for i in 1 2 3 4 5 6 7 8 9 10; do
+    "$BENCH" -p "$PORT" -n 1000 -d 4 && exit 0
+    sleep 0.2
+done
+
+exit 1
@@ -0,0 +1,511 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add simulated SWD target for host builds
+ */
+
+/*****************************************************************************
+ * Simulated CMSIS-DAP Probe
+ *
+ * Replaces the debug_probe component when the usbipd server core, hid_dap
+ * and bulk_dap are built on Linux with the POSIX platform. Commands are
+ * answered at DAP level by a simulated Cortex-M SWD target: one DP, one
+ * MEM-AP and a block of RAM reachable through TAR/DRW. Timing is not
+ * simulated, so benchmarks measure the USB/IP path alone.
+ *****************************************************************************/
+
+#include <stdint.h>
+#include <string.h>
+
+#include "DAP.h"
+
+#ifndef SIM_DAP_PACKET_SIZE
+#define SIM_DAP_PACKET_SIZE 512U
+#endif
+
+#ifndef SIM_DAP_PACKET_COUNT
+#define SIM_DAP_PACKET_COUNT 8U
+#endif
+
+#define SIM_DP_IDCODE   0x2BA01477U /* ARM SW-DP v2 */
+#define SIM_AP_IDR      0x24770011U /* AHB-AP */
+#define SIM_RAM_BASE    0x20000000U
+#define SIM_RAM_SIZE    0x10000U
+
+/* DP registers (A[3:2]) */
+#define DP_IDCODE       0x00U
+#define DP_CTRL_STAT    0x04U
+#define DP_SELECT       0x08U
+#define DP_RDBUFF       0x0CU
+
+/* MEM-AP registers */
+#define AP_CSW          0x00U
+#define AP_TAR          0x04U
+#define AP_DRW          0x0CU
+#define AP_IDR          0xFCU
+
+struct sim_target
+{
+    uint32_t ctrl_stat;
+    uint32_t select;
+    uint32_t rdbuff;
+    uint32_t csw;
+    uint32_t tar;
+    uint32_t match_mask;
+    uint32_t ram[SIM_RAM_SIZE / 4];
+};
+
+static struct sim_target s_target;
+
+/*****************************************************************************
+ * Simulated Target
+ *****************************************************************************/
+
+static uint32_t sim_get_u32(const uint8_t* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void sim_put_u32(uint8_t* p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t* sim_mem_word(uint32_t addr)
+{
+    if ((addr < SIM_RAM_BASE) || (addr >= SIM_RAM_BASE + SIM_RAM_SIZE))
+    {
+        return NULL;
+    }
+
+    return &s_target.ram[(addr - SIM_RAM_BASE) / 4];
+}
+
+static uint8_t sim_mem_access(int read, uint32_t* data)
+{
+    uint32_t* word = sim_mem_word(s_target.tar & ~3U);
+
+    if (word == NULL)
+    {
+        /* Bus fault, the DAP sees it as a FAULT ACK with STICKYERR set */
+        s_target.ctrl_stat |= (1U << 5);
+
+        return DAP_TRANSFER_FAULT;
+    }
+
+    if (read)
+    {
+        *data = *word;
+    }
+    else
+    {
+        *word = *data;
+    }
+
+    /* CSW.AddrInc == single increment */
+    if (((s_target.csw >> 4) & 3U) == 1U)
+    {
+        s_target.tar += 4;
+    }
+
+    return DAP_TRANSFER_OK;
+}
+
+/* One SWD transfer as seen by DAP_Transfer, request bits as in the DAP command */
+static uint8_t sim_transfer(uint32_t request, uint32_t* data)
+{
+    uint32_t addr = request & (DAP_TRANSFER_A2 | DAP_TRANSFER_A3);
+    int read = (request & DAP_TRANSFER_RnW) != 0;
+    uint8_t ack = DAP_TRANSFER_OK;
+
+    if ((request & DAP_TRANSFER_APnDP) == 0)
+    {
+        switch (addr)
+        {
+        case DP_IDCODE:
+            if (read)
+            {
+                *data = SIM_DP_IDCODE;
+            }
+            else
+            {
+                /* DP ABORT clears the sticky flags */
+                s_target.ctrl_stat &= ~(0x32U);
+            }
+            break;
+
+        case DP_CTRL_STAT:
+            if (read)
+            {
+                *data = s_target.ctrl_stat;
+            }
+            else
+            {
+                /* Power-up requests are acknowledged immediately */
+                s_target.ctrl_stat = *data & 0x50000F00U;
+                s_target.ctrl_stat |= (*data & 0x50000000U) << 1;
+            }
+            break;
+
+        case DP_SELECT:
+            if (!read)
+            {
+                s_target.select = *data;
+            }
+            else
+            {
+                *data = 0;
+            }
+            break;
+
+        default:
+            if (read)
+            {
+                *data = s_target.rdbuff;
+            }
+            break;
+        }
+
+        return ack;
+    }
+
+    addr |= s_target.select & 0xF0U;
+
+    switch (addr)
+    {
+    case AP_CSW:
+        if (read)
+        {
+            *data = s_target.csw | 0x03000040U;
+        }
+        else
+        {
+            s_target.csw = *data;
+        }
+        break;
+
+    case AP_TAR:
+        if (read)
+        {
+            *data = s_target.tar;
+        }
+        else
+        {
+            s_target.tar = *data;
+        }
+        break;
+
+    case AP_DRW:
+        ack = sim_mem_access(read, data);
+        break;
+
+    case AP_IDR:
+        if (read)
+        {
+            *data = SIM_AP_IDR;
+        }
+        break;
+
+    default:
+        if (read)
+        {
+            *data = 0;
+        }
+        break;
+    }
+
+    if (read && (ack == DAP_TRANSFER_OK))
+    {
+        s_target.rdbuff = *data;
+    }
+
+    return ack;
+}
+
+/*****************************************************************************
+ * DAP Commands
+ *****************************************************************************/
+
+static uint32_t sim_info_string(const char* str, uint8_t* info)
+{
+    uint32_t len = (uint32_t)strlen(str) + 1;
+
+    memcpy(info, str, len);
+
+    return len;
+}
+
+static uint32_t sim_dap_info(uint8_t id, uint8_t* info)
+{
+    switch (id)
+    {
+    case DAP_ID_VENDOR:
+        return sim_info_string("ESP32-DAPLink", info);
+
+    case DAP_ID_PRODUCT:
+        return sim_info_string("Simulated CMSIS-DAP", info);
+
+    case DAP_ID_SER_NUM:
+        return sim_info_string("SIM0001", info);
+
+    case DAP_ID_DAP_FW_VER:
+        return sim_info_string("2.1.1", info);
+
+    case DAP_ID_CAPABILITIES:
+        info[0] = 0x01U; /* SWD */
+        return 1;
+
+    case DAP_ID_PACKET_COUNT:
+        info[0] = (uint8_t)SIM_DAP_PACKET_COUNT;
+        return 1;
+
+    case DAP_ID_PACKET_SIZE:
+        info[0] = (uint8_t)SIM_DAP_PACKET_SIZE;
+        info[1] = (uint8_t)(SIM_DAP_PACKET_SIZE >> 8);
+        return 2;
+
+    default:
+        return 0;
+    }
+}
+
+static uint32_t sim_dap_transfer(const uint8_t* request, uint8_t* response)
+{
+    const uint8_t* req = request + 2; /* Skip DAP index */
+    uint8_t* resp = response + 2;
+    uint32_t count = request[1];
+    uint32_t done = 0;
+    uint8_t ack = DAP_TRANSFER_OK;
+    uint32_t data;
+    uint32_t req_bits;
+
+    for (; done < count; done++)
+    {
+        req_bits = *req++;
+
+        if (req_bits & DAP_TRANSFER_RnW)
+        {
+            if (req_bits & DAP_TRANSFER_MATCH_VALUE)
+            {
+                uint32_t match = sim_get_u32(req);
+
+                req += 4;
+                ack = sim_transfer(req_bits, &data);
+
+                if ((ack == DAP_TRANSFER_OK) && ((data & s_target.match_mask) != match))
+                {
+                    ack |= DAP_TRANSFER_MISMATCH;
+                }
+            }
+            else
+            {
+                ack = sim_transfer(req_bits, &data);
+
+                if (ack == DAP_TRANSFER_OK)
+                {
+                    sim_put_u32(resp, data);
+                    resp += 4;
+                }
+            }
+        }
+        else
+        {
+            data = sim_get_u32(req);
+            req += 4;
+
+            if (req_bits & DAP_TRANSFER_MATCH_MASK)
+            {
+                s_target.match_mask = data;
+            }
+            else
+            {
+                ack = sim_transfer(req_bits, &data);
+            }
+        }
+
+        if (ack != DAP_TRANSFER_OK)
+        {
+            break;
+        }
+    }
+
+    /* Skip the requests that were not executed, the failed one is already consumed */
+    for (uint32_t i = done + (ack != DAP_TRANSFER_OK ? 1 : 0); i < count; i++)
+    {
+        req_bits = *req++;
+
+        if (((req_bits & DAP_TRANSFER_RnW) == 0) || (req_bits & DAP_TRANSFER_MATCH_VALUE))
+        {
+            req += 4;
+        }
+    }
+
+    response[0] = (uint8_t)done;
+    response[1] = ack;
+
+    return ((uint32_t)(req - request) << 16) | (uint32_t)(resp - response);
+}
+
+static uint32_t sim_dap_transfer_block(const uint8_t* request, uint8_t* response)
+{
+    uint32_t count = (uint32_t)request[1] | ((uint32_t)request[2] << 8);
+    uint32_t req_bits = request[3];
+    const uint8_t* req = request + 4;
+    uint8_t* resp = response + 3;
+    uint32_t done = 0;
+    uint8_t ack = DAP_TRANSFER_OK;
+    uint32_t data;
+
+    for (; done < count; done++)
+    {
+        if (req_bits & DAP_TRANSFER_RnW)
+        {
+            ack = sim_transfer(req_bits, &data);
+
+            if (ack != DAP_TRANSFER_OK)
+            {
+                break;
+            }
+
+            sim_put_u32(resp, data);
+            resp += 4;
+        }
+        else
+        {
+            data = sim_get_u32(req);
+            req += 4;
+            ack = sim_transfer(req_bits, &data);
+
+            if (ack != DAP_TRANSFER_OK)
+            {
+                break;
+            }
+        }
+    }
+
+    /* Consume the unwritten data words so the request length stays right */
+    if ((req_bits & DAP_TRANSFER_RnW) == 0)
+    {
+        req = request + 4 + count * 4;
+    }
+
+    response[0] = (uint8_t)done;
+    response[1] = (uint8_t)(done >> 8);
+    response[2] = ack;
+
+    return ((uint32_t)(req - request) << 16) | (uint32_t)(resp - response);
+}
+
+uint32_t DAP_ProcessCommand(const uint8_t* request, uint8_t* response)
+{
+    uint32_t num;
+
+    *response++ = *request;
+
+    switch (*request++)
+    {
+    case ID_DAP_Info:
+        num = sim_dap_info(request[0], response + 1);
+        response[0] = (uint8_t)num;
+        return (2U << 16) | (2U + num);
+
+    case ID_DAP_HostStatus:
+        response[0] = DAP_OK;
+        return (3U << 16) | 2U;
+
+    case ID_DAP_Connect:
+        response[0] = (request[0] == 2U) ? 0U : 1U; /* SWD only */
+        return (2U << 16) | 2U;
+
+    case ID_DAP_Disconnect:
+        response[0] = DAP_OK;
+        return (1U << 16) | 2U;
+
+    case ID_DAP_SWD_Configure:
+        response[0] = DAP_OK;
+        return (2U << 16) | 2U;
+
+    case ID_DAP_TransferConfigure:
+        response[0] = DAP_OK;
+        return (6U << 16) | 2U;
+
+    case ID_DAP_WriteABORT:
+        s_target.ctrl_stat &= ~(0x32U);
+        response[0] = DAP_OK;
+        return (6U << 16) | 2U;
+
+    case ID_DAP_Delay:
+        response[0] = DAP_OK;
+        return (3U << 16) | 2U;
+
+    case ID_DAP_ResetTarget:
+        response[0] = DAP_OK;
+        response[1] = 0U;
+        return (1U << 16) | 3U;
+
+    case ID_DAP_SWJ_Pins:
+        response[0] = request[0];
+        return (7U << 16) | 2U;
+
+    case ID_DAP_SWJ_Clock:
+        response[0] = DAP_OK;
+        return (5U << 16) | 2U;
+
+    case ID_DAP_SWJ_Sequence:
+        num = request[0] ? request[0] : 256U;
+        response[0] = DAP_OK;
+        return ((2U + (num + 7U) / 8U) << 16) | 2U;
+
+    case ID_DAP_Transfer:
+        num = sim_dap_transfer(request, response);
+        return num + (1U << 16) + 1U;
+
+    case ID_DAP_TransferBlock:
+        num = sim_dap_transfer_block(request, response);
+        return num + (1U << 16) + 1U;
+
+    case ID_DAP_TransferAbort:
+        return (1U << 16);
+
+    default:
+        *(response - 1) = ID_DAP_Invalid;
+        return (1U << 16) | 1U;
+    }
+}
+
+uint32_t DAP_ExecuteCommand(const uint8_t* request, uint8_t* response)
+{
+    uint32_t cnt, num, n;
+
+    if (*request == ID_DAP_ExecuteCommands)
+    {
+        *response++ = *request++;
+        cnt = *request++;
+        *response++ = (uint8_t)cnt;
+        num = (2U << 16) | 2U;
+
+        while (cnt--)
+        {
+            n = DAP_ProcessCommand(request, response);
+            num += n;
+            request += (uint16_t)(n >> 16);
+            response += (uint16_t)n;
+        }
+
+        return num;
+    }
+
+    return DAP_ProcessCommand(request, response);
+}
+
+void DAP_Setup(void)
+{
+    memset(&s_target, 0, sizeof(s_target));
+}
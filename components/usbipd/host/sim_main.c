@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add host entry point for the simulated probe
+ */
+
+/*****************************************************************************
+ * Simulated Probe Server
+ *
+ * Runs the usbipd server core with the POSIX platform, hid_dap, bulk_dap and
+ * the simulated target in sim_dap.c. The platform and drivers register
+ * themselves from constructors before main() runs.
+ *
+ * Usage: usbipd_sim [port]
+ *****************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "DAP.h"
+#include "usbipd.h"
+
+int main(int argc, char** argv)
+{
+    uint16_t port = (argc > 1) ? (uint16_t)strtoul(argv[1], NULL, 0) : 3240;
+
+    DAP_Setup();
+    usbipd_init(port);
+
+    for (;;)
+    {
+        pause();
+    }
+
+    return 0;
+}
@@ -0,0 +1,451 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add USB/IP loopback throughput benchmark
+ */
+
+/*****************************************************************************
+ * USB/IP URB Benchmark
+ *
+ * Imports a CMSIS-DAP device from a usbipd server (a board on the network
+ * or the host build with posix_os.c, posix_transport.c and sim_dap.c over
+ * loopback) and streams DAP commands as CMD_SUBMIT URB pairs: one OUT URB
+ * with the command and one IN URB for the response. Reports URBs/s and
+ * round-trip latency percentiles.
+ *
+ * Build: components/usbipd/host/CMakeLists.txt, or gcc -O2 -o usbip_bench usbip_bench.c
+ * Usage: usbip_bench [-H host] [-p port] [-b busid] [-n count] [-d depth]
+ *                    [-o out_ep] [-i in_ep] [-l in_len]
+ *****************************************************************************/
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define USBIP_VERSION           0x0111
+#define OP_REQ_IMPORT           0x8003
+#define OP_REP_IMPORT           0x0003
+#define USBIP_CMD_SUBMIT        0x00000001
+#define USBIP_RET_SUBMIT        0x00000003
+#define USBIP_DIR_OUT           0
+#define USBIP_DIR_IN            1
+
+#define USBIP_BUSID_SIZE        32
+#define USBIP_DEVICE_SIZE       312
+#define USBIP_DEVICE_BUSNUM     288
+#define USBIP_DEVICE_DEVNUM     292
+#define USBIP_HEADER_SIZE       48
+
+#define BENCH_MAX_DEPTH         64
+#define BENCH_MAX_IN_LEN        1024
+
+/* DAP_Transfer: read DP IDCODE, the most common command during a debug session */
+static const uint8_t s_dap_cmd[] = {0x05, 0x00, 0x01, 0x02};
+
+struct bench_config
+{
+    const char* host;
+    const char* port;
+    const char* busid;
+    uint32_t count;
+    uint32_t depth;
+    uint32_t out_ep;
+    uint32_t in_ep;
+    uint32_t in_len;
+};
+
+/*****************************************************************************
+ * Helpers
+ *****************************************************************************/
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void put_be32(uint8_t* p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static uint32_t get_be32(const uint8_t* p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static int bench_send_all(int fd, const void* buf, size_t len)
+{
+    size_t total = 0;
+    ssize_t n;
+
+    while (total < len)
+    {
+        n = send(fd, (const char*)buf + total, len - total, 0);
+
+        if (n <= 0)
+        {
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+
+            return -1;
+        }
+
+        total += n;
+    }
+
+    return 0;
+}
+
+static int bench_recv_all(int fd, void* buf, size_t len)
+{
+    size_t total = 0;
+    ssize_t n;
+
+    while (total < len)
+    {
+        n = recv(fd, (char*)buf + total, len - total, MSG_WAITALL);
+
+        if (n <= 0)
+        {
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+
+            return -1;
+        }
+
+        total += n;
+    }
+
+    return 0;
+}
+
+static int bench_connect(const char* host, const char* port)
+{
+    struct addrinfo hints;
+    struct addrinfo* res;
+    struct addrinfo* ai;
+    int fd = -1;
+    int opt = 1;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    if (getaddrinfo(host, port, &hints, &res) != 0)
+    {
+        return -1;
+    }
+
+    for (ai = res; ai; ai = ai->ai_next)
+    {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+
+        if (fd < 0)
+        {
+            continue;
+        }
+
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0)
+        {
+            break;
+        }
+
+        close(fd);
+        fd = -1;
+    }
+
+    freeaddrinfo(res);
+
+    if (fd >= 0)
+    {
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+    }
+
+    return fd;
+}
+
+static int bench_cmp_u64(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+
+    return (x > y) - (x < y);
+}
+
+/*****************************************************************************
+ * USB/IP Protocol
+ *****************************************************************************/
+
+static int bench_import(int fd, const char* busid, uint32_t* devid)
+{
+    uint8_t req[8 + USBIP_BUSID_SIZE];
+    uint8_t rep[8];
+    uint8_t udev[USBIP_DEVICE_SIZE];
+
+    memset(req, 0, sizeof(req));
+    req[0] = USBIP_VERSION >> 8;
+    req[1] = USBIP_VERSION & 0xFF;
+    req[2] = OP_REQ_IMPORT >> 8;
+    req[3] = OP_REQ_IMPORT & 0xFF;
+    strncpy((char*)&req[8], busid, USBIP_BUSID_SIZE - 1);
+
+    if (bench_send_all(fd, req, sizeof(req)) < 0 || bench_recv_all(fd, rep, sizeof(rep)) < 0)
+    {
+        return -1;
+    }
+
+    if ((((uint32_t)rep[2] << 8) | rep[3]) != OP_REP_IMPORT || get_be32(&rep[4]) != 0)
+    {
+        fprintf(stderr, "import of %s refused (status %u)\n", busid, get_be32(&rep[4]));
+        return -1;
+    }
+
+    if (bench_recv_all(fd, udev, sizeof(udev)) < 0)
+    {
+        return -1;
+    }
+
+    *devid = (get_be32(&udev[USBIP_DEVICE_BUSNUM]) << 16) | get_be32(&udev[USBIP_DEVICE_DEVNUM]);
+
+    return 0;
+}
+
+/* Queue the OUT command URB and the IN response URB of one DAP transaction */
+static int bench_submit(int fd, const struct bench_config* cfg, uint32_t devid, uint32_t seqnum)
+{
+    uint8_t buf[2 * USBIP_HEADER_SIZE + sizeof(s_dap_cmd)];
+    uint8_t* out = buf;
+    uint8_t* in = buf + USBIP_HEADER_SIZE + sizeof(s_dap_cmd);
+
+    memset(buf, 0, sizeof(buf));
+
+    put_be32(&out[0], USBIP_CMD_SUBMIT);
+    put_be32(&out[4], seqnum);
+    put_be32(&out[8], devid);
+    put_be32(&out[12], USBIP_DIR_OUT);
+    put_be32(&out[16], cfg->out_ep);
+    put_be32(&out[24], sizeof(s_dap_cmd));
+    memcpy(&out[USBIP_HEADER_SIZE], s_dap_cmd, sizeof(s_dap_cmd));
+
+    put_be32(&in[0], USBIP_CMD_SUBMIT);
+    put_be32(&in[4], seqnum + 1);
+    put_be32(&in[8], devid);
+    put_be32(&in[12], USBIP_DIR_IN);
+    put_be32(&in[16], cfg->in_ep);
+    put_be32(&in[24], cfg->in_len);
+
+    return bench_send_all(fd, buf, sizeof(buf));
+}
+
+/* Read one RET_SUBMIT, returns its seqnum or 0 on error */
+static uint32_t bench_reply(int fd)
+{
+    uint8_t hdr[USBIP_HEADER_SIZE];
+    uint8_t data[BENCH_MAX_IN_LEN];
+    uint32_t len;
+
+    if (bench_recv_all(fd, hdr, sizeof(hdr)) < 0)
+    {
+        return 0;
+    }
+
+    if (get_be32(&hdr[0]) != USBIP_RET_SUBMIT || (int32_t)get_be32(&hdr[20]) != 0)
+    {
+        fprintf(stderr, "URB %u failed (command %u, status %d)\n", get_be32(&hdr[4]), get_be32(&hdr[0]),
+                (int32_t)get_be32(&hdr[20]));
+        return 0;
+    }
+
+    /* Only IN replies carry data */
+    len = (get_be32(&hdr[12]) == USBIP_DIR_IN) ? get_be32(&hdr[24]) : 0;
+
+    if (len > sizeof(data) || (len && bench_recv_all(fd, data, len) < 0))
+    {
+        return 0;
+    }
+
+    return get_be32(&hdr[4]);
+}
+
+/*****************************************************************************
+ * Benchmark
+ *****************************************************************************/
+
+static int bench_run(int fd, const struct bench_config* cfg, uint32_t devid)
+{
+    uint64_t* latency = calloc(cfg->count, sizeof(uint64_t));
+    uint64_t* start = calloc(cfg->count, sizeof(uint64_t));
+    uint32_t submitted = 0;
+    uint32_t completed = 0;
+    uint32_t seqnum;
+    uint64_t t0, elapsed;
+    double secs;
+
+    if (!latency || !start)
+    {
+        free(latency);
+        free(start);
+        return -1;
+    }
+
+    t0 = bench_now_ns();
+
+    while (completed < cfg->count)
+    {
+        /* Keep up to depth transactions in flight */
+        while (submitted < cfg->count && submitted - completed < cfg->depth)
+        {
+            start[submitted] = bench_now_ns();
+
+            if (bench_submit(fd, cfg, devid, 2 * submitted + 1) < 0)
+            {
+                goto fail;
+            }
+
+            submitted++;
+        }
+
+        seqnum = bench_reply(fd);
+
+        if (seqnum == 0)
+        {
+            goto fail;
+        }
+
+        /* A transaction completes with the reply to its IN URB (even seqnum) */
+        if ((seqnum & 1) == 0)
+        {
+            latency[(seqnum - 2) / 2] = bench_now_ns() - start[(seqnum - 2) / 2];
+            completed++;
+        }
+    }
+
+    elapsed = bench_now_ns() - t0;
+    secs = (double)elapsed / 1e9;
+    qsort(latency, cfg->count, sizeof(uint64_t), bench_cmp_u64);
+
+    printf("transactions : %u (depth %u)\n", cfg->count, cfg->depth);
+    printf("elapsed      : %.3f s\n", secs);
+    printf("URBs/s       : %.0f\n", 2.0 * cfg->count / secs);
+    printf("DAP cmds/s   : %.0f\n", cfg->count / secs);
+    printf("latency (us) : p50 %.1f  p90 %.1f  p99 %.1f  max %.1f\n",
+           latency[cfg->count * 50 / 100] / 1e3, latency[cfg->count * 90 / 100] / 1e3,
+           latency[cfg->count * 99 / 100] / 1e3, latency[cfg->count - 1] / 1e3);
+
+    free(latency);
+    free(start);
+
+    return 0;
+
+fail:
+    fprintf(stderr, "connection lost after %u transactions\n", completed);
+    free(latency);
+    free(start);
+
+    return -1;
+}
+
+int main(int argc, char** argv)
+{
+    struct bench_config cfg = {
+        .host = "127.0.0.1",
+        .port = "3240",
+        .busid = "2-2",
+        .count = 10000,
+        .depth = 1,
+        .out_ep = 1,
+        .in_ep = 1,
+        .in_len = 512,
+    };
+    uint32_t devid = 0;
+    int opt;
+    int fd;
+    int ret;
+
+    while ((opt = getopt(argc, argv, "H:p:b:n:d:o:i:l:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'H':
+            cfg.host = optarg;
+            break;
+        case 'p':
+            cfg.port = optarg;
+            break;
+        case 'b':
+            cfg.busid = optarg;
+            break;
+        case 'n':
+            cfg.count = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'd':
+            cfg.depth = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'o':
+            cfg.out_ep = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'i':
+            cfg.in_ep = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'l':
+            cfg.in_len = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr,
+                    "usage: %s [-H host] [-p port] [-b busid] [-n count] [-d depth] [-o out_ep] [-i in_ep] "
+                    "[-l in_len]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+
+    if (cfg.count == 0 || cfg.depth == 0 || cfg.depth > BENCH_MAX_DEPTH || cfg.in_len > BENCH_MAX_IN_LEN)
+    {
+        fprintf(stderr, "invalid parameters\n");
+        return 1;
+    }
+
+    fd = bench_connect(cfg.host, cfg.port);
+
+    if (fd < 0)
+    {
+        fprintf(stderr, "cannot connect to %s:%s\n", cfg.host, cfg.port);
+        return 1;
+    }
+
+    if (bench_import(fd, cfg.busid, &devid) < 0)
+    {
+        close(fd);
+        return 1;
+    }
+
+    printf("imported %s (devid 0x%08x) from %s:%s\n", cfg.busid, devid, cfg.host, cfg.port);
+    ret = bench_run(fd, &cfg, devid);
+    close(fd);
+
+    return ret < 0 ? 1 : 0;
+}
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   route USB/IP DAP commands through the arbiter
+ * 2026-10-19    hongquan.li   give every connection its own session
+ * 2026-10-19    hongquan.li   mark the tasks that execute DAP commands
+ * 2026-10-19    hongquan.li   run queued URBs under one DAP lock hold
+ */
+
+/*****************************************************************************
+ * ESP-IDF DAP Glue
+ *
+ * hid_dap.c and bulk_dap.c come from the usbipd core and call the CMSIS-DAP
+ * entry points directly. CMakeLists.txt renames those calls to
+ * usbip_dap_execute() so USB/IP clients share the debug port with USB, GDB
+ * and the programmer.
+ *
+ * Every connection is a session of its own, DAP_SESSION_USBIP + slot, so
+ * a second host is arbitrated against the first like any other session.
+ * The core does not pass the connection down to the DAP drivers. The
+ * transport binds the tasks that receive and send for a connection (its RX
+ * and URB processor threads) to the connection's session, and a command
+ * runs as the session of the task executing it.
+ *
+ * A bound task runs its commands as an arbiter batch. The DAP lock stays
+ * held while the URB processor finds more URBs queued, and the OSAL ends
+ * the batch with usbip_dap_batch_end() before the processor blocks.
+ *****************************************************************************/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dap_arbiter.h"
+#include "espidf_glue.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+
+#ifndef CONFIG_USBIP_MAX_CONNECTIONS
+#define CONFIG_USBIP_MAX_CONNECTIONS 2
+#endif
+
+/* RX thread, URB processor and the server thread answering the import */
+#define USBIP_DAP_TASKS (3 * CONFIG_USBIP_MAX_CONNECTIONS)
+
+/* Connections beyond the slots and tasks never bound share this session */
+#define USBIP_DAP_SESSION_SHARED (DAP_SESSION_USBIP + CONFIG_USBIP_MAX_CONNECTIONS)
+
+typedef struct
+{
+    TaskHandle_t task; /* Task serving a connection, NULL if the entry is free */
+    uint32_t session;  /* Session of that connection */
+    uint8_t executes;  /* The task has run a DAP command, it is the URB processor */
+} usbip_dap_task_t;
+
+static portMUX_TYPE s_conn_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint8_t s_conn_used[CONFIG_USBIP_MAX_CONNECTIONS];
+static usbip_dap_task_t s_tasks[USBIP_DAP_TASKS];
+
+/* Session of the calling task, 0 if the task is not bound to a connection */
+static uint32_t usbip_dap_session(void)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    uint32_t session = 0;
+
+    taskENTER_CRITICAL(&s_conn_lock);
+
+    for (int i = 0; i < USBIP_DAP_TASKS; i++)
+    {
+        if (s_tasks[i].task == self)
+        {
+            session = s_tasks[i].session;
+            s_tasks[i].executes = 1;
+            break;
+        }
+    }
+
+    taskEXIT_CRITICAL(&s_conn_lock);
+
+    return session;
+}
+
+int usbip_dap_task_executes(void)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    int executes = 0;
+
+    taskENTER_CRITICAL(&s_conn_lock);
+
+    for (int i = 0; i < USBIP_DAP_TASKS; i++)
+    {
+        if (s_tasks[i].task == self)
+        {
+            executes = s_tasks[i].executes;
+            break;
+        }
+    }
+
+    taskEXIT_CRITICAL(&s_conn_lock);
+
+    return executes;
+}
+
+uint32_t usbip_dap_execute(const uint8_t* request, uint8_t* response)
+{
+    uint32_t session = usbip_dap_session();
+
+    if (session == 0)
+    {
+        return dap_arbiter_execute(USBIP_DAP_SESSION_SHARED, request, response);
+    }
+
+    return dap_arbiter_execute_batch(session, request, response);
+}
+
+void usbip_dap_batch_end(void)
+{
+    dap_arbiter_batch_end();
+}
+
+uint32_t usbip_dap_conn_open(void)
+{
+    uint32_t session = USBIP_DAP_SESSION_SHARED;
+
+    taskENTER_CRITICAL(&s_conn_lock);
+
+    for (int i = 0; i < CONFIG_USBIP_MAX_CONNECTIONS; i++)
+    {
+        if (!s_conn_used[i])
+        {
+            s_conn_used[i] = 1;
+            session = DAP_SESSION_USBIP + i;
+            break;
+        }
+    }
+
+    taskEXIT_CRITICAL(&s_conn_lock);
+
+    return session;
+}
+
+void usbip_dap_conn_bind(uint32_t session)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    int slot = -1;
+
+    taskENTER_CRITICAL(&s_conn_lock);
+
+    /* A task serves one connection at a time, the server thread moves on to the next one */
+    for (int i = 0; i < USBIP_DAP_TASKS; i++)
+    {
+        if (s_tasks[i].task == self)
+        {
+            slot = i;
+            break;
+        }
+
+        if ((slot < 0) && (s_tasks[i].task == NULL))
+        {
+            slot = i;
+        }
+    }
+
+    if ((slot >= 0) && ((s_tasks[slot].task != self) || (s_tasks[slot].session != session)))
+    {
+        s_tasks[slot].task = self;
+        s_tasks[slot].session = session;
+        s_tasks[slot].executes = 0;
+    }
+
+    taskEXIT_CRITICAL(&s_conn_lock);
+}
+
+void usbip_dap_conn_close(uint32_t session)
+{
+    taskENTER_CRITICAL(&s_conn_lock);
+
+    for (int i = 0; i < USBIP_DAP_TASKS; i++)
+    {
+        if (s_tasks[i].session == session)
+        {
+            s_tasks[i].task = NULL;
+            s_tasks[i].session = 0;
+            s_tasks[i].executes = 0;
+        }
+    }
+
+    if (session < USBIP_DAP_SESSION_SHARED)
+    {
+        s_conn_used[session - DAP_SESSION_USBIP] = 0;
+    }
+
+    taskEXIT_CRITICAL(&s_conn_lock);
+
+    /* The shared session stays claimed until it goes idle, another connection may still use it */
+    if (session < USBIP_DAP_SESSION_SHARED)
+    {
+        dap_arbiter_release(session);
+    }
+}
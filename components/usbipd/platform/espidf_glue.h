@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   share the ESP-IDF platform glue between transport, OSAL and DAP
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*****************************************************************************
+ * DAP Glue (espidf_dap.c)
+ *****************************************************************************/
+
+/**
+ * @brief Execute a DAP packet for the connection served by the calling task
+ *
+ * hid_dap.c and bulk_dap.c call this in place of DAP_ProcessCommand() and
+ * DAP_ExecuteCommand().
+ *
+ * @param request DAP request packet
+ * @param response Response buffer, DAP_PACKET_SIZE bytes
+ * @return Request length in the upper 16 bits, response length in the lower 16 bits
+ */
+uint32_t usbip_dap_execute(const uint8_t* request, uint8_t* response);
+
+/**
+ * @brief End the calling task's DAP batch and release the DAP lock
+ *
+ * usbip_dap_execute() keeps the DAP lock between the commands of a URB
+ * processor. The OSAL calls this before a usbipd thread blocks.
+ */
+void usbip_dap_batch_end(void);
+
+/**
+ * @brief Take a DAP session for a new connection
+ * @return Session id of the connection
+ */
+uint32_t usbip_dap_conn_open(void);
+
+/**
+ * @brief Bind the calling task to a connection's session
+ * @param session Session id from usbip_dap_conn_open()
+ */
+void usbip_dap_conn_bind(uint32_t session);
+
+/**
+ * @brief Release a connection's session and its tasks
+ * @param session Session id from usbip_dap_conn_open()
+ */
+void usbip_dap_conn_close(uint32_t session);
+
+/**
+ * @brief Check if the calling task executes DAP commands (a URB processor)
+ * @return 1 if it does, 0 otherwise
+ */
+int usbip_dap_task_executes(void);
+
+/*****************************************************************************
+ * Transport Glue (espidf_transport.c)
+ *****************************************************************************/
+
+/**
+ * @brief Send the replies the calling task has staged
+ *
+ * A URB processor stages its replies and sends them together once it has
+ * no URB left to run. The OSAL calls this before a usbipd thread blocks.
+ */
+void espidf_transport_flush(void);
+
+#ifdef __cplusplus
+}
+#endif
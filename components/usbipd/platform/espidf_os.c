@@ -6,6 +6,9 @@
  * Change Logs:
  * Date           Author       Notes
  * 2026-3-27     hongquan.li   add ESP-IDF OSAL implementation
+ * 2026-10-19    hongquan.li   add static allocation pools for threads and sync objects
+ * 2026-10-19    hongquan.li   flush staged replies before a thread blocks
+ * 2026-10-19    hongquan.li   end the DAP batch before a thread blocks
  */
 
 /*
@@ -22,8 +25,22 @@
 #include "freertos/event_groups.h"
 #include "freertos/semphr.h"
 #include "freertos/task.h"
+#include "sdkconfig.h"
 
 #include "hal/usbip_osal.h"
+#include "espidf_glue.h"
+
+/*****************************************************************************
+ * ESP-IDF Idle Hook
+ *****************************************************************************/
+
+/* The URB processor blocks here once its queue is empty, the port goes back to the
+ * other DAP users and the replies it staged go out now */
+static void espidf_thread_idle(void)
+{
+    usbip_dap_batch_end();
+    espidf_transport_flush();
+}
 
 /*****************************************************************************
  * ESP-IDF Memory Operations (Low-level implementation, not using OSAL wrappers)
@@ -39,13 +56,79 @@ static void espidf_free(void* ptr)
     free(ptr);
 }
 
+/*****************************************************************************
+ * ESP-IDF Static Object Pools
+ *
+ * With CONFIG_USBIP_OSAL_STATIC, TCBs, stacks and sync objects come from
+ * fixed pools in .bss so that sessions coming and going never touch the
+ * heap. When a pool is exhausted the object falls back to the heap.
+ *****************************************************************************/
+
+#ifdef CONFIG_USBIP_OSAL_STATIC
+
+/* Index of ptr in a static pool array, -1 if it was not taken from the pool */
+#define ESPIDF_POOL_INDEX(pool, ptr)                                                                                 \
+    (((const char*)(ptr) >= (const char*)&(pool)[0] &&                                                               \
+      (const char*)(ptr) < (const char*)&(pool)[sizeof(pool) / sizeof((pool)[0])])                                   \
+         ? (int)(((const char*)(ptr) - (const char*)&(pool)[0]) / sizeof((pool)[0]))                                 \
+         : -1)
+
+static portMUX_TYPE s_pool_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static int espidf_pool_alloc(uint8_t* used, int count)
+{
+    int i;
+
+    taskENTER_CRITICAL(&s_pool_lock);
+
+    for (i = 0; i < count; i++)
+    {
+        if (!used[i])
+        {
+            used[i] = 1;
+            break;
+        }
+    }
+
+    taskEXIT_CRITICAL(&s_pool_lock);
+
+    return (i < count) ? i : -1;
+}
+
+static void espidf_pool_free(uint8_t* used, int index)
+{
+    taskENTER_CRITICAL(&s_pool_lock);
+    used[index] = 0;
+    taskEXIT_CRITICAL(&s_pool_lock);
+}
+
+static StaticSemaphore_t s_mutex_pool[CONFIG_USBIP_OSAL_STATIC_MUTEXES];
+static uint8_t s_mutex_used[CONFIG_USBIP_OSAL_STATIC_MUTEXES];
+static StaticSemaphore_t s_sem_pool[CONFIG_USBIP_OSAL_STATIC_SEMAPHORES];
+static uint8_t s_sem_used[CONFIG_USBIP_OSAL_STATIC_SEMAPHORES];
+
+#endif
+
 /*****************************************************************************
  * ESP-IDF Mutex Implementation
  *****************************************************************************/
 
 static int espidf_mutex_init(void** handle)
 {
-    SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+    SemaphoreHandle_t mutex = NULL;
+
+#ifdef CONFIG_USBIP_OSAL_STATIC
+    int index = espidf_pool_alloc(s_mutex_used, CONFIG_USBIP_OSAL_STATIC_MUTEXES);
+
+    if (index >= 0)
+    {
+        mutex = xSemaphoreCreateMutexStatic(&s_mutex_pool[index]);
+    }
+    else
+#endif
+    {
+        mutex = xSemaphoreCreateMutex();
+    }
 
     if (mutex == NULL)
     {
@@ -61,6 +144,14 @@ static int espidf_mutex_lock(void* handle)
 {
     SemaphoreHandle_t mutex = (SemaphoreHandle_t)handle;
 
+    if (xSemaphoreTake(mutex, 0) == pdTRUE)
+    {
+        return OSAL_OK;
+    }
+
+    /* The holder may be waiting for the DAP lock this thread's batch holds */
+    espidf_thread_idle();
+
     if (xSemaphoreTake(mutex, portMAX_DELAY) == pdTRUE)
     {
         return OSAL_OK;
@@ -88,6 +179,15 @@ static void espidf_mutex_destroy(void* handle)
     if (mutex != NULL)
     {
         vSemaphoreDelete(mutex);
+
+#ifdef CONFIG_USBIP_OSAL_STATIC
+        int index = ESPIDF_POOL_INDEX(s_mutex_pool, mutex);
+
+        if (index >= 0)
+        {
+            espidf_pool_free(s_mutex_used, index);
+        }
+#endif
     }
 }
 
@@ -102,32 +202,89 @@ struct espidf_cond
     volatile int signaled;
     volatile int nwaiters;
     SemaphoreHandle_t lock;
+#ifdef CONFIG_USBIP_OSAL_STATIC
+    StaticEventGroup_t event_group_buf;
+    StaticSemaphore_t lock_buf;
+#endif
 };
 
+#ifdef CONFIG_USBIP_OSAL_STATIC
+static struct espidf_cond s_cond_pool[CONFIG_USBIP_OSAL_STATIC_CONDS];
+static uint8_t s_cond_used[CONFIG_USBIP_OSAL_STATIC_CONDS];
+#endif
+
+static void espidf_cond_free(struct espidf_cond* cond)
+{
+#ifdef CONFIG_USBIP_OSAL_STATIC
+    int index = ESPIDF_POOL_INDEX(s_cond_pool, cond);
+
+    if (index >= 0)
+    {
+        espidf_pool_free(s_cond_used, index);
+        return;
+    }
+#endif
+
+    free(cond);
+}
+
 static int espidf_cond_init(void** handle)
 {
-    struct espidf_cond* cond = malloc(sizeof(struct espidf_cond));
+    struct espidf_cond* cond = NULL;
+
+#ifdef CONFIG_USBIP_OSAL_STATIC
+    int pooled = 0;
+    int index = espidf_pool_alloc(s_cond_used, CONFIG_USBIP_OSAL_STATIC_CONDS);
+
+    if (index >= 0)
+    {
+        cond = &s_cond_pool[index];
+        pooled = 1;
+    }
+    else
+#endif
+    {
+        cond = malloc(sizeof(struct espidf_cond));
+    }
 
     if (cond == NULL)
     {
         return OSAL_ERROR;
     }
 
-    cond->event_group = xEventGroupCreate();
+#ifdef CONFIG_USBIP_OSAL_STATIC
+    if (pooled)
+    {
+        cond->event_group = xEventGroupCreateStatic(&cond->event_group_buf);
+    }
+    else
+#endif
+    {
+        cond->event_group = xEventGroupCreate();
+    }
 
     if (cond->event_group == NULL)
     {
-        free(cond);
+        espidf_cond_free(cond);
 
         return OSAL_ERROR;
     }
 
-    cond->lock = xSemaphoreCreateMutex();
+#ifdef CONFIG_USBIP_OSAL_STATIC
+    if (pooled)
+    {
+        cond->lock = xSemaphoreCreateMutexStatic(&cond->lock_buf);
+    }
+    else
+#endif
+    {
+        cond->lock = xSemaphoreCreateMutex();
+    }
 
     if (cond->lock == NULL)
     {
         vEventGroupDelete(cond->event_group);
-        free(cond);
+        espidf_cond_free(cond);
         return OSAL_ERROR;
     }
 
@@ -158,6 +315,7 @@ static int espidf_cond_wait(void* cond_handle, void* mutex_handle)
 
         /* Release mutex and wait for the event */
         xSemaphoreGive(mutex);
+        espidf_thread_idle();
 
         /* Wait for the signal. xClearOnExit (pdTRUE) clears the bit upon return,
          * so there is no need to manually ClearBits before waiting.
@@ -195,6 +353,7 @@ static int espidf_cond_timedwait(void* cond_handle, void* mutex_handle, uint32_t
 
         /* Release mutex and wait for the event */
         xSemaphoreGive(mutex);
+        espidf_thread_idle();
 
         /* Wait for the signal with timeout. xClearOnExit (pdTRUE) clears the bit
          * upon return, removing the lost-wakeup window caused by ClearBits. */
@@ -275,7 +434,7 @@ static void espidf_cond_destroy(void* handle)
             vSemaphoreDelete(cond->lock);
         }
 
-        free(cond);
+        espidf_cond_free(cond);
     }
 }
 
@@ -286,7 +445,21 @@ static void espidf_cond_destroy(void* handle)
 static int espidf_sem_init(void** handle)
 {
     /* Use counting semaphore to match POSIX semantics (accumulates posts) */
-    SemaphoreHandle_t sem = xSemaphoreCreateCounting(portMAX_DELAY, 0);
+    SemaphoreHandle_t sem = NULL;
+
+#ifdef CONFIG_USBIP_OSAL_STATIC
+    int index = espidf_pool_alloc(s_sem_used, CONFIG_USBIP_OSAL_STATIC_SEMAPHORES);
+
+    if (index >= 0)
+    {
+        sem = xSemaphoreCreateCountingStatic(portMAX_DELAY, 0, &s_sem_pool[index]);
+    }
+    else
+#endif
+    {
+        sem = xSemaphoreCreateCounting(portMAX_DELAY, 0);
+    }
+
     if (sem == NULL)
     {
         return OSAL_ERROR;
@@ -297,6 +470,13 @@ static int espidf_sem_init(void** handle)
 
 static int espidf_sem_wait(void* handle)
 {
+    if (xSemaphoreTake((SemaphoreHandle_t)handle, 0) == pdTRUE)
+    {
+        return OSAL_OK;
+    }
+
+    espidf_thread_idle();
+
     if (xSemaphoreTake((SemaphoreHandle_t)handle, portMAX_DELAY) == pdTRUE)
     {
         return OSAL_OK;
@@ -334,6 +514,15 @@ static void espidf_sem_destroy(void* handle)
     if (handle != NULL)
     {
         vSemaphoreDelete((SemaphoreHandle_t)handle);
+
+#ifdef CONFIG_USBIP_OSAL_STATIC
+        int index = ESPIDF_POOL_INDEX(s_sem_pool, handle);
+
+        if (index >= 0)
+        {
+            espidf_pool_free(s_sem_used, index);
+        }
+#endif
     }
 }
 
@@ -347,32 +536,106 @@ struct thread_callback
     void* arg;
 };
 
+#ifdef CONFIG_USBIP_OSAL_STATIC
+
+/* A pooled thread does not delete itself: FreeRTOS would only release the
+ * TCB later from the idle task, so the slot could not be reused safely.
+ * It suspends instead, and join (or the next create, for detached threads)
+ * deletes it from another task, which cleans the TCB up synchronously. */
+struct espidf_thread_slot
+{
+    StaticTask_t tcb;
+    StackType_t stack[CONFIG_USBIP_OSAL_STATIC_STACK_SIZE / sizeof(StackType_t)];
+    struct thread_callback callback;
+    volatile int finished;
+    volatile int detached;
+};
+
+static struct espidf_thread_slot s_thread_pool[CONFIG_USBIP_OSAL_STATIC_THREADS];
+static uint8_t s_thread_used[CONFIG_USBIP_OSAL_STATIC_THREADS];
+
+static void espidf_thread_reap(struct espidf_thread_slot* slot)
+{
+    TaskHandle_t task = (TaskHandle_t)&slot->tcb;
+
+    while (!slot->finished || eTaskGetState(task) != eSuspended)
+    {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
+    vTaskDelete(task);
+}
+
+static struct espidf_thread_slot* espidf_thread_slot_alloc(void)
+{
+    struct espidf_thread_slot* slot;
+    int index = espidf_pool_alloc(s_thread_used, CONFIG_USBIP_OSAL_STATIC_THREADS);
+    int i;
+
+    if (index < 0)
+    {
+        /* Take over a detached thread that has already returned */
+        for (i = 0; i < CONFIG_USBIP_OSAL_STATIC_THREADS && index < 0; i++)
+        {
+            taskENTER_CRITICAL(&s_pool_lock);
+
+            if (s_thread_pool[i].detached && s_thread_pool[i].finished)
+            {
+                s_thread_pool[i].detached = 0;
+                index = i;
+            }
+
+            taskEXIT_CRITICAL(&s_pool_lock);
+        }
+
+        if (index < 0)
+        {
+            return NULL;
+        }
+
+        espidf_thread_reap(&s_thread_pool[index]);
+    }
+
+    slot = &s_thread_pool[index];
+    slot->finished = 0;
+    slot->detached = 0;
+
+    return slot;
+}
+
+#endif
+
 static void freertos_thread_entry(void* arg)
 {
     struct thread_callback* info = (struct thread_callback*)arg;
     void* (*thread_func)(void*) = info->func;
     void* thread_arg = info->arg;
 
+#ifdef CONFIG_USBIP_OSAL_STATIC
+    int index = ESPIDF_POOL_INDEX(s_thread_pool, info);
+
+    if (index >= 0)
+    {
+        thread_func(thread_arg);
+        espidf_thread_idle();
+        s_thread_pool[index].finished = 1;
+        vTaskSuspend(NULL);
+    }
+#endif
+
     free(info);
     thread_func(thread_arg);
+    espidf_thread_idle();
     vTaskDelete(NULL);
 }
 
 static int espidf_thread_create(void** handle, const char *name,void* (*func)(void*), void* arg, size_t stack_size,
                                 int priority)
 {
-    TaskHandle_t task_handle;
+    TaskHandle_t task_handle = NULL;
     BaseType_t ret;
     int task_priority;
-    struct thread_callback* tcb = malloc(sizeof(struct thread_callback));
-
-    if (tcb == NULL)
-    {
-        return OSAL_ERROR;
-    }
-
-    tcb->func = func;
-    tcb->arg = arg;
+    struct thread_callback* tcb = NULL;
 
     /* Use default stack size if not specified (ESP-IDF default is typically 2048) */
     if (stack_size == 0)
@@ -396,6 +659,46 @@ static int espidf_thread_create(void** handle, const char *name,void* (*func)(vo
         task_priority = configMAX_PRIORITIES - 1;
     }
 
+#ifdef CONFIG_USBIP_OSAL_STATIC
+    struct espidf_thread_slot* slot = NULL;
+
+    if (stack_size <= sizeof(slot->stack))
+    {
+        slot = espidf_thread_slot_alloc();
+    }
+
+    if (slot)
+    {
+        slot->callback.func = func;
+        slot->callback.arg = arg;
+
+        /* The whole slot stack is handed over, it is at least stack_size */
+        task_handle = xTaskCreateStatic((TaskFunction_t)freertos_thread_entry, name,
+                                        sizeof(slot->stack) / sizeof(StackType_t), &slot->callback, task_priority,
+                                        slot->stack, &slot->tcb);
+
+        if (task_handle == NULL)
+        {
+            espidf_pool_free(s_thread_used, ESPIDF_POOL_INDEX(s_thread_pool, slot));
+            return OSAL_ERROR;
+        }
+
+        *handle = (void*)task_handle;
+
+        return OSAL_OK;
+    }
+#endif
+
+    tcb = malloc(sizeof(struct thread_callback));
+
+    if (tcb == NULL)
+    {
+        return OSAL_ERROR;
+    }
+
+    tcb->func = func;
+    tcb->arg = arg;
+
     /* Note: xTaskCreate internal allocates TCB and stack automatically.
      * We cast func to TaskFunction_t - the return value is ignored by FreeRTOS */
     ret = xTaskCreate((TaskFunction_t)freertos_thread_entry, name, stack_size / sizeof(StackType_t), tcb,
@@ -416,6 +719,20 @@ static int espidf_thread_join(void* handle)
 {
     TaskHandle_t task = (TaskHandle_t)handle;
 
+    espidf_thread_idle();
+
+#ifdef CONFIG_USBIP_OSAL_STATIC
+    int index = ESPIDF_POOL_INDEX(s_thread_pool, task);
+
+    if (index >= 0)
+    {
+        espidf_thread_reap(&s_thread_pool[index]);
+        espidf_pool_free(s_thread_used, index);
+
+        return OSAL_OK;
+    }
+#endif
+
     /* FreeRTOS doesn't have a direct join equivalent.
      * We need to poll for task existence or use a notification mechanism.
      * For simplicity, we use eTaskGetState to check if task still exists */
@@ -435,6 +752,18 @@ static int espidf_thread_is_self(void* handle)
 
 static int espidf_thread_detach(void* handle)
 {
+#ifdef CONFIG_USBIP_OSAL_STATIC
+    int index = ESPIDF_POOL_INDEX(s_thread_pool, handle);
+
+    /* The slot is reclaimed by a later create once the thread has returned */
+    if (index >= 0)
+    {
+        s_thread_pool[index].detached = 1;
+
+        return OSAL_OK;
+    }
+#endif
+
     /* In FreeRTOS, tasks are automatically cleaned up when they exit
      * if they were created with xTaskCreate. Nothing special to do here. */
     (void)handle;
@@ -453,6 +782,7 @@ static uint32_t espidf_get_time_ms(void)
 
 static void espidf_sleep_ms(uint32_t ms)
 {
+    espidf_thread_idle();
     vTaskDelay(pdMS_TO_TICKS(ms));
 }
 
@@ -6,12 +6,22 @@
  * Change Logs:
  * Date           Author       Notes
  * 2026-3-27     hongquan.li   add ESP-IDF transport implementation
+ * 2026-10-19    hongquan.li   add per-connection receive buffer
+ * 2026-10-19    hongquan.li   release the debug port when the last client leaves
+ * 2026-10-19    hongquan.li   bind each connection's tasks to its own DAP session
+ * 2026-10-19    hongquan.li   send the replies of a URB batch together
  */
 
 /*****************************************************************************
  * ESP-IDF Transport Implementation
  *
  * TCP-based transport layer implementation for ESP-IDF using lwIP
+ *
+ * Replies from the URB processor are staged in a per-connection buffer
+ * while it keeps finding URBs in its queue. The OSAL calls
+ * espidf_transport_flush() before the processor waits for the next URB,
+ * and the staged replies go out with one send. A reply that does not fit
+ * goes out together with the staged ones in one sendmsg().
  *****************************************************************************/
 
 #include <errno.h>
@@ -20,8 +30,35 @@
 #include "lwip/netdb.h"
 #include "lwip/sockets.h"
 
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
 #include "hal/usbip_osal.h"
 #include "hal/usbip_transport.h"
+#include "espidf_glue.h"
+#include "sdkconfig.h"
+
+#ifndef CONFIG_USBIP_RX_BUFFER_SIZE
+#define CONFIG_USBIP_RX_BUFFER_SIZE 0
+#endif
+
+#ifndef CONFIG_USBIP_TX_BUFFER_SIZE
+#define CONFIG_USBIP_TX_BUFFER_SIZE 0
+#endif
+
+#ifndef CONFIG_USBIP_MAX_CONNECTIONS
+#define CONFIG_USBIP_MAX_CONNECTIONS 2
+#endif
+
+/* Per-connection receive buffer, 0 reads straight from the socket */
+#define ESPIDF_TRANSPORT_RX_BUF_SIZE CONFIG_USBIP_RX_BUFFER_SIZE
+
+/* Per-connection buffer for staged replies, 0 sends every reply right away */
+#define ESPIDF_TRANSPORT_TX_BUF_SIZE CONFIG_USBIP_TX_BUFFER_SIZE
+
+/* Connections espidf_transport_flush() looks at, one more is accepted before the core turns it away */
+#define ESPIDF_TRANSPORT_CONNS (CONFIG_USBIP_MAX_CONNECTIONS + 1)
 
 /*****************************************************************************
  * ESP-IDF Transport Private Data
@@ -35,11 +72,28 @@ struct tcp_transport_priv
 
 struct tcp_conn_priv
 {
-    int fd; /* Connection socket */
+    int fd;           /* Connection socket */
+    uint32_t session; /* DAP session of the connection */
+    size_t rx_head;   /* Offset of the first unread byte in rx_buf */
+    size_t rx_tail;   /* End of the valid data in rx_buf */
+#if ESPIDF_TRANSPORT_RX_BUF_SIZE > 0
+    uint8_t rx_buf[ESPIDF_TRANSPORT_RX_BUF_SIZE]; /* Data received but not yet consumed */
+#endif
+#if ESPIDF_TRANSPORT_TX_BUF_SIZE > 0
+    SemaphoreHandle_t tx_lock; /* Keeps staged and direct sends in order, NULL stages nothing */
+    TaskHandle_t tx_task;      /* Task whose replies are staged */
+    size_t tx_len;             /* Staged bytes in tx_buf */
+    uint8_t tx_buf[ESPIDF_TRANSPORT_TX_BUF_SIZE]; /* Replies not sent yet */
+#endif
 };
 
 void transport_register(const char* name, struct usbip_transport* trans);
 
+#if ESPIDF_TRANSPORT_TX_BUF_SIZE > 0
+static portMUX_TYPE s_conn_lock = portMUX_INITIALIZER_UNLOCKED;
+static struct tcp_conn_priv* s_conns[ESPIDF_TRANSPORT_CONNS];
+#endif
+
 /*****************************************************************************
  * ESP-IDF Transport Implementation
  *****************************************************************************/
@@ -94,6 +148,53 @@ static int tcp_listen(struct usbip_transport* trans, uint16_t port)
     return 0;
 }
 
+#if ESPIDF_TRANSPORT_TX_BUF_SIZE > 0
+
+static void tcp_conn_add(struct tcp_conn_priv* priv)
+{
+    priv->tx_lock = xSemaphoreCreateMutex();
+
+    if (!priv->tx_lock)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL(&s_conn_lock);
+
+    for (int i = 0; i < ESPIDF_TRANSPORT_CONNS; i++)
+    {
+        if (!s_conns[i])
+        {
+            s_conns[i] = priv;
+            break;
+        }
+    }
+
+    taskEXIT_CRITICAL(&s_conn_lock);
+}
+
+static void tcp_conn_remove(struct tcp_conn_priv* priv)
+{
+    taskENTER_CRITICAL(&s_conn_lock);
+
+    for (int i = 0; i < ESPIDF_TRANSPORT_CONNS; i++)
+    {
+        if (s_conns[i] == priv)
+        {
+            s_conns[i] = NULL;
+        }
+    }
+
+    taskEXIT_CRITICAL(&s_conn_lock);
+
+    if (priv->tx_lock)
+    {
+        vSemaphoreDelete(priv->tx_lock);
+    }
+}
+
+#endif
+
 static struct usbip_conn_ctx* tcp_accept(struct usbip_transport* trans)
 {
     struct tcp_transport_priv* priv = trans->priv;
@@ -138,14 +239,17 @@ static struct usbip_conn_ctx* tcp_accept(struct usbip_transport* trans)
 
     memset(conn_priv, 0, sizeof(*conn_priv));
     conn_priv->fd = fd;
+    conn_priv->session = usbip_dap_conn_open();
     ctx->priv = conn_priv;
+#if ESPIDF_TRANSPORT_TX_BUF_SIZE > 0
+    tcp_conn_add(conn_priv);
+#endif
 
     return ctx;
 }
 
-static ssize_t tcp_recv(struct usbip_conn_ctx* ctx, void* buf, size_t len)
+static ssize_t tcp_recv_direct(struct tcp_conn_priv* priv, void* buf, size_t len)
 {
-    struct tcp_conn_priv* priv = ctx->priv;
     size_t total = 0;
     ssize_t n;
 
@@ -176,9 +280,91 @@ static ssize_t tcp_recv(struct usbip_conn_ctx* ctx, void* buf, size_t len)
     return total;
 }
 
-static ssize_t tcp_send(struct usbip_conn_ctx* ctx, const void* buf, size_t len)
+#if ESPIDF_TRANSPORT_RX_BUF_SIZE > 0
+
+static ssize_t tcp_recv(struct usbip_conn_ctx* ctx, void* buf, size_t len)
 {
     struct tcp_conn_priv* priv = ctx->priv;
+    size_t total = 0;
+    size_t avail;
+    ssize_t n;
+
+    usbip_dap_conn_bind(priv->session);
+
+    while (total < len)
+    {
+        avail = priv->rx_tail - priv->rx_head;
+
+        if (avail > 0)
+        {
+            /* Serve from the buffer first */
+            if (avail > len - total)
+            {
+                avail = len - total;
+            }
+
+            memcpy((char*)buf + total, &priv->rx_buf[priv->rx_head], avail);
+            priv->rx_head += avail;
+            total += avail;
+            continue;
+        }
+
+        priv->rx_head = priv->rx_tail = 0;
+
+        /* Large payloads go straight to the caller, no point copying them twice */
+        if (len - total >= sizeof(priv->rx_buf))
+        {
+            n = tcp_recv_direct(priv, (char*)buf + total, len - total);
+
+            if (n <= 0)
+            {
+                return n;
+            }
+
+            total += n;
+            continue;
+        }
+
+        /* Take whatever the host has pipelined, up to the buffer size */
+        n = recv(priv->fd, priv->rx_buf, sizeof(priv->rx_buf), 0);
+
+        if (n <= 0)
+        {
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+
+            if (n == 0)
+            {
+                /* Connection closed */
+                return 0;
+            }
+
+            return -1;
+        }
+
+        priv->rx_tail = n;
+    }
+
+    return total;
+}
+
+#else
+
+static ssize_t tcp_recv(struct usbip_conn_ctx* ctx, void* buf, size_t len)
+{
+    struct tcp_conn_priv* priv = ctx->priv;
+
+    usbip_dap_conn_bind(priv->session);
+
+    return tcp_recv_direct(priv, buf, len);
+}
+
+#endif
+
+static ssize_t tcp_send_direct(struct tcp_conn_priv* priv, const void* buf, size_t len)
+{
     size_t total = 0;
     ssize_t n;
 
@@ -202,6 +388,161 @@ static ssize_t tcp_send(struct usbip_conn_ctx* ctx, const void* buf, size_t len)
     return total;
 }
 
+#if ESPIDF_TRANSPORT_TX_BUF_SIZE > 0
+
+static ssize_t tcp_sendv(struct tcp_conn_priv* priv, struct iovec* iov, int iovcnt)
+{
+    struct msghdr msg;
+    size_t total = 0;
+    size_t len = 0;
+    ssize_t n;
+    int first = 0;
+
+    for (int i = 0; i < iovcnt; i++)
+    {
+        len += iov[i].iov_len;
+    }
+
+    while (total < len)
+    {
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov[first];
+        msg.msg_iovlen = iovcnt - first;
+
+        n = sendmsg(priv->fd, &msg, 0);
+
+        if (n <= 0)
+        {
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+
+            return -1;
+        }
+
+        total += n;
+
+        /* Skip the fully sent entries and trim the partially sent one */
+        while (first < iovcnt && (size_t)n >= iov[first].iov_len)
+        {
+            n -= iov[first].iov_len;
+            first++;
+        }
+
+        if (first < iovcnt)
+        {
+            iov[first].iov_base = (char*)iov[first].iov_base + n;
+            iov[first].iov_len -= n;
+        }
+    }
+
+    return total;
+}
+
+/* Called with tx_lock held, a failed send shows up on the next recv as a closed connection */
+static void tcp_tx_flush(struct tcp_conn_priv* priv)
+{
+    if (priv->tx_len > 0)
+    {
+        tcp_send_direct(priv, priv->tx_buf, priv->tx_len);
+    }
+
+    priv->tx_len = 0;
+    priv->tx_task = NULL;
+}
+
+static ssize_t tcp_send(struct usbip_conn_ctx* ctx, const void* buf, size_t len)
+{
+    struct tcp_conn_priv* priv = ctx->priv;
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    struct iovec iov[2];
+    ssize_t ret = len;
+
+    /* The URB processor that runs this connection's DAP commands sends their replies */
+    usbip_dap_conn_bind(priv->session);
+
+    if (!priv->tx_lock)
+    {
+        return tcp_send_direct(priv, buf, len);
+    }
+
+    xSemaphoreTake(priv->tx_lock, portMAX_DELAY);
+
+    /* Another task's staged replies go first, the stream keeps the order of the sends */
+    if (priv->tx_task != self)
+    {
+        tcp_tx_flush(priv);
+    }
+
+    /* Only the URB processor stages, it flushes before it waits for the next URB */
+    if (usbip_dap_task_executes() && (priv->tx_len + len <= sizeof(priv->tx_buf)))
+    {
+        memcpy(&priv->tx_buf[priv->tx_len], buf, len);
+        priv->tx_len += len;
+        priv->tx_task = self;
+    }
+    else
+    {
+        iov[0].iov_base = priv->tx_buf;
+        iov[0].iov_len = priv->tx_len;
+        iov[1].iov_base = (void*)buf;
+        iov[1].iov_len = len;
+
+        /* The staged replies and this one in one call */
+        if (tcp_sendv(priv, &iov[priv->tx_len ? 0 : 1], priv->tx_len ? 2 : 1) < 0)
+        {
+            ret = -1;
+        }
+
+        priv->tx_len = 0;
+        priv->tx_task = NULL;
+    }
+
+    xSemaphoreGive(priv->tx_lock);
+
+    return ret;
+}
+
+void espidf_transport_flush(void)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    struct tcp_conn_priv* priv;
+
+    for (int i = 0; i < ESPIDF_TRANSPORT_CONNS; i++)
+    {
+        taskENTER_CRITICAL(&s_conn_lock);
+        priv = (s_conns[i] && (s_conns[i]->tx_task == self)) ? s_conns[i] : NULL;
+        taskEXIT_CRITICAL(&s_conn_lock);
+
+        /* Only this task stages for the connection, close waits for the core's threads to end */
+        if (priv)
+        {
+            xSemaphoreTake(priv->tx_lock, portMAX_DELAY);
+            tcp_tx_flush(priv);
+            xSemaphoreGive(priv->tx_lock);
+        }
+    }
+}
+
+#else
+
+static ssize_t tcp_send(struct usbip_conn_ctx* ctx, const void* buf, size_t len)
+{
+    struct tcp_conn_priv* priv = ctx->priv;
+
+    /* The URB processor that runs this connection's DAP commands sends their replies */
+    usbip_dap_conn_bind(priv->session);
+
+    return tcp_send_direct(priv, buf, len);
+}
+
+void espidf_transport_flush(void)
+{
+}
+
+#endif
+
 static void tcp_close(struct usbip_conn_ctx* ctx)
 {
     struct tcp_conn_priv* priv = NULL;
@@ -212,11 +553,16 @@ static void tcp_close(struct usbip_conn_ctx* ctx)
 
         if (priv)
         {
+#if ESPIDF_TRANSPORT_TX_BUF_SIZE > 0
+            tcp_conn_remove(priv);
+#endif
+
             if (priv->fd >= 0)
             {
                 close(priv->fd);
             }
 
+            usbip_dap_conn_close(priv->session);
             osal_free(priv);
         }
 
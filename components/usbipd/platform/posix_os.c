@@ -0,0 +1,391 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add POSIX OSAL implementation for host builds
+ * 2026-10-19    hongquan.li   register from a constructor on Linux
+ */
+
+/*
+ * OSAL POSIX Implementation
+ *
+ * OS Abstraction Layer implementation for Linux (pthreads), used to run the
+ * usbipd server core on a development host without ESP32 hardware
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hal/usbip_osal.h"
+
+/*****************************************************************************
+ * POSIX Memory Operations
+ *****************************************************************************/
+
+static void* posix_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void posix_free(void* ptr)
+{
+    free(ptr);
+}
+
+/*****************************************************************************
+ * POSIX Mutex Implementation
+ *****************************************************************************/
+
+static int posix_mutex_init(void** handle)
+{
+    pthread_mutex_t* mutex = malloc(sizeof(pthread_mutex_t));
+
+    if (mutex == NULL)
+    {
+        return OSAL_ERROR;
+    }
+
+    if (pthread_mutex_init(mutex, NULL) != 0)
+    {
+        free(mutex);
+
+        return OSAL_ERROR;
+    }
+
+    *handle = (void*)mutex;
+
+    return OSAL_OK;
+}
+
+static int posix_mutex_lock(void* handle)
+{
+    return (pthread_mutex_lock((pthread_mutex_t*)handle) == 0) ? OSAL_OK : OSAL_ERROR;
+}
+
+static int posix_mutex_unlock(void* handle)
+{
+    return (pthread_mutex_unlock((pthread_mutex_t*)handle) == 0) ? OSAL_OK : OSAL_ERROR;
+}
+
+static void posix_mutex_destroy(void* handle)
+{
+    if (handle != NULL)
+    {
+        pthread_mutex_destroy((pthread_mutex_t*)handle);
+        free(handle);
+    }
+}
+
+/*****************************************************************************
+ * POSIX Condition Variable Implementation
+ *****************************************************************************/
+
+static int posix_cond_init(void** handle)
+{
+    pthread_cond_t* cond = malloc(sizeof(pthread_cond_t));
+    pthread_condattr_t attr;
+
+    if (cond == NULL)
+    {
+        return OSAL_ERROR;
+    }
+
+    /* Timed waits use CLOCK_MONOTONIC so wall clock changes do not affect them */
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+
+    if (pthread_cond_init(cond, &attr) != 0)
+    {
+        pthread_condattr_destroy(&attr);
+        free(cond);
+
+        return OSAL_ERROR;
+    }
+
+    pthread_condattr_destroy(&attr);
+    *handle = (void*)cond;
+
+    return OSAL_OK;
+}
+
+static int posix_cond_wait(void* cond_handle, void* mutex_handle)
+{
+    if (pthread_cond_wait((pthread_cond_t*)cond_handle, (pthread_mutex_t*)mutex_handle) == 0)
+    {
+        return OSAL_OK;
+    }
+
+    return OSAL_ERROR;
+}
+
+static int posix_cond_timedwait(void* cond_handle, void* mutex_handle, uint32_t timeout_ms)
+{
+    struct timespec ts;
+    int ret;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec += timeout_ms / 1000;
+    ts.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+
+    if (ts.tv_nsec >= 1000000000L)
+    {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+
+    ret = pthread_cond_timedwait((pthread_cond_t*)cond_handle, (pthread_mutex_t*)mutex_handle, &ts);
+
+    if (ret == 0)
+    {
+        return OSAL_OK;
+    }
+
+    return (ret == ETIMEDOUT) ? OSAL_TIMEOUT : OSAL_ERROR;
+}
+
+static int posix_cond_signal(void* cond_handle)
+{
+    return (pthread_cond_signal((pthread_cond_t*)cond_handle) == 0) ? OSAL_OK : OSAL_ERROR;
+}
+
+static int posix_cond_broadcast(void* cond_handle)
+{
+    return (pthread_cond_broadcast((pthread_cond_t*)cond_handle) == 0) ? OSAL_OK : OSAL_ERROR;
+}
+
+static void posix_cond_destroy(void* handle)
+{
+    if (handle != NULL)
+    {
+        pthread_cond_destroy((pthread_cond_t*)handle);
+        free(handle);
+    }
+}
+
+/*****************************************************************************
+ * POSIX Semaphore Implementation
+ *****************************************************************************/
+
+static int posix_sem_init(void** handle)
+{
+    sem_t* sem = malloc(sizeof(sem_t));
+
+    if (sem == NULL)
+    {
+        return OSAL_ERROR;
+    }
+
+    if (sem_init(sem, 0, 0) != 0)
+    {
+        free(sem);
+
+        return OSAL_ERROR;
+    }
+
+    *handle = (void*)sem;
+
+    return OSAL_OK;
+}
+
+static int posix_sem_wait(void* handle)
+{
+    while (sem_wait((sem_t*)handle) != 0)
+    {
+        if (errno != EINTR)
+        {
+            return OSAL_ERROR;
+        }
+    }
+
+    return OSAL_OK;
+}
+
+static int posix_sem_trywait(void* handle)
+{
+    return (sem_trywait((sem_t*)handle) == 0) ? OSAL_OK : OSAL_TIMEOUT;
+}
+
+static int posix_sem_post(void* handle)
+{
+    return (sem_post((sem_t*)handle) == 0) ? OSAL_OK : OSAL_ERROR;
+}
+
+static void posix_sem_destroy(void* handle)
+{
+    if (handle != NULL)
+    {
+        sem_destroy((sem_t*)handle);
+        free(handle);
+    }
+}
+
+/*****************************************************************************
+ * POSIX Thread Implementation
+ *****************************************************************************/
+
+static int posix_thread_create(void** handle, const char* name, void* (*func)(void*), void* arg, size_t stack_size,
+                               int priority)
+{
+    pthread_t* thread = malloc(sizeof(pthread_t));
+    pthread_attr_t attr;
+
+    /* Priorities only matter on the target, host threads all run SCHED_OTHER */
+    (void)priority;
+
+    if (thread == NULL)
+    {
+        return OSAL_ERROR;
+    }
+
+    pthread_attr_init(&attr);
+
+    /* Stack sizes are tuned for FreeRTOS, never go below the host minimum */
+    if (stack_size > 0)
+    {
+        if (stack_size < 65536)
+        {
+            stack_size = 65536;
+        }
+
+        pthread_attr_setstacksize(&attr, stack_size);
+    }
+
+    if (pthread_create(thread, &attr, func, arg) != 0)
+    {
+        pthread_attr_destroy(&attr);
+        free(thread);
+
+        return OSAL_ERROR;
+    }
+
+    pthread_attr_destroy(&attr);
+
+#ifdef __linux__
+    if (name)
+    {
+        char short_name[16];
+
+        strncpy(short_name, name, sizeof(short_name) - 1);
+        short_name[sizeof(short_name) - 1] = '\0';
+        pthread_setname_np(*thread, short_name);
+    }
+#else
+    (void)name;
+#endif
+
+    *handle = (void*)thread;
+
+    return OSAL_OK;
+}
+
+static int posix_thread_join(void* handle)
+{
+    pthread_t* thread = (pthread_t*)handle;
+    int ret = pthread_join(*thread, NULL);
+
+    free(thread);
+
+    return (ret == 0) ? OSAL_OK : OSAL_ERROR;
+}
+
+static int posix_thread_is_self(void* handle)
+{
+    pthread_t* thread = (pthread_t*)handle;
+
+    return pthread_equal(*thread, pthread_self()) ? 1 : 0;
+}
+
+static int posix_thread_detach(void* handle)
+{
+    pthread_t* thread = (pthread_t*)handle;
+    int ret = pthread_detach(*thread);
+
+    free(thread);
+
+    return (ret == 0) ? OSAL_OK : OSAL_ERROR;
+}
+
+/*****************************************************************************
+ * POSIX Time Implementation
+ *****************************************************************************/
+
+static uint32_t posix_get_time_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL);
+}
+
+static void posix_sleep_ms(uint32_t ms)
+{
+    struct timespec ts;
+
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (long)(ms % 1000) * 1000000L;
+
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR)
+    {
+    }
+}
+
+/*****************************************************************************
+ * POSIX Operations Interface
+ *****************************************************************************/
+
+static osal_ops_t posix_ops = {
+    /* Mutex */
+    .mutex_init = posix_mutex_init,
+    .mutex_lock = posix_mutex_lock,
+    .mutex_unlock = posix_mutex_unlock,
+    .mutex_destroy = posix_mutex_destroy,
+
+    /* Condition variable */
+    .cond_init = posix_cond_init,
+    .cond_wait = posix_cond_wait,
+    .cond_timedwait = posix_cond_timedwait,
+    .cond_signal = posix_cond_signal,
+    .cond_broadcast = posix_cond_broadcast,
+    .cond_destroy = posix_cond_destroy,
+
+    /* Semaphore */
+    .sem_init = posix_sem_init,
+    .sem_wait = posix_sem_wait,
+    .sem_trywait = posix_sem_trywait,
+    .sem_post = posix_sem_post,
+    .sem_destroy = posix_sem_destroy,
+
+    /* Thread */
+    .thread_create = posix_thread_create,
+    .thread_join = posix_thread_join,
+    .thread_is_self = posix_thread_is_self,
+    .thread_detach = posix_thread_detach,
+
+    /* Time */
+    .get_time_ms = posix_get_time_ms,
+    .sleep_ms = posix_sleep_ms,
+
+    /* Memory */
+    .malloc = posix_malloc,
+    .free = posix_free,
+
+    /* Platform name */
+    .name = "posix",
+};
+
+/**
+ * Auto-register POSIX implementation, the ESP-IDF .usbip.init section has
+ * no counterpart in a Linux link so this runs as a constructor before main()
+ */
+__attribute__((constructor, used)) void default_os_register(void)
+{
+    osal_register("posix", &posix_ops);
+}
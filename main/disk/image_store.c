@@ -0,0 +1,607 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add content-addressed image store
+ * 2026-10-19    hongquan.li   map images into the address space
+ * 2026-10-19    hongquan.li   delete images and reuse their space
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "image_store.h"
+
+#define IMAGE_STORE_MAGIC 0x31474D49        /* "IMG1" */
+#define IMAGE_STORE_SECTOR_SIZE 4096
+#define IMAGE_STORE_HEADER_SIZE 128
+
+/* Records only ever clear bits: erased -> valid -> deleted */
+#define IMAGE_STORE_STATE_WRITING 0xFFFFFFFF
+#define IMAGE_STORE_STATE_VALID 0x0000FFFF
+#define IMAGE_STORE_STATE_DELETED 0x00000000
+
+typedef struct
+{
+    uint32_t magic;                         ///< IMAGE_STORE_MAGIC
+    uint32_t state;                         ///< Record state
+    uint32_t size;                          ///< Image size
+    uint32_t reserved;                      ///< Reserved, 0xFFFFFFFF
+    uint8_t sha256[IMAGE_STORE_HASH_SIZE];  ///< Image hash, written on commit
+    char name[IMAGE_STORE_NAME_SIZE];       ///< File name
+    uint8_t pad[IMAGE_STORE_HEADER_SIZE - 16 - IMAGE_STORE_HASH_SIZE - IMAGE_STORE_NAME_SIZE];
+} image_store_header_t;
+
+_Static_assert(sizeof(image_store_header_t) == IMAGE_STORE_HEADER_SIZE, "Incorrect header size");
+
+static const char *TAG = "image_store";
+static const esp_partition_t *s_part = NULL;
+static SemaphoreHandle_t s_mutex = NULL;
+static image_store_entry_t s_entries[CONFIG_IMAGE_STORE_MAX_IMAGES];
+static int s_entry_num = 0;
+static bool s_writing = false;
+
+static uint32_t image_store_record_end(uint32_t record, uint32_t size)
+{
+    uint32_t end = record + IMAGE_STORE_HEADER_SIZE + size;
+
+    return (end + IMAGE_STORE_SECTOR_SIZE - 1) & ~(IMAGE_STORE_SECTOR_SIZE - 1);
+}
+
+/* A header the scan can step over, the size is all it needs */
+static bool image_store_header_valid(uint32_t record, const image_store_header_t *hdr)
+{
+    return (hdr->magic == IMAGE_STORE_MAGIC) &&
+           ((hdr->state == IMAGE_STORE_STATE_WRITING) || (hdr->state == IMAGE_STORE_STATE_VALID) || (hdr->state == IMAGE_STORE_STATE_DELETED)) &&
+           (hdr->size <= s_part->size - record - IMAGE_STORE_HEADER_SIZE);
+}
+
+static void image_store_index_add(uint32_t record, const image_store_header_t *hdr)
+{
+    image_store_entry_t *entry = NULL;
+
+    if (s_entry_num >= CONFIG_IMAGE_STORE_MAX_IMAGES)
+    {
+        ESP_LOGW(TAG, "Index full, image at 0x%lx ignored", (unsigned long)record);
+        return;
+    }
+
+    entry = &s_entries[s_entry_num++];
+    entry->record = record;
+    entry->offset = record + IMAGE_STORE_HEADER_SIZE;
+    entry->size = hdr->size;
+    memcpy(entry->sha256, hdr->sha256, IMAGE_STORE_HASH_SIZE);
+    memcpy(entry->name, hdr->name, IMAGE_STORE_NAME_SIZE);
+    entry->name[IMAGE_STORE_NAME_SIZE - 1] = '\0';
+}
+
+static bool image_store_str_to_hash(const char *str, uint8_t *sha256)
+{
+    unsigned int byte = 0;
+
+    if (!str || (strlen(str) != IMAGE_STORE_HASH_STR_SIZE - 1))
+    {
+        return false;
+    }
+
+    for (int i = 0; i < IMAGE_STORE_HASH_SIZE; i++)
+    {
+        if (sscanf(&str[i * 2], "%2x", &byte) != 1)
+        {
+            return false;
+        }
+
+        sha256[i] = (uint8_t)byte;
+    }
+
+    return true;
+}
+
+/* Caller holds s_mutex */
+static image_store_entry_t *image_store_lookup(const uint8_t *sha256)
+{
+    for (int i = 0; i < s_entry_num; i++)
+    {
+        if (!memcmp(s_entries[i].sha256, sha256, IMAGE_STORE_HASH_SIZE))
+        {
+            return &s_entries[i];
+        }
+    }
+
+    return NULL;
+}
+
+/* Caller holds s_mutex */
+static image_store_entry_t *image_store_lookup_record(uint32_t record)
+{
+    for (int i = 0; i < s_entry_num; i++)
+    {
+        if (s_entries[i].record == record)
+        {
+            return &s_entries[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Caller holds s_mutex. First hole between live images the record fits in,
+ * deleted and abandoned records are free space.
+ */
+static bool image_store_alloc(uint32_t size, uint32_t *record, uint32_t *hole_end)
+{
+    uint32_t start = 0;
+    uint32_t end = 0;
+    image_store_entry_t *next = NULL;
+
+    if (size > s_part->size - IMAGE_STORE_HEADER_SIZE)
+    {
+        return false;
+    }
+
+    while (start < s_part->size)
+    {
+        end = s_part->size;
+
+        for (int i = 0; i < s_entry_num; i++)
+        {
+            if ((s_entries[i].record >= start) && (s_entries[i].record < end))
+            {
+                end = s_entries[i].record;
+            }
+        }
+
+        if (image_store_record_end(start, size) <= end)
+        {
+            *record = start;
+            *hole_end = end;
+            return true;
+        }
+
+        next = image_store_lookup_record(end);
+        if (!next)
+        {
+            break;
+        }
+
+        start = image_store_record_end(next->record, next->size);
+    }
+
+    return false;
+}
+
+/* Caller holds s_mutex. Mark the record deleted on flash and drop it from the index */
+static void image_store_delete(image_store_entry_t *entry)
+{
+    uint32_t state = IMAGE_STORE_STATE_DELETED;
+
+    esp_partition_write(s_part, entry->record + offsetof(image_store_header_t, state), &state, sizeof(state));
+    *entry = s_entries[--s_entry_num];
+}
+
+/* Sectors of a reused hole may hold old data, erase each one before use */
+static esp_err_t image_store_erase_to(image_store_writer_t *writer, uint32_t end)
+{
+    esp_err_t ret = ESP_OK;
+
+    while ((ret == ESP_OK) && (writer->erased < end))
+    {
+        ret = esp_partition_erase_range(s_part, writer->erased, IMAGE_STORE_SECTOR_SIZE);
+        writer->erased += IMAGE_STORE_SECTOR_SIZE;
+    }
+
+    return ret;
+}
+
+bool image_store_init(void)
+{
+    image_store_header_t hdr;
+    uint32_t offset = 0;
+    uint32_t used = 0;
+
+    if (s_part)
+    {
+        return true;
+    }
+
+    s_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, CONFIG_IMAGE_STORE_PARTITION);
+    if (!s_part)
+    {
+        ESP_LOGW(TAG, "No %s partition, image store disabled", CONFIG_IMAGE_STORE_PARTITION);
+        return false;
+    }
+
+    s_mutex = xSemaphoreCreateMutex();
+    if (!s_mutex)
+    {
+        s_part = NULL;
+        return false;
+    }
+
+    while (offset + IMAGE_STORE_HEADER_SIZE <= s_part->size)
+    {
+        if (esp_partition_read(s_part, offset, &hdr, sizeof(hdr)) != ESP_OK)
+        {
+            break;
+        }
+
+        /*
+         * Every hole ends in a record header, an erased or garbled header
+         * means a power cut while a hole was reused: resync on the next sector
+         */
+        if (!image_store_header_valid(offset, &hdr))
+        {
+            offset += IMAGE_STORE_SECTOR_SIZE;
+            continue;
+        }
+
+        if (hdr.state == IMAGE_STORE_STATE_VALID)
+        {
+            image_store_index_add(offset, &hdr);
+            used += image_store_record_end(offset, hdr.size) - offset;
+        }
+
+        offset = image_store_record_end(offset, hdr.size);
+    }
+
+    ESP_LOGI(TAG, "%d images, %lu of %lu bytes used", s_entry_num, (unsigned long)used, (unsigned long)s_part->size);
+
+    return true;
+}
+
+const esp_partition_t *image_store_partition(void)
+{
+    return s_part;
+}
+
+esp_err_t image_store_begin(image_store_writer_t *writer, const char *name, uint32_t size)
+{
+    image_store_header_t hdr;
+    uint32_t record = 0;
+    uint32_t hole_end = 0;
+    uint32_t end = 0;
+    esp_err_t ret = ESP_OK;
+
+    if (!s_part)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    if (s_writing)
+    {
+        ret = ESP_ERR_INVALID_STATE;
+        goto __exit;
+    }
+
+    if (s_entry_num >= CONFIG_IMAGE_STORE_MAX_IMAGES)
+    {
+        ret = ESP_ERR_NO_MEM;
+        goto __exit;
+    }
+
+    if (!image_store_alloc(size, &record, &hole_end))
+    {
+        ret = ESP_ERR_NO_MEM;
+        goto __exit;
+    }
+
+    writer->record = record;
+    writer->size = size;
+    writer->written = 0;
+    writer->erased = record;
+
+    /*
+     * The rest of a partly used hole becomes a deleted filler record. It is
+     * written before the new header so the boot scan can always walk on to
+     * the image behind the hole.
+     */
+    end = image_store_record_end(record, size);
+    if (end < hole_end)
+    {
+        memset(&hdr, 0xFF, sizeof(hdr));
+        hdr.magic = IMAGE_STORE_MAGIC;
+        hdr.state = IMAGE_STORE_STATE_DELETED;
+        hdr.size = hole_end - end - IMAGE_STORE_HEADER_SIZE;
+
+        ret = esp_partition_erase_range(s_part, end, IMAGE_STORE_SECTOR_SIZE);
+        if (ret == ESP_OK)
+        {
+            ret = esp_partition_write(s_part, end, &hdr, sizeof(hdr));
+        }
+
+        if (ret != ESP_OK)
+        {
+            goto __exit;
+        }
+    }
+
+    ret = image_store_erase_to(writer, record + IMAGE_STORE_HEADER_SIZE);
+    if (ret != ESP_OK)
+    {
+        goto __exit;
+    }
+
+    memset(&hdr, 0xFF, sizeof(hdr));
+    memset(hdr.name, 0, sizeof(hdr.name));
+    hdr.magic = IMAGE_STORE_MAGIC;
+    hdr.size = size;
+    strncpy(hdr.name, name, sizeof(hdr.name) - 1);
+
+    ret = esp_partition_write(s_part, writer->record, &hdr, sizeof(hdr));
+    if (ret != ESP_OK)
+    {
+        goto __exit;
+    }
+
+    mbedtls_sha256_init(&writer->sha);
+    mbedtls_sha256_starts(&writer->sha, 0);
+    s_writing = true;
+
+__exit:
+    xSemaphoreGive(s_mutex);
+
+    return ret;
+}
+
+esp_err_t image_store_write(image_store_writer_t *writer, const void *data, size_t len)
+{
+    esp_err_t ret = ESP_OK;
+    uint32_t addr = writer->record + IMAGE_STORE_HEADER_SIZE + writer->written;
+
+    if (writer->written + len > writer->size)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    ret = image_store_erase_to(writer, addr + len);
+    if (ret == ESP_OK)
+    {
+        ret = esp_partition_write(s_part, addr, data, len);
+    }
+
+    if (ret == ESP_OK)
+    {
+        mbedtls_sha256_update(&writer->sha, data, len);
+        writer->written += len;
+    }
+
+    return ret;
+}
+
+esp_err_t image_store_end(image_store_writer_t *writer, image_store_entry_t *entry)
+{
+    image_store_header_t hdr;
+    uint8_t sha256[IMAGE_STORE_HASH_SIZE];
+    uint32_t state = IMAGE_STORE_STATE_VALID;
+    image_store_entry_t *stored = NULL;
+    esp_err_t ret = ESP_OK;
+
+    if (writer->written != writer->size)
+    {
+        image_store_abort(writer);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    mbedtls_sha256_finish(&writer->sha, sha256);
+    mbedtls_sha256_free(&writer->sha);
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    /* Same content already stored, leave this record uncommitted, it stays a hole */
+    stored = image_store_lookup(sha256);
+    if (stored)
+    {
+        ESP_LOGI(TAG, "Same content as %s, not stored again", stored->name);
+        goto __exit;
+    }
+
+    ret = esp_partition_write(s_part, writer->record + offsetof(image_store_header_t, sha256), sha256, sizeof(sha256));
+    if (ret == ESP_OK)
+    {
+        ret = esp_partition_write(s_part, writer->record + offsetof(image_store_header_t, state), &state, sizeof(state));
+    }
+
+    if (ret != ESP_OK)
+    {
+        goto __exit;
+    }
+
+    /* Index it from the header as committed on flash, the same way the boot scan does */
+    ret = esp_partition_read(s_part, writer->record, &hdr, sizeof(hdr));
+    if (ret == ESP_OK)
+    {
+        image_store_index_add(writer->record, &hdr);
+        stored = &s_entries[s_entry_num - 1];
+    }
+
+__exit:
+    if (entry && stored)
+    {
+        *entry = *stored;
+    }
+
+    s_writing = false;
+    xSemaphoreGive(s_mutex);
+
+    return ret;
+}
+
+void image_store_abort(image_store_writer_t *writer)
+{
+    mbedtls_sha256_free(&writer->sha);
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_writing = false;
+    xSemaphoreGive(s_mutex);
+}
+
+bool image_store_find(const char *sha256, image_store_entry_t *entry)
+{
+    uint8_t hash[IMAGE_STORE_HASH_SIZE];
+    image_store_entry_t *stored = NULL;
+
+    if (!s_part || !image_store_str_to_hash(sha256, hash))
+    {
+        return false;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    stored = image_store_lookup(hash);
+    if (stored && entry)
+    {
+        *entry = *stored;
+    }
+
+    xSemaphoreGive(s_mutex);
+
+    return (stored != NULL);
+}
+
+bool image_store_find_name(const char *name, image_store_entry_t *entry)
+{
+    bool found = false;
+
+    if (!s_part)
+    {
+        return false;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    for (int i = 0; i < s_entry_num; i++)
+    {
+        if (!strcmp(s_entries[i].name, name))
+        {
+            if (entry)
+            {
+                *entry = s_entries[i];
+            }
+
+            found = true;
+            break;
+        }
+    }
+
+    xSemaphoreGive(s_mutex);
+
+    return found;
+}
+
+bool image_store_remove(const char *sha256)
+{
+    uint8_t hash[IMAGE_STORE_HASH_SIZE];
+    image_store_entry_t *stored = NULL;
+
+    if (!s_part || !image_store_str_to_hash(sha256, hash))
+    {
+        return false;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    stored = image_store_lookup(hash);
+    if (stored)
+    {
+        image_store_delete(stored);
+    }
+
+    xSemaphoreGive(s_mutex);
+
+    return (stored != NULL);
+}
+
+int image_store_remove_name(const char *name, const image_store_entry_t *keep)
+{
+    int removed = 0;
+    int i = 0;
+
+    if (!s_part)
+    {
+        return 0;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    while (i < s_entry_num)
+    {
+        if (strcmp(s_entries[i].name, name) || (keep && (s_entries[i].record == keep->record)))
+        {
+            i++;
+            continue;
+        }
+
+        image_store_delete(&s_entries[i]);
+        removed++;
+    }
+
+    xSemaphoreGive(s_mutex);
+
+    return removed;
+}
+
+esp_err_t image_store_read(const image_store_entry_t *entry, uint32_t offset, void *buf, size_t len)
+{
+    if (!s_part || (offset > entry->size) || (len > entry->size - offset))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    return esp_partition_read(s_part, entry->offset + offset, buf, len);
+}
+
+esp_err_t image_store_mmap(const image_store_entry_t *entry, uint32_t offset, size_t len, const void **ptr, esp_partition_mmap_handle_t *handle)
+{
+    if (!s_part || (offset > entry->size) || (len > entry->size - offset))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    return esp_partition_mmap(s_part, entry->offset + offset, len, ESP_PARTITION_MMAP_DATA, ptr, handle);
+}
+
+void image_store_munmap(esp_partition_mmap_handle_t handle)
+{
+    esp_partition_munmap(handle);
+}
+
+int image_store_list(void (*cb)(const image_store_entry_t *entry, void *arg), void *arg)
+{
+    int num = 0;
+
+    if (!s_part)
+    {
+        return 0;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    for (num = 0; num < s_entry_num; num++)
+    {
+        cb(&s_entries[num], arg);
+    }
+
+    xSemaphoreGive(s_mutex);
+
+    return num;
+}
+
+void image_store_hash_to_str(const uint8_t *sha256, char *str)
+{
+    for (int i = 0; i < IMAGE_STORE_HASH_SIZE; i++)
+    {
+        sprintf(&str[i * 2], "%02x", sha256[i]);
+    }
+
+    str[IMAGE_STORE_HASH_STR_SIZE - 1] = '\0';
+}
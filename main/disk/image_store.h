@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add content-addressed image store
+ * 2026-10-19    hongquan.li   map images into the address space
+ * 2026-10-19    hongquan.li   delete images and reuse their space
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_partition.h"
+#include "mbedtls/sha256.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file image_store.h
+ * @brief Content-addressed image store on a raw partition
+ *
+ * Images are appended to the partition named CONFIG_IMAGE_STORE_PARTITION,
+ * each one behind a small header holding its size, SHA-256 and file name,
+ * with every record starting on a flash sector. The index is rebuilt from
+ * the headers at boot, there is no FAT or wear levelling in between and an
+ * image is read straight from its partition offset. Deleted images leave
+ * holes that later uploads fill first fit.
+ */
+
+#define IMAGE_STORE_HASH_SIZE 32        ///< SHA-256 length
+#define IMAGE_STORE_HASH_STR_SIZE 65    ///< SHA-256 hex string length with terminator
+#define IMAGE_STORE_NAME_SIZE 48        ///< Stored file name length with terminator
+
+/**
+ * @brief Stored image
+ */
+typedef struct
+{
+    uint32_t record;                        ///< Header offset in the partition
+    uint32_t offset;                        ///< Image data offset in the partition
+    uint32_t size;                          ///< Image size
+    uint8_t sha256[IMAGE_STORE_HASH_SIZE];  ///< Image hash
+    char name[IMAGE_STORE_NAME_SIZE];       ///< File name given at upload
+} image_store_entry_t;
+
+/**
+ * @brief Image being written
+ */
+typedef struct
+{
+    uint32_t record;                        ///< Header offset of the new record
+    uint32_t size;                          ///< Expected image size
+    uint32_t written;                       ///< Bytes written so far
+    uint32_t erased;                        ///< End of the erased area
+    mbedtls_sha256_context sha;             ///< Running hash
+} image_store_writer_t;
+
+/**
+ * @brief Mount the image store and rebuild the index
+ * @return true on success, false if the partition is missing
+ */
+bool image_store_init(void);
+
+/**
+ * @brief Get the image store partition
+ * @return Partition, NULL if the store is not mounted
+ */
+const esp_partition_t *image_store_partition(void);
+
+/**
+ * @brief Start writing an image
+ *
+ * The image goes into the first hole left by deleted or abandoned records
+ * that is large enough, or after the last image.
+ *
+ * @param writer Writer state
+ * @param name File name, its extension selects the hex or bin programmer
+ * @param size Image size
+ * @return ESP_OK, ESP_ERR_NO_MEM if the image does not fit
+ */
+esp_err_t image_store_begin(image_store_writer_t *writer, const char *name, uint32_t size);
+
+/**
+ * @brief Append image data
+ * @param writer Writer state
+ * @param data Data
+ * @param len Data length
+ * @return ESP_OK on success
+ */
+esp_err_t image_store_write(image_store_writer_t *writer, const void *data, size_t len);
+
+/**
+ * @brief Finish an image
+ *
+ * An image whose hash is already stored is not committed, its space is
+ * reused by the next upload and the existing entry is returned instead.
+ *
+ * @param writer Writer state
+ * @param entry Output: the stored image
+ * @return ESP_OK on success, ESP_ERR_INVALID_SIZE if fewer bytes than announced were written
+ */
+esp_err_t image_store_end(image_store_writer_t *writer, image_store_entry_t *entry);
+
+/**
+ * @brief Abandon an image, its space is reused by the next upload
+ * @param writer Writer state
+ */
+void image_store_abort(image_store_writer_t *writer);
+
+/**
+ * @brief Find an image by hash
+ * @param sha256 Hash as a 64 character hex string
+ * @param entry Output: the stored image, may be NULL
+ * @return true if found
+ */
+bool image_store_find(const char *sha256, image_store_entry_t *entry);
+
+/**
+ * @brief Find the image stored under a file name
+ * @param name File name
+ * @param entry Output: the stored image, may be NULL
+ * @return true if found
+ */
+bool image_store_find_name(const char *name, image_store_entry_t *entry);
+
+/**
+ * @brief Delete an image, its space is reused by later uploads
+ * @param sha256 Hash as a 64 character hex string
+ * @return true if the image was stored
+ */
+bool image_store_remove(const char *sha256);
+
+/**
+ * @brief Delete every image with the given name, used once its replacement is committed
+ * @param name File name
+ * @param keep Image to keep under that name, may be NULL
+ * @return Number of images deleted
+ */
+int image_store_remove_name(const char *name, const image_store_entry_t *keep);
+
+/**
+ * @brief Read image data
+ * @param entry Stored image
+ * @param offset Offset in the image
+ * @param buf Output buffer
+ * @param len Length to read
+ * @return ESP_OK on success
+ */
+esp_err_t image_store_read(const image_store_entry_t *entry, uint32_t offset, void *buf, size_t len);
+
+/**
+ * @brief Map part of an image into the data address space
+ *
+ * The programmer reads a mapped image through the flash cache without
+ * copying it first. Map a bounded window at a time, the MMU pages are shared
+ * with the rest of the firmware.
+ *
+ * @param entry Stored image
+ * @param offset Offset in the image
+ * @param len Length to map
+ * @param ptr Output: mapped data
+ * @param handle Output: handle for image_store_munmap()
+ * @return ESP_OK on success
+ */
+esp_err_t image_store_mmap(const image_store_entry_t *entry, uint32_t offset, size_t len, const void **ptr, esp_partition_mmap_handle_t *handle);
+
+/**
+ * @brief Release a mapping made by image_store_mmap()
+ * @param handle Mapping handle
+ */
+void image_store_munmap(esp_partition_mmap_handle_t handle);
+
+/**
+ * @brief Iterate over the stored images
+ * @param cb Called for each image
+ * @param arg Callback argument
+ * @return Number of images
+ */
+int image_store_list(void (*cb)(const image_store_entry_t *entry, void *arg), void *arg);
+
+/**
+ * @brief Format a hash as a hex string
+ * @param sha256 Hash
+ * @param str Output, IMAGE_STORE_HASH_STR_SIZE bytes
+ */
+void image_store_hash_to_str(const uint8_t *sha256, char *str);
+
+#ifdef __cplusplus
+}
+#endif
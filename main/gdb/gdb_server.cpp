@@ -0,0 +1,1451 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add GDB remote serial protocol server
+ * 2026-10-19    hongquan.li   keep the FlashAccessor only while the port stays claimed
+ * 2026-10-19    hongquan.li   drop cached state and re-arm breakpoints after another session
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include "sdkconfig.h"
+#include "lwip/sockets.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "gdb/gdb_server.h"
+#include "programmer/programmer.h"
+#include "target_swd.h"
+#include "flash_accessor.h"
+#include "algo_extractor.h"
+#include "dap_arbiter.h"
+
+#define TAG "gdb_server"
+
+/* Cortex-M debug and system registers */
+#define GDB_DHCSR 0xE000EDF0
+#define GDB_DFSR 0xE000ED30
+#define GDB_DEMCR 0xE000EDFC
+#define GDB_AIRCR 0xE000ED0C
+#define GDB_FP_CTRL 0xE0002000
+#define GDB_FP_COMP0 0xE0002008
+
+#define GDB_DBGKEY 0xA05F0000
+#define GDB_C_DEBUGEN (1UL << 0)
+#define GDB_C_HALT (1UL << 1)
+#define GDB_C_STEP (1UL << 2)
+#define GDB_C_MASKINTS (1UL << 3)
+#define GDB_S_HALT (1UL << 17)
+#define GDB_DFSR_ALL 0x1F
+#define GDB_VC_CORERESET (1UL << 0)
+#define GDB_AIRCR_VECTKEY 0x05FA0000
+#define GDB_AIRCR_PRIGROUP 0x700
+#define GDB_AIRCR_SYSRESETREQ (1UL << 2)
+#define GDB_FP_KEY (1UL << 1)
+#define GDB_FP_ENABLE (1UL << 0)
+
+#define GDB_REG_NUM 19          /* R0-R15, xPSR, MSP, PSP, selectors are the DCRSR ones */
+#define GDB_HW_BP_MAX 16
+#define GDB_SW_BP_MAX 32
+#define GDB_BKPT_INSN 0xBE00
+#define GDB_CACHE_LIMIT 0x40000000
+#define GDB_HALT_RETRY 100
+#define GDB_RX_BUF_SIZE 512
+#define GDB_SEND_TIMEOUT_MS 1000
+#define GDB_EOF (-1)
+#define GDB_TIMEOUT (-2)
+#define GDB_INTERRUPT (-3)
+#define GDB_SIGINT 2
+#define GDB_SIGTRAP 5
+
+static_assert((CONFIG_GDB_SERVER_CACHE_LINE_SIZE & (CONFIG_GDB_SERVER_CACHE_LINE_SIZE - 1)) == 0, "Cache line size must be a power of 2");
+static_assert((CONFIG_GDB_SERVER_PACKET_SIZE % 4) == 0, "Packet size must be a multiple of 4");
+
+typedef struct
+{
+    uint32_t addr;      ///< Breakpoint address
+    uint16_t insn;      ///< Replaced instruction, software breakpoints only
+    bool used;          ///< Slot in use
+} gdb_bp_t;
+
+typedef struct
+{
+    uint32_t tag;       ///< Line number, address / CONFIG_GDB_SERVER_CACHE_LINE_SIZE
+    bool valid;         ///< Line holds target data
+} gdb_cache_line_t;
+
+static const char s_target_xml[] =
+    "<?xml version=\"1.0\"?>"
+    "<!DOCTYPE target SYSTEM \"gdb-target.dtd\">"
+    "<target version=\"1.0\">"
+    "<architecture>arm</architecture>"
+    "<feature name=\"org.gnu.gdb.arm.m-profile\">"
+    "<reg name=\"r0\" bitsize=\"32\"/><reg name=\"r1\" bitsize=\"32\"/><reg name=\"r2\" bitsize=\"32\"/>"
+    "<reg name=\"r3\" bitsize=\"32\"/><reg name=\"r4\" bitsize=\"32\"/><reg name=\"r5\" bitsize=\"32\"/>"
+    "<reg name=\"r6\" bitsize=\"32\"/><reg name=\"r7\" bitsize=\"32\"/><reg name=\"r8\" bitsize=\"32\"/>"
+    "<reg name=\"r9\" bitsize=\"32\"/><reg name=\"r10\" bitsize=\"32\"/><reg name=\"r11\" bitsize=\"32\"/>"
+    "<reg name=\"r12\" bitsize=\"32\"/><reg name=\"sp\" bitsize=\"32\" type=\"data_ptr\"/>"
+    "<reg name=\"lr\" bitsize=\"32\"/><reg name=\"pc\" bitsize=\"32\" type=\"code_ptr\"/>"
+    "<reg name=\"xpsr\" bitsize=\"32\"/>"
+    "</feature>"
+    "<feature name=\"org.gnu.gdb.arm.m-system\">"
+    "<reg name=\"msp\" bitsize=\"32\" type=\"data_ptr\"/><reg name=\"psp\" bitsize=\"32\" type=\"data_ptr\"/>"
+    "</feature>"
+    "</target>";
+
+static int s_listen_fd = -1;
+static int s_fd = -1;
+static bool s_no_ack = false;
+static bool s_lost = false;
+static uint32_t s_commands = 0;
+static uint8_t s_rx[GDB_RX_BUF_SIZE];
+static int s_rx_len = 0;
+static int s_rx_pos = 0;
+static char s_in[CONFIG_GDB_SERVER_PACKET_SIZE + 1];
+/* '$' + payload + "#xx" */
+static char s_out[CONFIG_GDB_SERVER_PACKET_SIZE + 5];
+/* SWD stores whole words through the data pointer, target data is kept word aligned in here */
+static uint32_t s_data[CONFIG_GDB_SERVER_PACKET_SIZE / 4 + 2];
+
+/* Valid until the target runs again */
+static uint32_t s_regs[GDB_REG_NUM];
+static uint32_t s_regs_valid = 0;
+static gdb_cache_line_t s_lines[CONFIG_GDB_SERVER_CACHE_LINES];
+static uint32_t s_line_data[CONFIG_GDB_SERVER_CACHE_LINES][CONFIG_GDB_SERVER_CACHE_LINE_SIZE / 4];
+static uint32_t s_cache_hits = 0;
+static uint32_t s_cache_misses = 0;
+
+static uint32_t s_fp_num = 0;
+static uint32_t s_fp_rev = 0;
+static gdb_bp_t s_hw_bp[GDB_HW_BP_MAX];
+static gdb_bp_t s_sw_bp[GDB_SW_BP_MAX];
+
+static AlgoExtractor s_extractor;
+static FlashIface::program_target_t s_target;
+static FlashIface::target_cfg_t s_cfg;
+static bool s_algo_loaded = false;
+/* The FlashAccessor is ours while set, only as long as the port never left this session */
+static bool s_flashing = false;
+static std::string s_memory_map;
+
+static int gdb_hex_digit(int c)
+{
+    if ((c >= '0') && (c <= '9'))
+        return c - '0';
+    if ((c >= 'a') && (c <= 'f'))
+        return c - 'a' + 10;
+    if ((c >= 'A') && (c <= 'F'))
+        return c - 'A' + 10;
+
+    return -1;
+}
+
+static char *gdb_hex_encode(char *out, const uint8_t *data, size_t len)
+{
+    static const char digits[] = "0123456789abcdef";
+
+    for (size_t i = 0; i < len; i++)
+    {
+        *out++ = digits[data[i] >> 4];
+        *out++ = digits[data[i] & 0xF];
+    }
+
+    return out;
+}
+
+static size_t gdb_hex_decode(const char *hex, size_t hex_len, uint8_t *out)
+{
+    size_t i = 0;
+    int hi = 0;
+    int lo = 0;
+
+    for (i = 0; i + 1 < hex_len; i += 2)
+    {
+        hi = gdb_hex_digit(hex[i]);
+        lo = gdb_hex_digit(hex[i + 1]);
+
+        if ((hi < 0) || (lo < 0))
+            break;
+
+        out[i / 2] = (hi << 4) | lo;
+    }
+
+    return i / 2;
+}
+
+/* Registers go over the wire in target byte order */
+static char *gdb_put_reg(char *out, uint32_t val)
+{
+    uint8_t bytes[4] = {(uint8_t)val, (uint8_t)(val >> 8), (uint8_t)(val >> 16), (uint8_t)(val >> 24)};
+
+    return gdb_hex_encode(out, bytes, sizeof(bytes));
+}
+
+static bool gdb_get_reg(const char *hex, size_t hex_len, uint32_t *val)
+{
+    uint8_t bytes[4] = {0};
+
+    if ((hex_len < 8) || (gdb_hex_decode(hex, 8, bytes) != sizeof(bytes)))
+        return false;
+
+    *val = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+
+    return true;
+}
+
+/* Binary data of X and vFlashWrite, '}' escapes the next byte */
+static size_t gdb_unescape(const char *in, size_t len, uint8_t *out)
+{
+    size_t n = 0;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        if ((in[i] == '}') && (i + 1 < len))
+            out[n++] = in[++i] ^ 0x20;
+        else
+            out[n++] = in[i];
+    }
+
+    return n;
+}
+
+static int gdb_getc(int timeout_ms)
+{
+    fd_set fds;
+    struct timeval tv = {timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+
+    if (s_rx_pos >= s_rx_len)
+    {
+        if (timeout_ms >= 0)
+        {
+            FD_ZERO(&fds);
+            FD_SET(s_fd, &fds);
+
+            if (select(s_fd + 1, &fds, NULL, NULL, &tv) <= 0)
+                return GDB_TIMEOUT;
+        }
+
+        s_rx_len = recv(s_fd, s_rx, sizeof(s_rx), 0);
+        s_rx_pos = 0;
+
+        if (s_rx_len <= 0)
+        {
+            s_rx_len = 0;
+            return GDB_EOF;
+        }
+    }
+
+    return s_rx[s_rx_pos++];
+}
+
+static bool gdb_send_all(const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    int sent = 0;
+
+    while (len > 0)
+    {
+        sent = send(s_fd, p, len, 0);
+
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            return false;
+        }
+
+        p += sent;
+        len -= sent;
+    }
+
+    return true;
+}
+
+/* The payload is at s_out + 1 */
+static bool gdb_send_packet(size_t len)
+{
+    uint8_t sum = 0;
+    int c = 0;
+
+    s_out[0] = '$';
+
+    for (size_t i = 1; i <= len; i++)
+        sum += s_out[i];
+
+    snprintf(&s_out[len + 1], 4, "#%02x", sum);
+
+    for (;;)
+    {
+        if (!gdb_send_all(s_out, len + 4))
+            return false;
+
+        if (s_no_ack)
+            return true;
+
+        do
+        {
+            c = gdb_getc(-1);
+        } while ((c != '+') && (c != '-') && (c != GDB_EOF));
+
+        if (c != '-')
+            return (c == '+');
+    }
+}
+
+static bool gdb_send_str(const char *str)
+{
+    size_t len = strlen(str);
+
+    memcpy(&s_out[1], str, len);
+
+    return gdb_send_packet(len);
+}
+
+/* Returns the payload length, GDB_INTERRUPT for a break or GDB_EOF when the client is gone */
+static int gdb_read_packet(void)
+{
+    int c = 0;
+    int hi = 0;
+    int lo = 0;
+    int len = 0;
+    uint8_t sum = 0;
+    bool overflow = false;
+
+    for (;;)
+    {
+        do
+        {
+            c = gdb_getc(-1);
+
+            if (c == GDB_EOF)
+                return GDB_EOF;
+
+            if (c == 0x03)
+                return GDB_INTERRUPT;
+        } while (c != '$');
+
+        len = 0;
+        sum = 0;
+        overflow = false;
+
+        while ((c = gdb_getc(-1)) != '#')
+        {
+            if (c == GDB_EOF)
+                return GDB_EOF;
+
+            sum += c;
+
+            if (len < CONFIG_GDB_SERVER_PACKET_SIZE)
+                s_in[len++] = c;
+            else
+                overflow = true;
+        }
+
+        hi = gdb_getc(-1);
+        lo = gdb_getc(-1);
+
+        if ((hi == GDB_EOF) || (lo == GDB_EOF))
+            return GDB_EOF;
+
+        if (s_no_ack)
+            break;
+
+        if (!overflow && (((gdb_hex_digit(hi) << 4) | gdb_hex_digit(lo)) == sum))
+        {
+            gdb_send_all("+", 1);
+            break;
+        }
+
+        gdb_send_all("-", 1);
+    }
+
+    s_in[len] = '\0';
+
+    return len;
+}
+
+static void gdb_invalidate(void);
+static bool gdb_bp_restore(SWDIface &swd);
+
+/* Keeps the port claimed, the session ends if another one took it over */
+static bool gdb_target_lock(SWDIface &swd)
+{
+    dap_arbiter_stats_t stats;
+
+    /* The session keeps its claim, an owner other than GDB means the port was taken over
+     * at some point and the new owner (the programmer among them) may have used the FlashAccessor */
+    dap_arbiter_get_stats(&stats);
+    if (s_flashing && (stats.owner != DAP_SESSION_GDB))
+    {
+        ESP_LOGW(TAG, "Debug port taken over while flashing");
+        s_flashing = false;
+        s_lost = true;
+        return false;
+    }
+
+    if (!(s_flashing ? dap_arbiter_try_claim(DAP_SESSION_GDB) : dap_arbiter_claim(DAP_SESSION_GDB)))
+    {
+        ESP_LOGW(TAG, "Debug port taken over by another session");
+        s_flashing = false;
+        s_lost = true;
+        return false;
+    }
+
+    dap_arbiter_lock();
+
+    /* Whoever held the lock since our last access may have switched the port off, reset the target,
+     * reloaded RAM or reprogrammed the FPB. Nothing read before can be trusted. */
+    dap_arbiter_get_stats(&stats);
+    if (stats.commands != s_commands)
+    {
+        gdb_invalidate();
+        swd.init_debug();
+        gdb_bp_restore(swd);
+    }
+
+    return true;
+}
+
+static void gdb_target_unlock(void)
+{
+    dap_arbiter_stats_t stats;
+
+    /* This unlock counts as a command too */
+    dap_arbiter_get_stats(&stats);
+    s_commands = stats.commands + 1;
+    dap_arbiter_unlock();
+}
+
+static bool gdb_read_word(SWDIface &swd, uint32_t addr, uint32_t *val)
+{
+    return swd.read_memory(addr, (uint8_t *)val, sizeof(*val));
+}
+
+static bool gdb_write_word(SWDIface &swd, uint32_t addr, uint32_t val)
+{
+    return swd.write_memory(addr, (uint8_t *)&val, sizeof(val));
+}
+
+static void gdb_invalidate(void)
+{
+    s_regs_valid = 0;
+
+    for (int i = 0; i < CONFIG_GDB_SERVER_CACHE_LINES; i++)
+        s_lines[i].valid = false;
+}
+
+static bool gdb_is_halted(SWDIface &swd, bool *halted)
+{
+    uint32_t dhcsr = 0;
+
+    if (!gdb_read_word(swd, GDB_DHCSR, &dhcsr))
+        return false;
+
+    *halted = (dhcsr & GDB_S_HALT) != 0;
+
+    return true;
+}
+
+/* Reads may fail while the target comes out of reset, keep trying */
+static bool gdb_wait_halted(SWDIface &swd)
+{
+    bool halted = false;
+
+    for (int i = 0; i < GDB_HALT_RETRY; i++)
+    {
+        if (gdb_is_halted(swd, &halted) && halted)
+            return true;
+
+        swd.msleep(1);
+    }
+
+    return false;
+}
+
+static bool gdb_halt(SWDIface &swd)
+{
+    return gdb_write_word(swd, GDB_DHCSR, GDB_DBGKEY | GDB_C_DEBUGEN | GDB_C_HALT) && gdb_wait_halted(swd);
+}
+
+static bool gdb_resume(SWDIface &swd, bool step)
+{
+    gdb_invalidate();
+
+    /* C_MASKINTS may only change while halted */
+    if (!gdb_write_word(swd, GDB_DFSR, GDB_DFSR_ALL) ||
+        !gdb_write_word(swd, GDB_DHCSR, GDB_DBGKEY | GDB_C_DEBUGEN | GDB_C_HALT | (step ? GDB_C_MASKINTS : 0)))
+        return false;
+
+    /* Interrupts stay masked for a step so it does not land in a handler */
+    return gdb_write_word(swd, GDB_DHCSR, GDB_DBGKEY | GDB_C_DEBUGEN | (step ? (GDB_C_MASKINTS | GDB_C_STEP) : 0));
+}
+
+static bool gdb_fpb_init(SWDIface &swd)
+{
+    uint32_t ctrl = 0;
+
+    if (!gdb_read_word(swd, GDB_FP_CTRL, &ctrl))
+        return false;
+
+    s_fp_num = ((ctrl >> 8) & 0x70) | ((ctrl >> 4) & 0xF);
+    s_fp_num = (s_fp_num > GDB_HW_BP_MAX) ? GDB_HW_BP_MAX : s_fp_num;
+    s_fp_rev = ctrl >> 28;
+
+    for (uint32_t i = 0; i < s_fp_num; i++)
+    {
+        if (!gdb_write_word(swd, GDB_FP_COMP0 + i * 4, 0))
+            return false;
+    }
+
+    return gdb_write_word(swd, GDB_FP_CTRL, GDB_FP_KEY | GDB_FP_ENABLE);
+}
+
+static bool gdb_reset_halt(SWDIface &swd)
+{
+    uint32_t demcr = 0;
+    uint32_t aircr = 0;
+    bool ret = false;
+
+    gdb_invalidate();
+
+    if (!swd.init_debug() || !gdb_halt(swd) || !gdb_read_word(swd, GDB_DEMCR, &demcr) ||
+        !gdb_write_word(swd, GDB_DEMCR, demcr | GDB_VC_CORERESET) || !gdb_read_word(swd, GDB_AIRCR, &aircr))
+        return false;
+
+    /* The core stops on the reset vector */
+    gdb_write_word(swd, GDB_AIRCR, GDB_AIRCR_VECTKEY | (aircr & GDB_AIRCR_PRIGROUP) | GDB_AIRCR_SYSRESETREQ);
+    ret = gdb_wait_halted(swd);
+
+    gdb_write_word(swd, GDB_DEMCR, demcr & ~GDB_VC_CORERESET);
+    gdb_write_word(swd, GDB_DFSR, GDB_DFSR_ALL);
+
+    return ret && gdb_fpb_init(swd);
+}
+
+static bool gdb_reg_read(SWDIface &swd, int n, uint32_t *val)
+{
+    if (!(s_regs_valid & (1UL << n)))
+    {
+        if (!swd.read_core_register(n, &s_regs[n]))
+            return false;
+
+        s_regs_valid |= 1UL << n;
+    }
+
+    *val = s_regs[n];
+
+    return true;
+}
+
+static bool gdb_reg_write(SWDIface &swd, int n, uint32_t val)
+{
+    if (!swd.write_core_register(n, val))
+    {
+        s_regs_valid &= ~(1UL << n);
+        return false;
+    }
+
+    s_regs[n] = val;
+    s_regs_valid |= 1UL << n;
+
+    return true;
+}
+
+/* RAM and code space go through the line cache, peripherals are always read from the target */
+static bool gdb_mem_read(SWDIface &swd, uint32_t addr, uint8_t *data, uint32_t len)
+{
+    uint32_t line = 0;
+    uint32_t offset = 0;
+    uint32_t n = 0;
+    gdb_cache_line_t *entry = NULL;
+
+    if ((addr >= GDB_CACHE_LIMIT) || (len > GDB_CACHE_LIMIT - addr))
+        return swd.read_memory(addr, data, len);
+
+    while (len > 0)
+    {
+        line = addr / CONFIG_GDB_SERVER_CACHE_LINE_SIZE;
+        offset = addr % CONFIG_GDB_SERVER_CACHE_LINE_SIZE;
+        n = CONFIG_GDB_SERVER_CACHE_LINE_SIZE - offset;
+        n = (n > len) ? len : n;
+        entry = &s_lines[line % CONFIG_GDB_SERVER_CACHE_LINES];
+
+        if (entry->valid && (entry->tag == line))
+        {
+            s_cache_hits++;
+        }
+        else
+        {
+            s_cache_misses++;
+            entry->tag = line;
+            entry->valid = swd.read_memory(line * CONFIG_GDB_SERVER_CACHE_LINE_SIZE, (uint8_t *)s_line_data[line % CONFIG_GDB_SERVER_CACHE_LINES],
+                                           CONFIG_GDB_SERVER_CACHE_LINE_SIZE);
+        }
+
+        /* The line may reach past the end of a memory, then just what was asked for is read */
+        if (entry->valid)
+            memcpy(data, (uint8_t *)s_line_data[line % CONFIG_GDB_SERVER_CACHE_LINES] + offset, n);
+        else if (!swd.read_memory(addr, data, n))
+            return false;
+
+        addr += n;
+        data += n;
+        len -= n;
+    }
+
+    return true;
+}
+
+static void gdb_invalidate_range(uint32_t addr, uint32_t len)
+{
+    uint32_t first = addr / CONFIG_GDB_SERVER_CACHE_LINE_SIZE;
+    uint32_t last = (addr + len - 1) / CONFIG_GDB_SERVER_CACHE_LINE_SIZE;
+
+    /* A range larger than the cache can hit every line */
+    if (last - first >= CONFIG_GDB_SERVER_CACHE_LINES)
+    {
+        gdb_invalidate();
+        return;
+    }
+
+    for (uint32_t line = first; line <= last; line++)
+    {
+        if (s_lines[line % CONFIG_GDB_SERVER_CACHE_LINES].tag == line)
+            s_lines[line % CONFIG_GDB_SERVER_CACHE_LINES].valid = false;
+    }
+}
+
+static bool gdb_mem_write(SWDIface &swd, uint32_t addr, uint8_t *data, uint32_t len)
+{
+    if (len == 0)
+        return true;
+
+    gdb_invalidate_range(addr, len);
+
+    return swd.write_memory(addr, data, len);
+}
+
+static bool gdb_fpb_match(uint32_t addr)
+{
+    /* The first FPB revision only covers the code region */
+    return (s_fp_rev != 0) || (addr < 0x20000000);
+}
+
+static uint32_t gdb_fpb_comp(uint32_t addr)
+{
+    if (s_fp_rev == 0)
+        return (addr & 0x1FFFFFFC) | ((addr & 0x2) ? 0x80000000 : 0x40000000) | GDB_FP_ENABLE;
+
+    return (addr & ~0x1UL) | GDB_FP_ENABLE;
+}
+
+static bool gdb_bp_insert(SWDIface &swd, bool hw, uint32_t addr)
+{
+    uint16_t insn = GDB_BKPT_INSN;
+    uint32_t check = 0;
+    gdb_bp_t *slot = NULL;
+
+    for (uint32_t i = 0; i < s_fp_num; i++)
+    {
+        if (s_hw_bp[i].used && (s_hw_bp[i].addr == addr))
+            return true;
+    }
+
+    for (int i = 0; i < GDB_SW_BP_MAX; i++)
+    {
+        if (s_sw_bp[i].used && (s_sw_bp[i].addr == addr))
+            return true;
+    }
+
+    /* Software breakpoints use a free comparator too, flash cannot be patched */
+    if (gdb_fpb_match(addr))
+    {
+        for (uint32_t i = 0; i < s_fp_num; i++)
+        {
+            if (!s_hw_bp[i].used)
+            {
+                if (!gdb_write_word(swd, GDB_FP_COMP0 + i * 4, gdb_fpb_comp(addr)))
+                    return false;
+
+                s_hw_bp[i].addr = addr;
+                s_hw_bp[i].used = true;
+                return true;
+            }
+        }
+    }
+
+    if (hw)
+        return false;
+
+    for (int i = 0; (i < GDB_SW_BP_MAX) && !slot; i++)
+        slot = s_sw_bp[i].used ? NULL : &s_sw_bp[i];
+
+    if (!slot || !gdb_mem_read(swd, addr & ~0x3UL, (uint8_t *)&check, sizeof(check)))
+        return false;
+
+    slot->insn = (addr & 0x2) ? (check >> 16) : (check & 0xFFFF);
+
+    /* Read back, a write to flash is silently ignored */
+    if (!gdb_mem_write(swd, addr, (uint8_t *)&insn, sizeof(insn)) || !swd.read_memory(addr & ~0x3UL, (uint8_t *)&check, sizeof(check)) ||
+        (((addr & 0x2) ? (check >> 16) : (check & 0xFFFF)) != GDB_BKPT_INSN))
+    {
+        gdb_mem_write(swd, addr, (uint8_t *)&slot->insn, sizeof(slot->insn));
+        return false;
+    }
+
+    slot->addr = addr;
+    slot->used = true;
+
+    return true;
+}
+
+static bool gdb_bp_remove(SWDIface &swd, uint32_t addr)
+{
+    for (uint32_t i = 0; i < s_fp_num; i++)
+    {
+        if (s_hw_bp[i].used && (s_hw_bp[i].addr == addr))
+        {
+            s_hw_bp[i].used = false;
+            return gdb_write_word(swd, GDB_FP_COMP0 + i * 4, 0);
+        }
+    }
+
+    for (int i = 0; i < GDB_SW_BP_MAX; i++)
+    {
+        if (s_sw_bp[i].used && (s_sw_bp[i].addr == addr))
+        {
+            s_sw_bp[i].used = false;
+            return gdb_mem_write(swd, addr, (uint8_t *)&s_sw_bp[i].insn, sizeof(s_sw_bp[i].insn));
+        }
+    }
+
+    return true;
+}
+
+/* Put the comparators back, a software breakpoint whose BKPT was overwritten is lost */
+static bool gdb_bp_restore(SWDIface &swd)
+{
+    uint32_t check = 0;
+
+    if (!gdb_fpb_init(swd))
+        return false;
+
+    for (uint32_t i = 0; i < GDB_HW_BP_MAX; i++)
+    {
+        if (!s_hw_bp[i].used)
+            continue;
+
+        if ((i >= s_fp_num) || !gdb_write_word(swd, GDB_FP_COMP0 + i * 4, gdb_fpb_comp(s_hw_bp[i].addr)))
+            s_hw_bp[i].used = false;
+    }
+
+    for (int i = 0; i < GDB_SW_BP_MAX; i++)
+    {
+        if (!s_sw_bp[i].used)
+            continue;
+
+        if (!swd.read_memory(s_sw_bp[i].addr & ~0x3UL, (uint8_t *)&check, sizeof(check)) ||
+            (((s_sw_bp[i].addr & 0x2) ? (check >> 16) : (check & 0xFFFF)) != GDB_BKPT_INSN))
+        {
+            ESP_LOGW(TAG, "Breakpoint at 0x%08lx lost", (unsigned long)s_sw_bp[i].addr);
+            s_sw_bp[i].used = false;
+        }
+    }
+
+    return true;
+}
+
+static void gdb_bp_clear(SWDIface &swd)
+{
+    for (uint32_t i = 0; i < s_fp_num; i++)
+    {
+        if (s_hw_bp[i].used)
+            gdb_bp_remove(swd, s_hw_bp[i].addr);
+    }
+
+    for (int i = 0; i < GDB_SW_BP_MAX; i++)
+    {
+        if (s_sw_bp[i].used)
+            gdb_bp_remove(swd, s_sw_bp[i].addr);
+    }
+
+    gdb_write_word(swd, GDB_FP_CTRL, GDB_FP_KEY);
+}
+
+static void gdb_build_memory_map(void)
+{
+    char buf[160];
+    uint32_t end = 0;
+    uint32_t start = 0;
+    uint32_t next = 0;
+    uint32_t addr = 0;
+
+    s_memory_map = "<?xml version=\"1.0\"?>"
+                   "<!DOCTYPE memory-map PUBLIC \"+//IDN gnu.org//DTD GDB Memory Map V1.0//EN\" \"http://sourceware.org/gdb/gdb-memory-map.dtd\">"
+                   "<memory-map>";
+
+    /* Everything outside the flash is RAM to GDB, otherwise it refuses to touch peripherals */
+    for (const FlashIface::region_info_t &region : s_cfg.flash_regions)
+    {
+        if (region.start > addr)
+        {
+            snprintf(buf, sizeof(buf), "<memory type=\"ram\" start=\"0x%lx\" length=\"0x%lx\"/>", (unsigned long)addr, (unsigned long)(region.start - addr));
+            s_memory_map += buf;
+        }
+
+        /* One element per run of equally sized sectors */
+        for (size_t i = 0; i < s_cfg.sector_info.size(); i++)
+        {
+            start = (s_cfg.sector_info[i].start > region.start) ? s_cfg.sector_info[i].start : region.start;
+            next = (i + 1 < s_cfg.sector_info.size()) ? s_cfg.sector_info[i + 1].start : region.end;
+            end = (next < region.end) ? next : region.end;
+
+            if (start >= end)
+                continue;
+
+            snprintf(buf, sizeof(buf), "<memory type=\"flash\" start=\"0x%lx\" length=\"0x%lx\"><property name=\"blocksize\">0x%lx</property></memory>",
+                     (unsigned long)start, (unsigned long)(end - start), (unsigned long)s_cfg.sector_info[i].size);
+            s_memory_map += buf;
+        }
+
+        addr = region.end;
+    }
+
+    if (addr)
+    {
+        snprintf(buf, sizeof(buf), "<memory type=\"ram\" start=\"0x%lx\" length=\"0x%lx\"/>", (unsigned long)addr, (unsigned long)(0 - addr));
+        s_memory_map += buf;
+    }
+
+    s_memory_map += "</memory-map>";
+}
+
+static void gdb_clean_algorithm(void)
+{
+    if (s_target.algo_blob)
+    {
+        delete[] s_target.algo_blob;
+        s_target.algo_blob = nullptr;
+    }
+
+    s_algo_loaded = false;
+}
+
+static bool gdb_load_algorithm(const char *name, uint32_t ram_addr)
+{
+    std::string path = std::string(CONFIG_PROGRAMMER_ALGORITHM_ROOT) + "/" + name;
+
+    gdb_clean_algorithm();
+
+    if (!s_extractor.extract(path, s_target, s_cfg, ram_addr) || s_cfg.flash_regions.empty())
+    {
+        ESP_LOGE(TAG, "Failed to load %s", path.c_str());
+        gdb_clean_algorithm();
+        return false;
+    }
+
+    s_algo_loaded = true;
+    gdb_build_memory_map();
+    ESP_LOGI(TAG, "Flash algorithm %s, %s", name, s_cfg.device_name.c_str());
+
+    return true;
+}
+
+static bool gdb_flash_done(SWDIface &swd)
+{
+    bool ret = true;
+
+    if (s_flashing)
+    {
+        ret = (FlashAccessor::get_instance().uninit() == FlashIface::ERR_NONE);
+        s_flashing = false;
+    }
+
+    /* The algorithm left the target running, start the program from reset like a debugger would */
+    return gdb_reset_halt(swd) && ret;
+}
+
+/* qXfer reply, 'm' while more data follows, 'l' for the last part */
+static bool gdb_send_xfer(const char *data, size_t size, const char *args)
+{
+    unsigned long offset = 0;
+    unsigned long len = 0;
+    char *end = NULL;
+
+    offset = strtoul(args, &end, 16);
+    if (*end != ',')
+        return gdb_send_str("E01");
+
+    len = strtoul(end + 1, NULL, 16);
+    len = (len > CONFIG_GDB_SERVER_PACKET_SIZE - 1) ? (CONFIG_GDB_SERVER_PACKET_SIZE - 1) : len;
+
+    if (offset >= size)
+        return gdb_send_str("l");
+
+    len = (len > size - offset) ? (size - offset) : len;
+    s_out[1] = (offset + len < size) ? 'm' : 'l';
+    memcpy(&s_out[2], data + offset, len);
+
+    return gdb_send_packet(len + 1);
+}
+
+static bool gdb_send_output(const char *msg)
+{
+    size_t len = strlen(msg);
+
+    s_out[1] = 'O';
+    gdb_hex_encode(&s_out[2], (const uint8_t *)msg, len);
+
+    return gdb_send_packet(len * 2 + 1);
+}
+
+static bool gdb_handle_monitor(SWDIface &swd, const char *hex)
+{
+    char cmd[96] = {0};
+    char name[64] = {0};
+    unsigned long ram_addr = 0x20000000;
+    size_t len = strlen(hex);
+    bool ok = false;
+
+    len = (len / 2 >= sizeof(cmd)) ? (sizeof(cmd) - 1) * 2 : len;
+    gdb_hex_decode(hex, len, (uint8_t *)cmd);
+
+    if (!strcmp(cmd, "reset") || !strcmp(cmd, "reset halt") || !strcmp(cmd, "halt"))
+    {
+        if (!gdb_target_lock(swd))
+            return false;
+
+        ok = (cmd[0] == 'r') ? gdb_reset_halt(swd) : gdb_halt(swd);
+        gdb_target_unlock();
+        gdb_send_output(ok ? "Target halted\n" : "Target not responding\n");
+    }
+    else if (sscanf(cmd, "algorithm %63s %lx", name, &ram_addr) >= 1)
+    {
+        if (s_flashing || programmer_is_busy())
+            gdb_send_output("Flash is in use\n");
+        else
+            gdb_send_output(gdb_load_algorithm(name, ram_addr) ? "Flash algorithm loaded\n" : "Failed to load the flash algorithm\n");
+    }
+    else
+    {
+        gdb_send_output("Commands: reset [halt], halt, algorithm <name.FLM> [ram_addr]\n");
+    }
+
+    return gdb_send_str("OK");
+}
+
+static bool gdb_send_stop(SWDIface &swd, int signal)
+{
+    uint32_t sp = 0;
+    uint32_t pc = 0;
+    char *p = &s_out[1];
+
+    p += sprintf(p, "T%02x", signal);
+
+    /* PC and SP go with the stop reply, GDB needs them first */
+    if (gdb_target_lock(swd))
+    {
+        if (gdb_reg_read(swd, 15, &pc) && gdb_reg_read(swd, 13, &sp))
+        {
+            p += sprintf(p, "0f:");
+            p = gdb_put_reg(p, pc);
+            p += sprintf(p, ";0d:");
+            p = gdb_put_reg(p, sp);
+            *p++ = ';';
+        }
+
+        gdb_target_unlock();
+    }
+
+    return gdb_send_packet(p - &s_out[1]);
+}
+
+/* Polls for the halt, fast at first so stepping over a line feels immediate, returns the stop signal or -1 */
+static int gdb_wait_halt(SWDIface &swd)
+{
+    int c = GDB_TIMEOUT;
+    int signal = GDB_SIGTRAP;
+    int interval = 0;
+    bool halted = false;
+    bool ok = false;
+
+    for (;;)
+    {
+        if (!gdb_target_lock(swd))
+            return -1;
+
+        if (c == 0x03)
+        {
+            gdb_halt(swd);
+            signal = GDB_SIGINT;
+        }
+
+        ok = gdb_is_halted(swd, &halted);
+        gdb_target_unlock();
+
+        /* A halt that did not take is reported anyway, the target is probably gone */
+        if ((ok && halted) || (signal == GDB_SIGINT))
+            return signal;
+
+        c = gdb_getc(interval);
+
+        if (c == GDB_EOF)
+            return -1;
+
+        interval = interval ? interval * 2 : 1;
+        interval = (interval > CONFIG_GDB_SERVER_POLL_MAX_MS) ? CONFIG_GDB_SERVER_POLL_MAX_MS : interval;
+    }
+}
+
+static bool gdb_handle_resume(SWDIface &swd, bool step)
+{
+    uint32_t addr = 0;
+    char *end = NULL;
+    bool ok = false;
+    int signal = 0;
+
+    if (!gdb_target_lock(swd))
+        return false;
+
+    ok = true;
+    if (s_in[1])
+    {
+        addr = strtoul(&s_in[1], &end, 16);
+        ok = (end != &s_in[1]) && gdb_reg_write(swd, 15, addr);
+    }
+
+    ok = ok && gdb_resume(swd, step);
+    gdb_target_unlock();
+
+    if (!ok)
+        return gdb_send_str("E01");
+
+    signal = gdb_wait_halt(swd);
+    if (signal < 0)
+        return false;
+
+    return gdb_send_stop(swd, signal);
+}
+
+static bool gdb_handle_regs(SWDIface &swd, bool write)
+{
+    uint32_t val = 0;
+    char *p = &s_out[1];
+    size_t len = strlen(&s_in[1]);
+    bool ok = false;
+
+    if (!gdb_target_lock(swd))
+        return false;
+
+    ok = true;
+    for (int i = 0; ok && (i < GDB_REG_NUM); i++)
+    {
+        if (!write)
+        {
+            ok = gdb_reg_read(swd, i, &val);
+            p = gdb_put_reg(p, val);
+        }
+        else if (len >= (size_t)(i + 1) * 8)
+        {
+            ok = gdb_get_reg(&s_in[1 + i * 8], 8, &val) && gdb_reg_write(swd, i, val);
+        }
+    }
+
+    gdb_target_unlock();
+
+    if (!ok)
+        return gdb_send_str("E01");
+
+    return write ? gdb_send_str("OK") : gdb_send_packet(p - &s_out[1]);
+}
+
+static bool gdb_handle_reg(SWDIface &swd, bool write)
+{
+    uint32_t val = 0;
+    char *end = NULL;
+    unsigned long n = strtoul(&s_in[1], &end, 16);
+    bool ok = false;
+
+    if ((n >= GDB_REG_NUM) || (write && (*end != '=')))
+        return gdb_send_str("E01");
+
+    if (!gdb_target_lock(swd))
+        return false;
+
+    if (write)
+        ok = gdb_get_reg(end + 1, strlen(end + 1), &val) && gdb_reg_write(swd, n, val);
+    else
+        ok = gdb_reg_read(swd, n, &val);
+
+    gdb_target_unlock();
+
+    if (!ok)
+        return gdb_send_str("E01");
+
+    if (write)
+        return gdb_send_str("OK");
+
+    return gdb_send_packet(gdb_put_reg(&s_out[1], val) - &s_out[1]);
+}
+
+static bool gdb_handle_memory(SWDIface &swd, int len)
+{
+    unsigned long addr = 0;
+    unsigned long size = 0;
+    char *end = NULL;
+    uint8_t *data = NULL;
+    bool ok = false;
+
+    addr = strtoul(&s_in[1], &end, 16);
+    if (*end != ',')
+        return gdb_send_str("E01");
+
+    size = strtoul(end + 1, &end, 16);
+    data = (uint8_t *)s_data + (addr & 0x3);
+
+    if (s_in[0] == 'm')
+    {
+        size = (size > CONFIG_GDB_SERVER_PACKET_SIZE / 2) ? CONFIG_GDB_SERVER_PACKET_SIZE / 2 : size;
+    }
+    else if ((*end != ':') || (size > CONFIG_GDB_SERVER_PACKET_SIZE) ||
+             (((s_in[0] == 'X') ? gdb_unescape(end + 1, &s_in[len] - (end + 1), data) : gdb_hex_decode(end + 1, &s_in[len] - (end + 1), data)) < size))
+    {
+        return gdb_send_str("E01");
+    }
+
+    if (!gdb_target_lock(swd))
+        return false;
+
+    if (s_in[0] == 'm')
+        ok = gdb_mem_read(swd, addr, data, size);
+    else
+        ok = gdb_mem_write(swd, addr, data, size);
+
+    gdb_target_unlock();
+
+    if (!ok)
+        return gdb_send_str("E01");
+
+    if (s_in[0] != 'm')
+        return gdb_send_str("OK");
+
+    return gdb_send_packet(gdb_hex_encode(&s_out[1], data, size) - &s_out[1]);
+}
+
+static bool gdb_handle_breakpoint(SWDIface &swd)
+{
+    unsigned long addr = 0;
+    char *end = NULL;
+    bool ok = false;
+
+    /* Watchpoints are left to GDB, it single steps and compares */
+    if ((s_in[1] != '0') && (s_in[1] != '1'))
+        return gdb_send_str("");
+
+    addr = strtoul(&s_in[3], &end, 16);
+
+    if (!gdb_target_lock(swd))
+        return false;
+
+    if (s_in[0] == 'Z')
+        ok = gdb_bp_insert(swd, s_in[1] == '1', addr);
+    else
+        ok = gdb_bp_remove(swd, addr);
+
+    gdb_target_unlock();
+
+    return gdb_send_str(ok ? "OK" : "E01");
+}
+
+static bool gdb_handle_flash(SWDIface &swd, int len)
+{
+    unsigned long addr = 0;
+    char *end = NULL;
+    uint8_t *data = NULL;
+    size_t size = 0;
+    bool ok = false;
+
+    /* Only the start of a sequence checks the programmer, from then on gdb_target_lock() keeps the port and the FlashAccessor ours */
+    if (!s_algo_loaded || (!s_flashing && programmer_is_busy()))
+        return gdb_send_str("E01");
+
+    if (!gdb_target_lock(swd))
+        return false;
+
+    if (!strncmp(s_in, "vFlashErase:", 12))
+    {
+        /* FlashAccessor erases each sector before its first write, the ranges GDB erases are the ones it writes */
+        gdb_invalidate();
+        ok = s_flashing || (FlashAccessor::get_instance().init(s_cfg) == FlashIface::ERR_NONE);
+        s_flashing = ok;
+    }
+    else if (!strncmp(s_in, "vFlashWrite:", 12))
+    {
+        addr = strtoul(&s_in[12], &end, 16);
+        data = (uint8_t *)s_data + (addr & 0x3);
+
+        if (s_flashing && (*end == ':'))
+        {
+            size = gdb_unescape(end + 1, &s_in[len] - (end + 1), data);
+            ok = (FlashAccessor::get_instance().write(addr, data, size) == FlashIface::ERR_NONE);
+        }
+    }
+    else
+    {
+        ok = gdb_flash_done(swd);
+    }
+
+    gdb_target_unlock();
+
+    return gdb_send_str(ok ? "OK" : "E01");
+}
+
+static bool gdb_handle_query(SWDIface &swd)
+{
+    char buf[128];
+
+    if (!strncmp(s_in, "qSupported", 10))
+    {
+        snprintf(buf, sizeof(buf), "PacketSize=%x;qXfer:features:read+;qXfer:memory-map:read+;QStartNoAckMode+", CONFIG_GDB_SERVER_PACKET_SIZE);
+        return gdb_send_str(buf);
+    }
+
+    if (!strncmp(s_in, "qXfer:features:read:target.xml:", 31))
+        return gdb_send_xfer(s_target_xml, sizeof(s_target_xml) - 1, &s_in[31]);
+
+    /* Without a flash algorithm there is no map, GDB then allows writes anywhere */
+    if (!strncmp(s_in, "qXfer:memory-map:read::", 23))
+        return s_algo_loaded ? gdb_send_xfer(s_memory_map.c_str(), s_memory_map.size(), &s_in[23]) : gdb_send_str("E01");
+
+    if (!strncmp(s_in, "qRcmd,", 6))
+        return gdb_handle_monitor(swd, &s_in[6]);
+
+    if (!strcmp(s_in, "qAttached"))
+        return gdb_send_str("1");
+
+    if (!strcmp(s_in, "qfThreadInfo"))
+        return gdb_send_str("m1");
+
+    if (!strcmp(s_in, "qsThreadInfo"))
+        return gdb_send_str("l");
+
+    if (!strcmp(s_in, "qC"))
+        return gdb_send_str("QC1");
+
+    if (!strncmp(s_in, "qSymbol", 7))
+        return gdb_send_str("OK");
+
+    return gdb_send_str("");
+}
+
+/* Returns false when the session ends */
+static bool gdb_handle_packet(SWDIface &swd, int len)
+{
+    switch (s_in[0])
+    {
+    case '?':
+        return gdb_send_stop(swd, GDB_SIGTRAP);
+
+    case 'g':
+    case 'G':
+        return gdb_handle_regs(swd, s_in[0] == 'G');
+
+    case 'p':
+    case 'P':
+        return gdb_handle_reg(swd, s_in[0] == 'P');
+
+    case 'm':
+    case 'M':
+    case 'X':
+        return gdb_handle_memory(swd, len);
+
+    case 'c':
+    case 's':
+        return gdb_handle_resume(swd, s_in[0] == 's');
+
+    case 'Z':
+    case 'z':
+        return gdb_handle_breakpoint(swd);
+
+    case 'H':
+    case 'T':
+        return gdb_send_str("OK");
+
+    case 'q':
+        return gdb_handle_query(swd);
+
+    case 'Q':
+        if (!strcmp(s_in, "QStartNoAckMode"))
+        {
+            /* Acknowledged with the old mode */
+            gdb_send_str("OK");
+            s_no_ack = true;
+            return true;
+        }
+
+        return gdb_send_str("");
+
+    case 'v':
+        if (!strncmp(s_in, "vFlash", 6))
+            return gdb_handle_flash(swd, len);
+
+        return gdb_send_str("");
+
+    case 'D':
+        gdb_send_str("OK");
+        return false;
+
+    case 'k':
+        return false;
+
+    default:
+        return gdb_send_str("");
+    }
+}
+
+static void gdb_session(SWDIface &swd)
+{
+    int len = 0;
+    bool attached = false;
+
+    s_no_ack = false;
+    s_lost = false;
+    s_rx_len = 0;
+    s_rx_pos = 0;
+    s_fp_num = 0;
+    s_cache_hits = 0;
+    s_cache_misses = 0;
+    memset(s_hw_bp, 0, sizeof(s_hw_bp));
+    memset(s_sw_bp, 0, sizeof(s_sw_bp));
+    gdb_invalidate();
+
+    if (!dap_arbiter_claim(DAP_SESSION_GDB))
+    {
+        ESP_LOGW(TAG, "Debug port in use by another session");
+        return;
+    }
+
+    /* GDB expects a stopped target, attach without a reset */
+    dap_arbiter_lock();
+    attached = swd.init_debug() && gdb_halt(swd) && gdb_fpb_init(swd);
+    gdb_target_unlock();
+
+    if (!attached)
+        ESP_LOGW(TAG, "No target, use `monitor reset halt` once it is connected");
+
+    if (CONFIG_GDB_SERVER_ALGORITHM[0] && !programmer_is_busy())
+        gdb_load_algorithm(CONFIG_GDB_SERVER_ALGORITHM, CONFIG_GDB_SERVER_RAM_ADDR);
+
+    for (;;)
+    {
+        len = gdb_read_packet();
+
+        if (len == GDB_EOF)
+            break;
+
+        /* A break while halted, nothing to do */
+        if (len == GDB_INTERRUPT)
+            continue;
+
+        if (!gdb_handle_packet(swd, len) || s_lost)
+            break;
+    }
+
+    if (!s_lost)
+    {
+        dap_arbiter_lock();
+
+        if (s_flashing)
+        {
+            FlashAccessor::get_instance().uninit();
+            s_flashing = false;
+        }
+
+        gdb_bp_clear(swd);
+        swd.set_target_state(SWDIface::TARGET_RUN);
+        gdb_target_unlock();
+    }
+
+    dap_arbiter_release(DAP_SESSION_GDB);
+    gdb_clean_algorithm();
+    ESP_LOGI(TAG, "Memory cache: %lu hits, %lu misses", (unsigned long)s_cache_hits, (unsigned long)s_cache_misses);
+}
+
+static void gdb_server_task(void *param)
+{
+    int opt = 1;
+    struct timeval timeout = {GDB_SEND_TIMEOUT_MS / 1000, 0};
+    SWDIface &swd = TargetSWD::get_instance();
+
+    for (;;)
+    {
+        s_fd = accept(s_listen_fd, NULL, NULL);
+        if (s_fd < 0)
+        {
+            continue;
+        }
+
+        /* Every packet waits for its answer, do not let Nagle hold them back */
+        setsockopt(s_fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+        setsockopt(s_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        ESP_LOGI(TAG, "GDB connected");
+        gdb_session(swd);
+
+        close(s_fd);
+        s_fd = -1;
+        ESP_LOGI(TAG, "GDB disconnected");
+    }
+}
+
+bool gdb_server_init(void)
+{
+    int opt = 1;
+    struct sockaddr_in addr = {};
+
+    if (s_listen_fd >= 0)
+    {
+        return true;
+    }
+
+    s_listen_fd = socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
+    if (s_listen_fd < 0)
+    {
+        return false;
+    }
+
+    setsockopt(s_listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(CONFIG_GDB_SERVER_PORT);
+
+    /* One client at a time, GDB does not share a target */
+    if ((bind(s_listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) || (listen(s_listen_fd, 1) != 0))
+    {
+        ESP_LOGE(TAG, "Failed to listen on port %d: errno %d", CONFIG_GDB_SERVER_PORT, errno);
+        goto __error;
+    }
+
+    if (xTaskCreate(gdb_server_task, "gdb_server", 1024 * 6, NULL, 4, NULL) != pdPASS)
+    {
+        goto __error;
+    }
+
+    ESP_LOGI(TAG, "GDB server on port %d", CONFIG_GDB_SERVER_PORT);
+
+    return true;
+
+__error:
+    close(s_listen_fd);
+    s_listen_fd = -1;
+
+    return false;
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add GDB remote serial protocol server
+ */
+#pragma once
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file gdb_server.h
+ * @brief GDB remote serial protocol server over SWD
+ *
+ * One GDB client at a time connects on CONFIG_GDB_SERVER_PORT with
+ * `target remote <probe-ip>:<port>`. The server owns the debug port
+ * as DAP_SESSION_GDB for the whole connection, the target is halted on
+ * connect and resumed on detach.
+ *
+ * Registers are read once per stop and kept until the target runs again.
+ * Memory below 0x40000000 is read in CONFIG_GDB_SERVER_CACHE_LINE_SIZE lines
+ * and cached until the target runs or the range is written, peripheral and
+ * system space is always read from the target.
+ *
+ * Flash is written through `load` once a flash algorithm is selected with
+ * CONFIG_GDB_SERVER_ALGORITHM or `monitor algorithm <name.FLM> [ram_addr]`,
+ * which also enables the memory map GDB needs to pick hardware breakpoints.
+ *
+ * Monitor commands: `reset [halt]`, `halt`, `algorithm <name> [ram_addr]`.
+ */
+
+/**
+ * @brief Start the GDB server task
+ * @return true on success, false on failure
+ */
+bool gdb_server_init(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -8,6 +8,15 @@
  * 2023-9-8      lihongquan   add license declaration
  * 2026-3-17     refactor     Integrate SerialManager for serial port management
  * 2026-3-27     refactor     Migrate to new usbip-server architecture
+ * 2026-10-19    hongquan.li   route USB DAP commands through the port arbiter
+ * 2026-10-19    hongquan.li   start the TCP serial bridge
+ * 2026-10-19    hongquan.li   mount the image store
+ * 2026-10-19    hongquan.li   start the programming job queue
+ * 2026-10-19    hongquan.li   start the armed auto-programming mode
+ * 2026-10-19    hongquan.li   start the RTT reader
+ * 2026-10-19    hongquan.li   start the GDB server
+ * 2026-10-19    hongquan.li   start the live variable sampler
+ * 2026-10-19    hongquan.li   start the SWO trace servers
  */
 
 #include <stdint.h>
@@ -22,6 +31,7 @@
 #include "sdkconfig.h"
 #include "serial/cdc_uart.h"
 #include "disk/disk.h"
+#include "disk/image_store.h"
 
 #if defined(CONFIG_USB_DEBUG_PROBE)
 
@@ -35,12 +45,20 @@
 
 #include "DAP_config.h"
 #include "DAP.h"
+#include "dap_arbiter.h"
 #include "esp_netif.h"
 #include "web/web_handler.h"
 #include "esp_http_server.h"
 #include "web/web_server.h"
 #include "programmer/programmer.h"
+#include "programmer/prog_queue.h"
+#include "programmer/prog_armed.h"
 #include "serial/serial_manager.h"
+#include "serial/serial_bridge.h"
+#include "serial/serial_rtt.h"
+#include "gdb/gdb_server.h"
+#include "watch/data_watch.h"
+#include "trace/swo_trace.h"
 #include "wifi.h"
 #include "usbipd.h"
 
@@ -112,7 +130,7 @@ extern "C" void tud_vendor_rx_cb(uint8_t itf, uint8_t const* buffer, uint16_t bu
 
     if (tud_vendor_n_read(itf, in, sizeof(in)) > 0)
     {
-        tud_vendor_n_write(itf, out, DAP_ProcessCommand(in, out) & 0xFFFF);
+        tud_vendor_n_write(itf, out, dap_arbiter_execute(DAP_SESSION_USB, in, out) & 0xFFFF);
         tud_vendor_n_flush(itf);
     }
 }
@@ -122,7 +140,7 @@ extern "C" void tud_hid_set_report_cb(uint8_t instance, uint8_t report_id, hid_r
 {
     static uint8_t s_tx_buf[CFG_TUD_HID_EP_BUFSIZE];
 
-    DAP_ProcessCommand(buffer, s_tx_buf);
+    dap_arbiter_execute(DAP_SESSION_USB, buffer, s_tx_buf);
     tud_hid_report(0, s_tx_buf, sizeof(s_tx_buf));
 }
 #endif // CONFIG_USB_DEBUG_PROBE
@@ -204,7 +222,10 @@ extern "C" void app_main(void)
 #else
     mount_spiflash_fs();
 #endif
+    image_store_init();
     programmer_init();
+    prog_queue_init();
+    prog_armed_init();
 
     // Initialize SerialManager for state management
     serial_manager_init(UART_NUM_1, GPIO_NUM_13, GPIO_NUM_14, 115200);
@@ -216,6 +237,22 @@ extern "C" void app_main(void)
     cdc_uart_register_rx_handler(CDC_UART_USB_HANDLER, usb_cdc_send_to_host, (void *)TINYUSB_CDC_ACM_0);
 #endif
     cdc_uart_register_rx_handler(CDC_UART_WEB_HANDLER, web_send_to_clients, &http_server);
+#ifdef CONFIG_SERIAL_BRIDGE_ENABLED
+    cdc_uart_register_rx_handler(CDC_UART_TCP_HANDLER, serial_bridge_send_to_clients, NULL);
+    serial_bridge_init();
+#endif
+#ifdef CONFIG_SERIAL_RTT_ENABLED
+    serial_rtt_init();
+#endif
+#ifdef CONFIG_GDB_SERVER_ENABLED
+    gdb_server_init();
+#endif
+#ifdef CONFIG_DATA_WATCH_ENABLED
+    data_watch_init();
+#endif
+#ifdef CONFIG_SWO_TRACE_ENABLED
+    swo_trace_init();
+#endif
     ESP_LOGI(TAG, "USB initialization DONE");
 
     /* Initialize USBIP Server - New Architecture */
@@ -0,0 +1,430 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add armed auto-programming mode
+ * 2026-10-19    hongquan.li   poll under the DAP try-lock
+ */
+#include "programmer/prog_armed.h"
+#include "programmer/programmer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "driver/gpio.h"
+#include "disk/image_store.h"
+#include "target_swd.h"
+#include "dap_arbiter.h"
+#include <sys/stat.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#define TAG "prog_armed"
+#define PROG_ARMED_RETRY_MS 100
+
+typedef enum
+{
+    PROG_ARMED_CMD_ARM,
+    PROG_ARMED_CMD_DISARM
+} prog_armed_cmd_def;
+
+typedef struct
+{
+    prog_armed_state_def state;
+    uint32_t idcode;        ///< IDCODE of the last target, 0 with the button trigger
+    uint32_t passed;        ///< Targets programmed
+    uint32_t failed;        ///< Targets that failed
+    uint32_t last_ms;       ///< Duration of the last job
+    bool last_ok;           ///< Outcome of the last job
+    bool preloaded;         ///< Program held in PSRAM
+} prog_armed_status_t;
+
+static const char *const s_state_names[] = {"off", "loading", "waiting", "programming", "removal"};
+
+static QueueHandle_t s_cmd_queue = nullptr;
+static SemaphoreHandle_t s_mutex = nullptr;
+static std::string s_pending;           ///< Request to arm with, under s_mutex
+static prog_armed_status_t s_status;    ///< Under s_mutex
+
+/* Owned by the armed task */
+static std::string s_request;
+static AlgoExtractor s_extractor;
+static FlashIface::program_target_t s_target;
+static FlashIface::target_cfg_t s_cfg;
+static prog_preload_t s_preload;
+
+static void prog_armed_set_state(prog_armed_state_def state)
+{
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_status.state = state;
+    xSemaphoreGive(s_mutex);
+}
+
+static void prog_armed_unload(void)
+{
+    /* A job may be using the preload, it is only taken away between jobs */
+    while (!programmer_set_preload(nullptr))
+        vTaskDelay(pdMS_TO_TICKS(PROG_ARMED_RETRY_MS));
+
+    if (s_preload.data)
+        heap_caps_free(const_cast<uint8_t *>(s_preload.data));
+
+    if (s_target.algo_blob)
+        delete[] s_target.algo_blob;
+
+    s_preload = prog_preload_t();
+    s_target = FlashIface::program_target_t();
+    s_cfg = FlashIface::target_cfg_t();
+}
+
+static bool prog_armed_read(const prog_req_t &request, uint8_t *data, uint32_t size)
+{
+    bool ret = false;
+    FILE *fp = nullptr;
+    image_store_entry_t image;
+
+    if (!request.image.empty())
+        return image_store_find(request.image.c_str(), &image) && (image_store_read(&image, 0, data, size) == ESP_OK);
+
+    fp = fopen(request.program.c_str(), "rb");
+    if (fp)
+    {
+        ret = (fread(data, 1, size, fp) == size);
+        fclose(fp);
+    }
+
+    return ret;
+}
+
+static bool prog_armed_load(void)
+{
+    prog_req_t request;
+    image_store_entry_t image;
+    struct stat st;
+    uint8_t *data = nullptr;
+
+    /* The files may have changed since the request was checked */
+    if (ProgData::request_decode(request, &s_request[0], s_request.size()) != PROG_ERR_NONE)
+        return false;
+
+    if (!s_extractor.extract(request.algorithm, s_target, s_cfg, request.ram_addr))
+    {
+        ESP_LOGE(TAG, "Failed to extract %s", request.algorithm.c_str());
+        return false;
+    }
+
+    /* Taken after the extraction, a later change to the file is always seen */
+    if (stat(request.algorithm.c_str(), &st) == 0)
+    {
+        s_preload.algorithm_size = st.st_size;
+        s_preload.algorithm_mtime = st.st_mtime;
+    }
+
+    s_preload.algorithm = request.algorithm;
+    s_preload.ram_addr = request.ram_addr;
+    s_preload.target = &s_target;
+    s_preload.cfg = &s_cfg;
+
+    if (!request.image.empty() && image_store_find(request.image.c_str(), &image))
+    {
+        s_preload.program = request.image;
+        s_preload.name = image.name;
+        s_preload.size = image.size;
+    }
+    else if (request.image.empty() && (stat(request.program.c_str(), &st) == 0))
+    {
+        s_preload.program = request.program;
+        s_preload.name = request.program;
+        s_preload.size = st.st_size;
+        s_preload.mtime = st.st_mtime;
+    }
+
+    /* Only PSRAM, a large image must not starve the internal heap */
+    if (s_preload.size)
+        data = (uint8_t *)heap_caps_malloc(s_preload.size, MALLOC_CAP_SPIRAM);
+
+    if (data && prog_armed_read(request, data, s_preload.size))
+    {
+        s_preload.data = data;
+        ESP_LOGI(TAG, "Preloaded %lu bytes of %s", (unsigned long)s_preload.size, s_preload.name.c_str());
+    }
+    else
+    {
+        heap_caps_free(data);
+        ESP_LOGW(TAG, "Program not preloaded, it is read again for every target");
+    }
+
+    while (!programmer_set_preload(&s_preload))
+        vTaskDelay(pdMS_TO_TICKS(PROG_ARMED_RETRY_MS));
+
+    return true;
+}
+
+/* Returns false if the target cannot be polled right now, present is then left alone */
+static bool prog_armed_poll(bool &present, uint32_t &id)
+{
+#if CONFIG_PROGRAMMER_ARMED_TRIGGER_GPIO >= 0
+    id = 0;
+    present = (gpio_get_level((gpio_num_t)CONFIG_PROGRAMMER_ARMED_TRIGGER_GPIO) == 0);
+
+    return true;
+#else
+    SWDIface &swd = TargetSWD::get_instance();
+
+    /* Leave the port alone while a debugger owns it, the line reset would disturb its session */
+    if (programmer_is_busy() || !dap_arbiter_try_lock())
+        return false;
+
+    /* A line reset and one DP read, the target is neither powered up nor halted */
+    swd.init();
+    present = swd.detect_target(&id);
+    swd.off();
+    dap_arbiter_unlock();
+
+    return true;
+#endif
+}
+
+/* Returns false if the programmer was busy with another client's job */
+static bool prog_armed_program(uint32_t id)
+{
+    uint32_t seq = 0;
+    uint32_t elapsed = 0;
+    bool ok = false;
+    prog_result_t result;
+    prog_err_def err = PROG_ERR_NONE;
+
+    prog_armed_set_state(PROG_ARMED_PROGRAMMING);
+    err = programmer_request_handle(&s_request[0], s_request.size(), &seq);
+
+    if (err == PROG_ERR_BUSY)
+    {
+        prog_armed_set_state(PROG_ARMED_WAITING);
+        return false;
+    }
+
+    memset(&result, 0, sizeof(result));
+    ok = (err == PROG_ERR_NONE) && programmer_wait_result(seq, result) && result.success;
+    elapsed = (result.end_us - result.start_us) / 1000;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_status.state = PROG_ARMED_REMOVAL;
+    s_status.idcode = id;
+    s_status.last_ok = ok;
+    s_status.last_ms = elapsed;
+    if (ok)
+        s_status.passed++;
+    else
+        s_status.failed++;
+    xSemaphoreGive(s_mutex);
+
+    ESP_LOGI(TAG, "Target 0x%08lx %s in %lu ms", (unsigned long)id, ok ? "programmed" : "failed", (unsigned long)elapsed);
+
+    return true;
+}
+
+static void prog_armed_task(void *pvParameters)
+{
+    int hits = 0;
+    uint32_t id = 0;
+    bool present = false;
+    prog_armed_cmd_def cmd = PROG_ARMED_CMD_DISARM;
+    prog_armed_state_def state = PROG_ARMED_OFF;
+
+    for (;;)
+    {
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        state = s_status.state;
+        xSemaphoreGive(s_mutex);
+
+        if (xQueueReceive(s_cmd_queue, &cmd, (state == PROG_ARMED_OFF) ? portMAX_DELAY : pdMS_TO_TICKS(CONFIG_PROGRAMMER_ARMED_POLL_MS)) == pdTRUE)
+        {
+            prog_armed_unload();
+            hits = 0;
+
+            xSemaphoreTake(s_mutex, portMAX_DELAY);
+            s_status.state = PROG_ARMED_OFF;
+            s_status.preloaded = false;
+            xSemaphoreGive(s_mutex);
+
+            if (cmd != PROG_ARMED_CMD_ARM)
+                continue;
+
+            xSemaphoreTake(s_mutex, portMAX_DELAY);
+            s_request = s_pending;
+            s_status.state = PROG_ARMED_LOADING;
+            s_status.passed = 0;
+            s_status.failed = 0;
+            xSemaphoreGive(s_mutex);
+
+            if (prog_armed_load())
+            {
+                /* A target already in the fixture is programmed right away */
+                xSemaphoreTake(s_mutex, portMAX_DELAY);
+                s_status.state = PROG_ARMED_WAITING;
+                s_status.preloaded = (s_preload.data != nullptr);
+                xSemaphoreGive(s_mutex);
+                ESP_LOGI(TAG, "Armed");
+            }
+            else
+            {
+                prog_armed_unload();
+                prog_armed_set_state(PROG_ARMED_OFF);
+                ESP_LOGE(TAG, "Failed to arm");
+            }
+
+            continue;
+        }
+
+        if ((state == PROG_ARMED_OFF) || !prog_armed_poll(present, id))
+            continue;
+
+        /* Insertions and removals must be seen on consecutive polls, contacts bounce while a board is seated */
+        hits = (present == (state == PROG_ARMED_WAITING)) ? (hits + 1) : 0;
+        if (hits < CONFIG_PROGRAMMER_ARMED_DEBOUNCE)
+            continue;
+
+        hits = 0;
+
+        if (state == PROG_ARMED_REMOVAL)
+            prog_armed_set_state(PROG_ARMED_WAITING);
+        else
+            prog_armed_program(id);
+    }
+}
+
+static bool prog_armed_save(const char *buf, int len)
+{
+    bool ret = false;
+    FILE *fp = fopen(CONFIG_PROGRAMMER_ARMED_FILE, "w");
+
+    if (fp)
+    {
+        ret = (fwrite(buf, 1, len, fp) == (size_t)len);
+        fclose(fp);
+    }
+
+    return ret;
+}
+
+static void prog_armed_restore(void)
+{
+    long len = 0;
+    std::string buf;
+    FILE *fp = fopen(CONFIG_PROGRAMMER_ARMED_FILE, "r");
+
+    if (!fp)
+        return;
+
+    if ((fseek(fp, 0, SEEK_END) == 0) && ((len = ftell(fp)) > 0))
+    {
+        buf.resize(len);
+        rewind(fp);
+        len = fread(&buf[0], 1, len, fp);
+    }
+
+    fclose(fp);
+
+    if ((len > 0) && (prog_armed_arm(buf.c_str(), len) != PROG_ERR_NONE))
+        ESP_LOGW(TAG, "Saved request is no longer valid, not armed");
+}
+
+bool prog_armed_init(void)
+{
+    if (s_cmd_queue)
+        return true;
+
+    s_mutex = xSemaphoreCreateMutex();
+    s_cmd_queue = xQueueCreate(4, sizeof(prog_armed_cmd_def));
+
+    if (!s_mutex || !s_cmd_queue)
+    {
+        ESP_LOGE(TAG, "Memory not enough");
+        return false;
+    }
+
+#if CONFIG_PROGRAMMER_ARMED_TRIGGER_GPIO >= 0
+    gpio_config_t io_conf = {};
+    io_conf.pin_bit_mask = 1ULL << CONFIG_PROGRAMMER_ARMED_TRIGGER_GPIO;
+    io_conf.mode = GPIO_MODE_INPUT;
+    io_conf.pull_up_en = GPIO_PULLUP_ENABLE;
+    gpio_config(&io_conf);
+#endif
+
+    memset(&s_status, 0, sizeof(s_status));
+
+    if (xTaskCreate(prog_armed_task, "prog_armed", 1024 * 4, nullptr, 2, nullptr) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to create armed task");
+        return false;
+    }
+
+    prog_armed_restore();
+
+    return true;
+}
+
+prog_err_def prog_armed_arm(const char *buf, int len)
+{
+    std::string json(buf, len);
+    prog_req_t request;
+    prog_err_def err = PROG_ERR_NONE;
+    prog_armed_cmd_def cmd = PROG_ARMED_CMD_ARM;
+
+    if (!s_cmd_queue)
+        return PROG_ERR_INVALID_OPERATION;
+
+    err = ProgData::request_decode(request, &json[0], len);
+    if ((err == PROG_ERR_NONE) && (request.mode != PROG_OFFLINE_MODE))
+        err = PROG_ERR_MODE_INVALID;
+
+    if (err != PROG_ERR_NONE)
+        return err;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_pending = json;
+    xSemaphoreGive(s_mutex);
+
+    if (!prog_armed_save(buf, len))
+        ESP_LOGW(TAG, "Failed to save the request, it is lost on reboot");
+
+    xQueueSend(s_cmd_queue, &cmd, portMAX_DELAY);
+
+    return PROG_ERR_NONE;
+}
+
+void prog_armed_disarm(void)
+{
+    prog_armed_cmd_def cmd = PROG_ARMED_CMD_DISARM;
+
+    if (!s_cmd_queue)
+        return;
+
+    remove(CONFIG_PROGRAMMER_ARMED_FILE);
+    xQueueSend(s_cmd_queue, &cmd, portMAX_DELAY);
+}
+
+void prog_armed_get_status(char *buf, int size, int &encode_len)
+{
+    prog_armed_status_t status;
+
+    memset(&status, 0, sizeof(status));
+
+    if (s_mutex)
+    {
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        status = s_status;
+        xSemaphoreGive(s_mutex);
+    }
+
+    encode_len = snprintf(buf, size, "{\"state\":\"%s\",\"idcode\":\"0x%08lx\",\"passed\":%lu,\"failed\":%lu,\"last_ok\":%s,\"last_ms\":%lu,\"preloaded\":%s}",
+                          s_state_names[status.state], (unsigned long)status.idcode, (unsigned long)status.passed,
+                          (unsigned long)status.failed, status.last_ok ? "true" : "false", (unsigned long)status.last_ms,
+                          status.preloaded ? "true" : "false");
+}
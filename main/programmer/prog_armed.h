@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add armed auto-programming mode
+ */
+#pragma once
+
+#include "programmer/prog_data.h"
+
+/**
+ * @file prog_armed.h
+ * @brief Armed auto-programming mode
+ *
+ * Once armed with an offline request, the flash algorithm is extracted and
+ * the program is read into PSRAM a single time. Target insertion is then
+ * detected by polling DP IDCODE over SWD, or by a button on
+ * CONFIG_PROGRAMMER_ARMED_TRIGGER_GPIO, and each new target is programmed
+ * from the preloaded data without any further request. After a target is
+ * programmed it has to be removed, or the button released, before the next
+ * one is accepted.
+ *
+ * The armed request is saved to CONFIG_PROGRAMMER_ARMED_FILE, the probe
+ * arms itself again after a reboot.
+ */
+
+/**
+ * @brief Armed mode states
+ */
+typedef enum
+{
+    PROG_ARMED_OFF,             ///< Not armed
+    PROG_ARMED_LOADING,         ///< Extracting the algorithm and reading the program
+    PROG_ARMED_WAITING,         ///< Waiting for a target
+    PROG_ARMED_PROGRAMMING,     ///< Programming a target
+    PROG_ARMED_REMOVAL          ///< Waiting for the programmed target to be removed
+} prog_armed_state_def;
+
+/**
+ * @brief Start the armed mode task, arms again if a request was saved
+ * @return true on success
+ */
+bool prog_armed_init(void);
+
+/**
+ * @brief Arm with an offline request
+ *
+ * Replaces the current request, if any. The request is checked here, the
+ * preloading is done by the armed mode task.
+ *
+ * @param buf JSON request buffer
+ * @param len Buffer length
+ * @return Error code
+ */
+prog_err_def prog_armed_arm(const char *buf, int len);
+
+/**
+ * @brief Disarm, a target being programmed is finished first
+ */
+void prog_armed_disarm(void);
+
+/**
+ * @brief Get the armed mode status
+ * @param buf Output buffer
+ * @param size Buffer size
+ * @param encode_len Output: encoded length
+ */
+void prog_armed_get_status(char *buf, int size, int &encode_len);
@@ -3,12 +3,14 @@
 #include "esp_log.h"
 #include <cstring>
 #include "file_programmer.h"
+#include "disk/image_store.h"
+#include "esp_timer.h"
 
 #define TAG "prog_data"
 #define MSG_BUF_SIZE 512
 
 ProgData::ProgData()
-    : _busy(false), _progress(0), _event_queue(nullptr)
+    : _busy(false), _progress(0), _event_queue(nullptr), _preload(nullptr), _status_changed_cb(nullptr)
 {
 }
 
@@ -30,6 +32,8 @@ void ProgData::init()
     _msg_buf = xMessageBufferCreate(MSG_BUF_SIZE);
     _event_queue = xQueueCreate(10, sizeof(prog_evt_def));
     _sync_sig = xSemaphoreCreateBinary();
+    _done_sig = xSemaphoreCreateBinary();
+    memset(&_result, 0, sizeof(_result));
     _timer = xTimerCreate("prog_timer", pdMS_TO_TICKS(10000), pdTRUE, this, program_timeout);
 }
 
@@ -69,9 +73,33 @@ void ProgData::write_msg(uint8_t *msg, size_t len)
 
 void ProgData::set_busy_state(bool state)
 {
+    bool changed = false;
+    int progress = 0;
+
     xSemaphoreTake(_mutex, portMAX_DELAY);
+    changed = (_busy != state);
     _busy = state;
+    progress = _progress;
+
+    /* A job starts and ends with the busy state */
+    if (changed && state)
+    {
+        uint32_t seq = _result.seq + 1;
+
+        memset(&_result, 0, sizeof(_result));
+        _result.seq = seq;
+        _result.start_us = esp_timer_get_time();
+    }
+    else if (changed)
+    {
+        _result.end_us = esp_timer_get_time();
+        xSemaphoreGive(_done_sig);
+    }
+
     xSemaphoreGive(_mutex);
+
+    if (changed && _status_changed_cb)
+        _status_changed_cb(progress, state);
 }
 
 bool ProgData::is_busy(void)
@@ -87,9 +115,17 @@ bool ProgData::is_busy(void)
 
 void ProgData::set_progress(int progress)
 {
+    bool changed = false;
+    bool busy = false;
+
     xSemaphoreTake(_mutex, portMAX_DELAY);
+    changed = (_progress != progress);
     _progress = progress;
+    busy = _busy;
     xSemaphoreGive(_mutex);
+
+    if (changed && _status_changed_cb)
+        _status_changed_cb(progress, busy);
 }
 
 int ProgData::get_progress(void)
@@ -103,6 +139,60 @@ int ProgData::get_progress(void)
     return ret;
 }
 
+void ProgData::register_status_changed_callback(const status_changed_cb_t &func)
+{
+    _status_changed_cb = func;
+}
+
+void ProgData::set_result(const prog_result_t &result)
+{
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    _result.success = result.success;
+    _result.extract = result.extract;
+    memcpy(_result.phases, result.phases, sizeof(_result.phases));
+    xSemaphoreGive(_mutex);
+}
+
+void ProgData::get_result(prog_result_t &result)
+{
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    result = _result;
+    xSemaphoreGive(_mutex);
+}
+
+bool ProgData::wait_done(uint32_t timeout)
+{
+    return (pdTRUE == xSemaphoreTake(_done_sig, (timeout != portMAX_DELAY) ? (pdMS_TO_TICKS(timeout)) : (portMAX_DELAY)));
+}
+
+bool ProgData::set_preload(const prog_preload_t *preload)
+{
+    bool ret = false;
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+
+    if (!_busy)
+    {
+        _preload = preload;
+        ret = true;
+    }
+
+    xSemaphoreGive(_mutex);
+
+    return ret;
+}
+
+const prog_preload_t *ProgData::get_preload(void)
+{
+    const prog_preload_t *ret = nullptr;
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    ret = _preload;
+    xSemaphoreGive(_mutex);
+
+    return ret;
+}
+
 void ProgData::set_swap(void *swap)
 {
     _swap = swap;
@@ -157,9 +247,12 @@ prog_err_def ProgData::request_decode(prog_req_t &request, char *buf, int len)
     cJSON *flash_addr_item = NULL;
     cJSON *algorithm_item = NULL;
     cJSON *program_item = NULL;
+    cJSON *image_item = NULL;
     cJSON *program_mode_item = NULL;
     cJSON *format_item = NULL;
     cJSON *total_size_item = NULL;
+    image_store_entry_t image;
+    const char *program_name = NULL;
 
     root = cJSON_Parse(buf);
     if (!root)
@@ -169,6 +262,7 @@ prog_err_def ProgData::request_decode(prog_req_t &request, char *buf, int len)
     }
 
     request.program.clear();
+    request.image.clear();
     request.algorithm.clear();
     request.flash_addr = 0;
     request.total_size = 0;
@@ -179,6 +273,7 @@ prog_err_def ProgData::request_decode(prog_req_t &request, char *buf, int len)
     ram_addr_item = cJSON_GetObjectItem(root, "ram_addr");
     flash_addr_item = cJSON_GetObjectItem(root, "flash_addr");
     program_item = cJSON_GetObjectItem(root, "program");
+    image_item = cJSON_GetObjectItem(root, "image");
     algorithm_item = cJSON_GetObjectItem(root, "algorithm");
     format_item = cJSON_GetObjectItem(root, "format");
     total_size_item = cJSON_GetObjectItem(root, "total_size");
@@ -189,6 +284,9 @@ prog_err_def ProgData::request_decode(prog_req_t &request, char *buf, int len)
     if (program_item && program_item->type == cJSON_String)
         request.program = std::string(CONFIG_PROGRAMMER_PROGRAM_ROOT) + "/" + std::string(program_item->valuestring);
 
+    if (image_item && image_item->type == cJSON_String)
+        request.image = image_item->valuestring;
+
     if (flash_addr_item && (flash_addr_item->type == cJSON_Number))
         request.flash_addr = flash_addr_item->valueint;
 
@@ -214,6 +312,8 @@ prog_err_def ProgData::request_decode(prog_req_t &request, char *buf, int len)
             request.format = PROG_BIN_FORMAT;
     }
 
+    program_name = request.program.c_str();
+
     if (request.mode == PROG_UNKNOWN_MODE)
     {
         ESP_LOGE(TAG, "Invalid program mode");
@@ -228,14 +328,25 @@ prog_err_def ProgData::request_decode(prog_req_t &request, char *buf, int len)
         return PROG_ERR_ALGORITHM_NOT_EXIST;
     }
 
-    if ((request.mode == PROG_OFFLINE_MODE) && (request.program.empty() || !FileProgrammer::is_exist(request.program.c_str())))
+    if ((request.mode == PROG_OFFLINE_MODE) && !request.image.empty())
+    {
+        if (!image_store_find(request.image.c_str(), &image))
+        {
+            ESP_LOGE(TAG, "Image is not exist");
+            cJSON_Delete(root);
+            return PROG_ERR_PROGRAM_NOT_EXIST;
+        }
+
+        program_name = image.name;
+    }
+    else if ((request.mode == PROG_OFFLINE_MODE) && (request.program.empty() || !FileProgrammer::is_exist(request.program.c_str())))
     {
         ESP_LOGE(TAG, "Program is not exist");
         cJSON_Delete(root);
         return PROG_ERR_PROGRAM_NOT_EXIST;
     }
 
-    if (FileProgrammer::compare_extension(request.program.c_str(), ".bin") && (request.flash_addr == 0))
+    if (FileProgrammer::compare_extension(program_name, ".bin") && (request.flash_addr == 0))
     {
         ESP_LOGE(TAG, "The programming address must be provided for programming with binary files.");
         cJSON_Delete(root);
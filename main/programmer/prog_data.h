@@ -7,6 +7,11 @@
  * Date           Author       Notes
  * 2023-9-8      lihongquan   Initial version
  * 2026-3-16     Refactor     Improved documentation and structure
+ * 2026-10-19    hongquan.li   publish status changes
+ * 2026-10-19    hongquan.li   program images from the image store
+ * 2026-10-19    hongquan.li   record job results and phase timing
+ * 2026-10-19    hongquan.li   accept a preloaded algorithm and image
+ * 2026-10-19    hongquan.li   drop a preload whose files changed
  */
 #pragma once
 
@@ -17,6 +22,8 @@
 #include "freertos/semphr.h"
 #include "freertos/message_buffer.h"
 #include "algo_extractor.h"
+#include <functional>
+#include <ctime>
 
 /**
  * @file prog_data.h
@@ -89,8 +96,47 @@ typedef struct
     uint32_t total_size;        ///< Total data size
     std::string algorithm;      ///< Algorithm file path
     std::string program;        ///< Program file path (offline mode)
+    std::string image;          ///< Image store SHA-256, used instead of program when set (offline mode)
 } prog_req_t;
 
+/**
+ * @brief Outcome and timing of a programming job
+ */
+typedef struct
+{
+    uint32_t seq;                   ///< Job sequence number, increases with every accepted request
+    bool success;                   ///< Set by offline jobs that programmed the target
+    int64_t start_us;               ///< esp_timer time the job was accepted
+    int64_t end_us;                 ///< esp_timer time the job finished, 0 while running
+    FlashIface::phase_time_t extract;                        ///< Flash algorithm extraction
+    FlashIface::phase_time_t phases[FlashIface::PHASE_COUNT]; ///< Target flash phases
+} prog_result_t;
+
+/**
+ * @brief Algorithm and image loaded ahead of the jobs that use them
+ *
+ * Offline jobs whose algorithm and ram_addr match use target and cfg
+ * instead of extracting the algorithm again, if the program matches too
+ * the image is programmed from data instead of being read again. A file
+ * whose size or modification time no longer matches was replaced by an
+ * upload or over USB and is read again. data holds the file as stored,
+ * a HEX program is still decoded for every job.
+ */
+typedef struct
+{
+    std::string algorithm;                  ///< Algorithm path, as in prog_req_t
+    uint32_t algorithm_size;                ///< Algorithm file size when extracted
+    time_t algorithm_mtime;                 ///< Algorithm file modification time when extracted
+    uint32_t ram_addr;                      ///< RAM address the algorithm was extracted for
+    std::string program;                    ///< Program path or image hash, as in prog_req_t
+    std::string name;                       ///< Program file name, selects the format
+    const uint8_t *data;                    ///< Program contents, nullptr if not loaded
+    uint32_t size;                          ///< Program size
+    time_t mtime;                           ///< Program file modification time, 0 for a stored image
+    FlashIface::program_target_t *target;   ///< Extracted algorithm
+    FlashIface::target_cfg_t *cfg;          ///< Extracted target configuration
+} prog_preload_t;
+
 /**
  * @brief Request data swap structure
  */
@@ -117,6 +163,9 @@ typedef struct
  */
 class ProgData
 {
+public:
+    using status_changed_cb_t = std::function<void(int progress, bool busy)>;
+
 private:
     bool _busy;                         ///< Busy flag
     int _progress;                      ///< Programming progress (0-100)
@@ -126,7 +175,11 @@ private:
     SemaphoreHandle_t _mutex;           ///< Mutex for thread safety
     QueueHandle_t _event_queue;         ///< Event queue
     SemaphoreHandle_t _sync_sig;        ///< Synchronization signal
+    SemaphoreHandle_t _done_sig;        ///< Given each time a job finishes
+    prog_result_t _result;              ///< Result of the running or last job
+    const prog_preload_t *_preload;     ///< Preloaded algorithm and image, may be nullptr
     MessageBufferHandle_t _msg_buf;     ///< Message buffer for streaming data
+    status_changed_cb_t _status_changed_cb; ///< Status change callback
 
     AlgoExtractor _extractor;           ///< Algorithm extractor
     FlashIface::target_cfg_t _cfg;      ///< Target configuration
@@ -208,6 +261,56 @@ public:
      */
     int get_progress(void);
     
+    /**
+     * @brief Register status change callback
+     *
+     * Called from the setting task, outside of the data mutex, whenever the
+     * progress or the busy state actually changes.
+     *
+     * @param func Callback function
+     */
+    void register_status_changed_callback(const status_changed_cb_t &func);
+    
+    /**
+     * @brief Store the outcome of the running job
+     *
+     * The sequence number and the start and end times are kept, they are
+     * maintained by set_busy_state().
+     *
+     * @param result Result
+     */
+    void set_result(const prog_result_t &result);
+
+    /**
+     * @brief Get the result of the running or last job
+     * @param result Output result
+     */
+    void get_result(prog_result_t &result);
+
+    /**
+     * @brief Wait until a job finishes
+     * @param timeout Timeout in ms
+     * @return true if a job finished within the timeout
+     */
+    bool wait_done(uint32_t timeout = 0xFFFFFFFF);
+
+    /**
+     * @brief Set the preloaded algorithm and image
+     *
+     * Refused while a job runs, so a job never sees the preload change or
+     * disappear under it.
+     *
+     * @param preload Preload, nullptr to remove it, must stay valid until removed
+     * @return true if the preload was set
+     */
+    bool set_preload(const prog_preload_t *preload);
+
+    /**
+     * @brief Get the preloaded algorithm and image
+     * @return Preload, nullptr if none
+     */
+    const prog_preload_t *get_preload(void);
+
     /**
      * @brief Set swap data
      * @param swap Swap data pointer
@@ -1,4 +1,5 @@
 #include "programmer/prog_idle.h"
+#include "dap_arbiter.h"
 
 #define TAG "prog_idle"
 
@@ -10,6 +11,13 @@ void ProgIdle::request_handle(ProgData &obj)
 
     /* Parses the request and checks the legitimacy of the parameters */
     ret = obj.request_decode(request, swap->data, swap->len);
+
+    /* A host, GDB or USB/IP session owning the debug port is never interrupted */
+    if ((ret == PROG_ERR_NONE) && !dap_arbiter_try_claim(DAP_SESSION_PROGRAMMER))
+    {
+        ret = PROG_ERR_BUSY;
+    }
+
     /* Pass the result to the http thread via swap */
     obj.set_swap(reinterpret_cast<void *>(ret));
 
@@ -2,6 +2,10 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "flash_accessor.h"
+#include <cstring>
+#include <sys/stat.h>
 
 #define TAG "prog_offline"
 
@@ -13,26 +17,217 @@ ProgOffline::ProgOffline()
 {
 }
 
+bool ProgOffline::program_image(ProgData &obj, const image_store_entry_t &image, FlashIface::target_cfg_t &cfg, uint32_t program_addr)
+{
+    uint32_t offset = 0;
+    uint32_t len = 0;
+    ProgramIface *iface = nullptr;
+
+    if (FileProgrammer::compare_extension(image.name, ".hex"))
+        iface = &_hex_program;
+    else if (FileProgrammer::compare_extension(image.name, ".bin"))
+        iface = &_bin_program;
+
+    if (!iface)
+    {
+        ESP_LOGE(TAG, "Unsupported image format: %s", image.name);
+        return false;
+    }
+
+    obj.set_progress(0);
+
+    if (!iface->init(cfg, program_addr))
+        return false;
+
+    while (offset < image.size)
+    {
+#ifdef CONFIG_IMAGE_STORE_MMAP
+        const void *ptr = nullptr;
+        esp_partition_mmap_handle_t handle;
+        bool ret = false;
+
+        /* Map a window and let the flash accessor program whole pages from it, no copy on the way */
+        len = ((image.size - offset) > _map_size) ? _map_size : (image.size - offset);
+        if (image_store_mmap(&image, offset, len, &ptr, &handle) == ESP_OK)
+        {
+            /* The programmers only read the data, the write interface is not const for historical reasons */
+            ret = iface->write(const_cast<uint8_t *>(static_cast<const uint8_t *>(ptr)), len);
+            image_store_munmap(handle);
+        }
+
+        if (!ret)
+#else
+        len = ((image.size - offset) > sizeof(_buffer)) ? sizeof(_buffer) : (image.size - offset);
+
+        if ((image_store_read(&image, offset, _buffer, len) != ESP_OK) || !iface->write(_buffer, len))
+#endif
+        {
+            ESP_LOGE(TAG, "Failed to write at address: 0x%lx", (unsigned long)iface->get_program_address());
+            iface->clean();
+            return false;
+        }
+
+        offset += len;
+        obj.set_progress(offset * 100 / image.size);
+    }
+
+    /* The last page is only written by the flush in clean() */
+    if (!iface->clean())
+    {
+        ESP_LOGE(TAG, "Failed to flush at address: 0x%lx", (unsigned long)iface->get_program_address());
+        return false;
+    }
+
+    obj.set_progress(100);
+
+    return true;
+}
+
+bool ProgOffline::program_buffer(ProgData &obj, const char *name, const uint8_t *data, uint32_t size, FlashIface::target_cfg_t &cfg, uint32_t program_addr)
+{
+    uint32_t offset = 0;
+    uint32_t len = 0;
+    ProgramIface *iface = nullptr;
+
+    if (FileProgrammer::compare_extension(name, ".hex"))
+        iface = &_hex_program;
+    else if (FileProgrammer::compare_extension(name, ".bin"))
+        iface = &_bin_program;
+
+    if (!iface)
+    {
+        ESP_LOGE(TAG, "Unsupported image format: %s", name);
+        return false;
+    }
+
+    obj.set_progress(0);
+
+    if (!iface->init(cfg, program_addr))
+        return false;
+
+    /* Written in windows only so the progress moves, the data is used in place */
+    while (offset < size)
+    {
+        len = ((size - offset) > _map_size) ? _map_size : (size - offset);
+
+        if (!iface->write(const_cast<uint8_t *>(data + offset), len))
+        {
+            ESP_LOGE(TAG, "Failed to write at address: 0x%lx", (unsigned long)iface->get_program_address());
+            iface->clean();
+            return false;
+        }
+
+        offset += len;
+        obj.set_progress(offset * 100 / size);
+    }
+
+    /* The last page is only written by the flush in clean() */
+    if (!iface->clean())
+    {
+        ESP_LOGE(TAG, "Failed to flush at address: 0x%lx", (unsigned long)iface->get_program_address());
+        return false;
+    }
+
+    obj.set_progress(100);
+
+    return true;
+}
+
+bool ProgOffline::file_unchanged(const std::string &path, uint32_t size, time_t mtime)
+{
+    struct stat st;
+
+    if ((stat(path.c_str(), &st) != 0) || ((uint32_t)st.st_size != size) || (st.st_mtime != mtime))
+    {
+        ESP_LOGW(TAG, "%s changed since it was preloaded", path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
 void ProgOffline::program_start_handle(ProgData &obj)
 {
     TickType_t start_time = 0;
     prog_req_t &request = obj.get_request();
     FlashIface::program_target_t *target = nullptr;
     FlashIface::target_cfg_t *cfg = nullptr;
+    image_store_entry_t image;
+    bool ret = false;
+    bool warm = false;
+    uint32_t elapsed = 0;
+    uint32_t size = 0;
+    prog_result_t result;
+    FlashAccessor &accessor = FlashAccessor::get_instance();
+    const prog_preload_t *preload = obj.get_preload();
+    const std::string &program = request.image.empty() ? request.program : request.image;
 
     _file_program.register_progress_changed_callback(std::bind(&ProgData::set_progress, &obj, std::placeholders::_1));
-    ESP_LOGI(TAG, "file: %s", request.program.c_str());
 
-    if (obj.get_algorithm(request.algorithm, &target, &cfg, request.ram_addr))
+    if (!request.image.empty())
+        ESP_LOGI(TAG, "image: %s", request.image.c_str());
+    else
+        ESP_LOGI(TAG, "file: %s", request.program.c_str());
+
+    memset(&result, 0, sizeof(result));
+    accessor.clear_phase_times();
+    result.extract.start_us = esp_timer_get_time();
+
+    /* The preload cannot change while this job keeps the programmer busy, the files under it can */
+    warm = preload && (preload->algorithm == request.algorithm) && (preload->ram_addr == request.ram_addr) &&
+           file_unchanged(request.algorithm, preload->algorithm_size, preload->algorithm_mtime);
+
+    if (warm)
+    {
+        target = preload->target;
+        cfg = preload->cfg;
+    }
+
+    ret = warm || obj.get_algorithm(request.algorithm, &target, &cfg, request.ram_addr);
+
+    /* Recorded for a failed extraction too, it is the only phase such a job has */
+    result.extract.total_us = esp_timer_get_time() - result.extract.start_us;
+    result.extract.count = warm ? 0 : 1;
+
+    if (ret)
     {
         start_time = xTaskGetTickCount();
-        if (_file_program.program(request.program, *cfg, request.flash_addr))
-            ESP_LOGI(TAG, "Elapsed time %ld ms", pdTICKS_TO_MS(xTaskGetTickCount() - start_time));
+
+        /* A stored image is addressed by its hash and cannot change */
+        if (warm && preload->data && (preload->program == program) &&
+            (!request.image.empty() || file_unchanged(request.program, preload->size, preload->mtime)))
+        {
+            size = preload->size;
+            ret = program_buffer(obj, preload->name.c_str(), preload->data, size, *cfg, request.flash_addr);
+        }
+        else if (!request.image.empty())
+        {
+            ret = image_store_find(request.image.c_str(), &image) && program_image(obj, image, *cfg, request.flash_addr);
+            size = image.size;
+        }
+        else
+        {
+            ret = _file_program.program(request.program, *cfg, request.flash_addr);
+        }
+
+        elapsed = pdTICKS_TO_MS(xTaskGetTickCount() - start_time);
+
+        if (ret && size && elapsed)
+            ESP_LOGI(TAG, "Elapsed time %lu ms, %lu bytes, %lu KB/s", (unsigned long)elapsed, (unsigned long)size,
+                     (unsigned long)((uint64_t)size * 1000 / 1024 / elapsed));
+        else if (ret)
+            ESP_LOGI(TAG, "Elapsed time %lu ms", (unsigned long)elapsed);
         else
             ESP_LOGE(TAG, "Program failed");
-        obj.clean_algorithm();
+
+        if (!warm)
+            obj.clean_algorithm();
     }
 
+    result.success = ret;
+    memcpy(result.phases, accessor.get_phase_times(), sizeof(result.phases));
+    obj.set_result(result);
+
     Prog::switch_mode(PROG_IDLE_MODE);
     obj.set_busy_state(false);
 }
@@ -7,6 +7,10 @@
  * Date           Author       Notes
  * 2023-9-8      lihongquan   Initial version
  * 2026-3-16     Refactor     Improved documentation
+ * 2026-10-19    hongquan.li   program images from the image store
+ * 2026-10-19    hongquan.li   program stored images from mapped flash
+ * 2026-10-19    hongquan.li   program from a preloaded algorithm and image
+ * 2026-10-19    hongquan.li   check preloaded files for changes
  */
 #pragma once
 
@@ -14,6 +18,7 @@
 #include "bin_program.h"
 #include "hex_program.h"
 #include "file_programmer.h"
+#include "disk/image_store.h"
 
 /**
  * @file prog_offline.h
@@ -38,6 +43,41 @@ protected:
 private:
     FileProgrammer _file_program;         ///< File programmer
 
+    static constexpr int _buf_size = 1024; ///< Buffer size for image reading
+    static constexpr uint32_t _map_size = 0x10000; ///< Image window mapped at a time
+    uint8_t _buffer[_buf_size];            ///< Image read buffer
+
+    /**
+     * @brief Program an image from the image store
+     * @param obj Programmer data object
+     * @param image Stored image
+     * @param cfg Target flash configuration
+     * @param program_addr Start address for binary images
+     * @return true if programming successful
+     */
+    bool program_image(ProgData &obj, const image_store_entry_t &image, FlashIface::target_cfg_t &cfg, uint32_t program_addr);
+
+    /**
+     * @brief Program an image held in memory
+     * @param obj Programmer data object
+     * @param name File name, selects the format
+     * @param data Image contents
+     * @param size Image size
+     * @param cfg Target flash configuration
+     * @param program_addr Start address for binary images
+     * @return true if programming successful
+     */
+    bool program_buffer(ProgData &obj, const char *name, const uint8_t *data, uint32_t size, FlashIface::target_cfg_t &cfg, uint32_t program_addr);
+
+    /**
+     * @brief Check that a preloaded file was not replaced since
+     * @param path File path
+     * @param size Size when it was preloaded
+     * @param mtime Modification time when it was preloaded
+     * @return true if size and modification time still match
+     */
+    static bool file_unchanged(const std::string &path, uint32_t size, time_t mtime);
+
 public:
     /**
      * @brief Constructor
@@ -45,8 +45,11 @@ void ProgOnline::program_timeout_handle(ProgData &obj)
 {
     if (!_recved_new_packet)
     {
+        obj.clean_algorithm();
         Prog::switch_mode(PROG_IDLE_MODE);
         obj.disable_timeout_timer();
+        obj.set_busy_state(false);
+        _stream_program.clean();
         ESP_LOGE(TAG, "Receive Packet timeout");
     }
 
@@ -56,6 +59,31 @@ void ProgOnline::program_timeout_handle(ProgData &obj)
 void ProgOnline::program_data_handle(ProgData &obj)
 {
     prog_data_swap_t *swap = reinterpret_cast<prog_data_swap_t *>(obj.get_swap());
+    prog_err_def ret = PROG_ERR_NONE;
+
+    /* An empty packet ends a stream whose size was not known up front, the last page is flushed before teardown */
+    if (swap->len == 0)
+    {
+        ret = _stream_program.clean() ? PROG_ERR_NONE : PROG_ERR_PROGRAM_FAILED;
+        Prog::switch_mode(PROG_IDLE_MODE);
+        obj.disable_timeout_timer();
+        obj.set_busy_state(false);
+        obj.clean_algorithm();
+
+        if (ret == PROG_ERR_NONE)
+        {
+            obj.set_progress(100);
+            ESP_LOGI(TAG, "Stream ended at %ld bytes, elapsed time %ld ms", _writed_offset, pdTICKS_TO_MS((xTaskGetTickCount() - _start_time)));
+        }
+        else
+        {
+            ESP_LOGE(TAG, "Flush at end of stream failed");
+        }
+
+        obj.set_swap(reinterpret_cast<void *>(ret));
+        obj.send_sync();
+        return;
+    }
 
     if (!_stream_program.write(swap->data, swap->len))
     {
@@ -77,14 +105,22 @@ void ProgOnline::program_data_handle(ProgData &obj)
             obj.set_progress(_writed_offset * 100 / _total_size);
         else if (_writed_offset == _total_size)
         {
-            obj.clean_algorithm();
+            /* Flush the last page while the algorithm is still loaded */
+            ret = _stream_program.clean() ? PROG_ERR_NONE : PROG_ERR_PROGRAM_FAILED;
             Prog::switch_mode(PROG_IDLE_MODE);
             obj.disable_timeout_timer();
             obj.set_busy_state(false);
             obj.clean_algorithm();
-            obj.set_progress(100);
-            _stream_program.clean();
-            ESP_LOGI(TAG, "Elapsed time %ld ms", pdTICKS_TO_MS((xTaskGetTickCount() - _start_time)));
+
+            if (ret == PROG_ERR_NONE)
+            {
+                obj.set_progress(100);
+                ESP_LOGI(TAG, "Elapsed time %ld ms", pdTICKS_TO_MS((xTaskGetTickCount() - _start_time)));
+            }
+            else
+            {
+                ESP_LOGE(TAG, "Flush at end of image failed");
+            }
         }
         else
         {
@@ -99,7 +135,7 @@ void ProgOnline::program_data_handle(ProgData &obj)
     }
 
     _recved_new_packet = true;
-    obj.set_swap(reinterpret_cast<void *>(PROG_ERR_NONE));
+    obj.set_swap(reinterpret_cast<void *>(ret));
     /* After a successful mode switch, send a synchronisation signal to keep the http server running */
     obj.send_sync();
 }
@@ -0,0 +1,348 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add programming job queue
+ */
+#include "programmer/prog_queue.h"
+#include "programmer/programmer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "cJSON.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#define TAG "prog_queue"
+#define PROG_QUEUE_RETRY_MS 100
+
+static prog_job_t s_jobs[CONFIG_PROGRAMMER_JOB_SLOTS];
+static std::string s_requests[CONFIG_PROGRAMMER_JOB_SLOTS];
+static SemaphoreHandle_t s_mutex = nullptr;
+static SemaphoreHandle_t s_signal = nullptr;
+static uint32_t s_next_id = 1;
+
+static const char *const s_state_names[] = {"free", "queued", "running", "done", "failed", "cancelled"};
+static const char *const s_phase_names[FlashIface::PHASE_COUNT] = {"connect", "algo_download", "erase", "program", "verify", "reset"};
+
+/* Caller holds s_mutex */
+static int prog_queue_find(uint32_t id)
+{
+    for (int i = 0; i < CONFIG_PROGRAMMER_JOB_SLOTS; i++)
+    {
+        if ((s_jobs[i].state != PROG_JOB_FREE) && (s_jobs[i].id == id))
+            return i;
+    }
+
+    return -1;
+}
+
+/* Caller holds s_mutex, a free slot or else the oldest finished job */
+static int prog_queue_alloc(void)
+{
+    int slot = -1;
+
+    for (int i = 0; i < CONFIG_PROGRAMMER_JOB_SLOTS; i++)
+    {
+        if (s_jobs[i].state == PROG_JOB_FREE)
+            return i;
+
+        if ((s_jobs[i].state >= PROG_JOB_DONE) && ((slot < 0) || (s_jobs[i].id < s_jobs[slot].id)))
+            slot = i;
+    }
+
+    return slot;
+}
+
+/* Caller holds s_mutex, the highest priority queued job, the oldest first */
+static int prog_queue_next(void)
+{
+    int slot = -1;
+
+    for (int i = 0; i < CONFIG_PROGRAMMER_JOB_SLOTS; i++)
+    {
+        if (s_jobs[i].state != PROG_JOB_QUEUED)
+            continue;
+
+        if ((slot < 0) || (s_jobs[i].priority > s_jobs[slot].priority) ||
+            ((s_jobs[i].priority == s_jobs[slot].priority) && (s_jobs[i].id < s_jobs[slot].id)))
+            slot = i;
+    }
+
+    return slot;
+}
+
+static void prog_queue_finish(uint32_t id, prog_job_state_def state, prog_err_def err, const prog_result_t *result)
+{
+    int slot = -1;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    slot = prog_queue_find(id);
+    if (slot >= 0)
+    {
+        int64_t start_us = s_jobs[slot].result.start_us;
+
+        s_jobs[slot].state = state;
+        s_jobs[slot].error = err;
+
+        /* Phases are reported relative to the dispatch, including any busy retries */
+        if (result)
+            s_jobs[slot].result = *result;
+
+        s_jobs[slot].result.start_us = start_us;
+        if (!s_jobs[slot].result.end_us)
+            s_jobs[slot].result.end_us = esp_timer_get_time();
+
+        s_requests[slot].clear();
+    }
+
+    xSemaphoreGive(s_mutex);
+}
+
+static void prog_queue_task(void *pvParameters)
+{
+    int slot = -1;
+    uint32_t id = 0;
+    uint32_t seq = 0;
+    bool ok = false;
+    std::string request;
+    prog_result_t result;
+    prog_err_def err = PROG_ERR_NONE;
+
+    for (;;)
+    {
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+        slot = prog_queue_next();
+        if (slot >= 0)
+        {
+            /* Mark it running first so it can no longer be cancelled */
+            s_jobs[slot].state = PROG_JOB_RUNNING;
+
+            /* A job put back while the programmer was busy keeps its first start */
+            if (!s_jobs[slot].result.start_us)
+                s_jobs[slot].result.start_us = esp_timer_get_time();
+
+            id = s_jobs[slot].id;
+            request = s_requests[slot];
+        }
+
+        xSemaphoreGive(s_mutex);
+
+        if (slot < 0)
+        {
+            xSemaphoreTake(s_signal, portMAX_DELAY);
+            continue;
+        }
+
+        err = programmer_request_handle(&request[0], request.size(), &seq);
+
+        /* Another client is programming, the job goes back to the queue */
+        if (err == PROG_ERR_BUSY)
+        {
+            xSemaphoreTake(s_mutex, portMAX_DELAY);
+            slot = prog_queue_find(id);
+            if (slot >= 0)
+                s_jobs[slot].state = PROG_JOB_QUEUED;
+            xSemaphoreGive(s_mutex);
+
+            vTaskDelay(pdMS_TO_TICKS(PROG_QUEUE_RETRY_MS));
+            continue;
+        }
+
+        if (err != PROG_ERR_NONE)
+        {
+            ESP_LOGE(TAG, "Job %lu rejected: %d", (unsigned long)id, err);
+            prog_queue_finish(id, PROG_JOB_FAILED, err, nullptr);
+            continue;
+        }
+
+        ok = programmer_wait_result(seq, result) && result.success;
+        ESP_LOGI(TAG, "Job %lu %s in %lld ms", (unsigned long)id, ok ? "done" : "failed", (long long)((result.end_us - result.start_us) / 1000));
+        prog_queue_finish(id, ok ? PROG_JOB_DONE : PROG_JOB_FAILED, ok ? PROG_ERR_NONE : PROG_ERR_PROGRAM_FAILED, &result);
+    }
+}
+
+static prog_err_def prog_queue_add(cJSON *item, uint32_t &id)
+{
+    int slot = -1;
+    int priority = 0;
+    char *json = nullptr;
+    prog_req_t request;
+    prog_err_def err = PROG_ERR_NONE;
+    cJSON *priority_item = cJSON_GetObjectItem(item, "priority");
+
+    id = 0;
+
+    if (priority_item && (priority_item->type == cJSON_Number))
+        priority = priority_item->valueint;
+
+    json = cJSON_PrintUnformatted(item);
+    if (!json)
+        return PROG_ERR_JSON_FORMAT_INCORRECT;
+
+    /* Checked now so a bad job is refused at submission, and again when it runs */
+    err = ProgData::request_decode(request, json, strlen(json));
+    if ((err == PROG_ERR_NONE) && (request.mode != PROG_OFFLINE_MODE))
+        err = PROG_ERR_MODE_INVALID;
+
+    if (err == PROG_ERR_NONE)
+    {
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+        slot = prog_queue_alloc();
+        if (slot >= 0)
+        {
+            id = s_next_id++;
+            memset(&s_jobs[slot], 0, sizeof(s_jobs[slot]));
+            s_jobs[slot].id = id;
+            s_jobs[slot].priority = priority;
+            s_jobs[slot].state = PROG_JOB_QUEUED;
+            s_jobs[slot].error = PROG_ERR_NONE;
+            s_jobs[slot].submit_us = esp_timer_get_time();
+            s_requests[slot] = json;
+        }
+
+        xSemaphoreGive(s_mutex);
+
+        err = (slot >= 0) ? PROG_ERR_NONE : PROG_ERR_BUSY;
+    }
+
+    cJSON_free(json);
+
+    return err;
+}
+
+bool prog_queue_init(void)
+{
+    if (s_mutex)
+        return true;
+
+    s_mutex = xSemaphoreCreateMutex();
+    s_signal = xSemaphoreCreateBinary();
+
+    if (!s_mutex || !s_signal)
+    {
+        ESP_LOGE(TAG, "Memory not enough");
+        return false;
+    }
+
+    return (xTaskCreate(prog_queue_task, "prog_queue", 1024 * 4, nullptr, 2, nullptr) == pdPASS);
+}
+
+prog_err_def prog_queue_submit(const char *buf, void (*cb)(uint32_t id, prog_err_def err, void *arg), void *arg)
+{
+    uint32_t id = 0;
+    prog_err_def err = PROG_ERR_NONE;
+    cJSON *root = nullptr;
+    cJSON *jobs = nullptr;
+    cJSON *item = nullptr;
+
+    if (!s_mutex)
+        return PROG_ERR_INVALID_OPERATION;
+
+    root = cJSON_Parse(buf);
+    if (!root)
+        return PROG_ERR_JSON_FORMAT_INCORRECT;
+
+    jobs = cJSON_IsArray(root) ? root : cJSON_GetObjectItem(root, "jobs");
+
+    if (jobs && cJSON_IsArray(jobs))
+    {
+        cJSON_ArrayForEach(item, jobs)
+        {
+            err = prog_queue_add(item, id);
+            cb(id, err, arg);
+        }
+    }
+    else
+    {
+        err = prog_queue_add(root, id);
+        cb(id, err, arg);
+    }
+
+    cJSON_Delete(root);
+    xSemaphoreGive(s_signal);
+
+    return PROG_ERR_NONE;
+}
+
+bool prog_queue_cancel(uint32_t id)
+{
+    int slot = -1;
+    bool ret = false;
+
+    if (!s_mutex)
+        return false;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    slot = prog_queue_find(id);
+    if ((slot >= 0) && (s_jobs[slot].state == PROG_JOB_QUEUED))
+    {
+        s_jobs[slot].state = PROG_JOB_CANCELLED;
+        s_requests[slot].clear();
+        ret = true;
+    }
+
+    xSemaphoreGive(s_mutex);
+
+    return ret;
+}
+
+int prog_queue_snapshot(prog_job_t *jobs, int max)
+{
+    int num = 0;
+
+    if (!s_mutex)
+        return 0;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    for (int i = 0; (i < CONFIG_PROGRAMMER_JOB_SLOTS) && (num < max); i++)
+    {
+        if (s_jobs[i].state != PROG_JOB_FREE)
+            jobs[num++] = s_jobs[i];
+    }
+
+    xSemaphoreGive(s_mutex);
+
+    std::sort(jobs, jobs + num, [](const prog_job_t &a, const prog_job_t &b) { return a.id < b.id; });
+
+    return num;
+}
+
+int prog_queue_encode(const prog_job_t &job, char *buf, int size)
+{
+    int len = 0;
+    int64_t start = job.result.start_us;
+    const FlashIface::phase_time_t *phase = nullptr;
+
+    len += snprintf(buf + len, size - len,
+                    "{\"id\":%lu,\"priority\":%d,\"state\":\"%s\",\"error\":%d,\"submit_us\":%lld,\"start_us\":%lld,\"end_us\":%lld,\"phases\":{",
+                    (unsigned long)job.id, job.priority, s_state_names[job.state], job.error,
+                    (long long)job.submit_us, (long long)job.result.start_us, (long long)job.result.end_us);
+
+    /* "at" is when the phase was first entered, relative to the job start */
+    phase = &job.result.extract;
+    len += snprintf(buf + len, (len < size) ? (size - len) : 0, "\"extract\":{\"at\":%lld,\"us\":%lld,\"n\":%lu}",
+                    (long long)(phase->count ? (phase->start_us - start) : 0), (long long)phase->total_us, (unsigned long)phase->count);
+
+    for (int i = 0; i < FlashIface::PHASE_COUNT; i++)
+    {
+        phase = &job.result.phases[i];
+        len += snprintf(buf + len, (len < size) ? (size - len) : 0, ",\"%s\":{\"at\":%lld,\"us\":%lld,\"n\":%lu}", s_phase_names[i],
+                        (long long)(phase->count ? (phase->start_us - start) : 0), (long long)phase->total_us, (unsigned long)phase->count);
+    }
+
+    len += snprintf(buf + len, (len < size) ? (size - len) : 0, "}}");
+
+    return (len < size) ? len : (size - 1);
+}
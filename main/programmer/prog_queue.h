@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add programming job queue
+ */
+#pragma once
+
+#include "programmer/prog_data.h"
+
+/**
+ * @file prog_queue.h
+ * @brief Queue of offline programming jobs
+ *
+ * Jobs are submitted in batches and run one after the other by a dispatcher
+ * task, the highest priority first and in submission order within a priority.
+ * Every job keeps its outcome and the time spent in each programming phase,
+ * finished jobs stay queryable until their slot is needed for a new job.
+ * The queue lives in RAM, pending jobs do not survive a reboot.
+ */
+
+/**
+ * @brief Job states
+ */
+typedef enum
+{
+    PROG_JOB_FREE,              ///< Slot unused
+    PROG_JOB_QUEUED,            ///< Waiting for the programmer
+    PROG_JOB_RUNNING,           ///< Being programmed
+    PROG_JOB_DONE,              ///< Programmed successfully
+    PROG_JOB_FAILED,            ///< Rejected or programming failed
+    PROG_JOB_CANCELLED          ///< Removed before it started
+} prog_job_state_def;
+
+/**
+ * @brief Job record
+ */
+typedef struct
+{
+    uint32_t id;                ///< Job id, never reused until reboot
+    int priority;               ///< Higher runs first
+    prog_job_state_def state;   ///< Job state
+    prog_err_def error;         ///< Request error, PROG_ERR_PROGRAM_FAILED if programming failed
+    int64_t submit_us;          ///< esp_timer time of submission
+    prog_result_t result;       ///< Result and phase timing, valid once started
+} prog_job_t;
+
+/**
+ * @brief Start the job dispatcher
+ * @return true on success
+ */
+bool prog_queue_init(void);
+
+/**
+ * @brief Submit jobs
+ *
+ * buf holds one job object, an array of them or {"jobs":[...]}. A job object
+ * is an offline request as accepted by programmer_request_handle() with an
+ * optional integer "priority", default 0.
+ *
+ * @param buf JSON buffer
+ * @param cb Called for each job with its id, 0 if it was refused, and the error
+ * @param arg Callback argument
+ * @return PROG_ERR_NONE if the JSON was parsed, the jobs may still be refused one by one
+ */
+prog_err_def prog_queue_submit(const char *buf, void (*cb)(uint32_t id, prog_err_def err, void *arg), void *arg);
+
+/**
+ * @brief Cancel a queued job
+ * @param id Job id
+ * @return true if the job was queued and is now cancelled
+ */
+bool prog_queue_cancel(uint32_t id);
+
+/**
+ * @brief Copy the job records, oldest first
+ * @param jobs Output array
+ * @param max Array length
+ * @return Number of records copied
+ */
+int prog_queue_snapshot(prog_job_t *jobs, int max);
+
+/**
+ * @brief Encode a job record as JSON
+ *
+ * Phase times are given in microseconds relative to the job start.
+ *
+ * @param job Job record
+ * @param buf Output buffer
+ * @param size Buffer size
+ * @return Encoded length
+ */
+int prog_queue_encode(const prog_job_t &job, char *buf, int size);
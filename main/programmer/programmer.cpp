@@ -5,6 +5,7 @@
 #include "freertos/message_buffer.h"
 #include "algo_extractor.h"
 #include "esp_log.h"
+#include "dap_arbiter.h"
 #include "programmer/prog_idle.h"
 #include "programmer/prog_online.h"
 #include "programmer/prog_offline.h"
@@ -17,9 +18,11 @@ static ProgData s_data;
 static Prog *s_prog = nullptr;
 static Prog *s_last_prog = nullptr;
 
-prog_err_def programmer_request_handle(char *buf, int len)
+prog_err_def programmer_request_handle(char *buf, int len, uint32_t *seq)
 {
     prog_request_swap_t swap = {buf, len};
+    prog_err_def ret = PROG_ERR_NONE;
+    prog_result_t result;
 
     if (s_data.is_busy())
     {
@@ -29,8 +32,35 @@ prog_err_def programmer_request_handle(char *buf, int len)
     s_data.set_swap(&swap);
     s_data.send_event(PROG_EVT_REQUEST);
     s_data.wait_sync();
+    ret = static_cast<prog_err_def>(reinterpret_cast<int>(s_data.get_swap()));
 
-    return static_cast<prog_err_def>(reinterpret_cast<int>(s_data.get_swap()));
+    /* The accepted job keeps the programmer busy, nothing else can have started since */
+    if ((ret == PROG_ERR_NONE) && seq)
+    {
+        s_data.get_result(result);
+        *seq = result.seq;
+    }
+
+    return ret;
+}
+
+bool programmer_wait_result(uint32_t seq, prog_result_t &result, uint32_t timeout)
+{
+    for (;;)
+    {
+        s_data.get_result(result);
+
+        /* A later job may already be running, its result would carry another sequence number */
+        if ((result.seq != seq) || result.end_us)
+        {
+            return (result.seq == seq);
+        }
+
+        if (!s_data.wait_done(timeout))
+        {
+            return false;
+        }
+    }
 }
 
 static void programmer_switch_mode(prog_mode_def mode)
@@ -74,6 +104,9 @@ static void programmer_task(void *pvParameters)
     {
         evt = obj.wait_event();
 
+        /* The programmer drives SWD directly, keep DAP commands from other clients out meanwhile */
+        dap_arbiter_lock();
+
         switch (evt)
         {
         case PROG_EVT_REQUEST:
@@ -91,6 +124,14 @@ static void programmer_task(void *pvParameters)
         default:
             break;
         }
+
+        /* The job claimed the port in ProgIdle::request_handle(), give it back once it is over */
+        if (!obj.is_busy())
+        {
+            dap_arbiter_release(DAP_SESSION_PROGRAMMER);
+        }
+
+        dap_arbiter_unlock();
     }
 }
 
@@ -111,6 +152,21 @@ void programmer_get_status(char *buf, int size, int &encode_len)
     encode_len = snprintf(buf, size, "{\"progress\": %d, \"status\": \"%s\"}", s_data.get_progress(), s_data.is_busy() ? ("busy") : ("idle"));
 }
 
+bool programmer_set_preload(const prog_preload_t *preload)
+{
+    return s_data.set_preload(preload);
+}
+
+bool programmer_is_busy(void)
+{
+    return s_data.is_busy();
+}
+
+void programmer_register_status_callback(void (*cb)(int progress, bool busy))
+{
+    s_data.register_status_changed_callback(cb);
+}
+
 prog_err_def programmer_write_data(uint8_t *data, int len)
 {
     prog_data_swap_t swap = {data, len};
@@ -7,6 +7,10 @@
  * Date           Author       Notes
  * 2023-9-8      lihongquan   Initial version
  * 2026-3-16     Refactor     Improved documentation
+ * 2026-10-19    hongquan.li   add status change notification
+ * 2026-10-19    hongquan.li   allow ending an online stream early
+ * 2026-10-19    hongquan.li   report job results for the job queue
+ * 2026-10-19    hongquan.li   accept a preloaded algorithm and image
  */
 #pragma once
 
@@ -30,9 +34,26 @@ void programmer_init(void);
  * @brief Handle programming request
  * @param buf JSON request buffer
  * @param len Buffer length
+ * @param seq Output: sequence number of the accepted job, may be nullptr
  * @return Error code
  */
-prog_err_def programmer_request_handle(char *buf, int len);
+prog_err_def programmer_request_handle(char *buf, int len, uint32_t *seq = nullptr);
+
+/**
+ * @brief Wait for a job to finish and get its result
+ * @param seq Sequence number returned by programmer_request_handle()
+ * @param result Output: job result
+ * @param timeout Timeout in ms
+ * @return true if the job finished within the timeout
+ */
+bool programmer_wait_result(uint32_t seq, prog_result_t &result, uint32_t timeout = 0xFFFFFFFF);
+
+/**
+ * @brief Set the preloaded algorithm and image used by matching offline jobs
+ * @param preload Preload, nullptr to remove it, must stay valid until removed
+ * @return true if set, false while a job is running
+ */
+bool programmer_set_preload(const prog_preload_t *preload);
 
 /**
  * @brief Get programmer status
@@ -42,10 +63,30 @@ prog_err_def programmer_request_handle(char *buf, int len);
  */
 void programmer_get_status(char *buf, int size, int &encode_len);
 
+/**
+ * @brief Check whether a programming job is running
+ * @return true if busy
+ */
+bool programmer_is_busy(void);
+
 /**
  * @brief Write programming data
+ *
+ * A write of length 0 ends the online job before total_size is reached,
+ * for sources that only learn the image size while streaming.
+ *
  * @param data Data buffer
  * @param len Data length
  * @return Error code
  */
 prog_err_def programmer_write_data(uint8_t *data, int len);
+
+/**
+ * @brief Register programmer status callback
+ *
+ * The callback runs in the programmer task each time the progress or the
+ * busy state changes, it must not block.
+ *
+ * @param cb Callback, receives progress (0-100) and busy state
+ */
+void programmer_register_status_callback(void (*cb)(int progress, bool busy));
@@ -7,18 +7,26 @@
  * Date           Author       Notes
  * 2023-9-8      lihongquan   add license declaration
  * 2026-3-17     refactor     Add deinit/suspend/resume functions
+ * 2026-10-19    hongquan.li   event driven RX with adaptive batching
  */
 
 #include "serial/cdc_uart.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_heap_caps.h"
+#include <sys/param.h>
 #include "esp_log.h"
 #include <stdatomic.h>
 
+#define CDC_UART_EVENT_QUEUE_SIZE 32
+
 typedef struct
 {
     uart_port_t uart;
     cdc_uart_cb_t cb[CDC_UART_HANDLER_NUM];
+    QueueHandle_t event_queue;
+    uint8_t *rx_buf;
     TaskHandle_t task_handle;
     atomic_bool suspended;
     atomic_bool initialized;
@@ -49,9 +57,21 @@ bool cdc_uart_init(uart_port_t uart, gpio_num_t tx_pin, gpio_num_t rx_pin, int b
     }
 
     s_cdc_uart.uart = uart;
-    ret = (ESP_OK == uart_driver_install(s_cdc_uart.uart, 2 * 1024, 2 * 1024, 0, NULL, 0));
+    /* Word aligned so the driver ring buffer copies run at full speed */
+    s_cdc_uart.rx_buf = (uint8_t *)heap_caps_malloc(CONFIG_CDC_UART_RX_BATCH_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_32BIT);
+    if (!s_cdc_uart.rx_buf)
+    {
+        ESP_LOGE(TAG, "Failed to allocate rx buffer");
+        return false;
+    }
+
+    ret = (ESP_OK == uart_driver_install(s_cdc_uart.uart, CONFIG_CDC_UART_RX_BUF_SIZE, 2 * 1024,
+                                         CDC_UART_EVENT_QUEUE_SIZE, &s_cdc_uart.event_queue, 0));
     ret = ret && (ESP_OK == uart_param_config(s_cdc_uart.uart, &uart_config));
     ret = ret && (ESP_OK == uart_set_pin(s_cdc_uart.uart, tx_pin, rx_pin, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));
+    /* UART_DATA is raised when the FIFO reaches the threshold or the line stays idle for the timeout */
+    ret = ret && (ESP_OK == uart_set_rx_full_threshold(s_cdc_uart.uart, CONFIG_CDC_UART_RX_FULL_THRESHOLD));
+    ret = ret && (ESP_OK == uart_set_rx_timeout(s_cdc_uart.uart, CONFIG_CDC_UART_RX_TIMEOUT));
 
     if (ret)
     {
@@ -59,6 +79,11 @@ bool cdc_uart_init(uart_port_t uart, gpio_num_t tx_pin, gpio_num_t rx_pin, int b
         xTaskCreate(cdc_uart_rx_task, "cdc_uart_rx_task", 4096, (void *)&s_cdc_uart, 10, &s_cdc_uart.task_handle);
         atomic_store(&s_cdc_uart.initialized, true);
     }
+    else
+    {
+        heap_caps_free(s_cdc_uart.rx_buf);
+        s_cdc_uart.rx_buf = NULL;
+    }
 
     return ret;
 }
@@ -80,6 +105,8 @@ bool cdc_uart_deinit(void)
 
     // Delete UART driver
     uart_driver_delete(s_cdc_uart.uart);
+    heap_caps_free(s_cdc_uart.rx_buf);
+    s_cdc_uart.rx_buf = NULL;
 
     atomic_store(&s_cdc_uart.initialized, false);
     atomic_store(&s_cdc_uart.suspended, false);
@@ -229,41 +256,103 @@ void cdc_uart_register_rx_handler(cdc_uart_handler_def handler, cdc_uart_rx_call
     s_cdc_uart.cb[handler].usr_data = context;
 }
 
-static void cdc_uart_rx_task(void *param)
+static void cdc_uart_dispatch(uint8_t *data, size_t size)
 {
-#define RX_BUF_SIZE 64
+    for (int i = 0; i < CDC_UART_HANDLER_NUM; i++)
+    {
+        if (s_cdc_uart.cb[i].func)
+        {
+            s_cdc_uart.cb[i].func(s_cdc_uart.cb[i].usr_data, data, size);
+        }
+    }
+}
 
-    int offset = 0;
-    int need = 0;
+static void cdc_uart_rx_task(void *param)
+{
     int read = 0;
-    uint8_t data[RX_BUF_SIZE] = {0};
+    size_t offset = 0;
+    size_t buffered = 0;
+    uart_event_t event;
     cdc_uart_t *cdc_uart = (cdc_uart_t *)param;
+    uint8_t *data = cdc_uart->rx_buf;
 
     for (;;)
     {
-        need = RX_BUF_SIZE - offset;
-        read = uart_read_bytes(cdc_uart->uart, data + offset, need, pdMS_TO_TICKS(5));
-
-        if (read < 0)
+        /* A batch that ended exactly on a FIFO threshold gets no idle event, flush it after one tick */
+        if (xQueueReceive(cdc_uart->event_queue, &event, (offset > 0) ? 1 : portMAX_DELAY) != pdTRUE)
         {
-            ESP_LOGE(TAG, "uart_read_bytes() failed: %d", read);
+            cdc_uart_dispatch(data, offset);
+            offset = 0;
+            continue;
         }
-        else
+
+        switch (event.type)
         {
-            offset += read;
+        case UART_DATA:
+            /* Take everything the driver holds, not only what this event reported */
+            uart_get_buffered_data_len(cdc_uart->uart, &buffered);
 
-            if ((offset == RX_BUF_SIZE) || ((read == 0) && (offset > 0)))
+            while (buffered > 0)
             {
-                for (int i = 0; i < CDC_UART_HANDLER_NUM; i++)
+                read = uart_read_bytes(cdc_uart->uart, data + offset, MIN(buffered, CONFIG_CDC_UART_RX_BATCH_SIZE - offset), 0);
+
+                if (read <= 0)
                 {
-                    if (s_cdc_uart.cb[i].func)
-                    {
-                        s_cdc_uart.cb[i].func(s_cdc_uart.cb[i].usr_data, data, offset);
-                    }
+                    break;
                 }
 
+                offset += read;
+                buffered -= read;
+
+                if (offset == CONFIG_CDC_UART_RX_BATCH_SIZE)
+                {
+                    cdc_uart_dispatch(data, offset);
+                    offset = 0;
+                }
+            }
+
+            /*
+             * The timeout flag means the line went idle: deliver at once so a
+             * few typed characters are not delayed. Under sustained traffic
+             * only FIFO threshold events arrive and data aggregates until at
+             * least half a batch is ready.
+             */
+            if ((offset > 0) && (event.timeout_flag || (offset >= CONFIG_CDC_UART_RX_BATCH_SIZE / 2)))
+            {
+                cdc_uart_dispatch(data, offset);
                 offset = 0;
             }
+            break;
+
+        case UART_FIFO_OVF:
+        case UART_BUFFER_FULL:
+            ESP_LOGW(TAG, "rx overflow (%d), data lost", event.type);
+            if (offset > 0)
+            {
+                cdc_uart_dispatch(data, offset);
+                offset = 0;
+            }
+            uart_flush_input(cdc_uart->uart);
+            xQueueReset(cdc_uart->event_queue);
+            break;
+
+        case UART_PATTERN_DET:
+            /* No pattern is configured, just deliver what has been batched */
+            if (offset > 0)
+            {
+                cdc_uart_dispatch(data, offset);
+                offset = 0;
+            }
+            break;
+
+        case UART_BREAK:
+        case UART_PARITY_ERR:
+        case UART_FRAME_ERR:
+            ESP_LOGD(TAG, "uart event: %d", event.type);
+            break;
+
+        default:
+            break;
         }
     }
-}
\ No newline at end of file
+}
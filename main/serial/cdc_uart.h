@@ -6,6 +6,7 @@
  * Change Logs:
  * Date           Author       Notes
  * 2023-9-8      lihongquan   add license declaration
+ * 2026-10-19    hongquan.li   add TCP bridge handler
  */
 
 #pragma once
@@ -29,6 +30,7 @@ typedef enum
 {
     CDC_UART_USB_HANDLER,
     CDC_UART_WEB_HANDLER,
+    CDC_UART_TCP_HANDLER,
     CDC_UART_HANDLER_NUM
 } cdc_uart_handler_def;
 
@@ -0,0 +1,645 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add raw TCP and RFC2217 serial bridge
+ * 2026-10-19    hongquan.li   only touch the UART while the bridge owns it
+ * 2026-10-19    hongquan.li   send escaped RFC2217 data in one call per chunk
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "lwip/sockets.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "driver/uart.h"
+#include "tcp_listen.h"
+#include "serial/serial_bridge.h"
+#include "serial/serial_manager.h"
+
+#define SERIAL_BRIDGE_PORT_NUM 2
+#define SERIAL_BRIDGE_RX_BUF_SIZE 1024
+#define SERIAL_BRIDGE_SEND_TIMEOUT_MS 100
+#define SERIAL_BRIDGE_TX_BUF_SIZE 512
+
+/* Telnet (RFC854) */
+#define TELNET_SE 240
+#define TELNET_SB 250
+#define TELNET_WILL 251
+#define TELNET_WONT 252
+#define TELNET_DO 253
+#define TELNET_DONT 254
+#define TELNET_IAC 255
+#define TELNET_OPT_BINARY 0
+#define TELNET_OPT_SGA 3
+#define TELNET_OPT_COM_PORT 44
+
+/* COM-PORT-OPTION client commands (RFC2217), the server answers with command + 100 */
+#define RFC2217_SET_BAUDRATE 1
+#define RFC2217_SET_DATASIZE 2
+#define RFC2217_SET_PARITY 3
+#define RFC2217_SET_STOPSIZE 4
+#define RFC2217_SET_CONTROL 5
+#define RFC2217_SET_LINESTATE_MASK 10
+#define RFC2217_SET_MODEMSTATE_MASK 11
+#define RFC2217_PURGE_DATA 12
+#define RFC2217_SERVER_OFFSET 100
+
+typedef enum
+{
+    TELNET_STATE_DATA,      ///< Plain data
+    TELNET_STATE_IAC,       ///< Got IAC
+    TELNET_STATE_OPTION,    ///< Got IAC WILL/WONT/DO/DONT
+    TELNET_STATE_SB,        ///< Inside a subnegotiation
+    TELNET_STATE_SB_IAC     ///< Got IAC inside a subnegotiation
+} telnet_state_t;
+
+typedef struct
+{
+    uint16_t port;          ///< TCP port, 0 if disabled
+    bool rfc2217;           ///< Telnet framing with COM-PORT-OPTION
+    int listen_fd;          ///< Listening socket
+    int fd;                 ///< Client socket, -1 if none
+    telnet_state_t state;   ///< Telnet parser state
+    uint8_t verb;           ///< Pending WILL/WONT/DO/DONT
+    uint8_t sb[16];         ///< Subnegotiation payload
+    size_t sb_len;          ///< Subnegotiation length
+} serial_bridge_port_t;
+
+static const char *TAG = "serial_bridge";
+static SemaphoreHandle_t s_mutex = NULL;
+static serial_bridge_port_t s_ports[SERIAL_BRIDGE_PORT_NUM] =
+{
+    {.port = CONFIG_SERIAL_BRIDGE_RAW_PORT, .rfc2217 = false, .listen_fd = -1, .fd = -1},
+    {.port = CONFIG_SERIAL_BRIDGE_RFC2217_PORT, .rfc2217 = true, .listen_fd = -1, .fd = -1},
+};
+
+/* Escaped RFC2217 data, protected by s_mutex */
+static uint8_t s_tx_buf[SERIAL_BRIDGE_TX_BUF_SIZE];
+
+/* Current UART framing in serial manager terms, read back from the UART when a client connects */
+static int s_data_bits = 8;
+static int s_parity = 0;
+static int s_stop_bits = 1;
+
+/* USB CDC or the web console may hold the UART, the bridge only drives it in the TCP state */
+static bool serial_bridge_owns_uart(void)
+{
+    return serial_manager_get_state() == SERIAL_STATE_TCP;
+}
+
+static void serial_bridge_to_uart(const uint8_t *data, size_t size)
+{
+    if (serial_bridge_owns_uart())
+    {
+        serial_manager_send_to_uart(data, size);
+    }
+}
+
+static void serial_bridge_load_config(void)
+{
+    uart_port_t uart = serial_manager_get_uart_port();
+    uart_word_length_t data_bits = UART_DATA_8_BITS;
+    uart_parity_t parity = UART_PARITY_DISABLE;
+    uart_stop_bits_t stop_bits = UART_STOP_BITS_1;
+
+    if (uart_get_word_length(uart, &data_bits) == ESP_OK)
+    {
+        s_data_bits = 5 + (int)data_bits;
+    }
+
+    if (uart_get_parity(uart, &parity) == ESP_OK)
+    {
+        s_parity = (parity == UART_PARITY_ODD) ? 1 : ((parity == UART_PARITY_EVEN) ? 2 : 0);
+    }
+
+    if (uart_get_stop_bits(uart, &stop_bits) == ESP_OK)
+    {
+        s_stop_bits = (stop_bits == UART_STOP_BITS_2) ? 2 : 1;
+    }
+}
+
+/* Caller holds s_mutex, returns the number of bytes that went out */
+static size_t serial_bridge_send_some(int fd, const uint8_t *data, size_t size)
+{
+    size_t total = 0;
+    int sent = 0;
+
+    while (total < size)
+    {
+        sent = send(fd, data + total, size - total, 0);
+
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            break;
+        }
+
+        total += sent;
+    }
+
+    return total;
+}
+
+/* Caller holds s_mutex */
+static bool serial_bridge_send(int fd, const uint8_t *data, size_t size)
+{
+    return serial_bridge_send_some(fd, data, size) == size;
+}
+
+/* Caller holds s_mutex. A chunk cut short may split an escaped IAC, the stream
+ * cannot be resynchronised and the client is dropped. */
+static bool serial_bridge_send_escaped(int fd, const uint8_t *data, size_t size)
+{
+    size_t len = 0;
+    size_t sent = 0;
+    size_t n = 0;
+
+    while (n < size)
+    {
+        len = 0;
+
+        /* Double each 0xFF while copying, at least two bytes of room per input byte */
+        while ((n < size) && (len + 2 <= sizeof(s_tx_buf)))
+        {
+            s_tx_buf[len++] = data[n];
+
+            if (data[n] == TELNET_IAC)
+            {
+                s_tx_buf[len++] = TELNET_IAC;
+            }
+
+            n++;
+        }
+
+        sent = serial_bridge_send_some(fd, s_tx_buf, len);
+
+        if (sent == len)
+        {
+            continue;
+        }
+
+        if (sent > 0)
+        {
+            /* The bridge task sees the socket close and cleans the port up */
+            shutdown(fd, SHUT_RDWR);
+        }
+
+        return false;
+    }
+
+    return true;
+}
+
+void serial_bridge_send_to_clients(void *usr_data, uint8_t *data, size_t size)
+{
+    bool ok = true;
+
+    if (serial_manager_get_state() != SERIAL_STATE_TCP)
+    {
+        return;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    for (int i = 0; i < SERIAL_BRIDGE_PORT_NUM; i++)
+    {
+        serial_bridge_port_t *port = &s_ports[i];
+
+        if (port->fd < 0)
+        {
+            continue;
+        }
+
+        if (!port->rfc2217)
+        {
+            ok = serial_bridge_send(port->fd, data, size);
+        }
+        else
+        {
+            ok = serial_bridge_send_escaped(port->fd, data, size);
+        }
+
+        if (!ok)
+        {
+            ESP_LOGD(TAG, "port %d: client too slow, %u bytes dropped", port->port, (unsigned)size);
+            ok = true;
+        }
+    }
+
+    xSemaphoreGive(s_mutex);
+}
+
+static void serial_bridge_send_locked(serial_bridge_port_t *port, const uint8_t *data, size_t size)
+{
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    if (port->fd >= 0)
+    {
+        serial_bridge_send(port->fd, data, size);
+    }
+
+    xSemaphoreGive(s_mutex);
+}
+
+static void serial_bridge_reply_option(serial_bridge_port_t *port, uint8_t verb, uint8_t option)
+{
+    uint8_t reply[3] = {TELNET_IAC, 0, option};
+
+    switch (verb)
+    {
+    case TELNET_WILL:
+        reply[1] = ((option == TELNET_OPT_BINARY) || (option == TELNET_OPT_SGA) || (option == TELNET_OPT_COM_PORT)) ? TELNET_DO : TELNET_DONT;
+        break;
+
+    case TELNET_DO:
+        reply[1] = ((option == TELNET_OPT_BINARY) || (option == TELNET_OPT_SGA)) ? TELNET_WILL : TELNET_WONT;
+        break;
+
+    default:
+        /* WONT and DONT need no answer */
+        return;
+    }
+
+    serial_bridge_send_locked(port, reply, sizeof(reply));
+}
+
+static void serial_bridge_reply_com_port(serial_bridge_port_t *port, uint8_t command, const uint8_t *value, size_t len)
+{
+    uint8_t reply[16];
+    size_t n = 0;
+
+    reply[n++] = TELNET_IAC;
+    reply[n++] = TELNET_SB;
+    reply[n++] = TELNET_OPT_COM_PORT;
+    reply[n++] = command + RFC2217_SERVER_OFFSET;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        reply[n++] = value[i];
+
+        if (value[i] == TELNET_IAC)
+        {
+            reply[n++] = TELNET_IAC;
+        }
+    }
+
+    reply[n++] = TELNET_IAC;
+    reply[n++] = TELNET_SE;
+    serial_bridge_send_locked(port, reply, n);
+}
+
+static void serial_bridge_com_port(serial_bridge_port_t *port, const uint8_t *sb, size_t len)
+{
+    uint8_t command = 0;
+    uint8_t value[4] = {0};
+    uint32_t baudrate = 0;
+    bool owned = serial_bridge_owns_uart();
+
+    if ((len < 3) || (sb[0] != TELNET_OPT_COM_PORT))
+    {
+        return;
+    }
+
+    command = sb[1];
+    value[0] = sb[2];
+
+    switch (command)
+    {
+    case RFC2217_SET_BAUDRATE:
+        if (len < 6)
+        {
+            return;
+        }
+
+        baudrate = ((uint32_t)sb[2] << 24) | ((uint32_t)sb[3] << 16) | ((uint32_t)sb[4] << 8) | sb[5];
+
+        /* Zero asks for the current value, other clients of the UART only get the current value too */
+        if (baudrate && owned)
+        {
+            serial_manager_set_baudrate(baudrate);
+        }
+
+        serial_manager_get_baudrate(&baudrate);
+        value[0] = (uint8_t)(baudrate >> 24);
+        value[1] = (uint8_t)(baudrate >> 16);
+        value[2] = (uint8_t)(baudrate >> 8);
+        value[3] = (uint8_t)baudrate;
+        serial_bridge_reply_com_port(port, command, value, 4);
+        return;
+
+    case RFC2217_SET_DATASIZE:
+        if (owned && (value[0] >= 5) && (value[0] <= 8))
+        {
+            s_data_bits = value[0];
+            serial_manager_set_config(s_data_bits, s_parity, s_stop_bits);
+        }
+
+        value[0] = s_data_bits;
+        break;
+
+    case RFC2217_SET_PARITY:
+        /* RFC2217 NONE/ODD/EVEN are 1/2/3, serial manager uses 0/1/2, MARK and SPACE are not supported */
+        if (owned && (value[0] >= 1) && (value[0] <= 3))
+        {
+            s_parity = value[0] - 1;
+            serial_manager_set_config(s_data_bits, s_parity, s_stop_bits);
+        }
+
+        value[0] = s_parity + 1;
+        break;
+
+    case RFC2217_SET_STOPSIZE:
+        if (owned && ((value[0] == 1) || (value[0] == 2)))
+        {
+            s_stop_bits = value[0];
+            serial_manager_set_config(s_data_bits, s_parity, s_stop_bits);
+        }
+
+        value[0] = s_stop_bits;
+        break;
+
+    case RFC2217_SET_CONTROL:
+        /* No flow control and no DTR/RTS lines, report no flow control for queries */
+        value[0] = (value[0] == 0) ? 1 : value[0];
+        break;
+
+    case RFC2217_SET_LINESTATE_MASK:
+    case RFC2217_SET_MODEMSTATE_MASK:
+    case RFC2217_PURGE_DATA:
+        break;
+
+    default:
+        ESP_LOGD(TAG, "Unsupported COM-PORT command %d", command);
+        return;
+    }
+
+    serial_bridge_reply_com_port(port, command, value, 1);
+}
+
+/* Strips telnet framing, data runs go to the UART without copying */
+static void serial_bridge_telnet_input(serial_bridge_port_t *port, const uint8_t *buf, size_t len)
+{
+    static const uint8_t iac = TELNET_IAC;
+    size_t start = 0;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        uint8_t c = buf[i];
+        telnet_state_t prev = port->state;
+
+        switch (port->state)
+        {
+        case TELNET_STATE_DATA:
+            if (c == TELNET_IAC)
+            {
+                if (i > start)
+                {
+                    serial_bridge_to_uart(buf + start, i - start);
+                }
+
+                port->state = TELNET_STATE_IAC;
+            }
+            break;
+
+        case TELNET_STATE_IAC:
+            if (c == TELNET_IAC)
+            {
+                serial_bridge_to_uart(&iac, 1);
+                port->state = TELNET_STATE_DATA;
+            }
+            else if ((c >= TELNET_WILL) && (c <= TELNET_DONT))
+            {
+                port->verb = c;
+                port->state = TELNET_STATE_OPTION;
+            }
+            else if (c == TELNET_SB)
+            {
+                port->sb_len = 0;
+                port->state = TELNET_STATE_SB;
+            }
+            else
+            {
+                port->state = TELNET_STATE_DATA;
+            }
+            break;
+
+        case TELNET_STATE_OPTION:
+            serial_bridge_reply_option(port, port->verb, c);
+            port->state = TELNET_STATE_DATA;
+            break;
+
+        case TELNET_STATE_SB:
+            if (c == TELNET_IAC)
+            {
+                port->state = TELNET_STATE_SB_IAC;
+            }
+            else if (port->sb_len < sizeof(port->sb))
+            {
+                port->sb[port->sb_len++] = c;
+            }
+            break;
+
+        case TELNET_STATE_SB_IAC:
+            if (c == TELNET_SE)
+            {
+                serial_bridge_com_port(port, port->sb, port->sb_len);
+                port->state = TELNET_STATE_DATA;
+            }
+            else
+            {
+                if ((c == TELNET_IAC) && (port->sb_len < sizeof(port->sb)))
+                {
+                    port->sb[port->sb_len++] = c;
+                }
+
+                port->state = TELNET_STATE_SB;
+            }
+            break;
+        }
+
+        /* Only bytes seen in the data state are payload */
+        if ((prev != TELNET_STATE_DATA) || (port->state != TELNET_STATE_DATA))
+        {
+            start = i + 1;
+        }
+    }
+
+    if ((port->state == TELNET_STATE_DATA) && (len > start))
+    {
+        serial_bridge_to_uart(buf + start, len - start);
+    }
+}
+
+static void serial_bridge_accept(serial_bridge_port_t *port)
+{
+    static const uint8_t negotiation[] =
+    {
+        TELNET_IAC, TELNET_WILL, TELNET_OPT_BINARY,
+        TELNET_IAC, TELNET_DO, TELNET_OPT_BINARY,
+        TELNET_IAC, TELNET_WILL, TELNET_OPT_SGA,
+        TELNET_IAC, TELNET_DO, TELNET_OPT_COM_PORT,
+    };
+    int opt = 1;
+    struct timeval timeout = {0, SERIAL_BRIDGE_SEND_TIMEOUT_MS * 1000};
+    int fd = accept(port->listen_fd, NULL, NULL);
+
+    if (fd < 0)
+    {
+        return;
+    }
+
+    if (port->fd >= 0)
+    {
+        ESP_LOGW(TAG, "port %d busy, connection refused", port->port);
+        close(fd);
+        return;
+    }
+
+    /* UART data is already batched, push every batch out at once */
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+    /* A stalled client must not hold the UART task for long */
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    port->fd = fd;
+    port->state = TELNET_STATE_DATA;
+    port->sb_len = 0;
+    xSemaphoreGive(s_mutex);
+
+    if (port->rfc2217)
+    {
+        serial_bridge_send_locked(port, negotiation, sizeof(negotiation));
+    }
+
+    ESP_LOGI(TAG, "port %d: client connected", port->port);
+    serial_manager_tcp_client_connected();
+
+    /* RFC2217 clients query the framing before setting it, answer with what the UART really runs */
+    serial_bridge_load_config();
+}
+
+static void serial_bridge_close(serial_bridge_port_t *port)
+{
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    close(port->fd);
+    port->fd = -1;
+    xSemaphoreGive(s_mutex);
+
+    ESP_LOGI(TAG, "port %d: client disconnected", port->port);
+    serial_manager_tcp_client_disconnected();
+}
+
+static void serial_bridge_task(void *param)
+{
+    int max_fd = -1;
+    int len = 0;
+    fd_set rfds;
+    uint8_t *buf = (uint8_t *)malloc(SERIAL_BRIDGE_RX_BUF_SIZE);
+
+    if (!buf)
+    {
+        ESP_LOGE(TAG, "Memory not enough");
+        vTaskDelete(NULL);
+        return;
+    }
+
+    for (;;)
+    {
+        FD_ZERO(&rfds);
+        max_fd = -1;
+
+        for (int i = 0; i < SERIAL_BRIDGE_PORT_NUM; i++)
+        {
+            if (s_ports[i].listen_fd >= 0)
+            {
+                FD_SET(s_ports[i].listen_fd, &rfds);
+                max_fd = (s_ports[i].listen_fd > max_fd) ? s_ports[i].listen_fd : max_fd;
+            }
+
+            if (s_ports[i].fd >= 0)
+            {
+                FD_SET(s_ports[i].fd, &rfds);
+                max_fd = (s_ports[i].fd > max_fd) ? s_ports[i].fd : max_fd;
+            }
+        }
+
+        if (select(max_fd + 1, &rfds, NULL, NULL, NULL) <= 0)
+        {
+            continue;
+        }
+
+        for (int i = 0; i < SERIAL_BRIDGE_PORT_NUM; i++)
+        {
+            serial_bridge_port_t *port = &s_ports[i];
+
+            if ((port->fd >= 0) && FD_ISSET(port->fd, &rfds))
+            {
+                len = recv(port->fd, buf, SERIAL_BRIDGE_RX_BUF_SIZE, 0);
+
+                if (len <= 0)
+                {
+                    serial_bridge_close(port);
+                }
+                else if (port->rfc2217)
+                {
+                    serial_bridge_telnet_input(port, buf, len);
+                }
+                else
+                {
+                    serial_bridge_to_uart(buf, len);
+                }
+            }
+
+            if ((port->listen_fd >= 0) && FD_ISSET(port->listen_fd, &rfds))
+            {
+                serial_bridge_accept(port);
+            }
+        }
+    }
+}
+
+bool serial_bridge_init(void)
+{
+    bool listening = false;
+
+    if (s_mutex)
+    {
+        return true;
+    }
+
+    s_mutex = xSemaphoreCreateMutex();
+    if (!s_mutex)
+    {
+        return false;
+    }
+
+    for (int i = 0; i < SERIAL_BRIDGE_PORT_NUM; i++)
+    {
+        if (s_ports[i].port)
+        {
+            s_ports[i].listen_fd = tcp_listen_open(s_ports[i].port);
+            listening = listening || (s_ports[i].listen_fd >= 0);
+        }
+    }
+
+    if (!listening)
+    {
+        return false;
+    }
+
+    ESP_LOGI(TAG, "Serial bridge on port %d (raw), %d (rfc2217)", CONFIG_SERIAL_BRIDGE_RAW_PORT, CONFIG_SERIAL_BRIDGE_RFC2217_PORT);
+
+    return (pdPASS == xTaskCreate(serial_bridge_task, "serial_bridge", 4096, NULL, 5, NULL));
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add raw TCP and RFC2217 serial bridge
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Start the TCP serial bridge
+ *
+ * Listens on CONFIG_SERIAL_BRIDGE_RAW_PORT for raw TCP clients and on
+ * CONFIG_SERIAL_BRIDGE_RFC2217_PORT for RFC2217 (telnet COM-PORT-OPTION)
+ * clients, one client per port. While a client is connected the serial
+ * manager routes the UART to the bridge unless USB CDC owns it.
+ *
+ * @return true on success, false on failure
+ */
+bool serial_bridge_init(void);
+
+/**
+ * @brief Forward UART data to the bridge clients
+ *
+ * Registered as the CDC_UART_TCP_HANDLER callback. The data is sent
+ * straight from the UART batch buffer, without an intermediate copy.
+ *
+ * @param usr_data Unused
+ * @param data UART data
+ * @param size Data length
+ */
+void serial_bridge_send_to_clients(void *usr_data, uint8_t *data, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
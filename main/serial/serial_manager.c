@@ -6,6 +6,8 @@
  * Change Logs:
  * Date           Author       Notes
  * 2026-3-17      refactor     Initial version for web serial refactoring
+ * 2026-10-19    hongquan.li   add TCP bridge state
+ * 2026-10-19    hongquan.li   count RTT clients
  */
 
 #include <inttypes.h>
@@ -30,6 +32,8 @@ typedef struct
     SemaphoreHandle_t mutex;                    ///< Mutex for state switching
     volatile serial_state_t state;              ///< Current state
     volatile int web_client_count;              ///< Web client count
+    volatile int tcp_client_count;              ///< TCP bridge client count
+    volatile int rtt_client_count;              ///< RTT client count, not part of the UART arbitration
     volatile bool usb_connected;                ///< USB connection status
     volatile bool uart_initialized;             ///< UART initialization status
     uart_port_t uart_num;                       ///< UART port number
@@ -44,6 +48,8 @@ static serial_manager_ctx_t s_ctx =
     .mutex = NULL,
     .state = SERIAL_STATE_IDLE,
     .web_client_count = 0,
+    .tcp_client_count = 0,
+    .rtt_client_count = 0,
     .usb_connected = false,
     .uart_initialized = false,
     .uart_num = UART_NUM_1,
@@ -95,14 +101,19 @@ static void _update(void)
     serial_state_t current = s_ctx.state;
     bool usb = s_ctx.usb_connected;
     int web_count = s_ctx.web_client_count;
+    int tcp_count = s_ctx.tcp_client_count;
 
     serial_state_t new_state = current;
 
-    /* Priority: STATE_USB > STATE_WEB > STATE_IDLE */
+    /* Priority: STATE_USB > STATE_TCP > STATE_WEB > STATE_IDLE */
     if (usb)
     {
         new_state = SERIAL_STATE_USB;
     }
+    else if (tcp_count > 0)
+    {
+        new_state = SERIAL_STATE_TCP;
+    }
     else if (web_count > 0)
     {
         new_state = SERIAL_STATE_WEB;
@@ -173,6 +184,80 @@ int serial_manager_get_web_client_count(void)
     return s_ctx.web_client_count;
 }
 
+void serial_manager_tcp_client_connected(void)
+{
+    if (s_ctx.mutex && xSemaphoreTake(s_ctx.mutex, pdMS_TO_TICKS(100)) == pdTRUE)
+    {
+        s_ctx.tcp_client_count++;
+        xSemaphoreGive(s_ctx.mutex);
+    }
+    else
+    {
+        s_ctx.tcp_client_count++;
+    }
+    ESP_LOGI(TAG, "TCP client connected, count: %d", s_ctx.tcp_client_count);
+    _update();
+}
+
+void serial_manager_tcp_client_disconnected(void)
+{
+    if (s_ctx.mutex && xSemaphoreTake(s_ctx.mutex, pdMS_TO_TICKS(100)) == pdTRUE)
+    {
+        if (s_ctx.tcp_client_count > 0)
+        {
+            s_ctx.tcp_client_count--;
+        }
+        xSemaphoreGive(s_ctx.mutex);
+    }
+    else if (s_ctx.tcp_client_count > 0)
+    {
+        s_ctx.tcp_client_count--;
+    }
+    ESP_LOGI(TAG, "TCP client disconnected, count: %d", s_ctx.tcp_client_count);
+    _update();
+}
+
+int serial_manager_get_tcp_client_count(void)
+{
+    return s_ctx.tcp_client_count;
+}
+
+void serial_manager_rtt_client_connected(void)
+{
+    if (s_ctx.mutex && xSemaphoreTake(s_ctx.mutex, pdMS_TO_TICKS(100)) == pdTRUE)
+    {
+        s_ctx.rtt_client_count++;
+        xSemaphoreGive(s_ctx.mutex);
+    }
+    else
+    {
+        s_ctx.rtt_client_count++;
+    }
+    ESP_LOGI(TAG, "RTT client connected, count: %d", s_ctx.rtt_client_count);
+}
+
+void serial_manager_rtt_client_disconnected(void)
+{
+    if (s_ctx.mutex && xSemaphoreTake(s_ctx.mutex, pdMS_TO_TICKS(100)) == pdTRUE)
+    {
+        if (s_ctx.rtt_client_count > 0)
+        {
+            s_ctx.rtt_client_count--;
+        }
+        xSemaphoreGive(s_ctx.mutex);
+    }
+    else if (s_ctx.rtt_client_count > 0)
+    {
+        s_ctx.rtt_client_count--;
+    }
+    ESP_LOGI(TAG, "RTT client disconnected, count: %d", s_ctx.rtt_client_count);
+}
+
+int serial_manager_get_rtt_client_count(void)
+{
+    return s_ctx.rtt_client_count;
+}
+
 void serial_manager_set_usb_connected(bool connected)
 {
     bool was_connected = s_ctx.usb_connected;
@@ -207,6 +292,10 @@ void serial_manager_handle_uart_data(const uint8_t *data, size_t len)
         /* This is handled by the cdc_uart callback mechanism */
         break;
 
+    case SERIAL_STATE_TCP:
+        /* TCP clients receive data via serial_bridge_send_to_clients callback */
+        break;
+
     case SERIAL_STATE_IDLE:
     default:
         /* Discard data in idle state */
@@ -6,6 +6,8 @@
  * Change Logs:
  * Date           Author       Notes
  * 2026-3-17      refactor     Initial version for web serial refactoring
+ * 2026-10-19    hongquan.li   add TCP bridge state
+ * 2026-10-19    hongquan.li   count RTT clients
  */
 
 #pragma once
@@ -27,7 +29,8 @@ typedef enum
 {
     SERIAL_STATE_IDLE,     ///< Idle state, UART closed
     SERIAL_STATE_USB,      ///< USB CDC connected
-    SERIAL_STATE_WEB       ///< Web client connected
+    SERIAL_STATE_WEB,      ///< Web client connected
+    SERIAL_STATE_TCP       ///< TCP bridge client connected
 } serial_state_t;
 
 /**
@@ -62,6 +65,41 @@ void serial_manager_web_client_disconnected(void);
  */
 int serial_manager_get_web_client_count(void);
 
+/**
+ * @brief Notify TCP bridge client connected
+ */
+void serial_manager_tcp_client_connected(void);
+
+/**
+ * @brief Notify TCP bridge client disconnected
+ */
+void serial_manager_tcp_client_disconnected(void);
+
+/**
+ * @brief Get TCP bridge client count
+ * @return Number of connected TCP bridge clients
+ */
+int serial_manager_get_tcp_client_count(void);
+
+/**
+ * @brief Notify RTT client connected
+ *
+ * RTT runs over SWD, RTT clients never take the UART and do not change
+ * the serial state, the count only keeps the RTT poller running.
+ */
+void serial_manager_rtt_client_connected(void);
+
+/**
+ * @brief Notify RTT client disconnected
+ */
+void serial_manager_rtt_client_disconnected(void);
+
+/**
+ * @brief Get RTT client count
+ * @return Number of connected RTT clients, TCP and WebSocket
+ */
+int serial_manager_get_rtt_client_count(void);
+
 /**
  * @brief Set USB connection status
  * @param connected true if USB CDC is connected
@@ -0,0 +1,578 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add SEGGER RTT reader
+ * 2026-10-19    hongquan.li   check the port owner under the DAP lock
+ */
+
+#include <errno.h>
+#include <stddef.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "lwip/sockets.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/stream_buffer.h"
+#include "serial/serial_rtt.h"
+#include "serial/serial_manager.h"
+#include "programmer/programmer.h"
+#include "target_swd.h"
+#include "dap_arbiter.h"
+#include "tcp_listen.h"
+
+#define SERIAL_RTT_ID "SEGGER RTT"
+#define SERIAL_RTT_ID_SIZE 16
+#define SERIAL_RTT_HDR_SIZE 24
+#define SERIAL_RTT_MAX_BUFFERS 32
+#define SERIAL_RTT_DOWN_BUF_SIZE 1024
+#define SERIAL_RTT_TCP_BUF_SIZE 256
+#define SERIAL_RTT_SEND_TIMEOUT_MS 100
+#define SERIAL_RTT_SCAN_RETRY_MS 1000
+#define SERIAL_RTT_BURST_US 50000
+#define SERIAL_RTT_OWNED (-2)           /* serial_rtt_cycle(): a session owns the port */
+
+static_assert((CONFIG_SERIAL_RTT_BUF_SIZE % 4) == 0, "RTT buffer size must be a multiple of 4");
+
+/* SEGGER_RTT_BUFFER_UP/DOWN as laid out in target memory */
+typedef struct
+{
+    uint32_t name;      ///< Name string
+    uint32_t buffer;    ///< Ring buffer
+    uint32_t size;      ///< Ring buffer size
+    uint32_t wr_off;    ///< Written by the producer
+    uint32_t rd_off;    ///< Written by the consumer
+    uint32_t flags;     ///< Operating mode
+} serial_rtt_desc_t;
+
+typedef enum
+{
+    SERIAL_RTT_STATE_IDLE,      ///< No clients
+    SERIAL_RTT_STATE_PAUSED,    ///< A debugger or the programmer has the port
+    SERIAL_RTT_STATE_SEARCHING, ///< Control block not found yet
+    SERIAL_RTT_STATE_RUNNING    ///< Polling the control block
+} serial_rtt_state_t;
+
+static const char *TAG = "serial_rtt";
+static const char *const s_state_names[] = {"idle", "paused", "searching", "running"};
+
+static SemaphoreHandle_t s_mutex = NULL;
+static StreamBufferHandle_t s_down = NULL;
+static int s_listen_fd = -1;
+static int s_tcp_fd = -1;
+static void (*s_output_cb)(const uint8_t *data, size_t size) = NULL;
+
+/* Set from other tasks, picked up by the RTT task */
+static volatile uint32_t s_set_addr = 0;
+static volatile bool s_set_pending = false;
+
+/* Status, written by the RTT task only */
+static volatile serial_rtt_state_t s_state = SERIAL_RTT_STATE_IDLE;
+static volatile uint32_t s_cb = 0;
+static volatile uint32_t s_up_bytes = 0;
+static volatile uint32_t s_down_bytes = 0;
+static volatile uint32_t s_interval = CONFIG_SERIAL_RTT_POLL_MAX_MS;
+
+/* Owned by the RTT task */
+static bool s_attached = false;
+static uint32_t s_commands = 0;
+static uint32_t s_cached = 0;
+static uint32_t s_max_up = 0;
+static uint32_t s_max_down = 0;
+static int64_t s_scan_us = 0;
+static size_t s_down_len = 0;
+static uint8_t s_down_buf[SERIAL_RTT_DOWN_BUF_SIZE];
+static uint32_t s_buf[CONFIG_SERIAL_RTT_BUF_SIZE / 4 + 1];
+static uint32_t s_stage[SERIAL_RTT_DOWN_BUF_SIZE / 4 + 1];
+
+/* read_memory stores whole words once the target address is aligned, keep the buffer in step with it */
+static bool serial_rtt_read(SWDIface &swd, uint32_t addr, uint32_t len, uint8_t **data)
+{
+    *data = (uint8_t *)s_buf + (addr & 0x3);
+
+    return swd.read_memory(addr, *data, len);
+}
+
+static bool serial_rtt_write_word(SWDIface &swd, uint32_t addr, uint32_t val)
+{
+    return swd.write_memory(addr, (uint8_t *)&val, sizeof(val));
+}
+
+static bool serial_rtt_valid(const serial_rtt_desc_t &desc)
+{
+    return desc.buffer && desc.size && (desc.wr_off < desc.size) && (desc.rd_off < desc.size);
+}
+
+static bool serial_rtt_check(SWDIface &swd, uint32_t addr)
+{
+    uint8_t *data = NULL;
+    uint32_t max_up = 0;
+    uint32_t max_down = 0;
+
+    if ((addr & 0x3) || !serial_rtt_read(swd, addr, SERIAL_RTT_HDR_SIZE, &data) || memcmp(data, SERIAL_RTT_ID, sizeof(SERIAL_RTT_ID)))
+    {
+        return false;
+    }
+
+    memcpy(&max_up, data + SERIAL_RTT_ID_SIZE, sizeof(max_up));
+    memcpy(&max_down, data + SERIAL_RTT_ID_SIZE + sizeof(max_up), sizeof(max_down));
+
+    if ((max_up > SERIAL_RTT_MAX_BUFFERS) || (max_down > SERIAL_RTT_MAX_BUFFERS) || (CONFIG_SERIAL_RTT_CHANNEL >= max_up))
+    {
+        return false;
+    }
+
+    s_max_up = max_up;
+    s_max_down = max_down;
+
+    return true;
+}
+
+static uint32_t serial_rtt_scan(SWDIface &swd)
+{
+    uint32_t addr = CONFIG_SERIAL_RTT_SCAN_START & ~0x3;
+    uint32_t end = CONFIG_SERIAL_RTT_SCAN_START + CONFIG_SERIAL_RTT_SCAN_SIZE;
+    uint32_t len = 0;
+    uint8_t *data = NULL;
+
+    while (addr < end)
+    {
+        len = ((end - addr) > CONFIG_SERIAL_RTT_BUF_SIZE) ? CONFIG_SERIAL_RTT_BUF_SIZE : (end - addr);
+
+        if (!serial_rtt_read(swd, addr, len, &data))
+        {
+            return 0;
+        }
+
+        /* The control block is word aligned */
+        for (uint32_t i = 0; i + sizeof(SERIAL_RTT_ID) <= len; i += 4)
+        {
+            if (!memcmp(data + i, SERIAL_RTT_ID, sizeof(SERIAL_RTT_ID)))
+            {
+                return addr + i;
+            }
+        }
+
+        if (addr + len >= end)
+        {
+            break;
+        }
+
+        /* Overlap the chunks so an ID split between two of them is still found */
+        addr += len - SERIAL_RTT_ID_SIZE;
+    }
+
+    return 0;
+}
+
+/* The cached address is tried first, a full scan only every SERIAL_RTT_SCAN_RETRY_MS */
+static uint32_t serial_rtt_find(SWDIface &swd)
+{
+    uint32_t addr = 0;
+    int64_t now = esp_timer_get_time();
+
+    if (s_cached && serial_rtt_check(swd, s_cached))
+    {
+        return s_cached;
+    }
+
+    if (s_scan_us && ((now - s_scan_us) < SERIAL_RTT_SCAN_RETRY_MS * 1000))
+    {
+        return 0;
+    }
+
+    s_scan_us = now;
+    addr = serial_rtt_scan(swd);
+
+    if (addr && serial_rtt_check(swd, addr))
+    {
+        ESP_LOGI(TAG, "Control block at 0x%08lx, %lu up, %lu down", (unsigned long)addr, (unsigned long)s_max_up, (unsigned long)s_max_down);
+        s_cached = addr;
+        return addr;
+    }
+
+    return 0;
+}
+
+static bool serial_rtt_put(SWDIface &swd, uint32_t desc_addr, const serial_rtt_desc_t &down)
+{
+    uint32_t space = (down.rd_off + down.size - down.wr_off - 1) % down.size;
+    uint32_t addr = down.buffer + down.wr_off;
+    uint32_t n = s_down_len;
+    uint8_t *data = (uint8_t *)s_stage + (addr & 0x3);
+
+    /* Up to the end of the ring, the rest goes in the next cycle */
+    n = (n > space) ? space : n;
+    n = (n > (down.size - down.wr_off)) ? (down.size - down.wr_off) : n;
+
+    if (n == 0)
+    {
+        return true;
+    }
+
+    memcpy(data, s_down_buf, n);
+
+    if (!swd.write_memory(addr, data, n) ||
+        !serial_rtt_write_word(swd, desc_addr + offsetof(serial_rtt_desc_t, wr_off), (down.wr_off + n) % down.size))
+    {
+        return false;
+    }
+
+    s_down_len -= n;
+    memmove(s_down_buf, s_down_buf + n, s_down_len);
+    s_down_bytes += n;
+
+    return true;
+}
+
+/* Returns the bytes read from the up-buffer, -1 if the control block is gone */
+static int serial_rtt_transfer(SWDIface &swd, uint8_t **out)
+{
+    serial_rtt_desc_t up;
+    serial_rtt_desc_t down;
+    uint32_t up_addr = s_cb + SERIAL_RTT_HDR_SIZE + CONFIG_SERIAL_RTT_CHANNEL * sizeof(serial_rtt_desc_t);
+    uint32_t down_addr = s_cb + SERIAL_RTT_HDR_SIZE + (s_max_up + CONFIG_SERIAL_RTT_CHANNEL) * sizeof(serial_rtt_desc_t);
+    bool has_down = (CONFIG_SERIAL_RTT_CHANNEL < s_max_down);
+    uint32_t len = has_down ? (down_addr + sizeof(down) - up_addr) : sizeof(up);
+    uint32_t n = 0;
+    uint8_t *data = NULL;
+
+    /* Both descriptors of the channel in one read */
+    if (!serial_rtt_read(swd, up_addr, len, &data))
+    {
+        return -1;
+    }
+
+    memcpy(&up, data, sizeof(up));
+    memcpy(&down, data + len - sizeof(down), sizeof(down));
+
+    if (!serial_rtt_valid(up))
+    {
+        return -1;
+    }
+
+    if (has_down && s_down_len && serial_rtt_valid(down) && !serial_rtt_put(swd, down_addr, down))
+    {
+        return -1;
+    }
+
+    if (up.wr_off == up.rd_off)
+    {
+        return 0;
+    }
+
+    /* Up to the end of the ring, a wrapped remainder is read right away in the next cycle */
+    n = (up.wr_off > up.rd_off) ? (up.wr_off - up.rd_off) : (up.size - up.rd_off);
+    n = (n > CONFIG_SERIAL_RTT_BUF_SIZE) ? CONFIG_SERIAL_RTT_BUF_SIZE : n;
+
+    if (!serial_rtt_read(swd, up.buffer + up.rd_off, n, out) ||
+        !serial_rtt_write_word(swd, up_addr + offsetof(serial_rtt_desc_t, rd_off), (up.rd_off + n) % up.size))
+    {
+        return -1;
+    }
+
+    s_up_bytes += n;
+
+    return n;
+}
+
+static int serial_rtt_cycle(SWDIface &swd, uint8_t **out)
+{
+    int ret = -1;
+    dap_arbiter_stats_t stats;
+
+    /* Checked under the lock, a debugger cannot claim the port between the check and the reads */
+    if (!dap_arbiter_try_lock())
+    {
+        return SERIAL_RTT_OWNED;
+    }
+
+    /* Whoever held the lock since the last cycle may have reset the port or switched it off */
+    dap_arbiter_get_stats(&stats);
+    if (!s_attached || (stats.commands != s_commands))
+    {
+        s_attached = swd.set_target_state(SWDIface::TARGET_DEBUG);
+    }
+
+    if (s_set_pending)
+    {
+        s_set_pending = false;
+        s_cached = s_set_addr;
+        s_scan_us = 0;
+        s_cb = 0;
+    }
+
+    if (s_attached && !s_cb)
+    {
+        s_cb = serial_rtt_find(swd);
+    }
+
+    if (s_attached && s_cb)
+    {
+        ret = serial_rtt_transfer(swd, out);
+
+        /* Target reset or new firmware, look again from the cached address */
+        if (ret < 0)
+        {
+            s_cb = 0;
+            s_attached = false;
+        }
+    }
+
+    s_state = s_cb ? SERIAL_RTT_STATE_RUNNING : SERIAL_RTT_STATE_SEARCHING;
+
+    /* This unlock counts as a command too */
+    s_commands = stats.commands + 1;
+    dap_arbiter_unlock();
+
+    return ret;
+}
+
+static void serial_rtt_send(const uint8_t *data, size_t size)
+{
+    int sent = 0;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    while ((s_tcp_fd >= 0) && (size > 0))
+    {
+        sent = send(s_tcp_fd, data, size, 0);
+
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            ESP_LOGD(TAG, "client too slow, %u bytes dropped", (unsigned)size);
+            break;
+        }
+
+        data += sent;
+        size -= sent;
+    }
+
+    xSemaphoreGive(s_mutex);
+}
+
+/* Only when nobody else needs the port, a host debugger would lose its DP state under us */
+static serial_rtt_state_t serial_rtt_blocked(void)
+{
+    if (serial_manager_get_rtt_client_count() == 0)
+    {
+        return SERIAL_RTT_STATE_IDLE;
+    }
+
+    /* A session owning the port is caught by serial_rtt_cycle() */
+    if (programmer_is_busy())
+    {
+        return SERIAL_RTT_STATE_PAUSED;
+    }
+
+    return SERIAL_RTT_STATE_RUNNING;
+}
+
+static void serial_rtt_task(void *param)
+{
+    int len = 0;
+    uint32_t interval = CONFIG_SERIAL_RTT_POLL_MAX_MS;
+    int64_t burst_us = esp_timer_get_time();
+    int64_t now = 0;
+    TickType_t wait = 0;
+    uint8_t *data = NULL;
+    serial_rtt_state_t blocked = SERIAL_RTT_STATE_IDLE;
+    SWDIface &swd = TargetSWD::get_instance();
+
+    for (;;)
+    {
+        /* Back to back while data flows, but give lower priority tasks a tick every SERIAL_RTT_BURST_US */
+        now = esp_timer_get_time();
+        if ((interval == 0) && ((now - burst_us) < SERIAL_RTT_BURST_US))
+        {
+            wait = 0;
+        }
+        else
+        {
+            wait = (pdMS_TO_TICKS(interval) > 0) ? pdMS_TO_TICKS(interval) : 1;
+            burst_us = now;
+        }
+
+        /* Client input cuts the wait short */
+        if (s_down_len == 0)
+        {
+            s_down_len = xStreamBufferReceive(s_down, s_down_buf, sizeof(s_down_buf), wait);
+        }
+        else if (wait)
+        {
+            vTaskDelay(wait);
+        }
+
+        blocked = serial_rtt_blocked();
+        if (blocked == SERIAL_RTT_STATE_RUNNING)
+        {
+            len = serial_rtt_cycle(swd, &data);
+            blocked = (len == SERIAL_RTT_OWNED) ? SERIAL_RTT_STATE_PAUSED : blocked;
+        }
+
+        if (blocked != SERIAL_RTT_STATE_RUNNING)
+        {
+            if (s_attached && (blocked == SERIAL_RTT_STATE_IDLE) && dap_arbiter_try_lock())
+            {
+                swd.off();
+                dap_arbiter_unlock();
+            }
+
+            if (blocked == SERIAL_RTT_STATE_IDLE)
+            {
+                s_down_len = 0;
+                xStreamBufferReset(s_down);
+            }
+
+            s_attached = false;
+            s_state = blocked;
+            interval = CONFIG_SERIAL_RTT_POLL_MAX_MS;
+            s_interval = interval;
+            continue;
+        }
+
+        if (len > 0)
+        {
+            serial_rtt_send(data, len);
+
+            if (s_output_cb)
+            {
+                s_output_cb(data, len);
+            }
+        }
+
+        /* Straight back while data flows, backing off exponentially while the target is quiet */
+        if (len > 0)
+        {
+            interval = 0;
+        }
+        else if (len < 0)
+        {
+            interval = CONFIG_SERIAL_RTT_POLL_MAX_MS;
+        }
+        else
+        {
+            interval = interval ? interval * 2 : 1;
+            interval = (interval > CONFIG_SERIAL_RTT_POLL_MAX_MS) ? CONFIG_SERIAL_RTT_POLL_MAX_MS : interval;
+        }
+
+        s_interval = interval;
+    }
+}
+
+static void serial_rtt_tcp_task(void *param)
+{
+    int fd = -1;
+    int len = 0;
+    int opt = 1;
+    struct timeval timeout = {0, SERIAL_RTT_SEND_TIMEOUT_MS * 1000};
+    uint8_t buf[SERIAL_RTT_TCP_BUF_SIZE];
+
+    for (;;)
+    {
+        fd = accept(s_listen_fd, NULL, NULL);
+        if (fd < 0)
+        {
+            continue;
+        }
+
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+        /* A stalled client must not hold the RTT task for long */
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        s_tcp_fd = fd;
+        xSemaphoreGive(s_mutex);
+
+        ESP_LOGI(TAG, "TCP client connected");
+        serial_manager_rtt_client_connected();
+
+        while ((len = recv(fd, buf, sizeof(buf), 0)) > 0)
+        {
+            serial_rtt_write(buf, len);
+        }
+
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        close(fd);
+        s_tcp_fd = -1;
+        xSemaphoreGive(s_mutex);
+
+        ESP_LOGI(TAG, "TCP client disconnected");
+        serial_manager_rtt_client_disconnected();
+    }
+}
+
+bool serial_rtt_init(void)
+{
+    if (s_mutex)
+    {
+        return true;
+    }
+
+    s_mutex = xSemaphoreCreateMutex();
+    s_down = xStreamBufferCreate(SERIAL_RTT_DOWN_BUF_SIZE, 1);
+
+    if (!s_mutex || !s_down)
+    {
+        ESP_LOGE(TAG, "Memory not enough");
+        return false;
+    }
+
+    if (xTaskCreate(serial_rtt_task, "serial_rtt", 4096, NULL, 2, NULL) != pdPASS)
+    {
+        return false;
+    }
+
+    if (CONFIG_SERIAL_RTT_TCP_PORT)
+    {
+        s_listen_fd = tcp_listen_open(CONFIG_SERIAL_RTT_TCP_PORT);
+
+        if ((s_listen_fd < 0) || (xTaskCreate(serial_rtt_tcp_task, "serial_rtt_tcp", 3072, NULL, 5, NULL) != pdPASS))
+        {
+            return false;
+        }
+
+        ESP_LOGI(TAG, "RTT on port %d", CONFIG_SERIAL_RTT_TCP_PORT);
+    }
+
+    return true;
+}
+
+void serial_rtt_register_output(void (*cb)(const uint8_t *data, size_t size))
+{
+    s_output_cb = cb;
+}
+
+size_t serial_rtt_write(const uint8_t *data, size_t size)
+{
+    if (!s_down)
+    {
+        return 0;
+    }
+
+    return xStreamBufferSend(s_down, data, size, pdMS_TO_TICKS(SERIAL_RTT_SEND_TIMEOUT_MS));
+}
+
+void serial_rtt_set_address(uint32_t addr)
+{
+    s_set_addr = addr;
+    s_set_pending = true;
+}
+
+void serial_rtt_get_status(char *buf, int size, int *encode_len)
+{
+    *encode_len = snprintf(buf, size, "{\"state\":\"%s\",\"addr\":\"0x%08lx\",\"channel\":%d,\"up_bytes\":%lu,\"down_bytes\":%lu,\"interval_ms\":%lu,\"clients\":%d}",
+                           s_state_names[s_state], (unsigned long)s_cb, CONFIG_SERIAL_RTT_CHANNEL, (unsigned long)s_up_bytes,
+                           (unsigned long)s_down_bytes, (unsigned long)s_interval, serial_manager_get_rtt_client_count());
+}
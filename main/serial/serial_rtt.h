@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add SEGGER RTT reader
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Start the RTT reader
+ *
+ * While RTT clients are connected the `_SEGGER_RTT` control block is located
+ * by scanning CONFIG_SERIAL_RTT_SCAN_START for CONFIG_SERIAL_RTT_SCAN_SIZE
+ * bytes, the address is cached until the block is no longer found there.
+ * Up-buffer CONFIG_SERIAL_RTT_CHANNEL is then polled over SWD, faster while
+ * data is flowing and slower down to CONFIG_SERIAL_RTT_POLL_MAX_MS when the
+ * target is quiet. Client input goes to the down-buffer of the same channel.
+ *
+ * Polling pauses while a debugger owns the DAP port or the programmer is
+ * busy, host debuggers read RTT themselves.
+ *
+ * Raw TCP clients connect on CONFIG_SERIAL_RTT_TCP_PORT, one at a time.
+ *
+ * @return true on success, false on failure
+ */
+bool serial_rtt_init(void);
+
+/**
+ * @brief Register a second output next to the TCP client
+ *
+ * The callback runs in the RTT task with each block read from the target,
+ * it must not block.
+ *
+ * @param cb Callback
+ */
+void serial_rtt_register_output(void (*cb)(const uint8_t *data, size_t size));
+
+/**
+ * @brief Queue data for the down-buffer
+ * @param data Data
+ * @param size Data length
+ * @return Bytes queued, less than size if the queue stayed full
+ */
+size_t serial_rtt_write(const uint8_t *data, size_t size);
+
+/**
+ * @brief Set the control block address
+ * @param addr Control block address, 0 to scan again
+ */
+void serial_rtt_set_address(uint32_t addr);
+
+/**
+ * @brief Get the RTT reader status as JSON
+ * @param buf Output buffer
+ * @param size Buffer size
+ * @param encode_len Output: encoded length
+ */
+void serial_rtt_get_status(char *buf, int size, int *encode_len);
+
+#ifdef __cplusplus
+}
+#endif
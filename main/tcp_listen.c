@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   share the TCP listen socket setup
+ */
+#include <errno.h>
+#include "lwip/sockets.h"
+#include "esp_log.h"
+#include "tcp_listen.h"
+
+static const char *TAG = "tcp_listen";
+
+int tcp_listen_open(uint16_t port)
+{
+    int opt = 1;
+    int fd = -1;
+    struct sockaddr_in addr = {0};
+
+    fd = socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
+    if (fd < 0)
+    {
+        ESP_LOGE(TAG, "Failed to create socket for port %d: errno %d", port, errno);
+        return -1;
+    }
+
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+
+    if ((bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) || (listen(fd, 1) != 0))
+    {
+        ESP_LOGE(TAG, "Failed to listen on port %d: errno %d", port, errno);
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   share the TCP listen socket setup
+ */
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Open a TCP socket listening on all interfaces
+ *
+ * SO_REUSEADDR is set so the port can be bound again right after a reboot.
+ * The backlog is one connection, the services on top serve one client per
+ * port and decide themselves what to do with a second one.
+ *
+ * @param port TCP port
+ * @return Listening socket, -1 on failure
+ */
+int tcp_listen_open(uint16_t port);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,534 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add SWO trace streaming and ITM decoder
+ * 2026-10-19    hongquan.li   set up trace under the DAP try-lock and again after a reattach
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include "sdkconfig.h"
+#include "lwip/sockets.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "trace/swo_trace.h"
+#include "programmer/programmer.h"
+#include "target_swd.h"
+#include "dap_arbiter.h"
+#include "swo.h"
+#include "tcp_listen.h"
+
+#define SWO_TRACE_ITM_PORTS 32
+#define SWO_TRACE_CHAN_BUF_SIZE 128
+#define SWO_TRACE_TCP_BUF_SIZE 64
+#define SWO_TRACE_SELECT_MS 100
+/* Index 0 is the raw stream, 1 + n stimulus port n */
+#define SWO_TRACE_SERVERS (1 + CONFIG_SWO_TRACE_ITM_CHANNELS)
+
+/* ITM sync is at least 47 zero bits and a one, 5 zero bytes and 0x80 */
+#define ITM_SYNC_ZEROS 5
+#define ITM_SYNC_END 0x80
+#define ITM_OVERFLOW 0x70
+
+/* CoreSight registers written for probe side capture */
+#define DEMCR 0xE000EDFC
+#define DEMCR_TRCENA (1UL << 24)
+#define TPIU_CSPSR 0xE0040004
+#define TPIU_ACPR 0xE0040010
+#define TPIU_SPPR 0xE00400F0
+#define TPIU_SPPR_NRZ 2
+#define TPIU_FFCR 0xE0040304
+#define TPIU_FFCR_TRIGIN 0x100
+#define ITM_TER 0xE0000E00
+#define ITM_TPR 0xE0000E40
+#define ITM_TCR 0xE0000E80
+#define ITM_TCR_VALUE ((1UL << 16) | (1UL << 3) | (1UL << 2) | (1UL << 0)) /* TraceBusID 1, TXENA, SYNCENA, ITMENA */
+#define ITM_TCR_MASK ((0x7FUL << 16) | 0x0FUL)    /* TraceBusID and the enables, BUSY is the ITM's own */
+#define ITM_LAR 0xE0000FB0
+#define ITM_LAR_KEY 0xC5ACCE55
+
+static_assert(CONFIG_SWO_TRACE_ITM_CHANNELS <= SWO_TRACE_ITM_PORTS, "ITM has 32 stimulus ports");
+
+typedef enum
+{
+    ITM_STATE_HEADER,   ///< Next byte is a packet header
+    ITM_STATE_PAYLOAD,  ///< Source packet payload
+    ITM_STATE_SKIP      ///< Protocol packet, runs until a byte without the continuation bit
+} itm_state_t;
+
+typedef enum
+{
+    SWO_TRACE_SETUP_OFF,        ///< No capture or setup disabled
+    SWO_TRACE_SETUP_PENDING,    ///< Waiting for the debug port
+    SWO_TRACE_SETUP_DONE,       ///< TPIU and ITM configured
+    SWO_TRACE_SETUP_FAILED      ///< SWD writes failed
+} swo_trace_setup_t;
+
+static const char *TAG = "swo_trace";
+static const char *const s_setup_names[] = {"off", "pending", "done", "failed"};
+
+static SemaphoreHandle_t s_mutex = NULL;
+static SemaphoreHandle_t s_client_mutex = NULL;
+static void (*s_output_cb)(uint8_t port, const uint8_t *data, size_t size) = NULL;
+
+/* Guarded by s_mutex, sent to from the capture task */
+static int s_listen_fd[SWO_TRACE_SERVERS];
+static int s_tcp_fd[SWO_TRACE_SERVERS];
+
+/* Guarded by s_client_mutex */
+static int s_clients = 0;
+static uint32_t s_baudrate = CONFIG_SWO_TRACE_BAUDRATE;
+static volatile uint32_t s_baudrate_used = 0;
+static volatile swo_trace_setup_t s_setup = SWO_TRACE_SETUP_OFF;
+/* Arbiter command count after the setup, owned by the trace task */
+static uint32_t s_commands = 0;
+
+/* Decoder, owned by the capture task */
+static itm_state_t s_itm_state = ITM_STATE_HEADER;
+static int s_itm_port = -1;
+static uint32_t s_itm_remaining = 0;
+static uint32_t s_itm_zeros = 0;
+static uint8_t s_chan_buf[SWO_TRACE_ITM_PORTS][SWO_TRACE_CHAN_BUF_SIZE];
+static uint8_t s_chan_len[SWO_TRACE_ITM_PORTS];
+
+/* Status */
+static volatile uint32_t s_packets = 0;
+static volatile uint32_t s_overflows = 0;
+static volatile uint32_t s_syncs = 0;
+static volatile uint32_t s_dropped = 0;
+
+/* Trace must not hold up the capture task, whatever a client cannot take is dropped */
+static void swo_trace_send(int index, const uint8_t *data, size_t size)
+{
+    int sent = 0;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    if (s_tcp_fd[index] >= 0)
+    {
+        sent = send(s_tcp_fd[index], data, size, MSG_DONTWAIT);
+        s_dropped += (sent < 0) ? size : (size - sent);
+    }
+
+    xSemaphoreGive(s_mutex);
+}
+
+static void swo_trace_flush_port(uint8_t port)
+{
+    if (s_chan_len[port] == 0)
+    {
+        return;
+    }
+
+    if (port < CONFIG_SWO_TRACE_ITM_CHANNELS)
+    {
+        swo_trace_send(1 + port, s_chan_buf[port], s_chan_len[port]);
+    }
+
+    if (s_output_cb)
+    {
+        s_output_cb(port, s_chan_buf[port], s_chan_len[port]);
+    }
+
+    s_chan_len[port] = 0;
+}
+
+static void swo_trace_header(uint8_t c)
+{
+    if (c == 0x00)
+    {
+        s_itm_zeros++;
+        return;
+    }
+
+    if ((c == ITM_SYNC_END) && (s_itm_zeros >= ITM_SYNC_ZEROS))
+    {
+        s_itm_zeros = 0;
+        s_syncs++;
+        return;
+    }
+
+    s_itm_zeros = 0;
+
+    if (c == ITM_OVERFLOW)
+    {
+        s_overflows++;
+        return;
+    }
+
+    /* Timestamps, extension and global timestamp packets carry on while bit 7 is set */
+    if ((c & 0x03) == 0)
+    {
+        s_itm_state = (c & 0x80) ? ITM_STATE_SKIP : ITM_STATE_HEADER;
+        return;
+    }
+
+    /* Source packet, 1, 2 or 4 payload bytes, hardware (DWT) sources are not forwarded */
+    s_itm_remaining = 1U << ((c & 0x03) - 1);
+    s_itm_port = (c & 0x04) ? -1 : (c >> 3);
+    s_itm_state = ITM_STATE_PAYLOAD;
+
+    if (s_itm_port >= 0)
+    {
+        s_packets++;
+    }
+}
+
+static void swo_trace_decode(const uint8_t *data, uint32_t size)
+{
+    uint8_t c = 0;
+
+    for (uint32_t i = 0; i < size; i++)
+    {
+        c = data[i];
+
+        switch (s_itm_state)
+        {
+        case ITM_STATE_PAYLOAD:
+            if (s_itm_port >= 0)
+            {
+                s_chan_buf[s_itm_port][s_chan_len[s_itm_port]++] = c;
+
+                if (s_chan_len[s_itm_port] == SWO_TRACE_CHAN_BUF_SIZE)
+                {
+                    swo_trace_flush_port(s_itm_port);
+                }
+            }
+
+            if (--s_itm_remaining == 0)
+            {
+                s_itm_state = ITM_STATE_HEADER;
+            }
+            break;
+
+        case ITM_STATE_SKIP:
+            if (!(c & 0x80))
+            {
+                s_itm_state = ITM_STATE_HEADER;
+            }
+            break;
+
+        default:
+            swo_trace_header(c);
+            break;
+        }
+    }
+}
+
+/* Runs on the SWO capture task */
+static void swo_trace_input(const uint8_t *data, uint32_t size)
+{
+    swo_trace_send(0, data, size);
+    swo_trace_decode(data, size);
+
+    /* A partial packet stays in the decoder, decoded bytes go out with every block */
+    for (uint8_t port = 0; port < SWO_TRACE_ITM_PORTS; port++)
+    {
+        swo_trace_flush_port(port);
+    }
+}
+
+static bool swo_trace_write(SWDIface &swd, uint32_t addr, uint32_t val)
+{
+    return swd.write_memory(addr, (uint8_t *)&val, sizeof(val));
+}
+
+/* The same TPIU and ITM setup a host debugger does for NRZ SWO, plus opening every stimulus port */
+static bool swo_trace_setup_target(SWDIface &swd, uint32_t baudrate)
+{
+    uint32_t demcr = 0;
+    uint32_t prescaler = CONFIG_SWO_TRACE_CPU_CLOCK / baudrate;
+
+    if (!swd.set_target_state(SWDIface::TARGET_DEBUG) ||
+        !swd.read_memory(DEMCR, (uint8_t *)&demcr, sizeof(demcr)))
+    {
+        return false;
+    }
+
+    return swo_trace_write(swd, DEMCR, demcr | DEMCR_TRCENA) &&
+           swo_trace_write(swd, TPIU_CSPSR, 1) &&
+           swo_trace_write(swd, TPIU_ACPR, prescaler ? (prescaler - 1) : 0) &&
+           swo_trace_write(swd, TPIU_SPPR, TPIU_SPPR_NRZ) &&
+           swo_trace_write(swd, TPIU_FFCR, TPIU_FFCR_TRIGIN) &&
+           swo_trace_write(swd, ITM_LAR, ITM_LAR_KEY) &&
+           swo_trace_write(swd, ITM_TCR, ITM_TCR_VALUE) &&
+           swo_trace_write(swd, ITM_TPR, 0) &&
+           swo_trace_write(swd, ITM_TER, 0xFFFFFFFF);
+}
+
+/* A session or a reset since the setup may have left the target without trace, the registers tell */
+static bool swo_trace_target_ready(SWDIface &swd, uint32_t baudrate)
+{
+    uint32_t tcr = 0;
+    uint32_t acpr = 0;
+    uint32_t prescaler = CONFIG_SWO_TRACE_CPU_CLOCK / baudrate;
+
+    return swd.set_target_state(SWDIface::TARGET_DEBUG) &&
+           swd.read_memory(ITM_TCR, (uint8_t *)&tcr, sizeof(tcr)) &&
+           swd.read_memory(TPIU_ACPR, (uint8_t *)&acpr, sizeof(acpr)) &&
+           ((tcr & ITM_TCR_MASK) == ITM_TCR_VALUE) &&
+           (acpr == (prescaler ? (prescaler - 1) : 0));
+}
+
+/* Only when nobody else needs the port, a host debugger sets up trace itself */
+static void swo_trace_try_setup(void)
+{
+    bool ok = false;
+    bool rearm = (s_setup == SWO_TRACE_SETUP_DONE);
+    uint32_t baudrate = s_baudrate_used;
+    dap_arbiter_stats_t stats;
+    swo_stats_t swo;
+    SWDIface &swd = TargetSWD::get_instance();
+
+    swo_get_stats(&swo);
+
+    if (swo.host_active)
+    {
+        s_setup = SWO_TRACE_SETUP_OFF;
+        return;
+    }
+
+    /* Checked under the lock, a session cannot claim the port between the check and the writes */
+    if ((baudrate == 0) || programmer_is_busy() || !dap_arbiter_try_lock())
+    {
+        return;
+    }
+
+    dap_arbiter_get_stats(&stats);
+    ok = (rearm && swo_trace_target_ready(swd, baudrate)) || swo_trace_setup_target(swd, baudrate);
+
+    /* This unlock counts as a command too */
+    s_commands = stats.commands + 1;
+    dap_arbiter_unlock();
+
+    if (rearm && ok)
+    {
+        return;
+    }
+
+    s_setup = ok ? SWO_TRACE_SETUP_DONE : SWO_TRACE_SETUP_FAILED;
+    ESP_LOGI(TAG, "Target trace setup %s at %lu baud", ok ? "done" : "failed", (unsigned long)baudrate);
+}
+
+/* Someone used the port since the setup, it may have reset the target or switched the port off */
+static bool swo_trace_reattached(void)
+{
+    dap_arbiter_stats_t stats;
+
+    dap_arbiter_get_stats(&stats);
+
+    return (s_setup == SWO_TRACE_SETUP_DONE) && (stats.commands != s_commands);
+}
+
+/* Called with s_client_mutex held */
+static void swo_trace_restart(void)
+{
+    if (s_clients == 0)
+    {
+        swo_stop();
+        s_baudrate_used = 0;
+        s_setup = SWO_TRACE_SETUP_OFF;
+        return;
+    }
+
+    s_baudrate_used = swo_start(s_baudrate);
+
+#ifdef CONFIG_SWO_TRACE_TARGET_SETUP
+    s_setup = SWO_TRACE_SETUP_PENDING;
+#endif
+}
+
+void swo_trace_client_connected(void)
+{
+    xSemaphoreTake(s_client_mutex, portMAX_DELAY);
+
+    if (s_clients++ == 0)
+    {
+        swo_trace_restart();
+    }
+
+    xSemaphoreGive(s_client_mutex);
+}
+
+void swo_trace_client_disconnected(void)
+{
+    xSemaphoreTake(s_client_mutex, portMAX_DELAY);
+
+    if ((s_clients > 0) && (--s_clients == 0))
+    {
+        swo_trace_restart();
+    }
+
+    xSemaphoreGive(s_client_mutex);
+}
+
+static void swo_trace_close(int index)
+{
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    close(s_tcp_fd[index]);
+    s_tcp_fd[index] = -1;
+    xSemaphoreGive(s_mutex);
+
+    swo_trace_client_disconnected();
+}
+
+static void swo_trace_accept(int index)
+{
+    int opt = 1;
+    int fd = accept(s_listen_fd[index], NULL, NULL);
+
+    if (fd < 0)
+    {
+        return;
+    }
+
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+    swo_trace_client_connected();
+
+    /* The newest client wins, an old one may be a connection that died silently */
+    if (s_tcp_fd[index] >= 0)
+    {
+        swo_trace_close(index);
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_tcp_fd[index] = fd;
+    xSemaphoreGive(s_mutex);
+}
+
+static void swo_trace_task(void *param)
+{
+    int max_fd = -1;
+    uint8_t buf[SWO_TRACE_TCP_BUF_SIZE];
+    fd_set fds;
+    struct timeval timeout;
+
+    for (;;)
+    {
+        FD_ZERO(&fds);
+        max_fd = -1;
+
+        for (int i = 0; i < SWO_TRACE_SERVERS; i++)
+        {
+            if (s_listen_fd[i] >= 0)
+            {
+                FD_SET(s_listen_fd[i], &fds);
+                max_fd = (s_listen_fd[i] > max_fd) ? s_listen_fd[i] : max_fd;
+            }
+
+            if (s_tcp_fd[i] >= 0)
+            {
+                FD_SET(s_tcp_fd[i], &fds);
+                max_fd = (s_tcp_fd[i] > max_fd) ? s_tcp_fd[i] : max_fd;
+            }
+        }
+
+        timeout.tv_sec = 0;
+        timeout.tv_usec = SWO_TRACE_SELECT_MS * 1000;
+
+        if (select(max_fd + 1, &fds, NULL, NULL, &timeout) > 0)
+        {
+            for (int i = 0; i < SWO_TRACE_SERVERS; i++)
+            {
+                /* Trace is one way, client input is only read to notice the close */
+                if ((s_tcp_fd[i] >= 0) && FD_ISSET(s_tcp_fd[i], &fds) && (recv(s_tcp_fd[i], buf, sizeof(buf), 0) <= 0))
+                {
+                    swo_trace_close(i);
+                }
+
+                if ((s_listen_fd[i] >= 0) && FD_ISSET(s_listen_fd[i], &fds))
+                {
+                    swo_trace_accept(i);
+                }
+            }
+        }
+
+        if ((s_setup == SWO_TRACE_SETUP_PENDING) || swo_trace_reattached())
+        {
+            xSemaphoreTake(s_client_mutex, portMAX_DELAY);
+            swo_trace_try_setup();
+            xSemaphoreGive(s_client_mutex);
+        }
+    }
+}
+
+bool swo_trace_init(void)
+{
+    if (s_mutex)
+    {
+        return true;
+    }
+
+    s_mutex = xSemaphoreCreateMutex();
+    s_client_mutex = xSemaphoreCreateMutex();
+
+    if (!s_mutex || !s_client_mutex)
+    {
+        ESP_LOGE(TAG, "Memory not enough");
+        return false;
+    }
+
+    for (int i = 0; i < SWO_TRACE_SERVERS; i++)
+    {
+        s_tcp_fd[i] = -1;
+        s_listen_fd[i] = -1;
+    }
+
+    if (CONFIG_SWO_TRACE_TCP_PORT)
+    {
+        s_listen_fd[0] = tcp_listen_open(CONFIG_SWO_TRACE_TCP_PORT);
+    }
+
+    for (int i = 1; CONFIG_SWO_TRACE_ITM_TCP_BASE && (i < SWO_TRACE_SERVERS); i++)
+    {
+        s_listen_fd[i] = tcp_listen_open(CONFIG_SWO_TRACE_ITM_TCP_BASE + i - 1);
+    }
+
+    swo_register_output(swo_trace_input);
+
+    if (xTaskCreate(swo_trace_task, "swo_trace", 3072, NULL, 5, NULL) != pdPASS)
+    {
+        return false;
+    }
+
+    ESP_LOGI(TAG, "SWO on port %d, ITM channels from port %d", CONFIG_SWO_TRACE_TCP_PORT, CONFIG_SWO_TRACE_ITM_TCP_BASE);
+
+    return true;
+}
+
+void swo_trace_register_output(void (*cb)(uint8_t port, const uint8_t *data, size_t size))
+{
+    s_output_cb = cb;
+}
+
+void swo_trace_set_baudrate(uint32_t baudrate)
+{
+    xSemaphoreTake(s_client_mutex, portMAX_DELAY);
+    s_baudrate = baudrate;
+
+    if (s_clients > 0)
+    {
+        swo_trace_restart();
+    }
+
+    xSemaphoreGive(s_client_mutex);
+}
+
+void swo_trace_get_status(char *buf, int size, int *encode_len)
+{
+    swo_stats_t swo;
+
+    swo_get_stats(&swo);
+    *encode_len = snprintf(buf, size,
+                           "{\"state\":\"%s\",\"baudrate\":%lu,\"host\":%s,\"clients\":%d,\"setup\":\"%s\",\"bytes\":%lu,"
+                           "\"overruns\":%lu,\"packets\":%lu,\"overflows\":%lu,\"syncs\":%lu,\"dropped\":%lu}",
+                           swo.baudrate ? "capturing" : "off", (unsigned long)swo.baudrate, swo.host_active ? "true" : "false",
+                           s_clients, s_setup_names[s_setup], (unsigned long)swo.bytes, (unsigned long)swo.overruns,
+                           (unsigned long)s_packets, (unsigned long)s_overflows, (unsigned long)s_syncs, (unsigned long)s_dropped);
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add SWO trace streaming and ITM decoder
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file swo_trace.h
+ * @brief SWO trace streaming with an on-probe ITM decoder
+ *
+ * While a client is connected SWO is captured at CONFIG_SWO_TRACE_BAUDRATE.
+ * The raw stream goes to the TCP client on CONFIG_SWO_TRACE_TCP_PORT, which
+ * Orbuculum and similar tools read directly. ITM software stimulus packets
+ * are decoded on the probe, stimulus port n goes to the TCP client on
+ * CONFIG_SWO_TRACE_ITM_TCP_BASE + n for the first CONFIG_SWO_TRACE_ITM_CHANNELS
+ * ports, and all ports go to the registered output.
+ *
+ * With CONFIG_SWO_TRACE_TARGET_SETUP the TPIU and ITM of the target are set
+ * up over SWD when capture starts, so plain ITM_SendChar() output shows up
+ * without a host debugger. A host that starts its own capture through the
+ * DAP_SWO_* commands sets up the target itself and its baudrate wins.
+ */
+
+/**
+ * @brief Start the trace servers
+ * @return true on success, false on failure
+ */
+bool swo_trace_init(void);
+
+/**
+ * @brief Register the decoded stimulus port output
+ *
+ * The callback runs in the SWO capture task, it must not block.
+ *
+ * @param cb Callback, port is the ITM stimulus port 0..31
+ */
+void swo_trace_register_output(void (*cb)(uint8_t port, const uint8_t *data, size_t size));
+
+/**
+ * @brief A client of the decoded output connected, capture starts with the first client
+ */
+void swo_trace_client_connected(void);
+
+/**
+ * @brief A client of the decoded output disconnected, capture stops with the last client
+ */
+void swo_trace_client_disconnected(void);
+
+/**
+ * @brief Set the SWO baudrate, a running capture restarts with it
+ * @param baudrate Baudrate in Hz
+ */
+void swo_trace_set_baudrate(uint32_t baudrate);
+
+/**
+ * @brief Get the trace status as JSON
+ * @param buf Output buffer
+ * @param size Buffer size
+ * @param encode_len Output: encoded length
+ */
+void swo_trace_get_status(char *buf, int size, int *encode_len);
+
+#ifdef __cplusplus
+}
+#endif
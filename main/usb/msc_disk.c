@@ -6,6 +6,7 @@
  * Change Logs:
  * Date           Author       Notes
  * 2023-9-8      lihongquan   add license declaration
+ * 2026-10-19    hongquan.li   add drag-and-drop drive mode
  */
 
 #include "tinyusb.h"
@@ -15,13 +16,20 @@
 #include "esp_log.h"
 #include "disk.h"
 #include "esp_check.h"
+#include "msc_vfs.h"
 
 static const char *TAG = "msc_disk";
 
 // mount the partition and show all the files in path
 bool msc_dick_mount(const char *path)
 {
-#ifdef CONFIG_MSC_STORAGE_MEDIA_SPIFLASH
+#if defined(CONFIG_MSC_STORAGE_MEDIA_VFS)
+    /* The FAT partition stays private to the probe, the host gets the virtual drive */
+    if (mount_spiflash_fs() != ESP_OK)
+        return false;
+
+    return msc_vfs_init();
+#elif defined(CONFIG_MSC_STORAGE_MEDIA_SPIFLASH)
     static wl_handle_t wl_handle = WL_INVALID_HANDLE;
     ESP_ERROR_CHECK(storage_init_spiflash(&wl_handle));
 
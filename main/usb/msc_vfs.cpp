@@ -0,0 +1,639 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add drag-and-drop programming drive
+ * 2026-10-19    hongquan.li   ignore the rest of an image that failed
+ */
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "tinyusb.h"
+#include "tusb.h"
+#include "usb/msc_vfs.h"
+#include "programmer/programmer.h"
+
+#define TAG "msc_vfs"
+
+/*
+ * Emulated FAT16 volume, 64MB so that any target image fits:
+ *   LBA 0          boot sector
+ *   LBA 1..128     two FATs of 64 sectors
+ *   LBA 129..160   root directory, 512 entries
+ *   LBA 161..      data area, 4KB clusters, DETAILS.TXT in cluster 2, FAIL.TXT in cluster 3
+ */
+#define VFS_SECTOR_SIZE 512
+#define VFS_SECTOR_NUM 0x20000
+#define VFS_CLUSTER_SECTORS 8
+#define VFS_FAT_SECTORS 64
+#define VFS_ROOT_ENTRIES 512
+#define VFS_FAT_START 1
+#define VFS_ROOT_START (VFS_FAT_START + 2 * VFS_FAT_SECTORS)
+#define VFS_DATA_START (VFS_ROOT_START + VFS_ROOT_ENTRIES * 32 / VFS_SECTOR_SIZE)
+#define VFS_DATA_SIZE ((VFS_SECTOR_NUM - VFS_DATA_START) * VFS_SECTOR_SIZE)
+#define VFS_CLUSTER_LBA(cluster) (VFS_DATA_START + ((cluster) - 2) * VFS_CLUSTER_SECTORS)
+#define VFS_DETAILS_CLUSTER 2
+#define VFS_FAIL_CLUSTER 3
+#define VFS_FAT_DATE 0x0021
+#define VFS_ATTR_READ_ONLY 0x01
+#define VFS_ATTR_VOLUME_ID 0x08
+#define VFS_ATTR_DIRECTORY 0x10
+#define VFS_ATTR_LFN 0x0F
+
+#define MSC_VFS_SLOT_WAIT_MS 5000
+#define MSC_VFS_REMOUNT_MS 500
+
+typedef struct
+{
+    uint32_t lba;       ///< First sector of the chunk
+    uint32_t len;       ///< Chunk length, whole sectors
+    uint8_t *buf;       ///< Sector data
+} msc_vfs_slot_t;
+
+typedef struct
+{
+    SemaphoreHandle_t mutex;                        ///< Guards the volume content served to the host
+    QueueHandle_t free_queue;                       ///< Empty slots
+    QueueHandle_t write_queue;                      ///< Slots written by the host
+    msc_vfs_slot_t *slots;                          ///< Slot pool
+    msc_vfs_slot_t *pending[CONFIG_MSC_VFS_BUFFERS];///< Slots that arrived ahead of the image
+    int pending_num;                                ///< Held slots
+    bool active;                                    ///< Image transfer running
+    bool owner;                                     ///< The programmer accepted our request
+    bool failed;                                    ///< Last transfer failed, FAIL.TXT is shown
+    bool skip;                                      ///< Ignoring the rest of a failed image
+    uint32_t skip_lba;                              ///< First sector of the failed image
+    uint32_t skip_end;                              ///< Sector after the failed image, UINT32_MAX until its size is known
+    uint32_t image_cluster;                         ///< First cluster of the image
+    uint32_t next_lba;                              ///< Next image sector expected
+    uint32_t written;                               ///< Bytes handed to the programmer
+    uint32_t image_size;                            ///< Size from the directory entry, 0 until seen
+    uint32_t start_tick;                            ///< Transfer start
+    volatile TickType_t ready_tick;                 ///< Medium reported absent until this tick
+    char details[VFS_SECTOR_SIZE];                  ///< DETAILS.TXT
+    char fail[128];                                 ///< FAIL.TXT
+    uint8_t root[VFS_SECTOR_SIZE];                  ///< First root directory sector
+} msc_vfs_ctx_t;
+
+static msc_vfs_ctx_t s_vfs;
+
+static inline void msc_vfs_put_le16(uint8_t *buf, uint16_t val)
+{
+    buf[0] = (uint8_t)val;
+    buf[1] = (uint8_t)(val >> 8);
+}
+
+static inline void msc_vfs_put_le32(uint8_t *buf, uint32_t val)
+{
+    msc_vfs_put_le16(buf, (uint16_t)val);
+    msc_vfs_put_le16(buf + 2, (uint16_t)(val >> 16));
+}
+
+static inline uint32_t msc_vfs_get_le16(const uint8_t *buf)
+{
+    return (uint32_t)buf[0] | ((uint32_t)buf[1] << 8);
+}
+
+static inline uint32_t msc_vfs_get_le32(const uint8_t *buf)
+{
+    return msc_vfs_get_le16(buf) | (msc_vfs_get_le16(buf + 2) << 16);
+}
+
+static void msc_vfs_put_entry(uint8_t *entry, const char *name, uint8_t attr, uint16_t cluster, uint32_t size)
+{
+    memcpy(entry, name, 11);
+    entry[11] = attr;
+    msc_vfs_put_le16(&entry[16], VFS_FAT_DATE);
+    msc_vfs_put_le16(&entry[18], VFS_FAT_DATE);
+    msc_vfs_put_le16(&entry[24], VFS_FAT_DATE);
+    msc_vfs_put_le16(&entry[26], cluster);
+    msc_vfs_put_le32(&entry[28], size);
+}
+
+/* Regenerates the files and the root directory, the host rereads them after a remount */
+static void msc_vfs_build(const char *result)
+{
+    xSemaphoreTake(s_vfs.mutex, portMAX_DELAY);
+
+    snprintf(s_vfs.details, sizeof(s_vfs.details),
+             "ESP32 DAPLink drag-and-drop programming\r\n"
+             "Copy a .hex or .bin image to this drive to program the target.\r\n\r\n"
+             "Algorithm: %s\r\n"
+             "Flash address: 0x%08lx\r\n"
+             "RAM address: 0x%08lx\r\n"
+             "Last result: %s\r\n",
+             CONFIG_MSC_VFS_ALGORITHM, (unsigned long)CONFIG_MSC_VFS_FLASH_ADDR,
+             (unsigned long)CONFIG_MSC_VFS_RAM_ADDR, result);
+
+    memset(s_vfs.root, 0, sizeof(s_vfs.root));
+    msc_vfs_put_entry(&s_vfs.root[0], "DAPLINK    ", VFS_ATTR_VOLUME_ID, 0, 0);
+    msc_vfs_put_entry(&s_vfs.root[32], "DETAILS TXT", VFS_ATTR_READ_ONLY, VFS_DETAILS_CLUSTER, strlen(s_vfs.details));
+
+    if (s_vfs.failed)
+    {
+        msc_vfs_put_entry(&s_vfs.root[64], "FAIL    TXT", VFS_ATTR_READ_ONLY, VFS_FAIL_CLUSTER, strlen(s_vfs.fail));
+    }
+
+    xSemaphoreGive(s_vfs.mutex);
+}
+
+static void msc_vfs_read_sector(uint32_t lba, uint8_t *buf)
+{
+    memset(buf, 0, VFS_SECTOR_SIZE);
+
+    if (lba == 0)
+    {
+        static const uint8_t jump[] = {0xEB, 0x3C, 0x90};
+
+        memcpy(&buf[0], jump, sizeof(jump));
+        memcpy(&buf[3], "MSWIN4.1", 8);
+        msc_vfs_put_le16(&buf[11], VFS_SECTOR_SIZE);
+        buf[13] = VFS_CLUSTER_SECTORS;
+        msc_vfs_put_le16(&buf[14], VFS_FAT_START);
+        buf[16] = 2;
+        msc_vfs_put_le16(&buf[17], VFS_ROOT_ENTRIES);
+        buf[21] = 0xF8;
+        msc_vfs_put_le16(&buf[22], VFS_FAT_SECTORS);
+        msc_vfs_put_le16(&buf[24], 63);
+        msc_vfs_put_le16(&buf[26], 255);
+        msc_vfs_put_le32(&buf[32], VFS_SECTOR_NUM);
+        buf[36] = 0x80;
+        buf[38] = 0x29;
+        msc_vfs_put_le32(&buf[39], 0x44415031);
+        memcpy(&buf[43], "DAPLINK    ", 11);
+        memcpy(&buf[54], "FAT16   ", 8);
+        buf[510] = 0x55;
+        buf[511] = 0xAA;
+    }
+    else if ((lba < VFS_ROOT_START) && (((lba - VFS_FAT_START) % VFS_FAT_SECTORS) == 0))
+    {
+        /* Media and reserved entries, then one cluster per file */
+        msc_vfs_put_le16(&buf[0], 0xFFF8);
+        msc_vfs_put_le16(&buf[2], 0xFFFF);
+        msc_vfs_put_le16(&buf[VFS_DETAILS_CLUSTER * 2], 0xFFFF);
+        msc_vfs_put_le16(&buf[VFS_FAIL_CLUSTER * 2], 0xFFFF);
+    }
+    else if (lba == VFS_ROOT_START)
+    {
+        xSemaphoreTake(s_vfs.mutex, portMAX_DELAY);
+        memcpy(buf, s_vfs.root, VFS_SECTOR_SIZE);
+        xSemaphoreGive(s_vfs.mutex);
+    }
+    else if (lba == VFS_CLUSTER_LBA(VFS_DETAILS_CLUSTER))
+    {
+        xSemaphoreTake(s_vfs.mutex, portMAX_DELAY);
+        memcpy(buf, s_vfs.details, strlen(s_vfs.details));
+        xSemaphoreGive(s_vfs.mutex);
+    }
+    else if (lba == VFS_CLUSTER_LBA(VFS_FAIL_CLUSTER))
+    {
+        xSemaphoreTake(s_vfs.mutex, portMAX_DELAY);
+        memcpy(buf, s_vfs.fail, strlen(s_vfs.fail));
+        xSemaphoreGive(s_vfs.mutex);
+    }
+}
+
+static const char *msc_vfs_image_format(const uint8_t *sector)
+{
+    uint32_t sp = msc_vfs_get_le32(&sector[0]);
+    uint32_t reset = msc_vfs_get_le32(&sector[4]);
+
+    /* Intel HEX starts with a record, usually an extended address one */
+    if ((sector[0] == ':') && isxdigit(sector[1]) && isxdigit(sector[2]))
+    {
+        return "hex";
+    }
+
+    /* A Cortex-M vector table: stack in RAM, Thumb reset handler in flash */
+    if (((sp >> 24) == (CONFIG_MSC_VFS_RAM_ADDR >> 24)) && (reset & 1) &&
+        ((reset >> 24) == (CONFIG_MSC_VFS_FLASH_ADDR >> 24)))
+    {
+        return "bin";
+    }
+
+    return NULL;
+}
+
+static void msc_vfs_finish(const char *reason)
+{
+    char result[96];
+    uint32_t elapsed = pdTICKS_TO_MS(xTaskGetTickCount() - s_vfs.start_tick);
+
+    if (!s_vfs.active)
+    {
+        return;
+    }
+
+    s_vfs.active = false;
+
+    if (!reason && s_vfs.pending_num)
+    {
+        reason = "Image incomplete, sectors missing";
+    }
+
+    if (!reason && s_vfs.image_size && (s_vfs.written < s_vfs.image_size))
+    {
+        reason = "Image incomplete, transfer stopped";
+    }
+
+    /* An empty write ends the stream and flushes the last page */
+    if (s_vfs.owner && (programmer_write_data(NULL, 0) != PROG_ERR_NONE) && !reason)
+    {
+        reason = "Target programming failed";
+    }
+
+    s_vfs.owner = false;
+
+    while (s_vfs.pending_num)
+    {
+        xQueueSend(s_vfs.free_queue, &s_vfs.pending[--s_vfs.pending_num], 0);
+    }
+
+    s_vfs.failed = (reason != NULL);
+
+    /* The host keeps writing the rest of a failed image, none of its clusters may start a new job */
+    s_vfs.skip = s_vfs.failed;
+    s_vfs.skip_lba = VFS_CLUSTER_LBA(s_vfs.image_cluster);
+    s_vfs.skip_end = s_vfs.image_size ? (s_vfs.skip_lba + (s_vfs.image_size + VFS_SECTOR_SIZE - 1) / VFS_SECTOR_SIZE) : UINT32_MAX;
+
+    if (reason)
+    {
+        ESP_LOGE(TAG, "%s", reason);
+        snprintf(s_vfs.fail, sizeof(s_vfs.fail), "%s\r\n", reason);
+        snprintf(result, sizeof(result), "failed, %s", reason);
+    }
+    else
+    {
+        ESP_LOGI(TAG, "Programmed %lu bytes in %lu ms", s_vfs.written, elapsed);
+        snprintf(result, sizeof(result), "success, %lu bytes in %lu ms", s_vfs.written, elapsed);
+    }
+
+    msc_vfs_build(result);
+    /* Drop the medium for a moment so the host rereads the directory */
+    s_vfs.ready_tick = xTaskGetTickCount() + pdMS_TO_TICKS(MSC_VFS_REMOUNT_MS);
+}
+
+static void msc_vfs_start(const uint8_t *sector, uint32_t lba)
+{
+    char request[256];
+    int len = 0;
+    prog_err_def ret = PROG_ERR_NONE;
+    const char *format = msc_vfs_image_format(sector);
+
+    if (!format)
+    {
+        return;
+    }
+
+    /* The size is unknown until the directory entry is written, the stream is ended explicitly */
+    len = snprintf(request, sizeof(request),
+                   "{\"program_mode\":\"online\",\"format\":\"%s\",\"algorithm\":\"%s\","
+                   "\"flash_addr\":%lu,\"ram_addr\":%lu,\"total_size\":%lu}",
+                   format, CONFIG_MSC_VFS_ALGORITHM, (unsigned long)CONFIG_MSC_VFS_FLASH_ADDR,
+                   (unsigned long)CONFIG_MSC_VFS_RAM_ADDR, (unsigned long)VFS_DATA_SIZE);
+
+    s_vfs.active = true;
+    s_vfs.image_cluster = (lba - VFS_DATA_START) / VFS_CLUSTER_SECTORS + 2;
+    s_vfs.next_lba = lba;
+    s_vfs.written = 0;
+    s_vfs.image_size = 0;
+    s_vfs.start_tick = xTaskGetTickCount();
+    ESP_LOGI(TAG, "%s image at cluster %lu", format, s_vfs.image_cluster);
+
+    ret = programmer_request_handle(request, len);
+    s_vfs.owner = (ret == PROG_ERR_NONE);
+
+    if (ret != PROG_ERR_NONE)
+    {
+        ESP_LOGE(TAG, "Request refused: %d", ret);
+        msc_vfs_finish((ret == PROG_ERR_BUSY) ? "Programmer busy" : "Invalid drag-and-drop configuration");
+    }
+}
+
+static void msc_vfs_program(uint8_t *data, uint32_t len)
+{
+    if (s_vfs.image_size && (s_vfs.written + len > s_vfs.image_size))
+    {
+        len = (s_vfs.written < s_vfs.image_size) ? (s_vfs.image_size - s_vfs.written) : 0;
+    }
+
+    if (len == 0)
+    {
+        return;
+    }
+
+    if (programmer_write_data(data, len) != PROG_ERR_NONE)
+    {
+        /* The programmer has already dropped the job */
+        s_vfs.owner = false;
+        msc_vfs_finish("Target programming failed");
+        return;
+    }
+
+    s_vfs.written += len;
+}
+
+/* Picks the image size out of its directory entry, for the running image or the one being skipped */
+static void msc_vfs_write_dir(uint32_t lba, const uint8_t *sector)
+{
+    const uint8_t *entry = NULL;
+    uint32_t size = 0;
+
+    if (lba == VFS_ROOT_START)
+    {
+        xSemaphoreTake(s_vfs.mutex, portMAX_DELAY);
+        memcpy(s_vfs.root, sector, VFS_SECTOR_SIZE);
+        xSemaphoreGive(s_vfs.mutex);
+    }
+
+    if (!s_vfs.active && !s_vfs.skip)
+    {
+        return;
+    }
+
+    for (int i = 0; i < VFS_SECTOR_SIZE / 32; i++)
+    {
+        entry = &sector[i * 32];
+
+        if (entry[0] == 0)
+        {
+            break;
+        }
+
+        if ((entry[0] == 0xE5) || (entry[11] == VFS_ATTR_LFN) || (entry[11] & (VFS_ATTR_VOLUME_ID | VFS_ATTR_DIRECTORY)))
+        {
+            continue;
+        }
+
+        if ((msc_vfs_get_le16(&entry[26]) | (msc_vfs_get_le16(&entry[20]) << 16)) != s_vfs.image_cluster)
+        {
+            continue;
+        }
+
+        size = msc_vfs_get_le32(&entry[28]);
+
+        if (s_vfs.active)
+        {
+            s_vfs.image_size = size;
+        }
+        else if (size)
+        {
+            s_vfs.skip_end = s_vfs.skip_lba + (size + VFS_SECTOR_SIZE - 1) / VFS_SECTOR_SIZE;
+        }
+    }
+}
+
+static uint32_t msc_vfs_first_data_lba(const msc_vfs_slot_t *slot)
+{
+    return (slot->lba > VFS_DATA_START) ? slot->lba : VFS_DATA_START;
+}
+
+/* Returns false when the slot is held back until the sectors before it arrive */
+static bool msc_vfs_handle(msc_vfs_slot_t *slot)
+{
+    uint32_t sectors = slot->len / VFS_SECTOR_SIZE;
+    uint32_t lba = slot->lba;
+    uint8_t *data = slot->buf;
+
+    for (uint32_t i = 0; i < sectors; i++, lba++, data += VFS_SECTOR_SIZE)
+    {
+        /* Boot sector and FAT writes are ignored, the layout never changes */
+        if (lba < VFS_ROOT_START)
+        {
+            continue;
+        }
+
+        if (lba < VFS_DATA_START)
+        {
+            msc_vfs_write_dir(lba, data);
+            continue;
+        }
+
+        if (s_vfs.skip && (lba >= s_vfs.skip_lba) && (lba < s_vfs.skip_end))
+        {
+            continue;
+        }
+
+        if (!s_vfs.active && (((lba - VFS_DATA_START) % VFS_CLUSTER_SECTORS) == 0))
+        {
+            msc_vfs_start(data, lba);
+        }
+
+        /* Other files, or sectors already programmed */
+        if (!s_vfs.active || (lba < s_vfs.next_lba))
+        {
+            continue;
+        }
+
+        if (lba > s_vfs.next_lba)
+        {
+            /* Keep one slot free for the sectors we are waiting for */
+            if (s_vfs.pending_num >= CONFIG_MSC_VFS_BUFFERS - 1)
+            {
+                msc_vfs_finish("Too many sectors out of order");
+                return true;
+            }
+
+            s_vfs.pending[s_vfs.pending_num++] = slot;
+            return false;
+        }
+
+        /* The rest of the chunk is contiguous, program it in one go */
+        msc_vfs_program(data, (sectors - i) * VFS_SECTOR_SIZE);
+        s_vfs.next_lba += sectors - i;
+        break;
+    }
+
+    return true;
+}
+
+static void msc_vfs_drain_pending(void)
+{
+    bool progress = true;
+
+    while (progress && s_vfs.active)
+    {
+        progress = false;
+
+        for (int i = 0; i < s_vfs.pending_num; i++)
+        {
+            msc_vfs_slot_t *slot = s_vfs.pending[i];
+
+            if (msc_vfs_first_data_lba(slot) <= s_vfs.next_lba)
+            {
+                s_vfs.pending[i] = s_vfs.pending[--s_vfs.pending_num];
+
+                if (msc_vfs_handle(slot))
+                {
+                    xQueueSend(s_vfs.free_queue, &slot, 0);
+                }
+
+                progress = true;
+                break;
+            }
+        }
+    }
+}
+
+/* Feeds host writes to the programmer so USB transfers overlap target programming */
+static void msc_vfs_task(void *pvParameters)
+{
+    msc_vfs_slot_t *slot = NULL;
+
+    for (;;)
+    {
+        if (xQueueReceive(s_vfs.write_queue, &slot, (s_vfs.active || s_vfs.skip) ? pdMS_TO_TICKS(CONFIG_MSC_VFS_IDLE_MS) : portMAX_DELAY) != pdTRUE)
+        {
+            /* The host went quiet, the image is complete or the failed one is over */
+            s_vfs.skip = false;
+            msc_vfs_finish(NULL);
+            continue;
+        }
+
+        if (msc_vfs_handle(slot))
+        {
+            xQueueSend(s_vfs.free_queue, &slot, 0);
+        }
+
+        msc_vfs_drain_pending();
+
+        if (s_vfs.active && s_vfs.image_size && (s_vfs.written >= s_vfs.image_size))
+        {
+            msc_vfs_finish(NULL);
+        }
+    }
+}
+
+bool msc_vfs_init(void)
+{
+    msc_vfs_slot_t *slot = NULL;
+
+    s_vfs.mutex = xSemaphoreCreateMutex();
+    s_vfs.free_queue = xQueueCreate(CONFIG_MSC_VFS_BUFFERS, sizeof(msc_vfs_slot_t *));
+    s_vfs.write_queue = xQueueCreate(CONFIG_MSC_VFS_BUFFERS, sizeof(msc_vfs_slot_t *));
+    s_vfs.slots = (msc_vfs_slot_t *)calloc(CONFIG_MSC_VFS_BUFFERS, sizeof(msc_vfs_slot_t));
+
+    if (!s_vfs.mutex || !s_vfs.free_queue || !s_vfs.write_queue || !s_vfs.slots)
+    {
+        goto __error;
+    }
+
+    for (int i = 0; i < CONFIG_MSC_VFS_BUFFERS; i++)
+    {
+        slot = &s_vfs.slots[i];
+        slot->buf = (uint8_t *)malloc(CONFIG_TINYUSB_MSC_BUFSIZE);
+
+        if (!slot->buf)
+        {
+            goto __error;
+        }
+
+        xQueueSend(s_vfs.free_queue, &slot, 0);
+    }
+
+    msc_vfs_build("none");
+
+    if (pdPASS != xTaskCreate(msc_vfs_task, "msc_vfs", 4096, NULL, 3, NULL))
+    {
+        goto __error;
+    }
+
+    ESP_LOGI(TAG, "Drag-and-drop drive ready, algorithm: %s", CONFIG_MSC_VFS_ALGORITHM);
+
+    return true;
+
+__error:
+    ESP_LOGE(TAG, "Memory not enough");
+
+    return false;
+}
+
+extern "C" void tud_msc_inquiry_cb(uint8_t lun, uint8_t vendor_id[8], uint8_t product_id[16], uint8_t product_rev[4])
+{
+    memcpy(vendor_id, "ESP32   ", 8);
+    memcpy(product_id, "DAPLink VFS     ", 16);
+    memcpy(product_rev, "1.0 ", 4);
+}
+
+extern "C" bool tud_msc_test_unit_ready_cb(uint8_t lun)
+{
+    if ((int32_t)(xTaskGetTickCount() - s_vfs.ready_tick) < 0)
+    {
+        tud_msc_set_sense(lun, SCSI_SENSE_NOT_READY, 0x3A, 0x00);
+        return false;
+    }
+
+    return true;
+}
+
+extern "C" void tud_msc_capacity_cb(uint8_t lun, uint32_t *block_count, uint16_t *block_size)
+{
+    *block_count = VFS_SECTOR_NUM;
+    *block_size = VFS_SECTOR_SIZE;
+}
+
+extern "C" bool tud_msc_start_stop_cb(uint8_t lun, uint8_t power_condition, bool start, bool load_eject)
+{
+    return true;
+}
+
+extern "C" int32_t tud_msc_read10_cb(uint8_t lun, uint32_t lba, uint32_t offset, void *buffer, uint32_t bufsize)
+{
+    uint8_t *buf = (uint8_t *)buffer;
+
+    lba += offset / VFS_SECTOR_SIZE;
+
+    for (uint32_t n = 0; n + VFS_SECTOR_SIZE <= bufsize; n += VFS_SECTOR_SIZE)
+    {
+        msc_vfs_read_sector(lba++, &buf[n]);
+    }
+
+    return bufsize;
+}
+
+extern "C" int32_t tud_msc_write10_cb(uint8_t lun, uint32_t lba, uint32_t offset, uint8_t *buffer, uint32_t bufsize)
+{
+    msc_vfs_slot_t *slot = NULL;
+
+    if (bufsize > CONFIG_TINYUSB_MSC_BUFSIZE)
+    {
+        return -1;
+    }
+
+    /* Blocks only while every slot is waiting for the target */
+    if (xQueueReceive(s_vfs.free_queue, &slot, pdMS_TO_TICKS(MSC_VFS_SLOT_WAIT_MS)) != pdTRUE)
+    {
+        ESP_LOGE(TAG, "Target programming stalled");
+        return -1;
+    }
+
+    slot->lba = lba + offset / VFS_SECTOR_SIZE;
+    slot->len = bufsize;
+    memcpy(slot->buf, buffer, bufsize);
+    xQueueSend(s_vfs.write_queue, &slot, portMAX_DELAY);
+
+    return bufsize;
+}
+
+extern "C" int32_t tud_msc_scsi_cb(uint8_t lun, uint8_t const scsi_cmd[16], void *buffer, uint16_t bufsize)
+{
+    switch (scsi_cmd[0])
+    {
+    case SCSI_CMD_PREVENT_ALLOW_MEDIUM_REMOVAL:
+        return 0;
+
+    default:
+        tud_msc_set_sense(lun, SCSI_SENSE_ILLEGAL_REQUEST, 0x20, 0x00);
+        return -1;
+    }
+}
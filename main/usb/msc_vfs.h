@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add drag-and-drop programming drive
+ */
+#pragma once
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Start the drag-and-drop programming drive
+ *
+ * The host sees a small emulated FAT16 volume instead of the FAT partition.
+ * A .hex or .bin image copied to it is recognised by its first sector and
+ * streamed straight into the online programmer, sectors written out of order
+ * are held back until the data before them arrives. The outcome is reported
+ * in DETAILS.TXT and, on error, FAIL.TXT.
+ *
+ * @return true on success, false on failure
+ */
+bool msc_vfs_init(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -7,6 +7,7 @@
  * Date           Author       Notes
  * 2023-9-8      lihongquan   add license declaration
  * 2026-3-17     refactor     Add USB connection state detection
+ * 2026-10-19    hongquan.li   send large UART batches in pieces
  */
 #include "usb/usb_cdc_handler.h"
 #include "serial/cdc_uart.h"
@@ -27,7 +28,26 @@ void usb_cdc_send_to_host(void *context, uint8_t *data, size_t size)
 
     if (tud_cdc_n_connected((int)context))
     {
-        tinyusb_cdcacm_write_queue((tinyusb_cdcacm_itf_t)context, data, size);
+        /* UART batches can be larger than the CDC TX FIFO, queue them in pieces */
+        while (size > 0)
+        {
+            size_t queued = tinyusb_cdcacm_write_queue((tinyusb_cdcacm_itf_t)context, data, size);
+
+            if (queued == 0)
+            {
+                /* The host is not reading, drop the rest rather than stall the UART */
+                if (tinyusb_cdcacm_write_flush((tinyusb_cdcacm_itf_t)context, pdMS_TO_TICKS(10)) != ESP_OK)
+                {
+                    break;
+                }
+
+                continue;
+            }
+
+            data += queued;
+            size -= queued;
+        }
+
         tinyusb_cdcacm_write_flush((tinyusb_cdcacm_itf_t)context, 1);
     }
 }
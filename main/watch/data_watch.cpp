@@ -0,0 +1,499 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add live variable sampler
+ * 2026-10-19    hongquan.li   sample under the DAP try-lock
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "watch/data_watch.h"
+#include "programmer/programmer.h"
+#include "target_swd.h"
+#include "dap_arbiter.h"
+
+#define DATA_WATCH_HDR_SIZE 8
+#define DATA_WATCH_TIME_SIZE 4
+#define DATA_WATCH_TYPE_SAMPLES 0x01
+#define DATA_WATCH_FLAG_LOST 0x01
+/* TAR only auto-increments within 1 KB, read_memory splits a block there anyway */
+#define DATA_WATCH_TAR_PAGE 1024
+
+static_assert((CONFIG_DATA_WATCH_LINE_SIZE >= 4) && !(CONFIG_DATA_WATCH_LINE_SIZE & (CONFIG_DATA_WATCH_LINE_SIZE - 1)),
+              "Watch line size must be a power of 2 of at least 4");
+static_assert((CONFIG_DATA_WATCH_MAX_BYTES % 4) == 0, "Watch read size must be a multiple of 4");
+
+typedef struct
+{
+    uint32_t start;     ///< Line aligned target address
+    uint32_t size;      ///< Multiple of the line size
+    uint32_t offset;    ///< Offset in s_read
+} data_watch_block_t;
+
+typedef struct
+{
+    uint32_t src;       ///< Offset of the value in s_read
+    uint8_t size;       ///< Value size
+} data_watch_slot_t;
+
+typedef enum
+{
+    DATA_WATCH_STATE_OFF,       ///< No variable list
+    DATA_WATCH_STATE_PAUSED,    ///< A debugger or the programmer has the port
+    DATA_WATCH_STATE_RUNNING,   ///< Sampling
+    DATA_WATCH_STATE_ERROR      ///< The last sample could not be read
+} data_watch_state_t;
+
+static const char *TAG = "data_watch";
+static const char *const s_state_names[] = {"off", "paused", "running", "error"};
+
+static SemaphoreHandle_t s_mutex = NULL;
+static TaskHandle_t s_task = NULL;
+static esp_timer_handle_t s_timer = NULL;
+static void (*s_output_cb)(const uint8_t *data, size_t size) = NULL;
+
+/* Sampling plan, guarded by s_mutex */
+static data_watch_slot_t s_slots[CONFIG_DATA_WATCH_MAX_VARS];
+static data_watch_block_t s_blocks[CONFIG_DATA_WATCH_MAX_VARS];
+static int s_slot_num = 0;
+static int s_block_num = 0;
+static uint32_t s_read_bytes = 0;
+static uint32_t s_record_size = 0;
+static uint32_t s_rate = 0;
+static uint32_t s_read[CONFIG_DATA_WATCH_MAX_BYTES / 4];
+
+/* Current batch, guarded by s_mutex */
+static uint8_t s_batch[CONFIG_DATA_WATCH_BATCH_SIZE];
+static size_t s_batch_len = 0;
+static uint16_t s_batch_count = 0;
+static uint32_t s_batch_seq = 0;
+static int64_t s_batch_us = 0;
+static uint32_t s_seq = 0;
+static uint32_t s_next_seq = 0;
+static bool s_lost = false;
+
+/* Status */
+static volatile data_watch_state_t s_state = DATA_WATCH_STATE_OFF;
+static volatile uint32_t s_samples = 0;
+static volatile uint32_t s_overruns = 0;
+static volatile uint32_t s_errors = 0;
+static volatile uint32_t s_sample_us = 0;
+static volatile uint32_t s_sample_max_us = 0;
+
+/* Port state, guarded by s_mutex */
+static bool s_attached = false;
+static uint32_t s_commands = 0;
+
+static void put_u16(uint8_t *buf, uint16_t val)
+{
+    buf[0] = val & 0xFF;
+    buf[1] = val >> 8;
+}
+
+static void put_u32(uint8_t *buf, uint32_t val)
+{
+    buf[0] = val & 0xFF;
+    buf[1] = (val >> 8) & 0xFF;
+    buf[2] = (val >> 16) & 0xFF;
+    buf[3] = val >> 24;
+}
+
+/*
+ * Variables are sorted and widened to whole lines, lines that touch or
+ * overlap the previous block extend it. A new block costs a CSW and a TAR
+ * write plus the posted read, about as much as the unused words a line
+ * adds, and merely touching lines are not joined across a TAR page.
+ */
+static data_watch_err_t data_watch_plan(const data_watch_var_t *vars, int count)
+{
+    uint16_t order[CONFIG_DATA_WATCH_MAX_VARS];
+    uint16_t block_of[CONFIG_DATA_WATCH_MAX_VARS];
+    uint32_t start = 0;
+    uint32_t end = 0;
+    uint32_t offset = 0;
+    uint32_t record = DATA_WATCH_TIME_SIZE;
+    uint16_t tmp = 0;
+    int blocks = 0;
+    int j = 0;
+    data_watch_block_t *blk = NULL;
+
+    for (int i = 0; i < count; i++)
+    {
+        tmp = i;
+
+        for (j = i; (j > 0) && (vars[order[j - 1]].addr > vars[tmp].addr); j--)
+        {
+            order[j] = order[j - 1];
+        }
+
+        order[j] = tmp;
+        record += vars[i].size;
+    }
+
+    if (record > CONFIG_DATA_WATCH_BATCH_SIZE - DATA_WATCH_HDR_SIZE)
+    {
+        return DATA_WATCH_ERR_TOO_LARGE;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        const data_watch_var_t &var = vars[order[i]];
+
+        start = var.addr & ~(CONFIG_DATA_WATCH_LINE_SIZE - 1);
+        end = (var.addr + var.size + CONFIG_DATA_WATCH_LINE_SIZE - 1) & ~(CONFIG_DATA_WATCH_LINE_SIZE - 1);
+        blk = blocks ? &s_blocks[blocks - 1] : NULL;
+
+        if (blk && ((start < blk->start + blk->size) ||
+                    ((start == blk->start + blk->size) && ((start / DATA_WATCH_TAR_PAGE) == (blk->start / DATA_WATCH_TAR_PAGE)))))
+        {
+            if (end > blk->start + blk->size)
+            {
+                blk->size = end - blk->start;
+            }
+        }
+        else
+        {
+            s_blocks[blocks].start = start;
+            s_blocks[blocks].size = end - start;
+            blocks++;
+        }
+
+        block_of[order[i]] = blocks - 1;
+    }
+
+    for (int i = 0; i < blocks; i++)
+    {
+        s_blocks[i].offset = offset;
+        offset += s_blocks[i].size;
+    }
+
+    if (offset > CONFIG_DATA_WATCH_MAX_BYTES)
+    {
+        return DATA_WATCH_ERR_TOO_LARGE;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        blk = &s_blocks[block_of[i]];
+        s_slots[i].src = blk->offset + (vars[i].addr - blk->start);
+        s_slots[i].size = vars[i].size;
+    }
+
+    s_slot_num = count;
+    s_block_num = blocks;
+    s_read_bytes = offset;
+    s_record_size = record;
+
+    return DATA_WATCH_OK;
+}
+
+static void data_watch_flush(void)
+{
+    if (s_batch_count == 0)
+    {
+        return;
+    }
+
+    s_batch[0] = DATA_WATCH_TYPE_SAMPLES;
+    s_batch[1] = s_lost ? DATA_WATCH_FLAG_LOST : 0;
+    put_u16(s_batch + 2, s_batch_count);
+    put_u32(s_batch + 4, s_batch_seq);
+
+    if (s_output_cb)
+    {
+        s_output_cb(s_batch, s_batch_len);
+    }
+
+    s_batch_count = 0;
+    s_batch_len = DATA_WATCH_HDR_SIZE;
+}
+
+static void data_watch_append(uint32_t timestamp)
+{
+    uint8_t *record = NULL;
+    bool gap = (s_seq != s_next_seq);
+
+    /* Records in a batch are consecutive, a gap starts a new one */
+    if ((s_batch_count && gap) || (s_batch_len + s_record_size > sizeof(s_batch)))
+    {
+        data_watch_flush();
+    }
+
+    if (s_batch_count == 0)
+    {
+        s_batch_len = DATA_WATCH_HDR_SIZE;
+        s_batch_seq = s_seq;
+        s_batch_us = esp_timer_get_time();
+        s_lost = gap;
+    }
+
+    record = s_batch + s_batch_len;
+    put_u32(record, timestamp);
+    record += DATA_WATCH_TIME_SIZE;
+
+    for (int i = 0; i < s_slot_num; i++)
+    {
+        memcpy(record, (uint8_t *)s_read + s_slots[i].src, s_slots[i].size);
+        record += s_slots[i].size;
+    }
+
+    s_batch_len += s_record_size;
+    s_batch_count++;
+    s_next_seq = s_seq + 1;
+}
+
+static void data_watch_sample(SWDIface &swd)
+{
+    bool ok = false;
+    int64_t start = 0;
+    uint32_t elapsed = 0;
+    dap_arbiter_stats_t stats;
+
+    /* Only when nobody else needs the port, a host debugger would lose its DP state under us.
+     * Checked under the lock, a session cannot claim the port between the check and the reads. */
+    if (programmer_is_busy() || !dap_arbiter_try_lock())
+    {
+        s_attached = false;
+        s_state = DATA_WATCH_STATE_PAUSED;
+        s_seq++;
+        return;
+    }
+
+    /* Whoever held the lock since the last sample may have reset the port or switched it off */
+    dap_arbiter_get_stats(&stats);
+    if (!s_attached || (stats.commands != s_commands))
+    {
+        s_attached = swd.set_target_state(SWDIface::TARGET_DEBUG);
+    }
+
+    start = esp_timer_get_time();
+    ok = s_attached;
+
+    /* AHB-AP reads, the core keeps running */
+    for (int i = 0; ok && (i < s_block_num); i++)
+    {
+        ok = swd.read_memory(s_blocks[i].start, (uint8_t *)s_read + s_blocks[i].offset, s_blocks[i].size);
+    }
+
+    elapsed = esp_timer_get_time() - start;
+
+    /* This unlock counts as a command too */
+    s_commands = stats.commands + 1;
+    dap_arbiter_unlock();
+
+    if (!ok)
+    {
+        s_attached = false;
+        s_errors++;
+        s_state = DATA_WATCH_STATE_ERROR;
+        s_seq++;
+        return;
+    }
+
+    s_sample_us = elapsed;
+    s_sample_max_us = (elapsed > s_sample_max_us) ? elapsed : s_sample_max_us;
+    s_state = DATA_WATCH_STATE_RUNNING;
+    s_samples++;
+
+    data_watch_append((uint32_t)start);
+    s_seq++;
+}
+
+static void data_watch_task(void *param)
+{
+    uint32_t pending = 0;
+    SWDIface &swd = TargetSWD::get_instance();
+
+    for (;;)
+    {
+        /* The timeout flushes the batch at low rates */
+        pending = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CONFIG_DATA_WATCH_BATCH_MS) ? pdMS_TO_TICKS(CONFIG_DATA_WATCH_BATCH_MS) : 1);
+
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+        if (pending && s_slot_num)
+        {
+            /* The timer fired again before the previous sample was done */
+            if (pending > 1)
+            {
+                s_overruns += pending - 1;
+                s_seq += pending - 1;
+            }
+
+            data_watch_sample(swd);
+        }
+
+        if (s_batch_count && ((esp_timer_get_time() - s_batch_us) >= CONFIG_DATA_WATCH_BATCH_MS * 1000))
+        {
+            data_watch_flush();
+        }
+
+        xSemaphoreGive(s_mutex);
+    }
+}
+
+static void data_watch_timer_cb(void *arg)
+{
+    xTaskNotifyGive(s_task);
+}
+
+bool data_watch_init(void)
+{
+    esp_timer_create_args_t args = {};
+
+    if (s_mutex)
+    {
+        return true;
+    }
+
+    s_mutex = xSemaphoreCreateMutex();
+    if (!s_mutex)
+    {
+        ESP_LOGE(TAG, "Memory not enough");
+        return false;
+    }
+
+    if (xTaskCreate(data_watch_task, "data_watch", 3072, NULL, 3, &s_task) != pdPASS)
+    {
+        return false;
+    }
+
+    args.callback = data_watch_timer_cb;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "data_watch";
+
+    if (esp_timer_create(&args, &s_timer) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to create the sample timer");
+        return false;
+    }
+
+    return true;
+}
+
+void data_watch_register_output(void (*cb)(const uint8_t *data, size_t size))
+{
+    s_output_cb = cb;
+}
+
+data_watch_err_t data_watch_start(const data_watch_var_t *vars, int count, uint32_t rate_hz)
+{
+    data_watch_err_t err = DATA_WATCH_OK;
+
+    if (!s_timer)
+    {
+        return DATA_WATCH_ERR_NOT_READY;
+    }
+
+    if ((rate_hz == 0) || (rate_hz > CONFIG_DATA_WATCH_MAX_RATE))
+    {
+        return DATA_WATCH_ERR_RATE;
+    }
+
+    if (count > CONFIG_DATA_WATCH_MAX_VARS)
+    {
+        return DATA_WATCH_ERR_TOO_MANY;
+    }
+
+    if (!vars || (count <= 0))
+    {
+        return DATA_WATCH_ERR_VAR;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        if (((vars[i].size != 1) && (vars[i].size != 2) && (vars[i].size != 4) && (vars[i].size != 8)) ||
+            (vars[i].addr > UINT32_MAX - CONFIG_DATA_WATCH_LINE_SIZE))
+        {
+            return DATA_WATCH_ERR_VAR;
+        }
+    }
+
+    data_watch_stop();
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    err = data_watch_plan(vars, count);
+    if (err == DATA_WATCH_OK)
+    {
+        s_rate = rate_hz;
+        s_seq = 0;
+        s_next_seq = 0;
+        s_samples = 0;
+        s_overruns = 0;
+        s_errors = 0;
+        s_sample_us = 0;
+        s_sample_max_us = 0;
+        s_state = DATA_WATCH_STATE_RUNNING;
+    }
+
+    xSemaphoreGive(s_mutex);
+
+    if (err != DATA_WATCH_OK)
+    {
+        return err;
+    }
+
+    ESP_LOGI(TAG, "%d variables in %d blocks of %lu bytes at %lu Hz", count, s_block_num,
+             (unsigned long)s_read_bytes, (unsigned long)rate_hz);
+
+    esp_timer_start_periodic(s_timer, 1000000 / rate_hz);
+
+    return DATA_WATCH_OK;
+}
+
+void data_watch_stop(void)
+{
+    dap_arbiter_stats_t stats;
+
+    if (!s_timer)
+    {
+        return;
+    }
+
+    esp_timer_stop(s_timer);
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    data_watch_flush();
+
+    /* Only if nobody used the port since the last sample, it may belong to a session by now */
+    if (s_attached && dap_arbiter_try_lock())
+    {
+        dap_arbiter_get_stats(&stats);
+        if (stats.commands == s_commands)
+        {
+            TargetSWD::get_instance().off();
+        }
+
+        dap_arbiter_unlock();
+    }
+
+    s_slot_num = 0;
+    s_block_num = 0;
+    s_read_bytes = 0;
+    s_record_size = 0;
+    s_rate = 0;
+    s_attached = false;
+    s_state = DATA_WATCH_STATE_OFF;
+    xSemaphoreGive(s_mutex);
+}
+
+void data_watch_get_status(char *buf, int size, int *encode_len)
+{
+    *encode_len = snprintf(buf, size,
+                           "{\"state\":\"%s\",\"rate_hz\":%lu,\"vars\":%d,\"blocks\":%d,\"read_bytes\":%lu,\"record_size\":%lu,"
+                           "\"samples\":%lu,\"overruns\":%lu,\"errors\":%lu,\"sample_us\":%lu,\"sample_max_us\":%lu}",
+                           s_state_names[s_state], (unsigned long)s_rate, s_slot_num, s_block_num, (unsigned long)s_read_bytes,
+                           (unsigned long)s_record_size, (unsigned long)s_samples, (unsigned long)s_overruns,
+                           (unsigned long)s_errors, (unsigned long)s_sample_us, (unsigned long)s_sample_max_us);
+}
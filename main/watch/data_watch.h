@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add live variable sampler
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file data_watch.h
+ * @brief Live variable sampling over SWD
+ *
+ * Target variables are read through the AHB-AP while the core keeps running,
+ * at a fixed rate from an esp_timer. The variables are sorted and grouped by
+ * CONFIG_DATA_WATCH_LINE_SIZE lines, touching or overlapping lines become one
+ * block read, so a few hundred bytes of globals cost only a handful of
+ * transfers per sample.
+ *
+ * Samples are packed into batches and handed to the registered output:
+ *
+ *     | 0x01 | flags u8 | count u16 | seq u32 | record * count |
+ *     record: | timestamp_us u32 | value of each variable, in list order |
+ *
+ * All fields are little endian. seq numbers every sample period since the
+ * list was set, periods that were missed or failed are skipped so the gap
+ * shows in seq. flags bit 0 is set when samples were lost since the
+ * previous batch.
+ *
+ * Sampling pauses while a debugger owns the DAP port or the programmer is
+ * busy.
+ */
+
+/**
+ * @brief Watched variable
+ */
+typedef struct
+{
+    uint32_t addr;  ///< Target address
+    uint8_t size;   ///< 1, 2, 4 or 8 bytes
+} data_watch_var_t;
+
+/**
+ * @brief Error codes
+ */
+typedef enum
+{
+    DATA_WATCH_OK = 0,          ///< Success
+    DATA_WATCH_ERR_RATE,        ///< Rate is 0 or above CONFIG_DATA_WATCH_MAX_RATE
+    DATA_WATCH_ERR_VAR,         ///< Bad variable size or no variables
+    DATA_WATCH_ERR_TOO_MANY,    ///< More than CONFIG_DATA_WATCH_MAX_VARS variables
+    DATA_WATCH_ERR_TOO_LARGE,   ///< Blocks or records do not fit the buffers
+    DATA_WATCH_ERR_NOT_READY    ///< data_watch_init not called
+} data_watch_err_t;
+
+/**
+ * @brief Start the sampler task
+ * @return true on success, false on failure
+ */
+bool data_watch_init(void);
+
+/**
+ * @brief Register the sample batch output
+ *
+ * The callback runs in the sampler task, it must not block.
+ *
+ * @param cb Callback
+ */
+void data_watch_register_output(void (*cb)(const uint8_t *data, size_t size));
+
+/**
+ * @brief Set the variable list and start sampling
+ *
+ * A running list is replaced, seq starts from 0 again.
+ *
+ * @param vars Variables, records keep this order
+ * @param count Number of variables
+ * @param rate_hz Samples per second
+ * @return Error code
+ */
+data_watch_err_t data_watch_start(const data_watch_var_t *vars, int count, uint32_t rate_hz);
+
+/**
+ * @brief Stop sampling, the pending batch is sent first
+ */
+void data_watch_stop(void);
+
+/**
+ * @brief Get the sampler status as JSON
+ * @param buf Output buffer
+ * @param size Buffer size
+ * @param encode_len Output: encoded length
+ */
+void data_watch_get_status(char *buf, int size, int *encode_len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,334 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add target memory dump endpoint
+ * 2026-10-19    hongquan.li   claim the debug port for a dump
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "web/web_dump.h"
+#include "programmer/programmer.h"
+#include "target_swd.h"
+#include "dap_arbiter.h"
+#include "debug_gpio.h"
+
+#define TAG "web_dump"
+
+#define WEB_DUMP_SLOTS 2
+
+static_assert((CONFIG_HTTPD_DUMP_CHUNK_SIZE % 4) == 0, "Dump chunk size must be a multiple of 4");
+
+typedef struct
+{
+    uint32_t addr;  ///< Start address
+    uint32_t len;   ///< Length to read
+} web_dump_job_t;
+
+typedef struct
+{
+    uint8_t *buf;   ///< CONFIG_HTTPD_DUMP_CHUNK_SIZE bytes
+    uint32_t skip;  ///< Bytes before the requested start, the read begins word aligned
+    uint32_t len;   ///< Requested bytes, from buf + skip
+    bool ok;        ///< false if the read failed, the dump stops here
+} web_dump_slot_t;
+
+static web_dump_slot_t s_slots[WEB_DUMP_SLOTS];
+static QueueHandle_t s_job_queue = NULL;
+static QueueHandle_t s_free_queue = NULL;
+static QueueHandle_t s_full_queue = NULL;
+static SemaphoreHandle_t s_done = NULL;
+static volatile bool s_abort = false;
+
+/* Reads the target into whichever buffer the httpd task is not sending */
+static void web_dump_task(void *pvParameters)
+{
+    web_dump_job_t job;
+    web_dump_slot_t *slot = NULL;
+    SWDIface &swd = TargetSWD::get_instance();
+    bool powered = false;
+    bool ok = false;
+
+    for (;;)
+    {
+        xQueueReceive(s_job_queue, &job, portMAX_DELAY);
+
+        dap_arbiter_lock();
+
+        /* A sampler may keep the port attached between reads, leave it up then */
+        powered = debug_probe_pins_active();
+
+        /* Attach without a reset, the memory is read as the target left it */
+        ok = swd.set_target_state(SWDIface::TARGET_DEBUG);
+        if (!ok)
+        {
+            ESP_LOGE(TAG, "Failed to attach to the target");
+        }
+
+        while ((job.len > 0) && !s_abort)
+        {
+            xQueueReceive(s_free_queue, &slot, portMAX_DELAY);
+
+            /* Only the first chunk can be short, every following one starts chunk aligned */
+            slot->len = CONFIG_HTTPD_DUMP_CHUNK_SIZE - (job.addr % CONFIG_HTTPD_DUMP_CHUNK_SIZE);
+            slot->len = (job.len < slot->len) ? job.len : slot->len;
+            /* SWD stores whole words into the buffer, so keep them aligned in it */
+            slot->skip = job.addr & 0x3;
+            slot->ok = ok && swd.read_memory(job.addr - slot->skip, slot->buf, slot->skip + slot->len);
+
+            if (!slot->ok)
+            {
+                ESP_LOGE(TAG, "Failed to read 0x%lx", (unsigned long)job.addr);
+                job.len = 0;
+            }
+            else
+            {
+                job.addr += slot->len;
+                job.len -= slot->len;
+            }
+
+            xQueueSend(s_full_queue, &slot, portMAX_DELAY);
+        }
+
+        if (!powered)
+        {
+            swd.off();
+        }
+
+        dap_arbiter_unlock();
+        xSemaphoreGive(s_done);
+    }
+}
+
+static bool web_dump_init(void)
+{
+    web_dump_slot_t *slot = NULL;
+
+    if (s_job_queue)
+    {
+        return true;
+    }
+
+    s_free_queue = xQueueCreate(WEB_DUMP_SLOTS, sizeof(web_dump_slot_t *));
+    s_full_queue = xQueueCreate(WEB_DUMP_SLOTS, sizeof(web_dump_slot_t *));
+    s_done = xSemaphoreCreateBinary();
+
+    if (!s_free_queue || !s_full_queue || !s_done)
+    {
+        ESP_LOGE(TAG, "Memory not enough");
+        goto __error;
+    }
+
+    for (int i = 0; i < WEB_DUMP_SLOTS; i++)
+    {
+        s_slots[i].buf = (uint8_t *)malloc(CONFIG_HTTPD_DUMP_CHUNK_SIZE);
+        if (!s_slots[i].buf)
+        {
+            ESP_LOGE(TAG, "Memory not enough");
+            goto __error;
+        }
+
+        slot = &s_slots[i];
+        xQueueSend(s_free_queue, &slot, 0);
+    }
+
+    s_job_queue = xQueueCreate(1, sizeof(web_dump_job_t));
+    if (!s_job_queue)
+    {
+        ESP_LOGE(TAG, "Memory not enough");
+        goto __error;
+    }
+
+    if (xTaskCreate(web_dump_task, "web_dump", 1024 * 4, NULL, 3, NULL) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to create dump task");
+        goto __error;
+    }
+
+    return true;
+
+__error:
+
+    if (s_job_queue)
+        vQueueDelete(s_job_queue);
+
+    if (s_free_queue)
+        vQueueDelete(s_free_queue);
+
+    if (s_full_queue)
+        vQueueDelete(s_full_queue);
+
+    if (s_done)
+        vSemaphoreDelete(s_done);
+
+    for (int i = 0; i < WEB_DUMP_SLOTS; i++)
+    {
+        free(s_slots[i].buf);
+        s_slots[i].buf = NULL;
+    }
+
+    s_job_queue = NULL;
+    s_free_queue = NULL;
+    s_full_queue = NULL;
+    s_done = NULL;
+
+    return false;
+}
+
+/* Wait for the reader to stop and hand every buffer back to the free queue */
+static void web_dump_finish(void)
+{
+    web_dump_slot_t *slot = NULL;
+
+    while (xSemaphoreTake(s_done, pdMS_TO_TICKS(10)) != pdTRUE)
+    {
+        if (xQueueReceive(s_full_queue, &slot, 0) == pdTRUE)
+        {
+            xQueueSend(s_free_queue, &slot, 0);
+        }
+    }
+
+    while (xQueueReceive(s_full_queue, &slot, 0) == pdTRUE)
+    {
+        xQueueSend(s_free_queue, &slot, 0);
+    }
+}
+
+static bool web_dump_get_query(httpd_req_t *req, uint32_t &addr, uint32_t &len)
+{
+    char *buf = NULL;
+    char *end = NULL;
+    char val[16] = {0};
+    size_t buf_size = httpd_req_get_url_query_len(req) + 1;
+    bool ret = false;
+
+    buf = (char *)malloc(buf_size);
+    if (!buf)
+    {
+        return false;
+    }
+
+    if ((httpd_req_get_url_query_str(req, buf, buf_size) != ESP_OK) ||
+        (httpd_query_key_value(buf, "addr", val, sizeof(val)) != ESP_OK))
+    {
+        goto __exit;
+    }
+
+    addr = strtoul(val, &end, 0);
+    if ((end == val) || (*end != '\0') || (httpd_query_key_value(buf, "len", val, sizeof(val)) != ESP_OK))
+    {
+        goto __exit;
+    }
+
+    len = strtoul(val, &end, 0);
+    ret = (end != val) && (*end == '\0');
+
+__exit:
+    free(buf);
+
+    return ret;
+}
+
+esp_err_t web_dump_handler(httpd_req_t *req)
+{
+    char disposition[64] = {0};
+    uint32_t addr = 0;
+    uint32_t len = 0;
+    uint32_t sent = 0;
+    web_dump_job_t job;
+    web_dump_slot_t *slot = NULL;
+    TickType_t start_time = 0;
+    esp_err_t ret = ESP_OK;
+
+    if (!web_dump_get_query(req, addr, len) || (len == 0) || (addr + len - 1 < addr))
+    {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid address or length");
+        return ESP_FAIL;
+    }
+
+    if (programmer_is_busy())
+    {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Programmer is busy");
+        return ESP_FAIL;
+    }
+
+    /* A debugger or a programming job owns the port, reading under it would break their state */
+    if (!dap_arbiter_try_claim(DAP_SESSION_DUMP))
+    {
+        httpd_resp_set_status(req, "409 Conflict");
+        httpd_resp_sendstr(req, "Debug port is busy");
+        return ESP_OK;
+    }
+
+    if (!web_dump_init())
+    {
+        dap_arbiter_release(DAP_SESSION_DUMP);
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Not enough memory");
+        return ESP_FAIL;
+    }
+
+    /* Handlers run on the single httpd task, one dump at a time */
+    job.addr = addr;
+    job.len = len;
+    s_abort = false;
+    start_time = xTaskGetTickCount();
+    xQueueSend(s_job_queue, &job, portMAX_DELAY);
+
+    snprintf(disposition, sizeof(disposition), "attachment; filename=\"dump_%08lx_%lx.bin\"", (unsigned long)addr, (unsigned long)len);
+    httpd_resp_set_type(req, "application/octet-stream");
+    httpd_resp_set_hdr(req, "Content-Disposition", disposition);
+
+    while (sent < len)
+    {
+        xQueueReceive(s_full_queue, &slot, portMAX_DELAY);
+
+        if (!slot->ok)
+        {
+            xQueueSend(s_free_queue, &slot, 0);
+            ret = ESP_FAIL;
+            break;
+        }
+
+        /* The reader is already filling the other buffer while this one goes out */
+        ret = httpd_resp_send_chunk(req, (const char *)slot->buf + slot->skip, slot->len);
+        sent += slot->len;
+        xQueueSend(s_free_queue, &slot, 0);
+
+        if (ret != ESP_OK)
+        {
+            ESP_LOGE(TAG, "Client went away after %lu bytes", (unsigned long)sent);
+            break;
+        }
+    }
+
+    s_abort = (ret != ESP_OK);
+    web_dump_finish();
+    dap_arbiter_release(DAP_SESSION_DUMP);
+
+    if ((ret != ESP_OK) && (sent == 0))
+    {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to read target memory");
+        return ESP_FAIL;
+    }
+
+    if (ret != ESP_OK)
+    {
+        /* Headers are out already, dropping the connection is the only way to flag the error */
+        return ESP_FAIL;
+    }
+
+    httpd_resp_send_chunk(req, NULL, 0);
+    ESP_LOGI(TAG, "Dumped %lu bytes at 0x%lx in %lu ms", (unsigned long)len, (unsigned long)addr,
+             (unsigned long)pdTICKS_TO_MS(xTaskGetTickCount() - start_time));
+
+    return ESP_OK;
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add target memory dump endpoint
+ */
+#pragma once
+
+#include "esp_http_server.h"
+
+/**
+ * @file web_dump.h
+ * @brief Target memory readback over HTTP
+ *
+ * GET /api/dump?addr=<addr>&len=<len> attaches to the running target without
+ * resetting it and streams the memory range back as a chunked
+ * application/octet-stream response. Both values accept decimal or 0x hex.
+ *
+ * A reader task fills one buffer over SWD while the httpd task sends the
+ * other, so SWD and TCP overlap. The DAP lock is held for the whole dump.
+ * On a read error the response is cut short without the terminating chunk,
+ * so a client never mistakes a partial dump for a complete one.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /**
+     * @brief Handler of the memory dump endpoint
+     * @param req Request
+     * @return ESP_OK on success
+     */
+    esp_err_t web_dump_handler(httpd_req_t *req);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   share the WebSocket fan-out of the trace sockets
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include "esp_log.h"
+#include "freertos/message_buffer.h"
+#include "web/web_fanout.h"
+
+#define TAG "web_fanout"
+
+/* Runs on the httpd task, every client gets the same frames */
+static void web_fanout_flush_work(void *arg)
+{
+    web_fanout_t *fanout = (web_fanout_t *)arg;
+    httpd_ws_frame_t ws_pkt = {false, false, HTTPD_WS_TYPE_BINARY, fanout->frame, 0};
+
+    fanout->work_queued = false;
+
+    while ((ws_pkt.len = xStreamBufferReceive(fanout->queue, fanout->frame, fanout->frame_size, 0)) > 0)
+    {
+        for (int i = 0; i < CONFIG_HTTPD_MAX_OPENED_SOCKETS; i++)
+        {
+            if (fanout->clients[i].fd >= 0)
+            {
+                httpd_ws_send_frame_async(fanout->server, fanout->clients[i].fd, &ws_pkt);
+            }
+        }
+    }
+}
+
+static void web_fanout_client_free(void *ctx)
+{
+    web_fanout_client_t *client = (web_fanout_client_t *)ctx;
+
+    client->fd = -1;
+
+    if (client->fanout->disconnected)
+    {
+        client->fanout->disconnected();
+    }
+}
+
+bool web_fanout_init(web_fanout_t *fanout, httpd_handle_t server, size_t queue_size, size_t frame_size, bool message)
+{
+    if (fanout->queue)
+    {
+        return true;
+    }
+
+    fanout->frame = (uint8_t *)malloc(frame_size);
+    fanout->queue = message ? xMessageBufferCreate(queue_size) : xStreamBufferCreate(queue_size, 1);
+
+    if (!fanout->frame || !fanout->queue)
+    {
+        ESP_LOGE(TAG, "Memory not enough");
+
+        if (fanout->queue)
+        {
+            vStreamBufferDelete(fanout->queue);
+        }
+
+        free(fanout->frame);
+        fanout->frame = NULL;
+        fanout->queue = NULL;
+        return false;
+    }
+
+    for (int i = 0; i < CONFIG_HTTPD_MAX_OPENED_SOCKETS; i++)
+    {
+        fanout->clients[i].fanout = fanout;
+        fanout->clients[i].fd = -1;
+    }
+
+    fanout->frame_size = frame_size;
+    fanout->server = server;
+
+    return true;
+}
+
+bool web_fanout_add(web_fanout_t *fanout, httpd_req_t *req)
+{
+    for (int i = 0; i < CONFIG_HTTPD_MAX_OPENED_SOCKETS; i++)
+    {
+        if (fanout->clients[i].fd < 0)
+        {
+            fanout->clients[i].fd = httpd_req_to_sockfd(req);
+            req->sess_ctx = &fanout->clients[i];
+            req->free_ctx = web_fanout_client_free;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Runs on the producer task, must not block on a slow client */
+void web_fanout_send(web_fanout_t *fanout, const void *data, size_t size)
+{
+    /* xMessageBufferSend() is the same call, a message buffer only stores a length with each frame */
+    xStreamBufferSend(fanout->queue, data, size, 0);
+
+    if (!fanout->work_queued)
+    {
+        fanout->work_queued = true;
+
+        if (httpd_queue_work(fanout->server, web_fanout_flush_work, fanout) != ESP_OK)
+        {
+            fanout->work_queued = false;
+        }
+    }
+}
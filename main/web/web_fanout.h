@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   share the WebSocket fan-out of the trace sockets
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_http_server.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/stream_buffer.h"
+
+/**
+ * @file web_fanout.h
+ * @brief One producer task, every WebSocket client gets the same frames
+ *
+ * The producer queues data without blocking, whatever does not fit is
+ * dropped so a slow browser never holds up the target side. A work item on
+ * the httpd task drains the queue and sends each frame to every client.
+ * With a message buffer the queue keeps the frames as sent, with a stream
+ * buffer it is cut into frames of up to frame_size bytes.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct web_fanout web_fanout_t;
+
+/**
+ * @brief Client slot, passed to httpd as the session context
+ */
+typedef struct
+{
+    web_fanout_t *fanout;   ///< Fan-out the client belongs to
+    int fd;                 ///< Socket, -1 if the slot is free
+} web_fanout_client_t;
+
+/**
+ * @brief Fan-out state, zero initialised until web_fanout_init()
+ */
+struct web_fanout
+{
+    httpd_handle_t server;                                          ///< Server the clients are on
+    StreamBufferHandle_t queue;                                     ///< Frames from the producer
+    uint8_t *frame;                                                 ///< Frame being sent, httpd task only
+    size_t frame_size;                                              ///< Largest frame
+    volatile bool work_queued;                                      ///< Drain work pending on the httpd task
+    void (*disconnected)(void);                                     ///< Called on the httpd task when a client leaves, may be NULL
+    web_fanout_client_t clients[CONFIG_HTTPD_MAX_OPENED_SOCKETS];   ///< Client slots, httpd task only
+};
+
+/**
+ * @brief Create the queue and the frame buffer, does nothing once done
+ * @param fanout Fan-out state
+ * @param server HTTP server
+ * @param queue_size Queue size in bytes
+ * @param frame_size Largest frame sent to a client
+ * @param message true to keep the producer's frames, false to send a byte stream
+ * @return true on success
+ */
+bool web_fanout_init(web_fanout_t *fanout, httpd_handle_t server, size_t queue_size, size_t frame_size, bool message);
+
+/**
+ * @brief Add the client of a WebSocket handshake
+ *
+ * The slot is freed and fanout->disconnected is called when httpd closes
+ * the session.
+ *
+ * @param fanout Fan-out state
+ * @param req Handshake request
+ * @return false if every slot is taken
+ */
+bool web_fanout_add(web_fanout_t *fanout, httpd_req_t *req);
+
+/**
+ * @brief Queue data for every client, never blocks
+ * @param fanout Fan-out state
+ * @param data Data, one frame with a message buffer
+ * @param size Data size
+ */
+void web_fanout_send(web_fanout_t *fanout, const void *data, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
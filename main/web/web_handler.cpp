@@ -7,6 +7,15 @@
  * Date           Author       Notes
  * 2023-9-8      lihongquan   add license declaration
  * 2026-3-17     refactor     Integrate SerialManager for web serial
+ * 2026-10-19    hongquan.li   export DAP lock statistics
+ * 2026-10-19    hongquan.li   serve gzip pages with ETag revalidation
+ * 2026-10-19    hongquan.li   push programming status over WebSocket
+ * 2026-10-19    hongquan.li   coalesce serial data per WebSocket client
+ * 2026-10-19    hongquan.li   report TCP bridge serial state
+ * 2026-10-19    hongquan.li   upload images to the image store
+ * 2026-10-19    hongquan.li   add programming job queue endpoint
+ * 2026-10-19    hongquan.li   add armed auto-programming endpoint
+ * 2026-10-19    hongquan.li   delete images from the image store
  */
 #include <stdbool.h>
 #include <string.h>
@@ -15,17 +24,24 @@
 #include "web/web_handler.h"
 #include "serial/cdc_uart.h"
 #include "programmer/programmer.h"
+#include "programmer/prog_queue.h"
+#include "programmer/prog_armed.h"
+#include "disk/image_store.h"
+#include "dap_arbiter.h"
 #include "cJSON.h"
 #include "esp_ota_ops.h"
 #include "esp_app_format.h"
 #include "esp_wifi.h"
 #include "esp_netif.h"
 #include "hex_program.h"
+#include "file_programmer.h"
 #include "serial/serial_manager.h"
 #include "wifi.h"
 #include "nvs_flash.h"
 #include "esp_system.h"
 #include "esp_flash.h"
+#include "esp_timer.h"
+#include "mbedtls/sha256.h"
 #include <sys/types.h>
 #include <sys/param.h>
 #include <sys/stat.h>
@@ -34,7 +50,8 @@
 #include <iomanip>
 
 #define TAG "web_handler"
-#define WEB_RESOURCE_NUM 5
+#define WEB_RESOURCE_NUM 6
+#define WEB_ETAG_SIZE 20
 #define IS_FILE_EXT(filename, ext) (strcasecmp(&filename[strlen(filename) - sizeof(ext) + 1], ext) == 0)
 
 typedef struct
@@ -42,34 +59,356 @@ typedef struct
     const char *path;
     const uint8_t *start;
     const uint8_t *end;
+    char etag[WEB_ETAG_SIZE];
 } web_resource_map_t;
 
-extern const uint8_t root_html_start[] asm("_binary_root_html_start");
-extern const uint8_t root_html_end[] asm("_binary_root_html_end");
-extern const uint8_t webserial_html_start[] asm("_binary_webserial_html_start");
-extern const uint8_t webserial_html_end[] asm("_binary_webserial_html_end");
-extern const uint8_t upgrade_html_start[] asm("_binary_upgrade_html_start");
-extern const uint8_t upgrade_html_end[] asm("_binary_upgrade_html_end");
-extern const uint8_t favicon_ico_start[] asm("_binary_favicon_ico_start");
-extern const uint8_t favicon_ico_end[] asm("_binary_favicon_ico_end");
-extern const uint8_t config_html_start[] asm("_binary_settings_html_start");
-extern const uint8_t config_html_end[] asm("_binary_settings_html_end");
+/* Pages are gzip compressed at build time, see main/CMakeLists.txt */
+extern const uint8_t root_html_start[] asm("_binary_root_html_gz_start");
+extern const uint8_t root_html_end[] asm("_binary_root_html_gz_end");
+extern const uint8_t webserial_html_start[] asm("_binary_webserial_html_gz_start");
+extern const uint8_t webserial_html_end[] asm("_binary_webserial_html_gz_end");
+extern const uint8_t upgrade_html_start[] asm("_binary_upgrade_html_gz_start");
+extern const uint8_t upgrade_html_end[] asm("_binary_upgrade_html_gz_end");
+extern const uint8_t favicon_ico_start[] asm("_binary_favicon_ico_gz_start");
+extern const uint8_t favicon_ico_end[] asm("_binary_favicon_ico_gz_end");
+extern const uint8_t config_html_start[] asm("_binary_settings_html_gz_start");
+extern const uint8_t config_html_end[] asm("_binary_settings_html_gz_end");
+extern const uint8_t program_html_start[] asm("_binary_program_html_gz_start");
+extern const uint8_t program_html_end[] asm("_binary_program_html_gz_end");
 
 web_resource_map_t s_resource_map[WEB_RESOURCE_NUM] = {
-    {"/data/httpd/root.html", root_html_start, root_html_end},
-    {"/data/httpd/favicon.ico", favicon_ico_start, favicon_ico_end},
-    {"/data/httpd/webserial.html", webserial_html_start, webserial_html_end},
-    {"/data/httpd/upgrade.html", upgrade_html_start, upgrade_html_end},
-    {"/data/httpd/settings.html", config_html_start, config_html_end}};
+    {"/data/httpd/root.html", root_html_start, root_html_end, ""},
+    {"/data/httpd/favicon.ico", favicon_ico_start, favicon_ico_end, ""},
+    {"/data/httpd/webserial.html", webserial_html_start, webserial_html_end, ""},
+    {"/data/httpd/upgrade.html", upgrade_html_start, upgrade_html_end, ""},
+    {"/data/httpd/settings.html", config_html_start, config_html_end, ""},
+    {"/data/httpd/program.html", program_html_start, program_html_end, ""}};
+
+static httpd_handle_t s_http_server = NULL;
+
+typedef struct
+{
+    int fd;       ///< Subscribed socket, -1 if the slot is free
+    int progress; ///< Last progress sent to this client
+    int busy;     ///< Last busy state sent to this client, -1 before the first update
+} web_status_client_t;
+
+static portMUX_TYPE s_status_lock = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t s_status_timer = NULL;
+static bool s_status_scheduled = false;
+static int64_t s_status_sent_us = 0;
+static int s_status_progress = 0;
+static bool s_status_busy = false;
+/* Only touched from the httpd task */
+static web_status_client_t s_status_clients[CONFIG_HTTPD_MAX_OPENED_SOCKETS];
+
+static void web_status_work(void *arg)
+{
+    char json_msg[64] = {0};
+    int progress = 0;
+    bool busy = false;
+    httpd_ws_frame_t ws_pkt = {false, false, HTTPD_WS_TYPE_TEXT, NULL, 0};
+
+    taskENTER_CRITICAL(&s_status_lock);
+    progress = s_status_progress;
+    busy = s_status_busy;
+    s_status_scheduled = false;
+    s_status_sent_us = esp_timer_get_time();
+    taskEXIT_CRITICAL(&s_status_lock);
+
+    snprintf(json_msg, sizeof(json_msg), "{\"type\":\"program_status\",\"progress\":%d,\"status\":\"%s\"}",
+             progress, busy ? "busy" : "idle");
+    ws_pkt.payload = (uint8_t *)json_msg;
+    ws_pkt.len = strlen(json_msg);
+
+    for (int i = 0; i < CONFIG_HTTPD_MAX_OPENED_SOCKETS; i++)
+    {
+        web_status_client_t *client = &s_status_clients[i];
+
+        /* Intermediate values are dropped, each client only gets the latest state once */
+        if ((client->fd < 0) || ((client->progress == progress) && (client->busy == (int)busy)))
+        {
+            continue;
+        }
+
+        /* The slot stays taken until the session closes and free_ctx releases it, the next update retries */
+        if ((httpd_ws_get_fd_info(s_http_server, client->fd) != HTTPD_WS_CLIENT_WEBSOCKET) ||
+            (httpd_ws_send_frame_async(s_http_server, client->fd, &ws_pkt) != ESP_OK))
+        {
+            continue;
+        }
+
+        client->progress = progress;
+        client->busy = busy;
+    }
+}
+
+static void web_status_timer_cb(void *arg)
+{
+    if (!s_http_server || (httpd_queue_work(s_http_server, web_status_work, NULL) != ESP_OK))
+    {
+        taskENTER_CRITICAL(&s_status_lock);
+        s_status_scheduled = false;
+        taskEXIT_CRITICAL(&s_status_lock);
+    }
+}
+
+void web_notify_program_status(int progress, bool busy)
+{
+    bool schedule = false;
+    int64_t elapsed = 0;
+    int64_t interval = (int64_t)CONFIG_HTTPD_PROGRAM_STATUS_INTERVAL_MS * 1000;
+
+    taskENTER_CRITICAL(&s_status_lock);
+    s_status_progress = progress;
+    s_status_busy = busy;
+    schedule = !s_status_scheduled;
+    s_status_scheduled = true;
+    elapsed = esp_timer_get_time() - s_status_sent_us;
+    taskEXIT_CRITICAL(&s_status_lock);
+
+    /* An update is already on its way and will pick up the new value */
+    if (!schedule || !s_status_timer)
+    {
+        return;
+    }
+
+    esp_timer_start_once(s_status_timer, (elapsed >= interval) ? 0 : (interval - elapsed));
+}
+
+static void web_status_client_free(void *ctx)
+{
+    ((web_status_client_t *)ctx)->fd = -1;
+}
+
+esp_err_t web_program_socket_handler(httpd_req_t *req)
+{
+    web_data_t *data = (web_data_t *)req->user_ctx;
+    httpd_ws_frame_t ws_pkt = {false, false, HTTPD_WS_TYPE_TEXT, NULL, 0};
+    int fd = httpd_req_to_sockfd(req);
+
+    /* Handshake, subscribe the client and push the current state */
+    if (req->method == HTTP_GET)
+    {
+        for (int i = 0; i < CONFIG_HTTPD_MAX_OPENED_SOCKETS; i++)
+        {
+            if (s_status_clients[i].fd < 0)
+            {
+                s_status_clients[i].fd = fd;
+                s_status_clients[i].busy = -1;
+                req->sess_ctx = &s_status_clients[i];
+                req->free_ctx = web_status_client_free;
+                return httpd_queue_work(req->handle, web_status_work, NULL);
+            }
+        }
+
+        ESP_LOGW(TAG, "Too many status clients");
+        return ESP_FAIL;
+    }
+
+    /* Clients never send anything but control frames, drain whatever arrives */
+    if (httpd_ws_recv_frame(req, &ws_pkt, 0) != ESP_OK)
+    {
+        return ESP_FAIL;
+    }
+
+    if (ws_pkt.len > CONFIG_HTTPD_RESP_BUF_SIZE)
+    {
+        return ESP_FAIL;
+    }
+
+    ws_pkt.payload = data->buf;
+
+    return httpd_ws_recv_frame(req, &ws_pkt, ws_pkt.len);
+}
+
+typedef struct
+{
+    int fd;           ///< Serial socket, -1 if the slot is free
+    uint8_t *buf;     ///< Ring buffer of CONFIG_HTTPD_SERIAL_CLIENT_BUF_SIZE bytes
+    size_t head;      ///< Read position
+    size_t count;     ///< Bytes buffered
+    uint32_t dropped; ///< Bytes dropped because the client fell behind
+} web_serial_client_t;
+
+static SemaphoreHandle_t s_serial_mutex = NULL;
+static esp_timer_handle_t s_serial_timer = NULL;
+static bool s_serial_timer_armed = false;
+static bool s_serial_work_queued = false;
+static uint32_t s_serial_frames = 0;
+static uint32_t s_serial_dropped = 0;
+static uint8_t s_serial_frame[CONFIG_HTTPD_SERIAL_FRAME_SIZE];
+static web_serial_client_t s_serial_clients[CONFIG_HTTPD_MAX_OPENED_SOCKETS];
+
+/* Append to a client ring, the oldest bytes make room when it is full */
+static void web_serial_ring_put(web_serial_client_t *client, const uint8_t *data, size_t size)
+{
+    size_t drop = 0;
+    size_t tail = 0;
+    size_t first = 0;
+
+    if (size > CONFIG_HTTPD_SERIAL_CLIENT_BUF_SIZE)
+    {
+        drop = size - CONFIG_HTTPD_SERIAL_CLIENT_BUF_SIZE;
+        data += drop;
+        size = CONFIG_HTTPD_SERIAL_CLIENT_BUF_SIZE;
+    }
+
+    if (client->count + size > CONFIG_HTTPD_SERIAL_CLIENT_BUF_SIZE)
+    {
+        size_t overflow = client->count + size - CONFIG_HTTPD_SERIAL_CLIENT_BUF_SIZE;
+
+        client->head = (client->head + overflow) % CONFIG_HTTPD_SERIAL_CLIENT_BUF_SIZE;
+        client->count -= overflow;
+        drop += overflow;
+    }
+
+    if (drop)
+    {
+        client->dropped += drop;
+        s_serial_dropped += drop;
+    }
+
+    tail = (client->head + client->count) % CONFIG_HTTPD_SERIAL_CLIENT_BUF_SIZE;
+    first = MIN(size, CONFIG_HTTPD_SERIAL_CLIENT_BUF_SIZE - tail);
+    memcpy(client->buf + tail, data, first);
+    memcpy(client->buf, data + first, size - first);
+    client->count += size;
+}
+
+static size_t web_serial_ring_get(web_serial_client_t *client, uint8_t *data, size_t size)
+{
+    size_t first = 0;
+
+    size = MIN(size, client->count);
+    first = MIN(size, CONFIG_HTTPD_SERIAL_CLIENT_BUF_SIZE - client->head);
+    memcpy(data, client->buf + client->head, first);
+    memcpy(data + first, client->buf, size - first);
+    client->head = (client->head + size) % CONFIG_HTTPD_SERIAL_CLIENT_BUF_SIZE;
+    client->count -= size;
+
+    return size;
+}
+
+/* Runs on the httpd task, drains every client ring in frames of up to CONFIG_HTTPD_SERIAL_FRAME_SIZE */
+static void web_serial_flush_work(void *arg)
+{
+    httpd_ws_frame_t ws_pkt = {false, false, HTTPD_WS_TYPE_TEXT, s_serial_frame, 0};
+    int fd = -1;
+
+    xSemaphoreTake(s_serial_mutex, portMAX_DELAY);
+    s_serial_work_queued = false;
+    xSemaphoreGive(s_serial_mutex);
+
+    for (int i = 0; i < CONFIG_HTTPD_MAX_OPENED_SOCKETS; i++)
+    {
+        /* Bounded so a client that keeps up cannot starve the others */
+        for (int n = 0; n <= CONFIG_HTTPD_SERIAL_CLIENT_BUF_SIZE / CONFIG_HTTPD_SERIAL_FRAME_SIZE; n++)
+        {
+            xSemaphoreTake(s_serial_mutex, portMAX_DELAY);
+            fd = s_serial_clients[i].fd;
+            ws_pkt.len = (fd < 0) ? 0 : web_serial_ring_get(&s_serial_clients[i], s_serial_frame, sizeof(s_serial_frame));
+            xSemaphoreGive(s_serial_mutex);
+
+            if (ws_pkt.len == 0)
+            {
+                break;
+            }
+
+            httpd_ws_send_frame_async(s_http_server, fd, &ws_pkt);
+            s_serial_frames++;
+        }
+    }
+}
+
+static void web_serial_queue_flush(void)
+{
+    if (httpd_queue_work(s_http_server, web_serial_flush_work, NULL) != ESP_OK)
+    {
+        s_serial_work_queued = false;
+    }
+}
+
+static void web_serial_timer_cb(void *arg)
+{
+    bool queue = false;
+
+    xSemaphoreTake(s_serial_mutex, portMAX_DELAY);
+    s_serial_timer_armed = false;
+    queue = !s_serial_work_queued;
+    s_serial_work_queued = true;
+
+    if (queue)
+    {
+        web_serial_queue_flush();
+    }
+
+    xSemaphoreGive(s_serial_mutex);
+}
+
+static void web_serial_client_free(void *ctx)
+{
+    web_serial_client_t *client = (web_serial_client_t *)ctx;
+
+    xSemaphoreTake(s_serial_mutex, portMAX_DELAY);
+
+    if (client->dropped)
+    {
+        ESP_LOGW(TAG, "Serial client %d dropped %lu bytes", client->fd, client->dropped);
+    }
+
+    free(client->buf);
+    client->buf = NULL;
+    client->fd = -1;
+    xSemaphoreGive(s_serial_mutex);
+
+    /* Covers both close frames and connections that just went away */
+    serial_manager_web_client_disconnected();
+}
+
+static web_serial_client_t *web_serial_client_alloc(int fd)
+{
+    web_serial_client_t *client = NULL;
+    uint8_t *buf = (uint8_t *)malloc(CONFIG_HTTPD_SERIAL_CLIENT_BUF_SIZE);
+
+    if (!buf)
+    {
+        return NULL;
+    }
+
+    xSemaphoreTake(s_serial_mutex, portMAX_DELAY);
+
+    for (int i = 0; i < CONFIG_HTTPD_MAX_OPENED_SOCKETS; i++)
+    {
+        if (s_serial_clients[i].fd < 0)
+        {
+            client = &s_serial_clients[i];
+            client->buf = buf;
+            client->head = 0;
+            client->count = 0;
+            client->dropped = 0;
+            client->fd = fd;
+            break;
+        }
+    }
+
+    xSemaphoreGive(s_serial_mutex);
+
+    if (!client)
+    {
+        free(buf);
+    }
+
+    return client;
+}
 
 void web_send_to_clients(void *context, uint8_t *data, size_t size)
 {
     httpd_handle_t http_server = *((httpd_handle_t *)context);
-    size_t clients = CONFIG_HTTPD_MAX_OPENED_SOCKETS;
-    static int client_fds[CONFIG_HTTPD_MAX_OPENED_SOCKETS] = {0};
-    httpd_ws_frame_t ws_pkt = {false, false, HTTPD_WS_TYPE_TEXT, data, size};
+    bool full = false;
+    bool arm = false;
 
-    if (!http_server)
+    if (!http_server || !s_serial_mutex)
         return;
 
     /* Only send to web clients when in WEB state */
@@ -78,29 +417,44 @@ void web_send_to_clients(void *context, uint8_t *data, size_t size)
         return;
     }
 
-    if (httpd_get_client_list(http_server, &clients, client_fds) == ESP_OK)
+    xSemaphoreTake(s_serial_mutex, portMAX_DELAY);
+
+    for (int i = 0; i < CONFIG_HTTPD_MAX_OPENED_SOCKETS; i++)
     {
-        for (size_t i = 0; i < clients; ++i)
+        if (s_serial_clients[i].fd >= 0)
         {
-            if (httpd_ws_get_fd_info(http_server, client_fds[i]) == HTTPD_WS_CLIENT_WEBSOCKET)
-            {
-                httpd_ws_send_frame_async(http_server, client_fds[i], &ws_pkt);
-            }
+            web_serial_ring_put(&s_serial_clients[i], data, size);
+            full = full || (s_serial_clients[i].count >= CONFIG_HTTPD_SERIAL_FRAME_SIZE);
         }
     }
-}
 
-static httpd_handle_t s_http_server = NULL;
+    /* A full frame goes out now, anything less waits up to CONFIG_HTTPD_SERIAL_FLUSH_MS for more data */
+    if (full && !s_serial_work_queued)
+    {
+        s_serial_work_queued = true;
+        web_serial_queue_flush();
+    }
+    else if (!full && !s_serial_work_queued && !s_serial_timer_armed)
+    {
+        s_serial_timer_armed = true;
+        arm = true;
+    }
+
+    xSemaphoreGive(s_serial_mutex);
+
+    if (arm)
+    {
+        esp_timer_start_once(s_serial_timer, CONFIG_HTTPD_SERIAL_FLUSH_MS * 1000);
+    }
+}
 
 void web_notify_serial_state(int state)
 {
-    size_t clients = CONFIG_HTTPD_MAX_OPENED_SOCKETS;
-    static int client_fds[CONFIG_HTTPD_MAX_OPENED_SOCKETS] = {0};
     const char *state_str = "IDLE";
     char json_msg[64] = {0};
     httpd_ws_frame_t ws_pkt = {false, false, HTTPD_WS_TYPE_TEXT, NULL, 0};
 
-    if (!s_http_server)
+    if (!s_http_server || !s_serial_mutex)
         return;
 
     /* Build JSON message: {"type":"state_change","state":"USB"} */
@@ -114,6 +468,10 @@ void web_notify_serial_state(int state)
         state_str = "WEB";
         break;
 
+    case SERIAL_STATE_TCP:
+        state_str = "TCP";
+        break;
+
     case SERIAL_STATE_IDLE:
     default:
         state_str = "IDLE";
@@ -125,21 +483,52 @@ void web_notify_serial_state(int state)
     ws_pkt.payload = (uint8_t *)json_msg;
     ws_pkt.len = strlen(json_msg);
 
-    if (httpd_get_client_list(s_http_server, &clients, client_fds) == ESP_OK)
+    /* Clients come and go from the httpd task */
+    xSemaphoreTake(s_serial_mutex, portMAX_DELAY);
+
+    for (int i = 0; i < CONFIG_HTTPD_MAX_OPENED_SOCKETS; i++)
     {
-        for (size_t i = 0; i < clients; ++i)
+        if (s_serial_clients[i].fd >= 0)
         {
-            if (httpd_ws_get_fd_info(s_http_server, client_fds[i]) == HTTPD_WS_CLIENT_WEBSOCKET)
-            {
-                httpd_ws_send_frame_async(s_http_server, client_fds[i], &ws_pkt);
-            }
+            httpd_ws_send_frame_async(s_http_server, s_serial_clients[i].fd, &ws_pkt);
         }
     }
+
+    xSemaphoreGive(s_serial_mutex);
 }
 
 void web_set_server_handle(httpd_handle_t server)
 {
+    const esp_timer_create_args_t timer_args = {
+        .callback = web_status_timer_cb,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "web_status",
+        .skip_unhandled_events = true,
+    };
+    const esp_timer_create_args_t serial_timer_args = {
+        .callback = web_serial_timer_cb,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "web_serial",
+        .skip_unhandled_events = true,
+    };
+
     s_http_server = server;
+
+    if (!s_status_timer)
+    {
+        for (int i = 0; i < CONFIG_HTTPD_MAX_OPENED_SOCKETS; i++)
+        {
+            s_status_clients[i].fd = -1;
+            s_serial_clients[i].fd = -1;
+        }
+
+        s_serial_mutex = xSemaphoreCreateMutex();
+        esp_timer_create(&serial_timer_args, &s_serial_timer);
+        esp_timer_create(&timer_args, &s_status_timer);
+        programmer_register_status_callback(web_notify_program_status);
+    }
 }
 
 esp_err_t web_send_to_uart(httpd_req_t *req)
@@ -150,6 +539,17 @@ esp_err_t web_send_to_uart(httpd_req_t *req)
 
     if (req->method == HTTP_GET)
     {
+        web_serial_client_t *client = web_serial_client_alloc(httpd_req_to_sockfd(req));
+
+        if (!client)
+        {
+            ESP_LOGE(TAG, "No room for another serial client");
+            return ESP_FAIL;
+        }
+
+        /* Released together with the session, however the connection ends */
+        req->sess_ctx = client;
+        req->free_ctx = web_serial_client_free;
         ESP_LOGI(TAG, "Handshake done, the new connection was opened");
         // Notify SerialManager about new web client
         serial_manager_web_client_connected();
@@ -183,7 +583,7 @@ esp_err_t web_send_to_uart(httpd_req_t *req)
     if (ws_pkt.type == HTTPD_WS_TYPE_CLOSE)
     {
         ESP_LOGI(TAG, "WebSocket close frame received");
-        serial_manager_web_client_disconnected();
+        httpd_sess_trigger_close(req->handle, httpd_req_to_sockfd(req));
         goto __exit;
     }
 
@@ -222,12 +622,44 @@ static esp_err_t web_set_content_type(httpd_req_t *req, const char *filename)
     return httpd_resp_set_type(req, "text/plain");
 }
 
-static bool web_resp_file(httpd_req_t *req, const char *filename, char *buf, size_t size)
+static const char *web_resource_etag(web_resource_map_t *res)
+{
+    uint8_t hash[32];
+
+    /* Hash once on first request, the assets never change at runtime */
+    if (res->etag[0] == '\0')
+    {
+        mbedtls_sha256(res->start, res->end - res->start, hash, 0);
+        snprintf(res->etag, sizeof(res->etag), "\"%02x%02x%02x%02x%02x%02x%02x%02x\"",
+                 hash[0], hash[1], hash[2], hash[3], hash[4], hash[5], hash[6], hash[7]);
+    }
+
+    return res->etag;
+}
+
+static bool web_etag_match(httpd_req_t *req, const char *etag)
+{
+    char value[64] = {0};
+    size_t len = httpd_req_get_hdr_value_len(req, "If-None-Match");
+
+    if ((len == 0) || (len >= sizeof(value)))
+    {
+        return false;
+    }
+
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", value, sizeof(value)) != ESP_OK)
+    {
+        return false;
+    }
+
+    return (strstr(value, etag) != NULL);
+}
+
+/* Send an embedded page and finish the response, answers 304 when the browser copy is current */
+static bool web_resp_file(httpd_req_t *req, const char *filename)
 {
     int i = 0;
-    uint32_t offset = 0;
-    uint32_t chunksize = 0;
-    uint32_t file_size = 0;
+    const char *etag = NULL;
 
     for (i = 0; i < WEB_RESOURCE_NUM; i++)
     {
@@ -244,24 +676,23 @@ static bool web_resp_file(httpd_req_t *req, const char *filename, char *buf, siz
         return false;
     }
 
-    offset = 0;
-    file_size = s_resource_map[i].end - s_resource_map[i].start;
-    web_set_content_type(req, filename);
+    etag = web_resource_etag(&s_resource_map[i]);
+    httpd_resp_set_hdr(req, "ETag", etag);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
 
-    while (offset < file_size)
+    if (web_etag_match(req, etag))
     {
-        chunksize = file_size - offset;
-        chunksize = (chunksize < size) ? (chunksize) : (size);
+        httpd_resp_set_status(req, "304 Not Modified");
+        return (ESP_OK == httpd_resp_send(req, NULL, 0));
+    }
 
-        if (ESP_OK != httpd_resp_send_chunk(req, (const char *)s_resource_map[i].start + offset, chunksize))
-        {
-            ESP_LOGE(TAG, "httpd_resp_send_chunk failed");
-            httpd_resp_send_chunk(req, NULL, 0);
-            httpd_resp_send_500(req);
-            return false;
-        }
+    web_set_content_type(req, filename);
+    httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
 
-        offset += chunksize;
+    if (ESP_OK != httpd_resp_send(req, (const char *)s_resource_map[i].start, s_resource_map[i].end - s_resource_map[i].start))
+    {
+        ESP_LOGE(TAG, "httpd_resp_send failed");
+        return false;
     }
 
     return true;
@@ -269,11 +700,8 @@ static bool web_resp_file(httpd_req_t *req, const char *filename, char *buf, siz
 
 esp_err_t web_serial_handler(httpd_req_t *req)
 {
-    web_data_t *data = (web_data_t *)req->user_ctx;
-
-    if ((req->method == HTTP_GET) && web_resp_file(req, "/data/httpd/webserial.html", (char *)data->buf, CONFIG_HTTPD_RESP_BUF_SIZE))
+    if ((req->method == HTTP_GET) && web_resp_file(req, "/data/httpd/webserial.html"))
     {
-        httpd_resp_send_chunk(req, NULL, 0);
         return ESP_OK;
     }
 
@@ -282,12 +710,10 @@ esp_err_t web_serial_handler(httpd_req_t *req)
 
 esp_err_t web_index_handler(httpd_req_t *req)
 {
-    web_data_t *data = (web_data_t *)req->user_ctx;
     ESP_LOGI(TAG, "%d connected", httpd_req_to_sockfd(req));
 
-    if (req->method == HTTP_GET && web_resp_file(req, "/data/httpd/root.html", (char *)data->buf, CONFIG_HTTPD_RESP_BUF_SIZE))
+    if (req->method == HTTP_GET && web_resp_file(req, "/data/httpd/root.html"))
     {
-        httpd_resp_send_chunk(req, NULL, 0);
         return ESP_OK;
     }
 
@@ -296,11 +722,8 @@ esp_err_t web_index_handler(httpd_req_t *req)
 
 esp_err_t web_favicon_handler(httpd_req_t *req)
 {
-    web_data_t *data = (web_data_t *)req->user_ctx;
-
-    if (req->method == HTTP_GET && web_resp_file(req, "/data/httpd/favicon.ico", (char *)data->buf, CONFIG_HTTPD_RESP_BUF_SIZE))
+    if (req->method == HTTP_GET && web_resp_file(req, "/data/httpd/favicon.ico"))
     {
-        httpd_resp_send_chunk(req, NULL, 0);
         return ESP_OK;
     }
 
@@ -316,9 +739,8 @@ esp_err_t web_upgrade_handler(httpd_req_t *req)
 
     if (req->method == HTTP_GET)
     {
-        if (web_resp_file(req, "/data/httpd/upgrade.html", (char *)data->buf, CONFIG_HTTPD_RESP_BUF_SIZE))
+        if (web_resp_file(req, "/data/httpd/upgrade.html"))
         {
-            httpd_resp_send_chunk(req, NULL, 0);
             return ESP_OK;
         }
 
@@ -455,315 +877,62 @@ __exit:
     return ret;
 }
 
-void web_add_option(httpd_req_t *req, char *path)
+static int s_list_count = 0;
+
+void web_add_json_item(httpd_req_t *req, char *path)
 {
-    httpd_resp_sendstr_chunk(req, "<option value=");
-    httpd_resp_sendstr_chunk(req, path);
-    httpd_resp_sendstr_chunk(req, ">");
+    httpd_resp_sendstr_chunk(req, (s_list_count++ == 0) ? "\"" : ",\"");
     httpd_resp_sendstr_chunk(req, path);
-    httpd_resp_sendstr_chunk(req, "</option>");
+    httpd_resp_sendstr_chunk(req, "\"");
 }
 
-esp_err_t web_program_handler(httpd_req_t *req)
+/* Image names come straight from the upload query, quote them for a JSON string */
+static void web_json_escape(const char *in, char *out, size_t size)
 {
-    char *buf = NULL;
-    size_t buf_size = 0;
-    bool is_zh = false;
-
-    if (req->method != HTTP_GET)
-    {
-        return ESP_FAIL;
-    }
+    size_t len = 0;
 
-    /* Check for language preference from query string */
-    buf_size = httpd_req_get_url_query_len(req) + 1;
-    if (buf_size > 1)
+    for (; *in && (len + 7 < size); in++)
     {
-        buf = (char *)malloc(buf_size);
-        if (buf)
+        if ((*in == '"') || (*in == '\\'))
         {
-            if (httpd_req_get_url_query_str(req, buf, buf_size) == ESP_OK)
-            {
-                char lang[4] = {0};
-                if (httpd_query_key_value(buf, "lang", lang, sizeof(lang)) == ESP_OK)
-                {
-                    is_zh = (strcmp(lang, "zh") == 0);
-                }
-            }
-            free(buf);
+            out[len++] = '\\';
+            out[len++] = *in;
+        }
+        else if ((unsigned char)*in < 0x20)
+        {
+            len += snprintf(&out[len], size - len, "\\u%04x", (unsigned char)*in);
+        }
+        else
+        {
+            out[len++] = *in;
         }
     }
 
-    httpd_resp_set_type(req, "text/html");
-    httpd_resp_sendstr_chunk(req, "<!DOCTYPE html>"
-                                  "<html lang=\"en\">"
-                                  "<head>"
-                                  "<meta charset=\"utf-8\">"
-                                  "<meta name=\"viewport\" content=\"width=device-width, initial-scale=1.0\">"
-                                  "<title>Program Device</title>"
-                                  "<style>"
-                                  "*{margin:0;padding:0;box-sizing:border-box}"
-                                  "body{font-family:'Segoe UI','Microsoft YaHei',sans-serif;background:linear-gradient(135deg,#0a0a0f 0%,#1a1a2e 50%,#0a0a0f 100%);color:#fff}"
-                                  ".container{max-width:800px;margin:0 auto;padding:15px}"
-                                  ".header{text-align:center;margin-bottom:20px}"
-                                  ".content{background:rgba(18,18,26,.8);backdrop-filter:blur(10px);border:1px solid rgba(0,245,255,.1);border-radius:15px;padding:25px}"
-                                  ".form-group{margin-bottom:20px}"
-                                  ".form-group label{display:block;margin-bottom:8px;color:rgba(0,245,255,.8);font-weight:600}"
-                                  ".form-group input,.form-group select,.form-group button{width:100%;padding:12px;border-radius:8px;font-size:14px}"
-                                  ".form-group input,.form-group select{background:rgba(0,0,0,.3);border:1px solid rgba(0,245,255,.2);color:#fff}"
-                                  ".form-group button{background:linear-gradient(135deg,rgba(0,245,255,.2),rgba(123,44,191,.2));border:1px solid rgba(0,245,255,.3);color:#fff;font-weight:600;cursor:pointer}"
-                                  ".form-group button:hover{border-color:rgba(0,245,255,.5);transform:translateY(-2px)}"
-                                  ".progress-container{margin:20px 0}"
-                                  ".progress-container progress{width:100%;height:20px;border-radius:10px}"
-                                  ".log-section{background:rgba(0,0,0,.3);border-radius:8px;padding:10px;max-height:150px;overflow-y:auto}"
-                                  ".log-entry{padding:5px 0;border-bottom:1px solid rgba(255,255,255,.05);font-size:13px}"
-                                  ".log-entry.info{color:#00f5ff}"
-                                  ".log-entry.success{color:#00ff88}"
-                                  ".log-entry.error{color:#ff006e}"
-                                  ".log-entry.warning{color:#ffaa00}"
-                                  ".drop-zone{border:2px dashed rgba(0,245,255,.3);border-radius:10px;padding:20px;text-align:center;cursor:pointer;transition:all .3s}"
-                                  ".drop-zone:hover{border-color:rgba(0,245,255,.6);background:rgba(0,245,255,.02)}"
-                                  ".file-info{background:rgba(0,245,255,.05);border-radius:8px;padding:10px;margin-top:10px}"
-                                  "</style>"
-                                  "</head>"
-                                  "<body>"
-                                  "<div class=\"container\">"
-                                  "<div class=\"header\">"
-                                  "<p>");
-
-    /* i18n JavaScript translations */
-    const char *i18n_js =
-        "var _i18n={en:{},zh:{}},_t=function(k){var l=localStorage.getItem('lang')||'en';return _i18n[l][k]||k;};"
-        "_i18n.en={"
-        "'program.title':'Offline Programming Tool',"
-        "'program.algorithm':'Algorithm File',"
-        "'program.select_algorithm':'Select algorithm',"
-        "'program.program':'Program File',"
-        "'program.select_program':'Select program',"
-        "'program.start_addr':'Flash Address',"
-        "'program.start_addr_hint':'BIN needs manual input, HEX auto-parses',"
-        "'program.ram_addr':'RAM Address',"
-        "'program.ram_hint':'e.g.: 0x20000000',"
-        "'program.offline_program':'Offline Program',"
-        "'program.online_program':'Online Program',"
-        "'program.drag_hint':'Drag file here or click to select',"
-        "'program.start':'Start Programming',"
-        "'program.ready':'[System] Ready',"
-        "'program.progress':'Progress: {p}% ({s})',"
-        "'program.complete':'Programming complete!',"
-        "'program.selected':'Selected: {name}',"
-        "'program.parsing_hex':'Parsing HEX file address...',"
-        "'program.hex_parsed':'HEX address auto-parsed: {addr}',"
-        "'program.hex_not_found':'HEX address not found, please fill manually',"
-        "'program.bin_manual':'BIN file needs manual Flash address',"
-        "'program.hex_auto':'hex address auto-parsed',"
-        "'program.hex_failed':'Failed to parse hex file',"
-        "'program.bin_manual2':'BIN file needs manual Flash address',"
-        "'program.select_both':'Please select program and algorithm',"
-        "'program.start_offline':'Starting offline programming: {name}',"
-        "'program.starting':'Programming started',"
-        "'program.program_failed':'Failed: {err}',"
-        "'program.select_file':'Please select file',"
-        "'program.select_algorithm2':'Please select algorithm',"
-        "'program.upload_algorithm':'Upload Algorithm',"
-        "'program.algorithm_upload_hint':'Drag FLM file here or click to upload',"
-        "'program.algorithm_uploaded':'Algorithm uploaded: {name}',"
-        "'program.algorithm_upload_failed':'Algorithm upload failed',"
-        "'program.start_online':'Starting online programming: {name} ({fmt})',"
-        "'program.config_sent':'Config sent, uploading file...',"
-        "'program.config_failed':'Config failed: {err}',"
-        "'program.upload_success':'File uploaded successfully',"
-        "'program.upload_failed':'Upload failed',"
-        "'program.parse_failed':'Parse failed: {err}'"
-        "};"
-        "_i18n.zh={"
-        "'program.title':'离线烧录工具',"
-        "'program.algorithm':'算法文件',"
-        "'program.select_algorithm':'请选择算法',"
-        "'program.program':'程序文件',"
-        "'program.select_program':'请选择程序',"
-        "'program.start_addr':'烧录地址',"
-        "'program.start_addr_hint':'bin 文件需要手动填写，hex 文件自动解析',"
-        "'program.ram_addr':'RAM 地址',"
-        "'program.ram_hint':'例如：0x20000000',"
-        "'program.offline_program':'离线烧录',"
-        "'program.online_program':'在线烧录',"
-        "'program.drag_hint':'拖拽文件到此处或点击选择',"
-        "'program.start':'开始烧录',"
-        "'program.ready':'[系统] 准备就绪',"
-        "'program.progress':'进度：{p}% ({s})',"
-        "'program.complete':'烧录完成！',"
-        "'program.selected':'已选择：{name}',"
-        "'program.parsing_hex':'正在解析 HEX 文件地址...',"
-        "'program.hex_parsed':'HEX 文件地址已自动解析：{addr}',"
-        "'program.hex_not_found':'未找到 HEX 地址，请手动填写',"
-        "'program.bin_manual':'BIN 文件请手动填写 Flash 地址',"
-        "'program.hex_auto':'hex 文件地址已自动解析',"
-        "'program.hex_failed':'解析 hex 文件失败',"
-        "'program.bin_manual2':'bin 文件请手动填写 Flash 地址',"
-        "'program.select_both':'请选择程序和算法',"
-        "'program.start_offline':'开始离线烧录：{name}',"
-        "'program.starting':'烧录已开始',"
-        "'program.program_failed':'失败：{err}',"
-        "'program.select_file':'请选择文件',"
-        "'program.select_algorithm2':'请选择算法',"
-        "'program.upload_algorithm':'上传算法',"
-        "'program.algorithm_upload_hint':'拖拽 FLM 文件到此处或点击上传',"
-        "'program.algorithm_uploaded':'算法已上传：{name}',"
-        "'program.algorithm_upload_failed':'算法上传失败',"
-        "'program.start_online':'开始在线烧录：{name} ({fmt})',"
-        "'program.config_sent':'配置已发送，开始上传文件...',"
-        "'program.config_failed':'配置失败：{err}',"
-        "'program.upload_success':'文件上传成功',"
-        "'program.upload_failed':'上传失败',"
-        "'program.parse_failed':'解析失败：{err}'"
-        "};";
-
-    const char *title = is_zh ? "离线烧录工具" : "Offline Programming Tool";
-    const char *algorithm_label = is_zh ? "算法文件" : "Algorithm File";
-    const char *select_algorithm = is_zh ? "请选择算法" : " Select algorithm";
-    const char *program_label = is_zh ? "程序文件" : "Program File";
-    const char *select_program = is_zh ? "请选择程序" : "Select program";
-    const char *start_addr_label = is_zh ? "烧录地址" : "Flash Address";
-    const char *start_addr_ph = is_zh ? "bin 文件需要手动填写，hex 文件自动解析" : "BIN needs manual input, HEX auto-parses";
-    const char *ram_addr_label = is_zh ? "RAM 地址" : "RAM Address";
-    const char *ram_addr_ph = is_zh ? "例如：0x20000000" : "e.g.: 0x20000000";
-    const char *offline_program_btn = is_zh ? "离线烧录" : "Offline Program";
-    const char *online_program_label = is_zh ? "在线烧录" : "Online Program";
-    const char *drag_hint = is_zh ? "拖拽文件到此处或点击选择" : "Drag file here or click to select";
-    const char *start_btn = is_zh ? "开始在线烧录" : "Start Programming";
-    const char *ready_msg = is_zh ? "[系统] 准备就绪" : "[System] Ready";
-    const char *upload_algorithm = is_zh ? "上传算法文件" : "Upload Algorithm File";
-    const char *algo_upload_hint = is_zh ? "拖拽 FLM 文件到此处或点击上传" : "Drag FLM file here or click to upload";
-
-    httpd_resp_sendstr_chunk(req, "<div class=\"container\">"
-                                  "<div class=\"header\">"
-                                  "<h1>🔧 ESP32 DAPLink</h1>"
-                                  "<p>");
-    httpd_resp_sendstr_chunk(req, title);
-    httpd_resp_sendstr_chunk(req, "</p>"
-                                  "</div>"
-                                  "<div class=\"content\">"
-                                  "<div class=\"form-group\">"
-                                  "<label for=\"algorithm\">");
-    httpd_resp_sendstr_chunk(req, algorithm_label);
-    httpd_resp_sendstr_chunk(req, "</label>"
-                                  "<select id=\"algorithm\">"
-                                  "<option value=\"\">");
-    httpd_resp_sendstr_chunk(req, select_algorithm);
-    httpd_resp_sendstr_chunk(req, "</option>");
-    web_list_files(CONFIG_PROGRAMMER_ALGORITHM_ROOT, CONFIG_PROGRAMMER_ALGORITHM_ROOT, web_add_option, req);
-    httpd_resp_sendstr_chunk(req, "</select>"
-                                  "</div>"
-                                  "<div class=\"form-group\">"
-                                  "<label>");
-    httpd_resp_sendstr_chunk(req, upload_algorithm);
-    httpd_resp_sendstr_chunk(req, "</label>"
-                                  "<div id=\"algo-drop-zone\" style=\"border:2px dashed rgba(0,245,255,0.3);border-radius:10px;padding:20px;text-align:center;cursor:pointer;background:rgba(0,245,255,0.02);\" "
-                                  "onclick=\"document.getElementById('algo-file').click()\" "
-                                  "ondragover=\"event.preventDefault();this.style.borderColor='var(--primary-color);\" "
-                                  "ondragleave=\"this.style.borderColor='rgba(0,245,255,0.3)';\" "
-                                  "ondrop=\"handleAlgoDrop(event);\">"
-                                  "<div style=\"font-size:1.5em;margin-bottom:5px;\">📁</div>"
-                                  "<div style=\"font-size:0.85em;color:rgba(255,255,255,0.6);\">");
-    httpd_resp_sendstr_chunk(req, algo_upload_hint);
-    httpd_resp_sendstr_chunk(req, "</div>"
-                                  "<input type=\"file\" id=\"algo-file\" accept=\"*.flm\" style=\"display:none;\" onchange=\"handleAlgoFile(this.files[0]);\">"
-                                  "</div>"
-                                  "<div id=\"algo-file-info\" style=\"display:none;margin-top:10px;padding:10px;background:rgba(0,245,255,0.05);border-radius:8px;\">"
-                                  "<div id=\"algo-file-name\" style=\"color:var(--primary-color);font-weight:600;\"></div>"
-                                  "<div id=\"algo-file-size\" style=\"color:var(--text-secondary);font-size:0.9em;\"></div>"
-                                  "</div>"
-                                  "<div class=\"form-group\">"
-                                  "<label for=\"offline-program\">");
-    httpd_resp_sendstr_chunk(req, program_label);
-    httpd_resp_sendstr_chunk(req, "</label>"
-                                  "<select id=\"offline-program\">"
-                                  "<option value=\"\">");
-    httpd_resp_sendstr_chunk(req, select_program);
-    httpd_resp_sendstr_chunk(req, "</option>");
-    web_list_files(CONFIG_PROGRAMMER_PROGRAM_ROOT, CONFIG_PROGRAMMER_PROGRAM_ROOT, web_add_option, req);
-    httpd_resp_sendstr_chunk(req, "</select>"
-                                  "</div>"
-                                  "<div class=\"form-group\">"
-                                  "<label for=\"start-address\">");
-    httpd_resp_sendstr_chunk(req, start_addr_label);
-    httpd_resp_sendstr_chunk(req, "</label>"
-                                  "<input type=\"text\" id=\"start-address\" placeholder=\"");
-    httpd_resp_sendstr_chunk(req, start_addr_ph);
-    httpd_resp_sendstr_chunk(req, "\">"
-                                  "</div>"
-                                  "<div class=\"form-group\">"
-                                  "<label for=\"ram-address\">");
-    httpd_resp_sendstr_chunk(req, ram_addr_label);
-    httpd_resp_sendstr_chunk(req, "</label>"
-                                  "<input type=\"text\" id=\"ram-address\" placeholder=\"");
-    httpd_resp_sendstr_chunk(req, ram_addr_ph);
-    httpd_resp_sendstr_chunk(req, "\" value=\"0x20000000\">"
-                                  "</div>"
-                                  "<div class=\"form-group\">"
-                                  "<button id=\"offline-program-btn\">");
-    httpd_resp_sendstr_chunk(req, offline_program_btn);
-    httpd_resp_sendstr_chunk(req, "</button>"
-                                  "</div>"
-                                  "<hr style=\"border:0;border-top:1px solid rgba(0,245,255,0.2);margin:20px 0;\">"
-                                  "<div class=\"form-group\">"
-                                  "<label>");
-    httpd_resp_sendstr_chunk(req, online_program_label);
-    httpd_resp_sendstr_chunk(req, "</label>"
-                                  "<div id=\"drop-zone\" style=\"border:2px dashed rgba(0,245,255,0.3);border-radius:10px;padding:30px;text-align:center;cursor:pointer;background:rgba(0,245,255,0.02);\" "
-                                  "onclick=\"document.getElementById('online-file').click()\" "
-                                  "ondragover=\"event.preventDefault();this.style.borderColor='var(--primary-color);\" "
-                                  "ondragleave=\"this.style.borderColor='rgba(0,245,255,0.3)';\" "
-                                  "ondrop=\"handleDrop(event);\">"
-                                  "<div style=\"font-size:2em;margin-bottom:10px;\">📤</div>"
-                                  "<div>");
-    httpd_resp_sendstr_chunk(req, drag_hint);
-    httpd_resp_sendstr_chunk(req, "</div>"
-                                  "<input type=\"file\" id=\"online-file\" accept=\"*.bin,*.hex\" style=\"display:none;\" onchange=\"handleFile(this.files[0]);\">"
-                                  "</div>"
-                                  "<div id=\"file-info\" style=\"display:none;margin-top:10px;padding:10px;background:rgba(0,245,255,0.05);border-radius:8px;\">"
-                                  "<div id=\"file-name\" style=\"color:var(--primary-color);font-weight:600;\"></div>"
-                                  "<div id=\"file-size\" style=\"color:var(--text-secondary);font-size:0.9em;\"></div>"
-                                  "</div>"
-                                  "<button id=\"online-program-btn\" style=\"margin-top:10px;display:none;\">");
-    httpd_resp_sendstr_chunk(req, start_btn);
-    httpd_resp_sendstr_chunk(req, "</button>"
-                                  "</div>"
-                                  "<div class=\"progress-container\">"
-                                  "<progress id=\"progress\" value=\"0\" max=\"100\"></progress>"
-                                  "</div>"
-                                  "<div class=\"log-section\" id=\"log-section\">"
-                                  "<div class=\"log-entry\">");
-    httpd_resp_sendstr_chunk(req, ready_msg);
-    httpd_resp_sendstr_chunk(req, "</div>"
-                                  "</div>"
-                                  "</div>"
-                                  "</div>"
-                                  "<script>");
-    httpd_resp_sendstr_chunk(req, i18n_js);
-    httpd_resp_sendstr_chunk(req,
-                                  "var pollTimer=null,selectedFile=null;"
-                                  "(function(){var sl=localStorage.getItem('lang')||'en';var rl='");
-    httpd_resp_sendstr_chunk(req, is_zh ? "zh" : "en");
-    httpd_resp_sendstr_chunk(req, "';if(sl!==rl){var u=new URL(window.location.href);u.searchParams.set('lang',sl);window.location.replace(u.toString());return;}})();"
-                                  "function fmt(s,d){for(var k in d)s=s.replace('{'+k+'}',d[k]);return s;}"
-                                  "function addLog(m,t){var l=document.getElementById('log-section');if(!l)return;var e=document.createElement('div');e.className='log-entry '+t;e.innerHTML='['+new Date().toLocaleTimeString()+'] '+m;l.appendChild(e);l.scrollTop=l.scrollHeight;}"
-                                  "function updateProgress(p){document.getElementById('progress').value=p;}"
-                                  "function pollStatus(){fetch('/api/query?type=program-status').then(function(r){return r.json();}).then(function(d){var p=d.progress||0;var s=d.status||'unknown';updateProgress(p);addLog(fmt(_t('program.progress'),{p:p,s:s}),'info');if(p>=100||s=='idle'){clearInterval(pollTimer);addLog(_t('program.complete'),'success');}}).catch(function(e){});}"
-                                  "function handleDrop(e){e.preventDefault();if(e.dataTransfer.files.length)handleFile(e.dataTransfer.files[0]);}"
-                                  "function handleFile(f){if(!f)return;selectedFile=f;document.getElementById('file-name').textContent=f.name;document.getElementById('file-size').textContent=(f.size/1024).toFixed(1)+' KB';document.getElementById('file-info').style.display='block';document.getElementById('online-program-btn').style.display='inline-block';addLog(fmt(_t('program.selected'),{name:f.name}),'info');if(f.name.toLowerCase().endsWith('.hex')){addLog(_t('program.parsing_hex'),'info');fetch('/api/parse-start-addr',{method:'POST',body:f}).then(function(r){return r.json();}).then(function(d){if(d.start_addr){document.getElementById('start-address').value=d.start_addr;addLog(fmt(_t('program.hex_parsed'),{addr:d.start_addr}),'success');}else{document.getElementById('start-address').value='';addLog(_t('program.hex_not_found'),'warning');}}).catch(function(e){addLog(fmt(_t('program.parse_failed'),{err:e.message}),'warning');});}else{document.getElementById('start-address').value='';addLog(_t('program.bin_manual'),'warning');}}"
-                                  "function handleAlgoDrop(e){e.preventDefault();if(e.dataTransfer.files.length)handleAlgoFile(e.dataTransfer.files[0]);}"
-                                  "function handleAlgoFile(f){if(!f)return;addLog(fmt(_t('program.selected'),{name:f.name}),'info');var x=new XMLHttpRequest();x.open('POST','/api/upload?location=algorithm&name='+encodeURIComponent(f.name)+'&overwrite=true');x.onload=function(){if(x.status==200){document.getElementById('algo-file-name').textContent=f.name;document.getElementById('algo-file-size').textContent=(f.size/1024).toFixed(1)+' KB';document.getElementById('algo-file-info').style.display='block';addLog(fmt(_t('program.algorithm_uploaded'),{name:f.name}),'success');var opt=document.createElement('option');opt.value=f.name;opt.textContent=f.name;var sel=document.getElementById('algorithm');sel.insertBefore(opt,sel.firstChild);sel.value=f.name;}else{addLog(_t('program.algorithm_upload_failed'),'error');}};x.onerror=function(){addLog(_t('program.algorithm_upload_failed'),'error');};x.send(f);}"
-                                  "document.getElementById('offline-program').onchange=function(){var p=this.value;if(!p){document.getElementById('start-address').value='';return;}if(p.toLowerCase().endsWith('.hex')){fetch('/api/query?type=start-addr&file='+encodeURIComponent(p)).then(function(r){return r.json();}).then(function(d){if(d.start_addr){document.getElementById('start-address').value=d.start_addr;}addLog(_t('program.hex_auto'),'success');}).catch(function(e){addLog(_t('program.hex_failed'),'warning');});}else{document.getElementById('start-address').value='';addLog(_t('program.bin_manual2'),'warning');}};"
-                                  "document.getElementById('offline-program-btn').onclick=function(){var p=document.getElementById('offline-program').value;var a=document.getElementById('algorithm').value;var fa=document.getElementById('start-address').value;var ra=document.getElementById('ram-address').value;if(!p||!a){addLog(_t('program.select_both'),'error');return;}addLog(fmt(_t('program.start_offline'),{name:p}),'info');var x=new XMLHttpRequest();x.open('POST','/program');x.setRequestHeader('Content-Type','application/json');x.onload=function(){if(x.status==200){addLog(_t('program.starting'),'success');pollTimer=setInterval(pollStatus,1000);}else{addLog(fmt(_t('program.program_failed'),{err:x.responseText}),'error');}};x.send(JSON.stringify({program:p,algorithm:a,start_addr:parseInt(fa),ram_addr:parseInt(ra),program_mode:'offline',format:'bin',total_size:0}));};"
-                                  "document.getElementById('online-program-btn').onclick=function(){if(!selectedFile){addLog(_t('program.select_file'),'error');return;}var a=document.getElementById('algorithm').value;var fa=document.getElementById('start-address').value;var ra=document.getElementById('ram-address').value;if(!a){addLog(_t('program.select_algorithm2'),'error');return;}var fileFormat=selectedFile.name.toLowerCase().endsWith('.hex')?'hex':'bin';addLog(fmt(_t('program.start_online'),{name:selectedFile.name,fmt:fileFormat}),'info');var x=new XMLHttpRequest();x.open('POST','/program');x.setRequestHeader('Content-Type','application/json');x.onload=function(){if(x.status==200){addLog(_t('program.config_sent'),'success');uploadFile(selectedFile);}else{addLog(fmt(_t('program.config_failed'),{err:x.responseText}),'error');}};x.send(JSON.stringify({algorithm:a,start_addr:parseInt(fa),ram_addr:parseInt(ra),program_mode:'online',format:fileFormat,total_size:selectedFile.size}));};"
-                                  "function uploadFile(file){var x=new XMLHttpRequest();x.open('POST','/api/online-program');x.setRequestHeader('Content-Type','application/octet-stream');x.onload=function(){if(x.status==200){addLog(_t('program.upload_success'),'success');pollTimer=setInterval(pollStatus,1000);}else{addLog(_t('program.upload_failed'),'error');}};x.onerror=function(){addLog(_t('program.upload_failed'),'error');};x.send(file);};"
-                                  "</script>"
-                                  "</body></html>");
-    httpd_resp_send_chunk(req, NULL, 0);
+    out[len] = '\0';
+}
 
-    return ESP_OK;
+static void web_add_image_item(const image_store_entry_t *image, void *arg)
+{
+    httpd_req_t *req = (httpd_req_t *)arg;
+    char sha256[IMAGE_STORE_HASH_STR_SIZE] = {0};
+    char name[IMAGE_STORE_NAME_SIZE * 6] = {0};
+    char item[IMAGE_STORE_HASH_STR_SIZE + sizeof(name) + 48] = {0};
+
+    image_store_hash_to_str(image->sha256, sha256);
+    web_json_escape(image->name, name, sizeof(name));
+    snprintf(item, sizeof(item), "%s{\"name\":\"%s\",\"sha256\":\"%s\",\"size\":%lu}",
+             (s_list_count++ == 0) ? "" : ",", name, sha256, (unsigned long)image->size);
+    httpd_resp_sendstr_chunk(req, item);
+}
+
+esp_err_t web_program_handler(httpd_req_t *req)
+{
+    if ((req->method == HTTP_GET) && web_resp_file(req, "/data/httpd/program.html"))
+    {
+        return ESP_OK;
+    }
+
+    return ESP_FAIL;
 }
 
 esp_err_t web_flash_handler(httpd_req_t *req)
@@ -817,6 +986,196 @@ esp_err_t web_flash_handler(httpd_req_t *req)
     }
 }
 
+static void web_add_job_id(uint32_t id, prog_err_def err, void *arg)
+{
+    char item[48] = {0};
+
+    snprintf(item, sizeof(item), "%s{\"id\":%lu,\"error\":%d}", (s_list_count++ == 0) ? "" : ",", (unsigned long)id, err);
+    httpd_resp_sendstr_chunk((httpd_req_t *)arg, item);
+}
+
+static bool web_get_job_id(httpd_req_t *req, uint32_t &id)
+{
+    char query[32] = {0};
+    char val[12] = {0};
+
+    if ((httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK) ||
+        (httpd_query_key_value(query, "id", val, sizeof(val)) != ESP_OK))
+    {
+        return false;
+    }
+
+    id = strtoul(val, NULL, 10);
+
+    return true;
+}
+
+esp_err_t web_jobs_handler(httpd_req_t *req)
+{
+#define JOBS_MAX_SIZE (16 * 1024)
+
+    int num = 0;
+    int offset = 0;
+    int received = 0;
+    uint32_t id = 0;
+    bool filter = false;
+    char *buf = NULL;
+    web_data_t *data = (web_data_t *)req->user_ctx;
+    prog_err_def err = PROG_ERR_NONE;
+
+    httpd_resp_set_type(req, "application/json");
+
+    if (req->method == HTTP_DELETE)
+    {
+        if (!web_get_job_id(req, id))
+        {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Job id is unknown");
+            return ESP_FAIL;
+        }
+
+        httpd_resp_sendstr(req, prog_queue_cancel(id) ? "{\"cancelled\":true}" : "{\"cancelled\":false}");
+        return ESP_OK;
+    }
+
+    if (req->method == HTTP_GET)
+    {
+        auto jobs = std::make_unique<prog_job_t[]>(CONFIG_PROGRAMMER_JOB_SLOTS);
+
+        filter = web_get_job_id(req, id);
+        num = prog_queue_snapshot(jobs.get(), CONFIG_PROGRAMMER_JOB_SLOTS);
+
+        s_list_count = 0;
+        httpd_resp_sendstr_chunk(req, "{\"jobs\":[");
+
+        for (int i = 0; i < num; i++)
+        {
+            if (filter && (jobs[i].id != id))
+                continue;
+
+            if (s_list_count++)
+                httpd_resp_sendstr_chunk(req, ",");
+
+            httpd_resp_send_chunk(req, (char *)data->buf, prog_queue_encode(jobs[i], (char *)data->buf, CONFIG_HTTPD_RESP_BUF_SIZE));
+        }
+
+        httpd_resp_sendstr_chunk(req, "]}");
+        httpd_resp_send_chunk(req, NULL, 0);
+
+        return ESP_OK;
+    }
+
+    /* A batch may be larger than the shared response buffer */
+    if ((req->content_len <= 0) || (req->content_len > JOBS_MAX_SIZE))
+    {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid job list size");
+        return ESP_FAIL;
+    }
+
+    buf = (char *)malloc(req->content_len + 1);
+    if (!buf)
+    {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Not enough memory");
+        return ESP_FAIL;
+    }
+
+    while (offset < req->content_len)
+    {
+        received = httpd_req_recv(req, buf + offset, req->content_len - offset);
+        if (received <= 0)
+        {
+            if (received == HTTPD_SOCK_ERR_TIMEOUT)
+            {
+                continue;
+            }
+
+            free(buf);
+            return ESP_FAIL;
+        }
+
+        offset += received;
+    }
+
+    buf[offset] = '\0';
+
+    /* Job ids and errors are streamed back as the jobs are queued */
+    s_list_count = 0;
+    httpd_resp_sendstr_chunk(req, "{\"jobs\":[");
+    err = prog_queue_submit(buf, web_add_job_id, req);
+    free(buf);
+
+    if (err != PROG_ERR_NONE)
+    {
+        snprintf((char *)data->buf, CONFIG_HTTPD_RESP_BUF_SIZE, "],\"error\":%d}", err);
+        httpd_resp_sendstr_chunk(req, (char *)data->buf);
+    }
+    else
+    {
+        httpd_resp_sendstr_chunk(req, "]}");
+    }
+
+    httpd_resp_send_chunk(req, NULL, 0);
+
+    return ESP_OK;
+}
+
+esp_err_t web_armed_handler(httpd_req_t *req)
+{
+    int len = 0;
+    int offset = 0;
+    int received = 0;
+    web_data_t *data = (web_data_t *)req->user_ctx;
+    char *buf = (char *)data->buf;
+    prog_err_def err = PROG_ERR_NONE;
+
+    httpd_resp_set_type(req, "application/json");
+
+    if (req->method == HTTP_POST)
+    {
+        if ((req->content_len <= 0) || (req->content_len >= CONFIG_HTTPD_RESP_BUF_SIZE))
+        {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid request size");
+            return ESP_FAIL;
+        }
+
+        while (offset < req->content_len)
+        {
+            received = httpd_req_recv(req, buf + offset, req->content_len - offset);
+            if (received <= 0)
+            {
+                if (received == HTTPD_SOCK_ERR_TIMEOUT)
+                {
+                    continue;
+                }
+
+                return ESP_FAIL;
+            }
+
+            offset += received;
+        }
+
+        buf[offset] = '\0';
+        err = prog_armed_arm(buf, offset);
+
+        if (err != PROG_ERR_NONE)
+        {
+            snprintf(buf, CONFIG_HTTPD_RESP_BUF_SIZE, "{\"error\":%d}", err);
+            httpd_resp_set_status(req, "400 Bad Request");
+            httpd_resp_sendstr(req, buf);
+            return ESP_OK;
+        }
+    }
+    else if (req->method == HTTP_DELETE)
+    {
+        prog_armed_disarm();
+    }
+
+    /* Arming and disarming happen in the armed task, the state may still be the previous one */
+    prog_armed_get_status(buf, CONFIG_HTTPD_RESP_BUF_SIZE, len);
+    httpd_resp_send(req, buf, len);
+
+    return ESP_OK;
+}
+
 static esp_err_t web_upload_file(httpd_req_t *req, char *path, bool overwrite)
 {
 #define PROGRAM_MAX_SIZE 0xA00000
@@ -915,6 +1274,178 @@ static esp_err_t web_upload_file(httpd_req_t *req, char *path, bool overwrite)
     return ESP_OK;
 }
 
+static void web_resp_image(httpd_req_t *req, const image_store_entry_t *image)
+{
+    char sha256[IMAGE_STORE_HASH_STR_SIZE] = {0};
+    char name[IMAGE_STORE_NAME_SIZE * 6] = {0};
+    web_data_t *data = (web_data_t *)req->user_ctx;
+
+    image_store_hash_to_str(image->sha256, sha256);
+    web_json_escape(image->name, name, sizeof(name));
+    snprintf((char *)data->buf, CONFIG_HTTPD_RESP_BUF_SIZE, "{\"sha256\":\"%s\",\"size\":%lu,\"name\":\"%s\"}",
+             sha256, (unsigned long)image->size, name);
+    httpd_resp_set_hdr(req, "Connection", "close");
+    httpd_resp_sendstr(req, (char *)data->buf);
+}
+
+/* Retire the older images stored under name once image holds its content */
+static esp_err_t web_upload_replace(httpd_req_t *req, const char *name, const image_store_entry_t *image)
+{
+    /* Content that dedupes to an image under another name leaves the image under name alone */
+    if (strcmp(image->name, name))
+    {
+        ESP_LOGI(TAG, "Content already stored as %s, the image under %s is kept", image->name, name);
+        return ESP_OK;
+    }
+
+    /* A running job may be reading the old image, same rule as deleting it */
+    if (programmer_is_busy())
+    {
+        httpd_resp_set_status(req, "409 Conflict");
+        httpd_resp_sendstr(req, "Programmer is busy");
+        return ESP_FAIL;
+    }
+
+    image_store_remove_name(name, image);
+
+    return ESP_OK;
+}
+
+static esp_err_t web_upload_image(httpd_req_t *req, const char *name, const char *sha256, bool overwrite)
+{
+    int received = 0;
+    int remaining = req->content_len;
+    esp_err_t ret = ESP_OK;
+    image_store_entry_t image;
+    image_store_writer_t writer;
+    web_data_t *data = (web_data_t *)req->user_ctx;
+
+    if (!image_store_partition())
+    {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Image store is not available");
+        return ESP_FAIL;
+    }
+
+    if (!FileProgrammer::compare_extension(name, ".hex") && !FileProgrammer::compare_extension(name, ".bin"))
+    {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Only .hex and .bin images are supported");
+        return ESP_FAIL;
+    }
+
+    /* The client already knows the hash, skip the transfer if the content is stored */
+    if (image_store_find(sha256, &image))
+    {
+        ESP_LOGI(TAG, "Image %s already stored as %s", sha256, image.name);
+        if (overwrite && (web_upload_replace(req, name, &image) != ESP_OK))
+        {
+            return ESP_OK;
+        }
+
+        web_resp_image(req, &image);
+        return ESP_OK;
+    }
+
+    if (image_store_find_name(name, NULL))
+    {
+        if (!overwrite)
+        {
+            ESP_LOGE(TAG, "Image already exists: %s", name);
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "File already exist!");
+            return ESP_FAIL;
+        }
+
+        /* Refuse before the transfer instead of after it */
+        if (programmer_is_busy())
+        {
+            httpd_resp_set_status(req, "409 Conflict");
+            httpd_resp_sendstr(req, "Programmer is busy");
+            return ESP_OK;
+        }
+
+        ESP_LOGI(TAG, "%s will be overwritten", name);
+    }
+
+    ret = image_store_begin(&writer, name, req->content_len);
+    if (ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to store image: %s", esp_err_to_name(ret));
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, (ret == ESP_ERR_NO_MEM) ? "Image store full" : "Failed to store image");
+        return ESP_FAIL;
+    }
+
+    while (remaining > 0)
+    {
+        received = httpd_req_recv(req, (char *)data->buf, (remaining <= CONFIG_HTTPD_RESP_BUF_SIZE) ? (remaining) : (CONFIG_HTTPD_RESP_BUF_SIZE));
+
+        if (received <= 0)
+        {
+            if (received == HTTPD_SOCK_ERR_TIMEOUT)
+            {
+                continue;
+            }
+
+            image_store_abort(&writer);
+            ESP_LOGE(TAG, "Image reception failed!");
+            httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to receive file");
+            return ESP_FAIL;
+        }
+
+        if (image_store_write(&writer, data->buf, received) != ESP_OK)
+        {
+            image_store_abort(&writer);
+            ESP_LOGE(TAG, "Image write failed!");
+            httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to write file to storage");
+            return ESP_FAIL;
+        }
+
+        remaining -= received;
+    }
+
+    if (image_store_end(&writer, &image) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Image commit failed!");
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to write file to storage");
+        return ESP_FAIL;
+    }
+
+    /* The old image is only retired once the new one is committed, a retry dedupes and retires it */
+    if (overwrite && (web_upload_replace(req, name, &image) != ESP_OK))
+    {
+        return ESP_OK;
+    }
+
+    web_resp_image(req, &image);
+    ESP_LOGI(TAG, "Image reception complete");
+
+    return ESP_OK;
+}
+
+esp_err_t web_image_handler(httpd_req_t *req)
+{
+    char query[IMAGE_STORE_HASH_STR_SIZE + 16] = {0};
+    char sha256[IMAGE_STORE_HASH_STR_SIZE] = {0};
+
+    if ((httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK) ||
+        (httpd_query_key_value(query, "sha256", sha256, sizeof(sha256)) != ESP_OK))
+    {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Image hash is unknown");
+        return ESP_FAIL;
+    }
+
+    /* A running job may be reading the image, its space must not be reused under it */
+    if (programmer_is_busy())
+    {
+        httpd_resp_set_status(req, "409 Conflict");
+        httpd_resp_sendstr(req, "Programmer is busy");
+        return ESP_OK;
+    }
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, image_store_remove(sha256) ? "{\"deleted\":true}" : "{\"deleted\":false}");
+
+    return ESP_OK;
+}
+
 esp_err_t web_upload_file_handler(httpd_req_t *req)
 {
     struct stat st;
@@ -956,6 +1487,26 @@ esp_err_t web_upload_file_handler(httpd_req_t *req)
         return ESP_FAIL;
     }
 
+    /* Images go to the image store instead of the FAT partition */
+    if (!strcmp(location + location_offset, "image"))
+    {
+        char sha256[IMAGE_STORE_HASH_STR_SIZE] = {0};
+        char name[IMAGE_STORE_NAME_SIZE] = {0};
+
+        if (httpd_query_key_value(buf, "name", name, sizeof(name)) != ESP_OK)
+        {
+            free(buf);
+            httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Name is unknown");
+            return ESP_FAIL;
+        }
+
+        httpd_query_key_value(buf, "sha256", sha256, sizeof(sha256));
+        httpd_query_key_value(buf, "overwrite", overwrite, sizeof(overwrite));
+        free(buf);
+
+        return web_upload_image(req, name, sha256, 0 == memcmp(overwrite, "true", sizeof("true")));
+    }
+
     /* Check the upload position */
     if (strcmp(location + location_offset, "algorithm") && strcmp(location + location_offset, "program"))
     {
@@ -1059,6 +1610,60 @@ esp_err_t web_query_handler(httpd_req_t *req)
                  app_desc->version, rssi, CONFIG_IDF_TARGET, (unsigned long)flash_size);
         httpd_resp_sendstr(req, status);
     }
+    else if (!strcmp("dap-stats", type))
+    {
+        dap_arbiter_stats_t stats;
+
+        dap_arbiter_get_stats(&stats);
+        snprintf((char *)data->buf, CONFIG_HTTPD_RESP_BUF_SIZE,
+                 "{\"owner\":%lu,\"commands\":%lu,\"monitor\":%lu,\"rejected\":%lu,\"contended\":%lu,"
+                 "\"handovers\":%lu,\"hold_total_us\":%llu,\"hold_max_us\":%lu,\"wait_max_us\":%lu}",
+                 (unsigned long)stats.owner, (unsigned long)stats.commands, (unsigned long)stats.monitor,
+                 (unsigned long)stats.rejected, (unsigned long)stats.contended, (unsigned long)stats.handovers,
+                 (unsigned long long)stats.hold_total_us, (unsigned long)stats.hold_max_us,
+                 (unsigned long)stats.wait_max_us);
+        httpd_resp_sendstr(req, (char *)data->buf);
+    }
+    else if (!strcmp("file-list", type))
+    {
+        char location[16] = {0};
+        const char *root = CONFIG_PROGRAMMER_PROGRAM_ROOT;
+
+        httpd_query_key_value(buf, "location", location, sizeof(location));
+
+        if (!strcmp("algorithm", location))
+        {
+            root = CONFIG_PROGRAMMER_ALGORITHM_ROOT;
+        }
+
+        /* Handlers run on the single httpd task, the item counter needs no lock */
+        s_list_count = 0;
+        httpd_resp_sendstr_chunk(req, "{\"files\":[");
+        web_list_files(root, root, web_add_json_item, req);
+        httpd_resp_sendstr_chunk(req, "]}");
+        httpd_resp_send_chunk(req, NULL, 0);
+    }
+    else if (!strcmp("image-list", type))
+    {
+        s_list_count = 0;
+        httpd_resp_sendstr_chunk(req, "{\"images\":[");
+        image_store_list(web_add_image_item, req);
+        httpd_resp_sendstr_chunk(req, "]}");
+        httpd_resp_send_chunk(req, NULL, 0);
+    }
+    else if (!strcmp("serial-stats", type))
+    {
+        int clients = 0;
+
+        for (int i = 0; i < CONFIG_HTTPD_MAX_OPENED_SOCKETS; i++)
+        {
+            clients += (s_serial_clients[i].fd >= 0) ? 1 : 0;
+        }
+
+        snprintf(status, sizeof(status), "{\"clients\":%d,\"frames\":%lu,\"dropped\":%lu}",
+                 clients, (unsigned long)s_serial_frames, (unsigned long)s_serial_dropped);
+        httpd_resp_sendstr(req, status);
+    }
     else if (!strcmp("start-addr", type))
     {
         uint32_t start_addr = 0xFFFFFFFF;
@@ -1284,11 +1889,8 @@ esp_err_t web_set_uart_config_handler(httpd_req_t *req)
 
 esp_err_t web_wifi_config_handler(httpd_req_t *req)
 {
-    web_data_t *data = (web_data_t *)req->user_ctx;
-
-    if (req->method == HTTP_GET && web_resp_file(req, "/data/httpd/settings.html", (char *)data->buf, CONFIG_HTTPD_RESP_BUF_SIZE))
+    if (req->method == HTTP_GET && web_resp_file(req, "/data/httpd/settings.html"))
     {
-        httpd_resp_send_chunk(req, NULL, 0);
         return ESP_OK;
     }
 
@@ -6,6 +6,10 @@
  * Change Logs:
  * Date           Author       Notes
  * 2023-9-8      lihongquan   add license declaration
+ * 2026-10-19    hongquan.li   push programming status over WebSocket
+ * 2026-10-19    hongquan.li   add programming job queue endpoint
+ * 2026-10-19    hongquan.li   add armed auto-programming endpoint
+ * 2026-10-19    hongquan.li   add image delete endpoint
  */
 #pragma once
 
@@ -29,13 +33,29 @@ extern "C" {
      */
     void web_notify_serial_state(int state);
 
+    /**
+     * @brief Publish programmer status to the program page clients
+     *
+     * Safe to call from any task. Updates are coalesced and sent at most once
+     * per CONFIG_HTTPD_PROGRAM_STATUS_INTERVAL_MS, each client only receives
+     * the latest state.
+     *
+     * @param progress Progress percentage (0-100)
+     * @param busy Programmer busy state
+     */
+    void web_notify_program_status(int progress, bool busy);
+
     void web_set_server_handle(httpd_handle_t server);
     esp_err_t web_serial_handler(httpd_req_t *req);
     esp_err_t web_send_to_uart(httpd_req_t *req);
+    esp_err_t web_program_socket_handler(httpd_req_t *req);
     esp_err_t web_index_handler(httpd_req_t *req);
     esp_err_t web_favicon_handler(httpd_req_t *req);
     esp_err_t web_program_handler(httpd_req_t *req);
     esp_err_t web_flash_handler(httpd_req_t *req);
+    esp_err_t web_jobs_handler(httpd_req_t *req);
+    esp_err_t web_armed_handler(httpd_req_t *req);
+    esp_err_t web_image_handler(httpd_req_t *req);
     esp_err_t web_upload_file_handler(httpd_req_t *req);
     esp_err_t web_query_handler(httpd_req_t *req);
     esp_err_t web_parse_start_addr_handler(httpd_req_t *req);
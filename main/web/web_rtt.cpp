@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add RTT WebSocket and endpoint
+ * 2026-10-19    hongquan.li   use the shared WebSocket fan-out
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "esp_log.h"
+#include "web/web_rtt.h"
+#include "web/web_handler.h"
+#include "web/web_fanout.h"
+#include "serial/serial_rtt.h"
+#include "serial/serial_manager.h"
+
+#define TAG "web_rtt"
+
+#define WEB_RTT_STREAM_SIZE 4096
+#define WEB_RTT_FRAME_SIZE 1024
+
+static web_fanout_t s_rtt_fanout;
+
+/* Runs on the RTT task, the TCP client is not held up by the browsers */
+static void web_rtt_output(const uint8_t *data, size_t size)
+{
+    web_fanout_send(&s_rtt_fanout, data, size);
+}
+
+static bool web_rtt_init(httpd_handle_t server)
+{
+    if (s_rtt_fanout.queue)
+    {
+        return true;
+    }
+
+    if (!web_fanout_init(&s_rtt_fanout, server, WEB_RTT_STREAM_SIZE, WEB_RTT_FRAME_SIZE, false))
+    {
+        return false;
+    }
+
+    s_rtt_fanout.disconnected = serial_manager_rtt_client_disconnected;
+    serial_rtt_register_output(web_rtt_output);
+
+    return true;
+}
+
+esp_err_t web_rtt_socket_handler(httpd_req_t *req)
+{
+    esp_err_t ret = ESP_OK;
+    web_data_t *data = (web_data_t *)req->user_ctx;
+    httpd_ws_frame_t ws_pkt = {false, false, HTTPD_WS_TYPE_BINARY, NULL, 0};
+
+    /* Handshake */
+    if (req->method == HTTP_GET)
+    {
+        if (!web_rtt_init(req->handle))
+        {
+            return ESP_FAIL;
+        }
+
+        if (!web_fanout_add(&s_rtt_fanout, req))
+        {
+            ESP_LOGE(TAG, "No room for another RTT client");
+            return ESP_FAIL;
+        }
+
+        serial_manager_rtt_client_connected();
+        return ESP_OK;
+    }
+
+    ret = httpd_ws_recv_frame(req, &ws_pkt, 0);
+    if (ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "httpd_ws_recv_frame failed to get frame len with %d", ret);
+        return ret;
+    }
+
+    if (ws_pkt.len > CONFIG_HTTPD_RESP_BUF_SIZE)
+    {
+        ESP_LOGE(TAG, "Frame length is over the limit(%d)", CONFIG_HTTPD_RESP_BUF_SIZE);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    ws_pkt.payload = data->buf;
+    ret = httpd_ws_recv_frame(req, &ws_pkt, ws_pkt.len);
+
+    if ((ret == ESP_OK) && ((ws_pkt.type == HTTPD_WS_TYPE_BINARY) || (ws_pkt.type == HTTPD_WS_TYPE_TEXT)))
+    {
+        serial_rtt_write(data->buf, ws_pkt.len);
+    }
+
+    return ret;
+}
+
+esp_err_t web_rtt_handler(httpd_req_t *req)
+{
+    int len = 0;
+    char *end = NULL;
+    char val[16] = {0};
+    uint32_t addr = 0;
+    web_data_t *data = (web_data_t *)req->user_ctx;
+    char *buf = (char *)data->buf;
+
+    httpd_resp_set_type(req, "application/json");
+
+    if (req->method == HTTP_POST)
+    {
+        if ((httpd_req_get_url_query_str(req, buf, CONFIG_HTTPD_RESP_BUF_SIZE) != ESP_OK) ||
+            (httpd_query_key_value(buf, "addr", val, sizeof(val)) != ESP_OK))
+        {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Missing addr");
+            return ESP_FAIL;
+        }
+
+        addr = strtoul(val, &end, 0);
+        if ((end == val) || (*end != '\0'))
+        {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid addr");
+            return ESP_FAIL;
+        }
+
+        serial_rtt_set_address(addr);
+    }
+
+    /* The address is picked up by the RTT task, the status may still show the previous one */
+    serial_rtt_get_status(buf, CONFIG_HTTPD_RESP_BUF_SIZE, &len);
+    httpd_resp_send(req, buf, len);
+
+    return ESP_OK;
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add RTT WebSocket and endpoint
+ */
+#pragma once
+
+#include "esp_http_server.h"
+
+/**
+ * @file web_rtt.h
+ * @brief SEGGER RTT over WebSocket
+ *
+ * Every client of /rtt_socket receives the RTT up-buffer as binary frames,
+ * binary or text frames from a client go to the down-buffer.
+ *
+ * GET /api/rtt returns the reader status, POST /api/rtt?addr=<addr> sets the
+ * control block address instead of scanning for it, addr=0 scans again.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /**
+     * @brief WebSocket handler of the RTT endpoint
+     * @param req Request
+     * @return ESP_OK on success
+     */
+    esp_err_t web_rtt_socket_handler(httpd_req_t *req);
+
+    /**
+     * @brief Handler of the RTT status endpoint
+     * @param req Request
+     * @return ESP_OK on success
+     */
+    esp_err_t web_rtt_handler(httpd_req_t *req);
+
+#ifdef __cplusplus
+}
+#endif
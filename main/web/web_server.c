@@ -6,11 +6,25 @@
  * Change Logs:
  * Date           Author       Notes
  * 2023-9-8      lihongquan   add license declaration
+ * 2026-10-19    hongquan.li   add programming status socket
+ * 2026-10-19    hongquan.li   add streaming programming socket
+ * 2026-10-19    hongquan.li   add target memory dump endpoint
+ * 2026-10-19    hongquan.li   add programming job queue endpoint
+ * 2026-10-19    hongquan.li   add armed auto-programming endpoint
+ * 2026-10-19    hongquan.li   add RTT socket and endpoint
+ * 2026-10-19    hongquan.li   add live variable socket and endpoint
+ * 2026-10-19    hongquan.li   add SWO trace socket and endpoint
+ * 2026-10-19    hongquan.li   add image delete endpoint
  */
 #include "web/web_server.h"
 #include <stdbool.h>
 #include "esp_log.h"
 #include "web/web_handler.h"
+#include "web/web_stream.h"
+#include "web/web_dump.h"
+#include "web/web_rtt.h"
+#include "web/web_watch.h"
+#include "web/web_swo.h"
 
 #define TAG "web_server"
 
@@ -18,12 +32,32 @@ static web_data_t s_web_data = {0};
 static const httpd_uri_t s_index = {"/", HTTP_GET, web_index_handler, &s_web_data, false, false, NULL};
 static const httpd_uri_t s_webserial = {"/webserial", HTTP_GET, web_serial_handler, &s_web_data, true, true, NULL};
 static const httpd_uri_t s_webserial_send = {"/webserial_socket", HTTP_GET, web_send_to_uart, &s_web_data, true, true, NULL};
+static const httpd_uri_t s_program_socket = {"/program_socket", HTTP_GET, web_program_socket_handler, &s_web_data, true, false, NULL};
+static const httpd_uri_t s_program_stream = {"/program_stream", HTTP_GET, web_stream_handler, &s_web_data, true, false, NULL};
 static const httpd_uri_t s_favicon = {"/favicon.ico", HTTP_GET, web_favicon_handler, &s_web_data, false, false, NULL};
 static const httpd_uri_t s_get_program = {"/program", HTTP_GET, web_program_handler, &s_web_data, false, false, NULL};
 static const httpd_uri_t s_post_program = {"/program", HTTP_POST, web_flash_handler, &s_web_data, false, false, NULL};
 static const httpd_uri_t s_get_upgrade = {"/upgrade", HTTP_GET, web_upgrade_handler, &s_web_data, false, false, NULL};
 static const httpd_uri_t s_post_upgrade = {"/upgrade", HTTP_POST, web_upgrade_handler, &s_web_data, false, false, NULL};
 static const httpd_uri_t s_query = {"/api/query*", HTTP_GET, web_query_handler, &s_web_data, false, false, NULL};
+static const httpd_uri_t s_get_jobs = {"/api/jobs*", HTTP_GET, web_jobs_handler, &s_web_data, false, false, NULL};
+static const httpd_uri_t s_post_jobs = {"/api/jobs*", HTTP_POST, web_jobs_handler, &s_web_data, false, false, NULL};
+static const httpd_uri_t s_delete_jobs = {"/api/jobs*", HTTP_DELETE, web_jobs_handler, &s_web_data, false, false, NULL};
+static const httpd_uri_t s_get_armed = {"/api/armed", HTTP_GET, web_armed_handler, &s_web_data, false, false, NULL};
+static const httpd_uri_t s_post_armed = {"/api/armed", HTTP_POST, web_armed_handler, &s_web_data, false, false, NULL};
+static const httpd_uri_t s_delete_armed = {"/api/armed", HTTP_DELETE, web_armed_handler, &s_web_data, false, false, NULL};
+static const httpd_uri_t s_rtt_socket = {"/rtt_socket", HTTP_GET, web_rtt_socket_handler, &s_web_data, true, true, NULL};
+static const httpd_uri_t s_get_rtt = {"/api/rtt*", HTTP_GET, web_rtt_handler, &s_web_data, false, false, NULL};
+static const httpd_uri_t s_post_rtt = {"/api/rtt*", HTTP_POST, web_rtt_handler, &s_web_data, false, false, NULL};
+static const httpd_uri_t s_watch_socket = {"/watch_socket", HTTP_GET, web_watch_socket_handler, &s_web_data, true, true, NULL};
+static const httpd_uri_t s_get_watch = {"/api/watch", HTTP_GET, web_watch_handler, &s_web_data, false, false, NULL};
+static const httpd_uri_t s_post_watch = {"/api/watch", HTTP_POST, web_watch_handler, &s_web_data, false, false, NULL};
+static const httpd_uri_t s_delete_watch = {"/api/watch", HTTP_DELETE, web_watch_handler, &s_web_data, false, false, NULL};
+static const httpd_uri_t s_swo_socket = {"/swo_socket", HTTP_GET, web_swo_socket_handler, &s_web_data, true, true, NULL};
+static const httpd_uri_t s_get_swo = {"/api/swo*", HTTP_GET, web_swo_handler, &s_web_data, false, false, NULL};
+static const httpd_uri_t s_post_swo = {"/api/swo*", HTTP_POST, web_swo_handler, &s_web_data, false, false, NULL};
+static const httpd_uri_t s_dump = {"/api/dump*", HTTP_GET, web_dump_handler, &s_web_data, false, false, NULL};
+static const httpd_uri_t s_delete_image = {"/api/images*", HTTP_DELETE, web_image_handler, &s_web_data, false, false, NULL};
 static const httpd_uri_t s_upload_file = {"/api/upload*", HTTP_POST, web_upload_file_handler, &s_web_data, false, false, NULL};
 static const httpd_uri_t s_parse_start_addr = {"/api/parse-start-addr", HTTP_POST, web_parse_start_addr_handler, &s_web_data, false, false, NULL};
 static const httpd_uri_t s_online_program = {"/api/online-program", HTTP_POST, web_online_program_handler, &s_web_data, false, false, NULL};
@@ -41,7 +75,7 @@ bool web_server_init(httpd_handle_t *server)
         return false;
     }
 
-    config.max_uri_handlers = 20;
+    config.max_uri_handlers = 38;
     config.max_open_sockets = CONFIG_HTTPD_MAX_OPENED_SOCKETS;
     config.uri_match_fn = httpd_uri_match_wildcard;
     ESP_LOGI(TAG, "Starting server on port: '%d'", config.server_port);
@@ -54,6 +88,8 @@ bool web_server_init(httpd_handle_t *server)
 
     httpd_register_uri_handler(s_web_data.server, &s_webserial);
     httpd_register_uri_handler(s_web_data.server, &s_webserial_send);
+    httpd_register_uri_handler(s_web_data.server, &s_program_socket);
+    httpd_register_uri_handler(s_web_data.server, &s_program_stream);
     httpd_register_uri_handler(s_web_data.server, &s_index);
     httpd_register_uri_handler(s_web_data.server, &s_favicon);
     httpd_register_uri_handler(s_web_data.server, &s_get_program);
@@ -61,7 +97,31 @@ bool web_server_init(httpd_handle_t *server)
     httpd_register_uri_handler(s_web_data.server, &s_get_upgrade);
     httpd_register_uri_handler(s_web_data.server, &s_post_upgrade);
     httpd_register_uri_handler(s_web_data.server, &s_upload_file);
+    httpd_register_uri_handler(s_web_data.server, &s_delete_image);
     httpd_register_uri_handler(s_web_data.server, &s_query);
+    httpd_register_uri_handler(s_web_data.server, &s_dump);
+    httpd_register_uri_handler(s_web_data.server, &s_get_jobs);
+    httpd_register_uri_handler(s_web_data.server, &s_post_jobs);
+    httpd_register_uri_handler(s_web_data.server, &s_delete_jobs);
+    httpd_register_uri_handler(s_web_data.server, &s_get_armed);
+    httpd_register_uri_handler(s_web_data.server, &s_post_armed);
+    httpd_register_uri_handler(s_web_data.server, &s_delete_armed);
+#ifdef CONFIG_SERIAL_RTT_ENABLED
+    httpd_register_uri_handler(s_web_data.server, &s_rtt_socket);
+    httpd_register_uri_handler(s_web_data.server, &s_get_rtt);
+    httpd_register_uri_handler(s_web_data.server, &s_post_rtt);
+#endif
+#ifdef CONFIG_DATA_WATCH_ENABLED
+    httpd_register_uri_handler(s_web_data.server, &s_watch_socket);
+    httpd_register_uri_handler(s_web_data.server, &s_get_watch);
+    httpd_register_uri_handler(s_web_data.server, &s_post_watch);
+    httpd_register_uri_handler(s_web_data.server, &s_delete_watch);
+#endif
+#ifdef CONFIG_SWO_TRACE_ENABLED
+    httpd_register_uri_handler(s_web_data.server, &s_swo_socket);
+    httpd_register_uri_handler(s_web_data.server, &s_get_swo);
+    httpd_register_uri_handler(s_web_data.server, &s_post_swo);
+#endif
     httpd_register_uri_handler(s_web_data.server, &s_parse_start_addr);
     httpd_register_uri_handler(s_web_data.server, &s_online_program);
     httpd_register_uri_handler(s_web_data.server, &s_set_uart_config);
@@ -0,0 +1,443 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add binary WebSocket streaming programming
+ */
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+#include "cJSON.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "web/web_stream.h"
+#include "web/web_handler.h"
+#include "programmer/programmer.h"
+
+#define TAG "web_stream"
+
+#define WEB_STREAM_CONFIG 0x01
+#define WEB_STREAM_DATA 0x02
+#define WEB_STREAM_ACK 0x81
+#define WEB_STREAM_CONFIG_HDR_SIZE 8
+#define WEB_STREAM_DATA_HDR_SIZE 12
+#define WEB_STREAM_ACK_SIZE 20
+#define WEB_STREAM_FRAME_SIZE (WEB_STREAM_DATA_HDR_SIZE + CONFIG_HTTPD_STREAM_CHUNK_SIZE)
+
+typedef struct
+{
+    uint32_t session;                       ///< Session the chunk belongs to
+    uint32_t offset;                        ///< Offset of the payload in the image
+    uint32_t len;                           ///< Payload length
+    uint8_t frame[WEB_STREAM_FRAME_SIZE];   ///< Received frame, payload after the header
+} web_stream_slot_t;
+
+typedef struct
+{
+    bool active;    ///< Transfer running
+    int fd;         ///< Socket of the client driving the transfer, -1 while it is away
+    uint32_t id;    ///< Session id chosen by the client
+    uint32_t total; ///< Image size
+    uint32_t next;  ///< Next offset expected from the client
+    uint32_t done;  ///< Bytes written to the target
+} web_stream_session_t;
+
+static portMUX_TYPE s_stream_lock = portMUX_INITIALIZER_UNLOCKED;
+static httpd_handle_t s_stream_server = NULL;
+static web_stream_session_t s_session = {false, -1, 0, 0, 0, 0};
+static web_stream_slot_t *s_slots = NULL;
+static QueueHandle_t s_free_queue = NULL;
+static QueueHandle_t s_write_queue = NULL;
+
+static inline uint32_t web_stream_get_le32(const uint8_t *buf)
+{
+    return (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) | ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24);
+}
+
+static inline void web_stream_put_le32(uint8_t *buf, uint32_t val)
+{
+    buf[0] = (uint8_t)val;
+    buf[1] = (uint8_t)(val >> 8);
+    buf[2] = (uint8_t)(val >> 16);
+    buf[3] = (uint8_t)(val >> 24);
+}
+
+static void web_stream_send_ack(int fd, uint8_t status)
+{
+    uint8_t ack[WEB_STREAM_ACK_SIZE] = {0};
+    httpd_ws_frame_t ws_pkt = {false, false, HTTPD_WS_TYPE_BINARY, ack, sizeof(ack)};
+    uint32_t next = 0;
+    uint32_t done = 0;
+
+    if ((fd < 0) || !s_stream_server)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL(&s_stream_lock);
+    next = s_session.next;
+    done = s_session.done;
+    taskEXIT_CRITICAL(&s_stream_lock);
+
+    ack[0] = WEB_STREAM_ACK;
+    ack[1] = status;
+    web_stream_put_le32(&ack[4], CONFIG_HTTPD_STREAM_CHUNK_SIZE);
+    web_stream_put_le32(&ack[8], next);
+    web_stream_put_le32(&ack[12], done);
+    /* The window is whatever the programming queue can still hold */
+    web_stream_put_le32(&ack[16], done + CONFIG_HTTPD_STREAM_CREDITS * CONFIG_HTTPD_STREAM_CHUNK_SIZE);
+    httpd_ws_send_frame_async(s_stream_server, fd, &ws_pkt);
+}
+
+/* Feeds queued chunks to the programmer so the httpd task never waits for the target */
+static void web_stream_task(void *pvParameters)
+{
+    web_stream_slot_t *slot = NULL;
+    prog_err_def ret = PROG_ERR_NONE;
+    uint8_t status = WEB_STREAM_OK;
+    bool current = false;
+    int fd = -1;
+
+    for (;;)
+    {
+        xQueueReceive(s_write_queue, &slot, portMAX_DELAY);
+
+        taskENTER_CRITICAL(&s_stream_lock);
+        current = s_session.active && (s_session.id == slot->session);
+        taskEXIT_CRITICAL(&s_stream_lock);
+
+        /* Left over from an aborted transfer */
+        if (!current)
+        {
+            xQueueSend(s_free_queue, &slot, 0);
+            continue;
+        }
+
+        ret = programmer_write_data(&slot->frame[WEB_STREAM_DATA_HDR_SIZE], slot->len);
+        status = WEB_STREAM_OK;
+
+        taskENTER_CRITICAL(&s_stream_lock);
+
+        if (ret != PROG_ERR_NONE)
+        {
+            s_session.active = false;
+            status = WEB_STREAM_FAILED;
+        }
+        else
+        {
+            s_session.done += slot->len;
+
+            if (s_session.done == s_session.total)
+            {
+                s_session.active = false;
+                status = WEB_STREAM_DONE;
+            }
+        }
+
+        fd = s_session.fd;
+        taskEXIT_CRITICAL(&s_stream_lock);
+
+        if (status == WEB_STREAM_FAILED)
+        {
+            ESP_LOGE(TAG, "Write failed at offset %lu, ret: %d", slot->offset, ret);
+        }
+
+        xQueueSend(s_free_queue, &slot, 0);
+        web_stream_send_ack(fd, status);
+    }
+}
+
+static bool web_stream_init(httpd_handle_t server)
+{
+    web_stream_slot_t *slot = NULL;
+
+    if (s_slots)
+    {
+        return true;
+    }
+
+    s_slots = (web_stream_slot_t *)malloc(sizeof(web_stream_slot_t) * CONFIG_HTTPD_STREAM_CREDITS);
+    s_free_queue = xQueueCreate(CONFIG_HTTPD_STREAM_CREDITS, sizeof(web_stream_slot_t *));
+    s_write_queue = xQueueCreate(CONFIG_HTTPD_STREAM_CREDITS, sizeof(web_stream_slot_t *));
+
+    if (!s_slots || !s_free_queue || !s_write_queue)
+    {
+        ESP_LOGE(TAG, "Memory not enough");
+        goto __error;
+    }
+
+    for (int i = 0; i < CONFIG_HTTPD_STREAM_CREDITS; i++)
+    {
+        slot = &s_slots[i];
+        xQueueSend(s_free_queue, &slot, 0);
+    }
+
+    if (xTaskCreate(web_stream_task, "web_stream", 1024 * 4, NULL, 2, NULL) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to create stream task");
+        goto __error;
+    }
+
+    s_stream_server = server;
+
+    return true;
+
+__error:
+
+    if (s_free_queue)
+        vQueueDelete(s_free_queue);
+
+    if (s_write_queue)
+        vQueueDelete(s_write_queue);
+
+    free(s_slots);
+    s_slots = NULL;
+    s_free_queue = NULL;
+    s_write_queue = NULL;
+
+    return false;
+}
+
+static void web_stream_client_free(void *ctx)
+{
+    int fd = (int)(intptr_t)ctx;
+
+    /* Keep the transfer, the client may come back and resume it */
+    taskENTER_CRITICAL(&s_stream_lock);
+
+    if (s_session.fd == fd)
+    {
+        s_session.fd = -1;
+    }
+
+    taskEXIT_CRITICAL(&s_stream_lock);
+}
+
+static void web_stream_config(int fd, uint8_t *frame, size_t len)
+{
+    uint32_t id = 0;
+    uint32_t total = 0;
+    bool resume = false;
+    prog_err_def ret = PROG_ERR_NONE;
+    cJSON *root = NULL;
+    cJSON *total_item = NULL;
+
+    if (len <= WEB_STREAM_CONFIG_HDR_SIZE)
+    {
+        web_stream_send_ack(fd, WEB_STREAM_BAD_FRAME);
+        return;
+    }
+
+    id = web_stream_get_le32(&frame[4]);
+
+    taskENTER_CRITICAL(&s_stream_lock);
+    resume = s_session.active && (s_session.id == id);
+    taskEXIT_CRITICAL(&s_stream_lock);
+
+    /* Only resume while the programmer is still waiting for this image, it gives up after its data timeout */
+    if (resume && programmer_is_busy())
+    {
+        taskENTER_CRITICAL(&s_stream_lock);
+        s_session.fd = fd;
+        taskEXIT_CRITICAL(&s_stream_lock);
+
+        ESP_LOGI(TAG, "Resume session %08lx at %lu", id, s_session.next);
+        web_stream_send_ack(fd, WEB_STREAM_OK);
+        return;
+    }
+
+    std::string request((const char *)&frame[WEB_STREAM_CONFIG_HDR_SIZE], len - WEB_STREAM_CONFIG_HDR_SIZE);
+
+    root = cJSON_Parse(request.c_str());
+    total_item = cJSON_GetObjectItem(root, "total_size");
+
+    if (!cJSON_IsNumber(total_item) || (total_item->valuedouble <= 0))
+    {
+        cJSON_Delete(root);
+        web_stream_send_ack(fd, WEB_STREAM_BAD_FRAME);
+        return;
+    }
+
+    total = (uint32_t)total_item->valuedouble;
+    cJSON_Delete(root);
+
+    ret = programmer_request_handle(&request[0], request.length());
+
+    if (ret != PROG_ERR_NONE)
+    {
+        ESP_LOGE(TAG, "Request refused, ret: %d", ret);
+        web_stream_send_ack(fd, (ret == PROG_ERR_BUSY) ? WEB_STREAM_BUSY : WEB_STREAM_REJECTED);
+        return;
+    }
+
+    taskENTER_CRITICAL(&s_stream_lock);
+    s_session.active = true;
+    s_session.fd = fd;
+    s_session.id = id;
+    s_session.total = total;
+    s_session.next = 0;
+    s_session.done = 0;
+    taskEXIT_CRITICAL(&s_stream_lock);
+
+    ESP_LOGI(TAG, "Start session %08lx, size: %lu", id, total);
+    web_stream_send_ack(fd, WEB_STREAM_OK);
+}
+
+/* Returns the slot if the chunk was not queued */
+static web_stream_slot_t *web_stream_data(int fd, uint8_t *frame, size_t len, web_stream_slot_t *slot)
+{
+    uint8_t status = WEB_STREAM_OK;
+    uint32_t offset = 0;
+    uint32_t size = 0;
+    uint32_t id = 0;
+    bool duplicate = false;
+
+    if (len <= WEB_STREAM_DATA_HDR_SIZE)
+    {
+        web_stream_send_ack(fd, WEB_STREAM_BAD_FRAME);
+        return slot;
+    }
+
+    offset = web_stream_get_le32(&frame[4]);
+    size = len - WEB_STREAM_DATA_HDR_SIZE;
+
+    taskENTER_CRITICAL(&s_stream_lock);
+
+    if (!s_session.active || (s_session.fd != fd))
+    {
+        status = WEB_STREAM_NO_SESSION;
+    }
+    else if ((offset < s_session.next) && (offset + size <= s_session.next))
+    {
+        /* Resent after a reconnect, already queued */
+        duplicate = true;
+    }
+    else if (offset != s_session.next)
+    {
+        status = WEB_STREAM_BAD_OFFSET;
+    }
+    else if ((offset + size > s_session.total) ||
+             ((size != CONFIG_HTTPD_STREAM_CHUNK_SIZE) && (offset + size != s_session.total)))
+    {
+        status = WEB_STREAM_BAD_FRAME;
+    }
+
+    id = s_session.id;
+    taskEXIT_CRITICAL(&s_stream_lock);
+
+    if ((status == WEB_STREAM_OK) && !duplicate &&
+        (esp_rom_crc32_le(0, &frame[WEB_STREAM_DATA_HDR_SIZE], size) != web_stream_get_le32(&frame[8])))
+    {
+        status = WEB_STREAM_BAD_CRC;
+    }
+
+    if ((status != WEB_STREAM_OK) || duplicate)
+    {
+        web_stream_send_ack(fd, status);
+        return slot;
+    }
+
+    /* Short chunks were received into the shared buffer, move them into the queue */
+    if (!slot)
+    {
+        if (xQueueReceive(s_free_queue, &slot, 0) != pdTRUE)
+        {
+            /* Sent beyond the window, make the client resend from next */
+            web_stream_send_ack(fd, WEB_STREAM_BAD_OFFSET);
+            return NULL;
+        }
+
+        memcpy(slot->frame, frame, len);
+    }
+
+    slot->session = id;
+    slot->offset = offset;
+    slot->len = size;
+
+    taskENTER_CRITICAL(&s_stream_lock);
+    s_session.next += size;
+    taskEXIT_CRITICAL(&s_stream_lock);
+
+    /* Never blocks, the window guarantees a free place for every slot */
+    xQueueSend(s_write_queue, &slot, 0);
+
+    return NULL;
+}
+
+esp_err_t web_stream_handler(httpd_req_t *req)
+{
+    esp_err_t ret = ESP_OK;
+    web_data_t *data = (web_data_t *)req->user_ctx;
+    httpd_ws_frame_t ws_pkt = {false, false, HTTPD_WS_TYPE_BINARY, NULL, 0};
+    web_stream_slot_t *slot = NULL;
+    uint8_t *frame = data->buf;
+    int fd = httpd_req_to_sockfd(req);
+
+    /* Handshake */
+    if (req->method == HTTP_GET)
+    {
+        req->sess_ctx = (void *)(intptr_t)fd;
+        req->free_ctx = web_stream_client_free;
+
+        return web_stream_init(req->handle) ? ESP_OK : ESP_FAIL;
+    }
+
+    ret = httpd_ws_recv_frame(req, &ws_pkt, 0);
+    if (ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "httpd_ws_recv_frame failed to get frame len with %d", ret);
+        return ret;
+    }
+
+    if (ws_pkt.len > WEB_STREAM_FRAME_SIZE)
+    {
+        ESP_LOGE(TAG, "Frame too large: %u", (unsigned int)ws_pkt.len);
+        return ESP_FAIL;
+    }
+
+    /* Full size chunks are received straight into a queue slot */
+    if (ws_pkt.len > CONFIG_HTTPD_RESP_BUF_SIZE)
+    {
+        if (xQueueReceive(s_free_queue, &slot, 0) != pdTRUE)
+        {
+            ESP_LOGE(TAG, "Client ignored the flow control window");
+            return ESP_FAIL;
+        }
+
+        frame = slot->frame;
+    }
+
+    ws_pkt.payload = frame;
+    ret = httpd_ws_recv_frame(req, &ws_pkt, ws_pkt.len);
+
+    if ((ret == ESP_OK) && (ws_pkt.type == HTTPD_WS_TYPE_BINARY) && (ws_pkt.len > 0))
+    {
+        switch (frame[0])
+        {
+        case WEB_STREAM_CONFIG:
+            web_stream_config(fd, frame, ws_pkt.len);
+            break;
+
+        case WEB_STREAM_DATA:
+            slot = web_stream_data(fd, frame, ws_pkt.len, slot);
+            break;
+
+        default:
+            web_stream_send_ack(fd, WEB_STREAM_BAD_FRAME);
+            break;
+        }
+    }
+
+    if (slot)
+    {
+        xQueueSend(s_free_queue, &slot, 0);
+    }
+
+    return ret;
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add binary WebSocket streaming programming
+ */
+#pragma once
+
+#include "esp_http_server.h"
+
+/**
+ * @file web_stream.h
+ * @brief Streaming programming over a binary WebSocket
+ *
+ * All multi-byte fields are little endian.
+ *
+ * Client to server:
+ *   CONFIG  | 0x01 | rsv[3] | session u32 | JSON request (same as POST /program)
+ *   DATA    | 0x02 | rsv[3] | offset u32  | crc32 u32 | payload
+ *
+ * Server to client:
+ *   ACK     | 0x81 | status u8 | rsv[2] | chunk u32 | next u32 | done u32 | limit u32
+ *
+ * Every DATA payload is exactly `chunk` bytes except the last one. The client
+ * may send data up to `limit`, which is the programmed offset plus the free
+ * space of the programming queue, and advances the window with each ACK.
+ * `next` is the offset the server expects, `done` is what has been written
+ * to the target. A CONFIG frame carrying the session id of a transfer that is
+ * still running resumes it at `next` instead of starting a new one.
+ */
+
+/**
+ * @brief Stream status codes carried in ACK frames
+ */
+typedef enum
+{
+    WEB_STREAM_OK = 0,          ///< Transfer running
+    WEB_STREAM_DONE,            ///< All data written to the target
+    WEB_STREAM_BUSY,            ///< Another transfer owns the programmer
+    WEB_STREAM_REJECTED,        ///< Configuration refused by the programmer
+    WEB_STREAM_NO_SESSION,      ///< Data without a running transfer
+    WEB_STREAM_BAD_OFFSET,      ///< Offset is not `next`, resend from there
+    WEB_STREAM_BAD_CRC,         ///< Payload checksum mismatch, resend from `next`
+    WEB_STREAM_BAD_FRAME,       ///< Malformed frame
+    WEB_STREAM_FAILED           ///< Target programming failed, transfer aborted
+} web_stream_status_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /**
+     * @brief WebSocket handler of the streaming programming endpoint
+     * @param req Request
+     * @return ESP_OK on success
+     */
+    esp_err_t web_stream_handler(httpd_req_t *req);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add SWO trace WebSocket and endpoint
+ * 2026-10-19    hongquan.li   use the shared WebSocket fan-out
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "web/web_fanout.h"
+#include "web/web_swo.h"
+#include "web/web_handler.h"
+#include "trace/swo_trace.h"
+
+#define TAG "web_swo"
+
+/* Port byte and the decoder's flush size */
+#define WEB_SWO_FRAME_SIZE 129
+#define WEB_SWO_QUEUE_SIZE 4096
+
+static web_fanout_t s_swo_fanout;
+/* Only touched from the SWO capture task */
+static uint8_t s_swo_msg[WEB_SWO_FRAME_SIZE];
+
+/* Runs on the SWO capture task */
+static void web_swo_output(uint8_t port, const uint8_t *data, size_t size)
+{
+    size = (size > sizeof(s_swo_msg) - 1) ? (sizeof(s_swo_msg) - 1) : size;
+    s_swo_msg[0] = port;
+    memcpy(s_swo_msg + 1, data, size);
+    web_fanout_send(&s_swo_fanout, s_swo_msg, size + 1);
+}
+
+static bool web_swo_init(httpd_handle_t server)
+{
+    if (!web_fanout_init(&s_swo_fanout, server, WEB_SWO_QUEUE_SIZE, WEB_SWO_FRAME_SIZE, true))
+    {
+        return false;
+    }
+
+    s_swo_fanout.disconnected = swo_trace_client_disconnected;
+    swo_trace_register_output(web_swo_output);
+
+    return true;
+}
+
+esp_err_t web_swo_socket_handler(httpd_req_t *req)
+{
+    esp_err_t ret = ESP_OK;
+    web_data_t *data = (web_data_t *)req->user_ctx;
+    httpd_ws_frame_t ws_pkt = {false, false, HTTPD_WS_TYPE_BINARY, NULL, 0};
+
+    /* Handshake */
+    if (req->method == HTTP_GET)
+    {
+        if (!web_swo_init(req->handle))
+        {
+            return ESP_FAIL;
+        }
+
+        if (!web_fanout_add(&s_swo_fanout, req))
+        {
+            ESP_LOGE(TAG, "No room for another SWO client");
+            return ESP_FAIL;
+        }
+
+        swo_trace_client_connected();
+        return ESP_OK;
+    }
+
+    ret = httpd_ws_recv_frame(req, &ws_pkt, 0);
+    if (ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "httpd_ws_recv_frame failed to get frame len with %d", ret);
+        return ret;
+    }
+
+    if (ws_pkt.len > CONFIG_HTTPD_RESP_BUF_SIZE)
+    {
+        ESP_LOGE(TAG, "Frame length is over the limit(%d)", CONFIG_HTTPD_RESP_BUF_SIZE);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    /* Trace is one way, client frames are read and dropped */
+    ws_pkt.payload = data->buf;
+
+    return httpd_ws_recv_frame(req, &ws_pkt, ws_pkt.len);
+}
+
+esp_err_t web_swo_handler(httpd_req_t *req)
+{
+    int len = 0;
+    char *end = NULL;
+    char val[16] = {0};
+    uint32_t baud = 0;
+    web_data_t *data = (web_data_t *)req->user_ctx;
+    char *buf = (char *)data->buf;
+
+    httpd_resp_set_type(req, "application/json");
+
+    if (req->method == HTTP_POST)
+    {
+        if ((httpd_req_get_url_query_str(req, buf, CONFIG_HTTPD_RESP_BUF_SIZE) != ESP_OK) ||
+            (httpd_query_key_value(buf, "baud", val, sizeof(val)) != ESP_OK))
+        {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Missing baud");
+            return ESP_FAIL;
+        }
+
+        baud = strtoul(val, &end, 0);
+        if ((end == val) || (*end != '\0') || (baud == 0))
+        {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid baud");
+            return ESP_FAIL;
+        }
+
+        swo_trace_set_baudrate(baud);
+    }
+
+    swo_trace_get_status(buf, CONFIG_HTTPD_RESP_BUF_SIZE, &len);
+    httpd_resp_send(req, buf, len);
+
+    return ESP_OK;
+}
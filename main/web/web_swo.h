@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add SWO trace WebSocket and endpoint
+ */
+#pragma once
+
+#include "esp_http_server.h"
+
+/**
+ * @file web_swo.h
+ * @brief Decoded ITM stimulus ports over WebSocket
+ *
+ * Every client of /swo_socket receives binary frames of one stimulus port
+ * each, the first byte is the port number (0..31) and the rest its data.
+ *
+ * GET /api/swo returns the trace status, POST /api/swo?baud=<baudrate> sets
+ * the SWO baudrate used for probe side capture.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /**
+     * @brief WebSocket handler of the SWO trace endpoint
+     * @param req Request
+     * @return ESP_OK on success
+     */
+    esp_err_t web_swo_socket_handler(httpd_req_t *req);
+
+    /**
+     * @brief Handler of the SWO trace status endpoint
+     * @param req Request
+     * @return ESP_OK on success
+     */
+    esp_err_t web_swo_handler(httpd_req_t *req);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add live variable WebSocket and endpoint
+ * 2026-10-19    hongquan.li   use the shared WebSocket fan-out
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "esp_log.h"
+#include "cJSON.h"
+#include "web/web_fanout.h"
+#include "web/web_watch.h"
+#include "web/web_handler.h"
+#include "watch/data_watch.h"
+
+#define TAG "web_watch"
+
+/* Whole batches, a slow browser loses batches rather than parts of them */
+#define WEB_WATCH_QUEUE_SIZE (4 * CONFIG_DATA_WATCH_BATCH_SIZE)
+
+static web_fanout_t s_watch_fanout;
+static data_watch_var_t s_watch_vars[CONFIG_DATA_WATCH_MAX_VARS];
+
+/* Runs on the sampler task */
+static void web_watch_output(const uint8_t *data, size_t size)
+{
+    web_fanout_send(&s_watch_fanout, data, size);
+}
+
+static bool web_watch_init(httpd_handle_t server)
+{
+    if (!web_fanout_init(&s_watch_fanout, server, WEB_WATCH_QUEUE_SIZE, CONFIG_DATA_WATCH_BATCH_SIZE, true))
+    {
+        return false;
+    }
+
+    data_watch_register_output(web_watch_output);
+
+    return true;
+}
+
+static bool web_watch_get_addr(const cJSON *item, uint32_t *addr)
+{
+    char *end = NULL;
+
+    if (cJSON_IsNumber(item))
+    {
+        /* valueint saturates at INT_MAX, system space is above that */
+        if ((item->valuedouble < 0) || (item->valuedouble > UINT32_MAX))
+        {
+            return false;
+        }
+
+        *addr = (uint32_t)item->valuedouble;
+        return true;
+    }
+
+    if (cJSON_IsString(item))
+    {
+        *addr = strtoul(item->valuestring, &end, 0);
+        return (end != item->valuestring) && (*end == '\0');
+    }
+
+    return false;
+}
+
+/* Returns false if the JSON itself is unusable, err holds the sampler's verdict otherwise */
+static bool web_watch_apply(const char *json, data_watch_err_t *err)
+{
+    int count = 0;
+    cJSON *root = NULL;
+    cJSON *rate = NULL;
+    cJSON *vars = NULL;
+    cJSON *var = NULL;
+    cJSON *size = NULL;
+    bool ret = false;
+
+    root = cJSON_Parse(json);
+    if (!root)
+    {
+        return false;
+    }
+
+    rate = cJSON_GetObjectItem(root, "rate_hz");
+    vars = cJSON_GetObjectItem(root, "vars");
+
+    if (!cJSON_IsNumber(rate) || !cJSON_IsArray(vars))
+    {
+        goto __exit;
+    }
+
+    cJSON_ArrayForEach(var, vars)
+    {
+        if (count >= CONFIG_DATA_WATCH_MAX_VARS)
+        {
+            *err = DATA_WATCH_ERR_TOO_MANY;
+            ret = true;
+            goto __exit;
+        }
+
+        size = cJSON_GetObjectItem(var, "size");
+        if (!cJSON_IsNumber(size) || !web_watch_get_addr(cJSON_GetObjectItem(var, "addr"), &s_watch_vars[count].addr))
+        {
+            goto __exit;
+        }
+
+        s_watch_vars[count].size = (size->valueint > 0 && size->valueint <= UINT8_MAX) ? size->valueint : 0;
+        count++;
+    }
+
+    *err = data_watch_start(s_watch_vars, count, (rate->valueint > 0) ? rate->valueint : 0);
+    ret = true;
+
+__exit:
+    cJSON_Delete(root);
+    return ret;
+}
+
+esp_err_t web_watch_socket_handler(httpd_req_t *req)
+{
+    esp_err_t ret = ESP_OK;
+    web_data_t *data = (web_data_t *)req->user_ctx;
+    httpd_ws_frame_t ws_pkt = {false, false, HTTPD_WS_TYPE_TEXT, NULL, 0};
+    data_watch_err_t err = DATA_WATCH_OK;
+
+    /* Handshake */
+    if (req->method == HTTP_GET)
+    {
+        if (!web_watch_init(req->handle))
+        {
+            return ESP_FAIL;
+        }
+
+        if (!web_fanout_add(&s_watch_fanout, req))
+        {
+            ESP_LOGE(TAG, "No room for another watch client");
+            return ESP_FAIL;
+        }
+
+        return ESP_OK;
+    }
+
+    ret = httpd_ws_recv_frame(req, &ws_pkt, 0);
+    if (ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "httpd_ws_recv_frame failed to get frame len with %d", ret);
+        return ret;
+    }
+
+    /* Room for the terminator */
+    if (ws_pkt.len >= CONFIG_HTTPD_RESP_BUF_SIZE)
+    {
+        ESP_LOGE(TAG, "Frame length is over the limit(%d)", CONFIG_HTTPD_RESP_BUF_SIZE);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    ws_pkt.payload = data->buf;
+    ret = httpd_ws_recv_frame(req, &ws_pkt, ws_pkt.len);
+
+    if ((ret == ESP_OK) && (ws_pkt.type == HTTPD_WS_TYPE_TEXT))
+    {
+        data->buf[ws_pkt.len] = '\0';
+
+        if (!web_watch_apply((char *)data->buf, &err))
+        {
+            ESP_LOGW(TAG, "Invalid variable list");
+        }
+        else if (err != DATA_WATCH_OK)
+        {
+            ESP_LOGW(TAG, "Variable list rejected: %d", err);
+        }
+    }
+
+    return ret;
+}
+
+esp_err_t web_watch_handler(httpd_req_t *req)
+{
+    int len = 0;
+    int offset = 0;
+    int received = 0;
+    web_data_t *data = (web_data_t *)req->user_ctx;
+    char *buf = (char *)data->buf;
+    data_watch_err_t err = DATA_WATCH_OK;
+
+    httpd_resp_set_type(req, "application/json");
+
+    if (req->method == HTTP_POST)
+    {
+        if ((req->content_len <= 0) || (req->content_len >= CONFIG_HTTPD_RESP_BUF_SIZE))
+        {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid request size");
+            return ESP_FAIL;
+        }
+
+        while (offset < req->content_len)
+        {
+            received = httpd_req_recv(req, buf + offset, req->content_len - offset);
+            if (received <= 0)
+            {
+                if (received == HTTPD_SOCK_ERR_TIMEOUT)
+                {
+                    continue;
+                }
+
+                return ESP_FAIL;
+            }
+
+            offset += received;
+        }
+
+        buf[offset] = '\0';
+
+        if (!web_watch_apply(buf, &err))
+        {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid variable list");
+            return ESP_FAIL;
+        }
+
+        if (err != DATA_WATCH_OK)
+        {
+            snprintf(buf, CONFIG_HTTPD_RESP_BUF_SIZE, "{\"error\":%d}", err);
+            httpd_resp_set_status(req, "400 Bad Request");
+            httpd_resp_sendstr(req, buf);
+            return ESP_OK;
+        }
+    }
+    else if (req->method == HTTP_DELETE)
+    {
+        data_watch_stop();
+    }
+
+    data_watch_get_status(buf, CONFIG_HTTPD_RESP_BUF_SIZE, &len);
+    httpd_resp_send(req, buf, len);
+
+    return ESP_OK;
+}
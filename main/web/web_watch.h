@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2026-2026, hongquan.li
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19    hongquan.li   add live variable WebSocket and endpoint
+ */
+#pragma once
+
+#include "esp_http_server.h"
+
+/**
+ * @file web_watch.h
+ * @brief Live variable sampling over WebSocket
+ *
+ * Every client of /watch_socket receives the sample batches described in
+ * data_watch.h as binary frames. A text frame from a client sets the
+ * variable list the same way as POST /api/watch.
+ *
+ * POST /api/watch starts sampling with a JSON body:
+ *
+ *     {"rate_hz": 1000, "vars": [{"addr": "0x20000010", "size": 4}, ...]}
+ *
+ * addr is a number or a string in any strtoul base. GET /api/watch returns
+ * the sampler status, DELETE /api/watch stops it.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /**
+     * @brief WebSocket handler of the live variable endpoint
+     * @param req Request
+     * @return ESP_OK on success
+     */
+    esp_err_t web_watch_socket_handler(httpd_req_t *req);
+
+    /**
+     * @brief Handler of the live variable status and control endpoint
+     * @param req Request
+     * @return ESP_OK on success
+     */
+    esp_err_t web_watch_handler(httpd_req_t *req);
+
+#ifdef __cplusplus
+}
+#endif